@@ -26,6 +26,9 @@
 
 #ifdef JITTARGET_GENERIC
 
+// ANSI C
+#include <string.h>
+
 // Einstein
 #include "TMemory.h"
 #include "TJITGeneric.h"
@@ -35,6 +38,8 @@
 #include "TMemoryConsts.h"
 
 #include "TJITGenericROMPatch.h"
+#include "TJITGenericROMCache.h"
+#include "ROM/TROMImage.h"
 
 #if RASPBERRY_PI || TARGET_OS_LINUX
 #include "../../NativeCalls/TVirtualizedCallsPatches.h"
@@ -133,10 +138,26 @@ test()
 // -------------------------------------------------------------------------- //
 TJITGeneric::TJITGeneric(
 		TMemory* inMemoryIntf,
-		TMMU* inMMUIntf )
+		TMMU* inMMUIntf,
+		KUInt32 inCachePageCount /* = 0 */ )
 	:
-		TJIT<TJITGeneric, TJITGenericPage>( inMemoryIntf, inMMUIntf )
+		TJIT<TJITGeneric, TJITGenericPage>(
+			inMemoryIntf, inMMUIntf, inCachePageCount ),
+		mReturnStackTop( 0 )
 {
+	// Generation 0 is never valid.
+	::memset( mReturnStack, 0, sizeof(mReturnStack) );
+#if JIT_TIERED_TRANSLATION
+	mTierUpUnits[0].fFuncPtr = TJITGenericPage::Retranslate;
+	mTierUpUnits[1].fPtr = 0;
+	mTierUpUnits[2].fValue = 0;
+	mTierUpCount = 0;
+#endif
+	mVerifyState.fLogging = false;
+	mVerifyState.fStepping = false;
+	mVerifyState.fAborted = false;
+	mVerifyState.fInstructionCount = 0;
+	mVerifyState.fWriteCount = 0;
 }
 
 // -------------------------------------------------------------------------- //
@@ -144,6 +165,31 @@ TJITGeneric::TJITGeneric(
 // -------------------------------------------------------------------------- //
 TJITGeneric::~TJITGeneric( void )
 {
+#if JIT_ROM_CACHE
+	if (mROMCache)
+	{
+		delete mROMCache;
+	}
+#endif
+}
+
+// -------------------------------------------------------------------------- //
+//  * OpenROMCache( TROMImage* )
+// -------------------------------------------------------------------------- //
+void
+TJITGeneric::OpenROMCache( TROMImage* inROMImage )
+{
+#if JIT_ROM_CACHE
+	const char* theImagePath = inROMImage->GetImagePath();
+	if (theImagePath && (mROMCache == NULL))
+	{
+		KUInt32 theChecksums[10];
+		inROMImage->ComputeChecksums( theChecksums );
+		mROMCache = new TJITGenericROMCache( theImagePath, theChecksums );
+	}
+#else
+	(void) inROMImage;
+#endif
 }
 
 // -------------------------------------------------------------------------- //
@@ -202,18 +248,76 @@ TJITGeneric::Step( TARMProcessor* ioCPU, KUInt32 count )
 	JITUnit* theJITUnit = GetJITUnitForPC( ioCPU, theMemoryInterface, *pcPtr );
 	while (count-- > 0)
 	{
+#if JIT_TIERED_TRANSLATION
+		// Translate the page again before the halt is inserted, and start
+		// with the instruction itself rather than with the counting stub.
+		if (theJITUnit->fFuncPtr == TJITGenericPage::Retranslate)
+		{
+			theJITUnit = theJITUnit->fFuncPtr( theJITUnit, ioCPU );
+		}
+#endif
+#if JIT_LAZY_TRANSLATION
+		// The stub only translates the run and returns its first unit.
+		if (theJITUnit->fFuncPtr == TJITGenericPage::LazyTranslate)
+		{
+			theJITUnit = theJITUnit->fFuncPtr( theJITUnit, ioCPU );
+		}
+#endif
+#if JIT_TIERED_TRANSLATION
+		theJITUnit = TJITGenericPage::SkipCountingStub( theJITUnit );
+#endif
 		// To make sure we execute only one instruction, insert a halt for the
 		// next instruction.
 		JITUnit* theNextJITUnit =
 			GetJITUnitForPC( ioCPU, theMemoryInterface, *pcPtr + 4 );
+#if JIT_TIERED_TRANSLATION
+		// The previous instruction falls through to it without its stub.
+		theNextJITUnit = TJITGenericPage::SkipCountingStub( theNextJITUnit );
+#endif
+		// The units of the page move if the instruction makes it grow:
+		// remember where the halt is.
+		TJITGenericPage* theNextPage = NULL;
+		KUInt32 theNextUnitIndex = 0;
 		KUIntPtr theSavedValue = 0;
 		if (theNextJITUnit) {
+			theNextPage = GetPage( *pcPtr );
+			if (theNextPage
+				&& (theNextJITUnit >= theNextPage->mUnits)
+				&& (theNextJITUnit < &theNextPage->mUnits[theNextPage->mUnitCount]))
+			{
+				theNextUnitIndex =
+					(KUInt32) (theNextJITUnit - theNextPage->mUnits);
+			} else {
+				theNextPage = NULL;
+			}
 			theSavedValue = theNextJITUnit->fPtr;
 			theNextJITUnit->fFuncPtr = TJITGenericPage::Halt;
 		}
 		// Execute only one instruction.
+#if JIT_LAZY_TRANSLATION
+		KUInt32 thePC = *pcPtr;
+#endif
 		theJITUnit = theJITUnit->fFuncPtr( theJITUnit, ioCPU );
-		if (theNextJITUnit) {
+		if (theNextPage) {
+			theNextJITUnit = &theNextPage->mUnits[theNextUnitIndex];
+		}
+#if JIT_LAZY_TRANSLATION
+		// The end of a run returns the next unit instead of calling it, so
+		// the halt did not set the PC.
+		JITUnit* theReturnedUnit = theJITUnit;
+#if JIT_TIERED_TRANSLATION
+		theReturnedUnit = TJITGenericPage::SkipCountingStub( theReturnedUnit );
+#endif
+		if (theNextJITUnit
+			&& (theReturnedUnit == theNextJITUnit)
+			&& (*pcPtr == thePC))
+		{
+			theJITUnit = TJITGenericPage::Halt( theNextJITUnit, ioCPU );
+		}
+#endif
+		// The page may also have been translated again in the meantime.
+		if (theNextJITUnit
+			&& (theNextJITUnit->fFuncPtr == TJITGenericPage::Halt)) {
 			theNextJITUnit->fPtr = theSavedValue;
 		}
 
@@ -266,6 +370,39 @@ TJITGeneric::GetJITUnitForPC(
 	return thePage->GetJITUnitForOffset(indexInPage);
 }
 
+// -------------------------------------------------------------------------- //
+//  * GetJITUnitForLink( TARMProcessor*, TMemory*, KUInt32, Boolean* )
+// -------------------------------------------------------------------------- //
+JITUnit*
+TJITGeneric::GetJITUnitForLink(
+					TARMProcessor* ioCPU,
+					TMemory* inMemoryInterface,
+					KUInt32 inPC,
+					Boolean* outCanLink )
+{
+	KUInt32 pc = inPC - 4;
+	KUInt32 theMisses = GetCacheStats().fMisses;
+	TJITGenericPage* thePage = GetPage(pc);
+
+	if (thePage == NULL)
+	{
+		// Let's manage the exception, the link won't be made.
+		*outCanLink = false;
+		ioCPU->PrefetchAbort();
+		
+		pc = ioCPU->mCurrentRegisters[TARMProcessor::kR15];
+		return GetJITUnitForPC( ioCPU, inMemoryInterface, pc );
+	}
+
+	// A miss may have recycled the page of the link.
+	*outCanLink = (GetCacheStats().fMisses == theMisses);
+
+	// Recycling the page will break the link.
+	MarkLinked( thePage );
+
+	KUInt32 indexInPage = GetOffsetInPage(pc) / sizeof( KUInt32 );
+	return thePage->GetJITUnitForOffset(indexInPage);
+}
 
 KSInt32
 TJITGeneric::GetJITUnitDelta(
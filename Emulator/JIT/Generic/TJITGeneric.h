@@ -33,17 +33,37 @@
 
 class TMemory;
 class TARMProcessor;
+class TROMImage;
+class TJITGenericROMCache;
 union JITUnit;
 
 
 const KSInt32 kNotTheSamePage	= 0x7f000001;
 const KSInt32 kOffsetUnknown	= 0x7f000000;
 
+///
+/// Holder of the cache of the translated ROM pages.
+/// It is a base class of TJITGeneric so the pointer is set before the cache
+/// of pages is created: its constructor initializes ROM pages, which look
+/// for the ROM cache.
+///
+class TJITGenericROMCacheHolder
+{
+protected:
+	TJITGenericROMCacheHolder( void )
+		:
+			mROMCache( NULL )
+		{}
+
+	TJITGenericROMCache*	mROMCache;	///< Cache of the ROM pages (or NULL).
+};
+
 ///
 /// Class for generic JIT interface.
 ///
 class TJITGeneric
 	:
+		private TJITGenericROMCacheHolder,
 		public TJIT< TJITGeneric, TJITGenericPage >
 {
 public:
@@ -53,10 +73,12 @@ public:
 	///
 	/// \param inMemoryIntf	interface to memory.
 	/// \param inMMUIntf	interface to the MMU.
+	/// \param inCachePageCount	number of pages of the cache (0 for default).
 	///
 	TJITGeneric(
 		TMemory* inMemoryIntf,
-		TMMU* inMMUIntf );
+		TMMU* inMMUIntf,
+		KUInt32 inCachePageCount = 0 );
 	
 	///
 	/// Destructor.
@@ -92,6 +114,19 @@ public:
 					TMemory* inMemoryInterface,
 					KUInt32 inPC );
 
+	///
+	/// Get a JIT unit for a given PC, to be kept by a link or an inline
+	/// cache. The page is marked as linked to.
+	///
+	/// \param outCanLink	on output, \c false if the lookup aborted or
+	///						recycled a page (maybe the one with the link).
+	///
+	JITUnit* GetJITUnitForLink(
+					TARMProcessor* ioCPU,
+					TMemory* inMemoryInterface,
+					KUInt32 inPC,
+					Boolean* outCanLink );
+
 	///
 	/// Get the offset between the current JIT unit and the JIT unit for the new PC
 	/// \return kNotTheSamePage if the units are not on the same page
@@ -102,6 +137,134 @@ public:
 							JITUnit* inUnit,
 							KUInt32 inPC);
 
+	///
+	/// Record the return address of a call (BL) on the return stack.
+	///
+	/// \param inPC		value of the PC on return (LR + 4).
+	/// \param inUnit	unit that follows the call.
+	///
+	void	PushReturn( KUInt32 inPC, JITUnit* inUnit )
+		{
+			mReturnStackTop = (mReturnStackTop + 1) & (kReturnStackSize - 1);
+			SReturnEntry* theEntry = &mReturnStack[mReturnStackTop];
+			theEntry->fPC = inPC;
+			theEntry->fUnit = inUnit;
+			theEntry->fGeneration = GetCacheGeneration();
+		}
+
+	///
+	/// Predict the unit of an indirect branch with the return stack.
+	/// The top entry is popped if it matches the new PC and if it was
+	/// recorded in the current generation of the cache (so invalidations
+	/// flush the stack).
+	///
+	/// \param inPC		new value of the PC.
+	/// \return the unit or NULL if the prediction failed.
+	///
+	JITUnit*	PopReturn( KUInt32 inPC )
+		{
+			SReturnEntry* theEntry = &mReturnStack[mReturnStackTop];
+			if ((theEntry->fPC == inPC)
+				&& (theEntry->fGeneration == GetCacheGeneration()))
+			{
+				mReturnStackTop =
+					(mReturnStackTop - 1) & (kReturnStackSize - 1);
+				return theEntry->fUnit;
+			}
+			return NULL;
+		}
+
+	///
+	/// Drop the entries of the return stack in a page that is recycled.
+	///
+	/// \param inPage	page that is recycled.
+	///
+	void	ForgetReturns( const TJITGenericPage* inPage )
+		{
+			const JITUnit* theFirstUnit = inPage->mUnits;
+			const JITUnit* theLastUnit = theFirstUnit + inPage->mUnitCount;
+			KUInt32 indexEntry;
+			for (indexEntry = 0; indexEntry < kReturnStackSize; indexEntry++)
+			{
+				SReturnEntry* theEntry = &mReturnStack[indexEntry];
+				if ((theEntry->fUnit >= theFirstUnit)
+					&& (theEntry->fUnit < theLastUnit))
+				{
+					theEntry->fGeneration = 0;
+				}
+			}
+		}
+
+	///
+	/// Drop every entry of the return stack.
+	///
+	void	FlushReturns( void )
+		{
+			::memset( mReturnStack, 0, sizeof(mReturnStack) );
+		}
+
+#if JIT_TIERED_TRANSLATION
+	///
+	/// Request the translation of a hot page again, from its stub.
+	///
+	/// \param inPage	page to translate again.
+	/// \param inIndex	index of the instruction to continue with.
+	/// \return the unit to continue with, that translates the page.
+	///
+	JITUnit*	RequestTierUp( TJITGenericPage* inPage, KUInt32 inIndex )
+		{
+			mTierUpUnits[1].fPtr = (KUIntPtr) inPage;
+			mTierUpUnits[2].fValue = inIndex;
+			return mTierUpUnits;
+		}
+
+	///
+	/// A page was translated again, its units were replaced.
+	///
+	void		TieredUp( void )
+		{
+			mTierUpCount++;
+			InvalidateLinks();
+		}
+
+	///
+	/// Number of pages that were translated again since the JIT was created.
+	///
+	KUInt32		GetTierUpCount( void ) const
+		{
+			return mTierUpCount;
+		}
+#endif
+
+	///
+	/// Open the cache of the translated ROM pages, beside the ROM image.
+	/// Does nothing if the cache is disabled.
+	///
+	/// \param inROMImage	ROM image.
+	///
+	void OpenROMCache( TROMImage* inROMImage );
+
+	///
+	/// Accessor on the cache of the translated ROM pages.
+	///
+	/// \return the cache or NULL if there is none.
+	///
+	TJITGenericROMCache* GetROMCache( void )
+		{
+			return mROMCache;
+		}
+
+	///
+	/// Accessor on the state of the verification of the precompiled
+	/// translations of this emulator.
+	///
+	/// \return the state of the verification.
+	///
+	TJITGenericPatchPrecompiled::SVerifyState* GetVerifyState( void )
+		{
+			return &mVerifyState;
+		}
+
 	///
 	/// ID and version for patches.
 	/// Version should be bumped for every new collection of retargetted functions.
@@ -133,11 +296,29 @@ private:
 
 	enum {
 		kPoolSize = 512,	///< 512 pages in pool.
+		kReturnStackSize = 16,	///< Entries of the return stack (power of 2).
+	};
+
+	/// Entry of the return stack.
+	struct SReturnEntry {
+		KUInt32		fPC;			///< PC on return.
+		JITUnit*	fUnit;			///< Unit that follows the call.
+		KUInt32		fGeneration;	///< Generation of the cache.
 	};
 	
 	/// \name Variables
 	
 	TJITGenericPage*	mPagesPool;	///< Array with all the pages.
+	SReturnEntry		mReturnStack[kReturnStackSize];	///< Return stack,
+									///< circular.
+	KUInt32				mReturnStackTop;	///< Index of the top entry.
+#if JIT_TIERED_TRANSLATION
+	JITUnit				mTierUpUnits[3];	///< Retranslate, page, index.
+	KUInt32				mTierUpCount;		///< Pages translated again.
+#endif
+	TJITGenericPatchPrecompiled::SVerifyState
+						mVerifyState;		///< Verification of the
+											///< precompiled translations.
 };
 
 #endif
@@ -28,7 +28,10 @@
 
 // Einstein
 #include "TARMProcessor.h"
+#include "TEmulator.h"
 #include "TJITGenericPage.h"
+#include "TJITGenericROMCache.h"
+#include "TMemory.h"
 
 #include "TJITGeneric_Macros.h"
 
@@ -41,6 +44,7 @@
 #include "TJITGeneric_MultiplyAndAccumulate.h"
 #include "TJITGeneric_BlockDataTransfer.h"
 #include "TJITGeneric_HalfwordAndSignedDataTransfer.h"
+#include "TJITGeneric_SuperInstructions.h"
 
 #ifdef JIT_PERFORMANCE
 #include "TJITPerformance.h"
@@ -61,8 +65,20 @@ static KUInt16 gMaxUnitsCount = 0;
 // -------------------------------------------------------------------------- //
 TJITGenericPage::TJITGenericPage( void )
 {
-	mUnits = (JITUnit*) ::malloc(sizeof(JITUnit) * kDefaultUnitCount);
-	mUnitCount = kDefaultUnitCount;
+	// Units are allocated from the arena of the cache, by Init.
+	mUnits = NULL;
+	mUnitCount = 0;
+	mUnitArena = NULL;
+#if JIT_ROM_CACHE
+	mFuncMap = NULL;
+#endif
+#if JIT_NATIVE_CODE
+	mNativeBlockCrsr = 0;
+#endif
+#if JIT_TIERED_TRANSLATION
+	mExecCount = 0;
+	mHot = false;
+#endif
 }
 
 // -------------------------------------------------------------------------- //
@@ -70,7 +86,10 @@ TJITGenericPage::TJITGenericPage( void )
 // -------------------------------------------------------------------------- //
 TJITGenericPage::~TJITGenericPage( void )
 {
-	::free(mUnits);
+	if (mUnitArena)
+	{
+		mUnitArena->Free(mUnits, mUnitCount);
+	}
 }
 
 // -------------------------------------------------------------------------- //
@@ -83,25 +102,94 @@ TJITGenericPage::Init(
 			KUInt32 inPAddr )
 {
 	TJITPage<TJITGeneric, TJITGenericPage>::Init( inMemoryIntf, inVAddr, inPAddr );
-	KUInt32* thePointer = GetPointer();
 
-	// Translate the page.
-	KUInt32 indexInstr;
-	KUInt32 theOffsetInPage = 0;
-	KUInt16 unitCrsr = 0;
-	for (indexInstr = 0; indexInstr < kInstructionCount; indexInstr++)
+	// A recycled page reuses its units.
+	if (mUnits == NULL)
 	{
-		mUnitsTable[indexInstr] = unitCrsr;
-		Translate(
-		    inMemoryIntf,
-			&unitCrsr,
-			thePointer[indexInstr],
-			inVAddr + theOffsetInPage );
-		theOffsetInPage += 4;
+		mUnitCount = kDefaultUnitCount;
+		mUnits = mUnitArena->Allocate(&mUnitCount);
 	}
 
-	PushUnit(&unitCrsr, TJITGenericPage::EndOfPage);
-	PushUnit(&unitCrsr, inVAddr + theOffsetInPage + 4);	// PC + 8
+#if JIT_TIERED_TRANSLATION
+	mExecCount = 0;
+	mHot = false;
+#endif
+	InitUnits( inMemoryIntf );
+}
+
+#if JIT_TIERED_TRANSLATION
+// -------------------------------------------------------------------------- //
+//  * TierUp( TMemory* )
+// -------------------------------------------------------------------------- //
+void
+TJITGenericPage::TierUp( TMemory* inMemoryIntf )
+{
+	mHot = true;
+	InitUnits( inMemoryIntf );
+}
+#endif
+
+// -------------------------------------------------------------------------- //
+//  * InitUnits( TMemory* )
+// -------------------------------------------------------------------------- //
+void
+TJITGenericPage::InitUnits( TMemory* inMemoryIntf )
+{
+	KUInt16 unitCrsr = 0;
+#if JIT_ROM_CACHE
+	// ROM pages are translated completely and kept in the cache.
+	TJITGenericROMCache* theROMCache =
+		inMemoryIntf->GetJITObject()->GetROMCache();
+	Boolean isCached =
+		theROMCache && TJITGenericROMCache::Covers( GetPAddr() );
+#if JIT_TIERED_TRANSLATION
+	if (isCached)
+	{
+		// They are translated once, with every optimization.
+		mHot = true;
+	}
+#endif
+#endif
+#if JIT_FLAGS_LIVENESS
+	if (IsHot())
+	{
+		ComputeFlagsLiveness();
+	}
+#endif
+#if JIT_NATIVE_CODE
+	mEmitter.Reset();
+#endif
+#if JIT_ROM_CACHE
+	if (isCached)
+	{
+		if (!theROMCache->Load( this, &unitCrsr ))
+		{
+			theROMCache->BeginStore( this );
+			TranslatePage( inMemoryIntf, &unitCrsr );
+			theROMCache->Store( this, unitCrsr );
+		}
+	} else
+#endif
+	{
+#if JIT_LAZY_TRANSLATION
+		// Put a stub for every instruction, they will be translated when they
+		// are first executed.
+		KUInt32 indexInstr;
+		for (indexInstr = 0; indexInstr < kInstructionCount; indexInstr++)
+		{
+			mUnitsTable[indexInstr] = unitCrsr;
+			PushUnit(&unitCrsr, TJITGenericPage::LazyTranslate);
+			PushUnit(&unitCrsr, (KUIntPtr) this);
+			PushUnit(&unitCrsr, indexInstr);
+		}
+		PushEndOfPage(&unitCrsr);
+#else
+		TranslatePage( inMemoryIntf, &unitCrsr );
+#endif
+	}
+#if JIT_LAZY_TRANSLATION
+	mUnitCrsr = unitCrsr;
+#endif
 
 #ifdef COLLECT_STATS_ON_PAGES
 	if (unitCrsr > gMaxUnitsCount) {
@@ -111,6 +199,90 @@ TJITGenericPage::Init(
 #endif
 }
 
+// -------------------------------------------------------------------------- //
+//  * TranslatePage( TMemory*, KUInt16* )
+// -------------------------------------------------------------------------- //
+void
+TJITGenericPage::TranslatePage(
+			TMemory* inMemoryIntf,
+			KUInt16* ioUnitCrsr )
+{
+	KUInt32* thePointer = GetPointer();
+	KUInt32 theVAddr = GetVAddr();
+
+	// Translate the page.
+#if JIT_SUPERINSTRUCTIONS
+	KUInt16 theSkipCrsr = 0;
+#endif
+	KUInt32 indexInstr;
+	for (indexInstr = 0; indexInstr < kInstructionCount; indexInstr++)
+	{
+		mUnitsTable[indexInstr] = *ioUnitCrsr;
+#if JIT_NATIVE_CODE
+		if (TranslateNative(
+				inMemoryIntf,
+				ioUnitCrsr,
+				thePointer[indexInstr],
+				theVAddr + (indexInstr * 4) ))
+		{
+			continue;
+		}
+		CloseNativeBlock(*ioUnitCrsr);
+#endif
+#if JIT_SUPERINSTRUCTIONS
+		if (theSkipCrsr == 0)
+		{
+			if ((indexInstr + 1 < kInstructionCount)
+				&& Translate_SuperInstruction(
+					this,
+					ioUnitCrsr,
+					thePointer[indexInstr],
+					thePointer[indexInstr + 1],
+					theVAddr + (indexInstr * 4),
+					&theSkipCrsr ))
+			{
+				continue;
+			}
+		}
+#endif
+		Translate(
+			inMemoryIntf,
+			ioUnitCrsr,
+			thePointer[indexInstr],
+			theVAddr + (indexInstr * 4) );
+#if JIT_SUPERINSTRUCTIONS
+		if (theSkipCrsr != 0)
+		{
+			// Second instruction of a superinstruction.
+			Finish_SuperInstruction(
+				this,
+				mUnitsTable[indexInstr - 1],
+				theSkipCrsr,
+				*ioUnitCrsr );
+			theSkipCrsr = 0;
+		}
+#endif
+	}
+#if JIT_NATIVE_CODE
+	CloseNativeBlock(*ioUnitCrsr);
+	mEmitter.MakeExecutable();
+#endif
+
+	PushEndOfPage(ioUnitCrsr);
+}
+
+// -------------------------------------------------------------------------- //
+//  * PushEndOfPage( KUInt16* )
+// -------------------------------------------------------------------------- //
+void
+TJITGenericPage::PushEndOfPage( KUInt16* ioUnitCrsr )
+{
+	PushUnit(ioUnitCrsr, TJITGenericPage::EndOfPage);
+	PushUnit(ioUnitCrsr, GetVAddr() + (kInstructionCount * 4) + 4);	// PC + 8
+	PushUnit(ioUnitCrsr, (KUIntPtr) 0);				// Linked unit
+	PushUnit(ioUnitCrsr, (KUIntPtr) 0);				// Link generation
+}
+
 // -------------------------------------------------------------------------- //
 //  * PushUnit( KUInt16*, KUIntPtr )
 // -------------------------------------------------------------------------- //
@@ -120,14 +292,288 @@ TJITGenericPage::PushUnit(KUInt16* ioUnitCrsr, KUIntPtr inUnit)
 	// Can we push it?
 	KUInt16 theCrsr = *ioUnitCrsr;
 	if (theCrsr == mUnitCount) {
-		// We need to resize the table.
-		mUnitCount += kUnitIncrement;
-		mUnits = (JITUnit*) ::realloc(mUnits, mUnitCount * sizeof(JITUnit));
+		GrowUnits(mUnitCount + kUnitIncrement);
 	}
+	
 	mUnits[theCrsr++].fPtr = inUnit;
 	*ioUnitCrsr = theCrsr;
 }
 
+// -------------------------------------------------------------------------- //
+//  * GrowUnits( KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TJITGenericPage::GrowUnits( KUInt32 inUnitCount )
+{
+	mUnits = mUnitArena->Grow(mUnits, &mUnitCount, inUnitCount);
+}
+
+
+#if JIT_LAZY_TRANSLATION
+// -------------------------------------------------------------------------- //
+//  * TranslateRun( TMemory*, KUInt32 )
+// -------------------------------------------------------------------------- //
+JITUnit*
+TJITGenericPage::TranslateRun(
+				TMemory* inMemoryIntf,
+				KUInt32 inIndex )
+{
+	KUInt32* thePointer = GetPointer();
+	KUInt32 theVAddr = GetVAddr();
+	KUInt16 unitCrsr = mUnitCrsr;
+	KUInt16 firstUnitCrsr = unitCrsr;
+	const JITUnit* theUnits = mUnits;
+	KUInt32 indexInstr = inIndex;
+	
+	// Translate up to the next instruction that may change the PC or the
+	// next instruction that was already translated. We also stop at stubs
+	// replaced with Halt by Step.
+#if JIT_SUPERINSTRUCTIONS
+	KUInt16 theSkipCrsr = 0;
+#endif
+	do {
+		KUInt32 theInstruction = thePointer[indexInstr];
+		KUInt32 theStubCrsr = kStubUnitCount * indexInstr;
+
+		// The stub now jumps to the translated instruction.
+#if JIT_TIERED_TRANSLATION
+		if (!mHot)
+		{
+			// It remains the entry point of the instruction, to count the
+			// entries into the page.
+			mUnits[theStubCrsr].fFuncPtr = CountedLazyJump;
+			mUnits[theStubCrsr + 1].fValue = unitCrsr - (theStubCrsr + 1);
+			mUnits[theStubCrsr + 2].fPtr = (KUIntPtr) this;
+		} else
+#endif
+		{
+			mUnits[theStubCrsr].fFuncPtr = LazyJump;
+			mUnits[theStubCrsr + 1].fValue = unitCrsr - (theStubCrsr + 1);
+			mUnitsTable[indexInstr] = unitCrsr;
+		}
+
+#if JIT_NATIVE_CODE
+		if (TranslateNative(
+				inMemoryIntf,
+				&unitCrsr,
+				theInstruction,
+				theVAddr + (indexInstr * 4) ))
+		{
+			indexInstr++;
+			continue;
+		}
+		CloseNativeBlock(unitCrsr);
+#endif
+#if JIT_SUPERINSTRUCTIONS
+		// The second instruction must be translated in this run.
+		if ((theSkipCrsr == 0)
+			&& IsHot()
+			&& (indexInstr + 1 < kInstructionCount)
+			&& (mUnits[theStubCrsr + kStubUnitCount].fFuncPtr == LazyTranslate)
+			&& Translate_SuperInstruction(
+				this,
+				&unitCrsr,
+				theInstruction,
+				thePointer[indexInstr + 1],
+				theVAddr + (indexInstr * 4),
+				&theSkipCrsr ))
+		{
+			indexInstr++;
+			continue;
+		}
+#endif
+		Translate(
+			inMemoryIntf,
+			&unitCrsr,
+			theInstruction,
+			theVAddr + (indexInstr * 4) );
+		indexInstr++;
+#if JIT_SUPERINSTRUCTIONS
+		if (theSkipCrsr != 0)
+		{
+			// Second instruction of a superinstruction.
+			Finish_SuperInstruction(
+				this,
+				mUnitsTable[indexInstr - 2],
+				theSkipCrsr,
+				unitCrsr );
+			theSkipCrsr = 0;
+		}
+#endif
+		if (EndsRun(theInstruction))
+		{
+			break;
+		}
+	} while ((indexInstr < kInstructionCount)
+		&& (mUnits[kStubUnitCount * indexInstr].fFuncPtr == LazyTranslate));
+#if JIT_NATIVE_CODE
+	CloseNativeBlock(unitCrsr);
+	mEmitter.MakeExecutable();
+#endif
+	
+	// Continue with the next instruction.
+	KUInt32 theNextUnitCrsr;
+	if (indexInstr < kInstructionCount)
+	{
+		theNextUnitCrsr = mUnitsTable[indexInstr];
+	} else {
+		theNextUnitCrsr = kEndOfPageUnit;
+	}
+	PushUnit(&unitCrsr, LazyJump);
+	PushUnit(&unitCrsr, (KUInt32) (theNextUnitCrsr - unitCrsr));
+	mUnitCrsr = unitCrsr;
+
+	if (mUnits != theUnits)
+	{
+		// The table grew: links and caches point to the previous one.
+		inMemoryIntf->GetJITObject()->InvalidateLinks();
+	}
+
+	return &mUnits[firstUnitCrsr];
+}
+#endif
+
+// -------------------------------------------------------------------------- //
+//  * EndsRun( KUInt32 )
+// -------------------------------------------------------------------------- //
+Boolean
+TJITGenericPage::EndsRun( KUInt32 inInstruction )
+{
+	if ((inInstruction & 0x0E000000) == 0x0A000000)
+	{
+		// Branch.
+		return true;
+	} else if ((inInstruction & 0x0F000000) == 0x0F000000) {
+		// SWI and native calls.
+		return true;
+	} else if ((inInstruction & 0x0E108000) == 0x08108000) {
+		// LDM with R15 in the list.
+		return true;
+	} else if ((inInstruction & 0x0C10F000) == 0x0410F000) {
+		// LDR with Rd = R15.
+		return true;
+	} else if ((inInstruction & 0x0C00F000) == 0x0000F000) {
+		// Data processing with Rd = R15 (and a few others).
+		return true;
+	}
+	
+	return false;
+}
+
+#if JIT_FLAGS_LIVENESS
+// -------------------------------------------------------------------------- //
+//  * ComputeFlagsLiveness( void )
+// -------------------------------------------------------------------------- //
+void
+TJITGenericPage::ComputeFlagsLiveness( void )
+{
+	const KUInt32* thePointer = GetPointer();
+	
+	// Backward pass, we don't know what happens after the page.
+	KUInt8 theLiveFlags = kFlagsAll;
+	KUInt32 indexInstr = kInstructionCount;
+	do {
+		indexInstr--;
+		mFlagsLiveOut[indexInstr] = theLiveFlags;
+		theLiveFlags = GetFlagsLiveIn( thePointer[indexInstr], theLiveFlags );
+	} while (indexInstr > 0);
+}
+
+// -------------------------------------------------------------------------- //
+//  * GetFlagsLiveIn( KUInt32, KUInt8 )
+// -------------------------------------------------------------------------- //
+KUInt8
+TJITGenericPage::GetFlagsLiveIn(
+				KUInt32 inInstruction,
+				KUInt8 inLiveOut )
+{
+	// Flags read by the condition.
+	static const KUInt8 kConditionFlags[16] = {
+		kFlagZ, kFlagZ,						// EQ, NE
+		kFlagC, kFlagC,						// CS, CC
+		kFlagN, kFlagN,						// MI, PL
+		kFlagV, kFlagV,						// VS, VC
+		kFlagC | kFlagZ, kFlagC | kFlagZ,	// HI, LS
+		kFlagN | kFlagV, kFlagN | kFlagV,	// GE, LT
+		kFlagN | kFlagZ | kFlagV,			// GT
+		kFlagN | kFlagZ | kFlagV,			// LE
+		0, 0 };								// AL, NV
+
+	if (EndsRun(inInstruction)
+		|| ((inInstruction & 0x0C000000) == 0x0C000000))
+	{
+		// The PC may change, or SWI, coprocessor and native calls.
+		return kFlagsAll;
+	}
+
+	const int theTestKind = inInstruction >> 28;
+	if (theTestKind == kTestNV)
+	{
+		return inLiveOut;
+	}
+
+	KUInt8 theRead = kConditionFlags[theTestKind];
+	KUInt8 theSet = 0;
+	if ((inInstruction & 0x0FC000F0) == 0x00000090)
+	{
+		// Multiply, S sets N and Z.
+		if (inInstruction & 0x00100000)
+		{
+			theSet = kFlagsNZ;
+		}
+	} else if ((inInstruction & 0x0E000090) == 0x00000090) {
+		// Single Data Swap, Halfword and Signed Data Transfer.
+	} else if ((inInstruction & 0x0C000000) == 0x00000000) {
+		// Data Processing PSR Transfer
+		const KUInt32 theOpcode = (inInstruction >> 21) & 0xF;
+		const Boolean theFlagS = (inInstruction & 0x00100000) != 0;
+		if (((theOpcode & 0xC) == 0x8) && !theFlagS)
+		{
+			// MRS, MSR (and software breakpoints).
+			return kFlagsAll;
+		}
+		if ((inInstruction & 0x02000FF0) == 0x00000060)
+		{
+			// RRX.
+			theRead |= kFlagC;
+		}
+		if ((theOpcode >= 0x5) && (theOpcode <= 0x7))
+		{
+			// ADC, SBC, RSC.
+			theRead |= kFlagC;
+		}
+		if (theFlagS)
+		{
+			if (((theOpcode >= 0x2) && (theOpcode <= 0x7))
+				|| (theOpcode == 0xA) || (theOpcode == 0xB))
+			{
+				// Arithmetic operations.
+				theSet = kFlagsAll;
+			} else if ((inInstruction & 0x02000F00) == 0x02000000) {
+				// Logical operation with an immediate without rotation,
+				// the carry is left unchanged.
+				theSet = kFlagsNZ;
+			} else if (inInstruction & 0x02000000) {
+				theSet = kFlagsNZC;
+			} else {
+				// The carry may be left unchanged.
+				theSet = kFlagsNZ;
+			}
+		}
+	} else if ((inInstruction & 0x0E000FF0) == 0x06000060) {
+		// Single Data Transfer with a register offset shifted with RRX.
+		theRead |= kFlagC;
+	}
+	
+	if (theTestKind != kTestAL)
+	{
+		// The instruction may not be executed.
+		theSet = 0;
+	}
+	
+	return (inLiveOut & ~theSet) | theRead;
+}
+#endif
 
 #ifdef JIT_PERFORMANCE
 JITInstructionProto(instrCount)
@@ -139,6 +585,15 @@ JITInstructionProto(instrCount)
 }
 #endif
 
+#if JIT_VIRTUAL_TIME
+JITInstructionProto(RetireInstruction)
+{
+	// Move the time of the emulator forward.
+	ioCPU->GetEmulator()->GetInterruptManager()->RetireInstruction();
+	EXECUTENEXTUNIT;
+}
+#endif
+
 
 // -------------------------------------------------------------------------- //
 //  * Translate( JITUnit*, KUInt32, KUInt32, KUInt32 )
@@ -154,6 +609,9 @@ TJITGenericPage::Translate(
 	PushUnit(ioUnitCrsr, instrCount);
 	PushUnit(ioUnitCrsr, inVAddr);
 #endif
+#if JIT_VIRTUAL_TIME
+	PushUnit(ioUnitCrsr, RetireInstruction);
+#endif
 
 	// handle injections before anything else
 	if (TJITGenericPatchObject::IsNativeInjection(inInstruction)) {
@@ -247,6 +705,12 @@ TJITGenericPage::PutTest(
 				unsigned char inDelta,
 				int inTest )
 {
+#if JIT_ROM_CACHE
+	if (mFuncMap) {
+		MarkFuncUnit(inUnitCrsr);
+	}
+#endif
+
 	// Test the condition.
 	switch (inTest)
 	{
@@ -329,6 +793,39 @@ TJITGenericPage::PutTest(
 	}
 }
 
+// -------------------------------------------------------------------------- //
+//  * IsTestUnit( KUInt16 ) const
+// -------------------------------------------------------------------------- //
+#define __TestFuncs_packet(func)						\
+		func ## 2, func ## 3, func ## 4, func ## 5, func ## 6, func ## 7
+
+Boolean
+TJITGenericPage::IsTestUnit( KUInt16 inUnitCrsr ) const
+{
+	static const JITFuncPtr kTestFuncs[] = {
+		__TestFuncs_packet(TestEQ), __TestFuncs_packet(TestNE),
+		__TestFuncs_packet(TestCS), __TestFuncs_packet(TestCC),
+		__TestFuncs_packet(TestMI), __TestFuncs_packet(TestPL),
+		__TestFuncs_packet(TestVS), __TestFuncs_packet(TestVC),
+		__TestFuncs_packet(TestHI), __TestFuncs_packet(TestLS),
+		__TestFuncs_packet(TestGE), __TestFuncs_packet(TestLT),
+		__TestFuncs_packet(TestGT), __TestFuncs_packet(TestLE),
+	};
+	JITFuncPtr theFunc = mUnits[inUnitCrsr].fFuncPtr;
+	KUInt32 indexFunc;
+	for (indexFunc = 0;
+		indexFunc < sizeof(kTestFuncs) / sizeof(kTestFuncs[0]);
+		indexFunc++)
+	{
+		if (kTestFuncs[indexFunc] == theFunc)
+		{
+			return true;
+		}
+	}
+	
+	return false;
+}
+
 // -------------------------------------------------------------------------- //
 //  * DoTranslate_00( KUInt32, JITFuncPtr*, JITUnit* )
 // -------------------------------------------------------------------------- //
@@ -470,8 +967,8 @@ TJITGenericPage::EndOfPage(
 	// PC shouldn't have been incremented.
 	POPPC();
 
-	// Don't execute next function.
-	MMUCALLNEXT(GETPC());
+	// Continue on the next page, directly if it was already resolved.
+	MMULINKNEXT(GETPC());
 }
 
 // -------------------------------------------------------------------------- //
@@ -489,6 +986,173 @@ TJITGenericPage::Halt(
 	return ioUnit;
 }
 
+#if JIT_LAZY_TRANSLATION
+// -------------------------------------------------------------------------- //
+//  * LazyTranslate( JITUnit*, TARMProcessor* )
+// -------------------------------------------------------------------------- //
+JITUnit*
+TJITGenericPage::LazyTranslate(
+				JITUnit* ioUnit,
+				TARMProcessor* ioCPU )
+{
+	TJITGenericPage* thePage = (TJITGenericPage*) ioUnit[1].fPtr;
+	KUInt32 theIndex = ioUnit[2].fValue;
+	
+	// Translate and execute.
+	return thePage->TranslateRun( ioCPU->GetMemory(), theIndex );
+}
+
+// -------------------------------------------------------------------------- //
+//  * LazyJump( JITUnit*, TARMProcessor* )
+// -------------------------------------------------------------------------- //
+JITUnit*
+TJITGenericPage::LazyJump(
+				JITUnit* ioUnit,
+				TARMProcessor* ioCPU )
+{
+	KSInt32 theDelta;
+	POPVALUE(theDelta);
+	
+	return ioUnit + theDelta;
+}
+#endif
+
+#if JIT_TIERED_TRANSLATION
+// -------------------------------------------------------------------------- //
+//  * CountedLazyJump( JITUnit*, TARMProcessor* )
+// -------------------------------------------------------------------------- //
+JITUnit*
+TJITGenericPage::CountedLazyJump(
+				JITUnit* ioUnit,
+				TARMProcessor* ioCPU )
+{
+	TJITGenericPage* thePage = (TJITGenericPage*) ioUnit[2].fPtr;
+	if (++thePage->mExecCount >= kHotThreshold)
+	{
+		// Translate the page again before we execute the instruction.
+		// This is done by a unit of the JIT, as the units of the page are
+		// replaced.
+		return ioCPU->GetMemory()->GetJITObject()->RequestTierUp(
+			thePage,
+			(KUInt32) (ioUnit - thePage->mUnits) / kStubUnitCount );
+	}
+
+	KSInt32 theDelta;
+	POPVALUE(theDelta);
+	
+	return ioUnit + theDelta;
+}
+
+// -------------------------------------------------------------------------- //
+//  * Retranslate( JITUnit*, TARMProcessor* )
+// -------------------------------------------------------------------------- //
+JITUnit*
+TJITGenericPage::Retranslate(
+				JITUnit* ioUnit,
+				TARMProcessor* ioCPU )
+{
+	TJITGenericPage* thePage = (TJITGenericPage*) ioUnit[1].fPtr;
+	KUInt32 theIndex = ioUnit[2].fValue;
+	TMemory* theMemIntf = ioCPU->GetMemory();
+	
+	thePage->TierUp( theMemIntf );
+	theMemIntf->GetJITObject()->TieredUp();
+	
+	return thePage->GetJITUnitForOffset( theIndex );
+}
+#endif
+
+#if JIT_NATIVE_CODE
+// -------------------------------------------------------------------------- //
+//  * TranslateNative( TMemory*, KUInt16*, KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+Boolean
+TJITGenericPage::TranslateNative(
+				TMemory* inMemoryIntf,
+				KUInt16* ioUnitCrsr,
+				KUInt32 inInstruction,
+				KUInt32 inVAddr )
+{
+#if JIT_ROM_CACHE
+	if (mFuncMap)
+	{
+		// Native code cannot be saved.
+		return false;
+	}
+#endif
+	KUInt8 theDeadFlags = 0;
+	if (AreFlagsDead(inVAddr, kFlagN)) theDeadFlags |= kFlagN;
+	if (AreFlagsDead(inVAddr, kFlagZ)) theDeadFlags |= kFlagZ;
+	if (AreFlagsDead(inVAddr, kFlagC)) theDeadFlags |= kFlagC;
+	if (AreFlagsDead(inVAddr, kFlagV)) theDeadFlags |= kFlagV;
+
+	Boolean isNewBlock = !mEmitter.IsBlockOpen();
+	KUInt8* theCode = mEmitter.Translate( inInstruction, inVAddr, theDeadFlags );
+	if (theCode == NULL)
+	{
+		return false;
+	}
+
+	KUInt16 theEntryCrsr = *ioUnitCrsr;
+	if (isNewBlock)
+	{
+		mNativeBlockCrsr = theEntryCrsr;
+	}
+	PushUnit(ioUnitCrsr, TJITGenericPage::NativeRun);
+	PushUnit(ioUnitCrsr, (KUIntPtr) theCode);
+	PushUnit(ioUnitCrsr, (KUIntPtr) 0);		// Delta to the next instruction
+	PushUnit(ioUnitCrsr, (KUIntPtr) 0);		// Delta to the end of the block
+	Translate( inMemoryIntf, ioUnitCrsr, inInstruction, inVAddr );
+	mUnits[theEntryCrsr + 2].fValue = *ioUnitCrsr - theEntryCrsr;
+
+	return true;
+}
+
+// -------------------------------------------------------------------------- //
+//  * CloseNativeBlock( KUInt16 )
+// -------------------------------------------------------------------------- //
+void
+TJITGenericPage::CloseNativeBlock( KUInt16 inUnitCrsr )
+{
+	if (mEmitter.IsBlockOpen())
+	{
+		mEmitter.CloseBlock();
+
+		// Every instruction of the block continues after the block.
+		KUInt32 theCrsr = mNativeBlockCrsr;
+		while (theCrsr < inUnitCrsr)
+		{
+			mUnits[theCrsr + 3].fValue = inUnitCrsr - theCrsr;
+			theCrsr += mUnits[theCrsr + 2].fValue;
+		}
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * NativeRun( JITUnit*, TARMProcessor* )
+// -------------------------------------------------------------------------- //
+JITUnit*
+TJITGenericPage::NativeRun(
+				JITUnit* ioUnit,
+				TARMProcessor* ioCPU )
+{
+	// When stepping, the next instruction is a Halt: only execute this one,
+	// with its generic units.
+	if (ioUnit[ioUnit[2].fValue].fFuncPtr == TJITGenericPage::Halt)
+	{
+		CALLUNIT(4);
+	}
+
+	JITNativeFuncPtr theCode = (JITNativeFuncPtr) ioUnit[1].fPtr;
+	if (theCode( ioCPU ))
+	{
+		// Data abort, the PC was set by the helper.
+		MMUCALLNEXT_AFTERSETPC;
+	}
+	CALLUNIT(ioUnit[3].fValue);
+}
+#endif
+
 #endif
 
 // ============================================================================= //
@@ -26,14 +26,77 @@
 
 #include <K/Defines/KDefinitions.h>
 #include "Emulator/JIT/TJITPage.h"
+#include "Emulator/JIT/Generic/TJITGenericUnitArena.h"
+#include "Emulator/TInterruptManager.h"		// JIT_VIRTUAL_TIME
 
 #if defined(_MSC_VER) && defined(_DEBUG)
 #include "Emulator/JIT/TJITPerformance.h"
 #endif
 
+// Translate instructions on first execution instead of whole pages at once.
+// Define it to 0 to translate the 256 instructions of a page in Init.
+#ifndef JIT_LAZY_TRANSLATION
+	#define JIT_LAZY_TRANSLATION 1
+#endif
+
+// Keep the units of ROM pages in a file beside the ROM image.
+// Define it to 0 to translate ROM pages at every launch.
+// Native code of the x86-64 target is not cached.
+#ifndef JIT_ROM_CACHE
+	#ifdef JITTARGET_X86_64
+		#define JIT_ROM_CACHE 0
+	#else
+		#define JIT_ROM_CACHE 1
+	#endif
+#endif
+
+// Translate S-suffixed data processing instructions without computing the
+// flags when they are overwritten before they are read.
+#ifndef JIT_FLAGS_LIVENESS
+	#define JIT_FLAGS_LIVENESS 1
+#endif
+
+// Fuse frequent pairs of instructions into a single unit.
+// Disabled with JIT_PERFORMANCE and JIT_VIRTUAL_TIME which count every
+// instruction, and with the x86-64 target which emits native code for these
+// instructions.
+#ifndef JIT_SUPERINSTRUCTIONS
+	#if defined(JIT_PERFORMANCE) || JIT_VIRTUAL_TIME || defined(JITTARGET_X86_64)
+		#define JIT_SUPERINSTRUCTIONS 0
+	#else
+		#define JIT_SUPERINSTRUCTIONS 1
+	#endif
+#endif
+
+// Let the emulator thread wait for the next timer match when the emulated
+// code spins in a short loop that only polls the timer or interrupt registers.
+#ifndef JIT_IDLE_LOOPS
+	#define JIT_IDLE_LOOPS 1
+#endif
+
+// Emit native code for runs of simple instructions (x86-64 target).
+#if defined(JITTARGET_X86_64) && !JIT_SUPERINSTRUCTIONS && !defined(JIT_PERFORMANCE) && !JIT_VIRTUAL_TIME
+	#define JIT_NATIVE_CODE 1
+	#include "Emulator/JIT/X86_64/TJITX86_64Emitter.h"
+#else
+	#define JIT_NATIVE_CODE 0
+#endif
+
+// Translate cold pages quickly and translate them again with the flags
+// liveness, the superinstructions and the folding of PC-relative loads once
+// they are hot. Entries into cold pages are counted by their stubs.
+// Requires lazy translation.
+#ifndef JIT_TIERED_TRANSLATION
+	#define JIT_TIERED_TRANSLATION JIT_LAZY_TRANSLATION
+#endif
+#if JIT_TIERED_TRANSLATION && !JIT_LAZY_TRANSLATION
+	#error JIT_TIERED_TRANSLATION requires JIT_LAZY_TRANSLATION
+#endif
+
 class TARMProcessor;
 union JITUnit;
 class TJITGeneric;
+class TJITGenericROMCache;
 
 // Function.
 typedef JITUnit* (*JITFuncPtr)(JITUnit* ioUnit, TARMProcessor* ioCPU);
@@ -62,6 +125,21 @@ public:
 	/// Access from TJITGeneric
 	///
 	friend class TJITGeneric;
+
+	///
+	/// Access from TJITGenericROMCache
+	///
+	friend class TJITGenericROMCache;
+
+	///
+	/// Access from TJITGenericUnitArena
+	///
+	friend class TJITGenericUnitArena;
+
+	///
+	/// Storage of the units, owned by the cache.
+	///
+	typedef TJITGenericUnitArena TUnitArena;
 	
 	///
 	/// Default constructor.
@@ -73,6 +151,15 @@ public:
 	///
 	~TJITGenericPage( void );
 
+	///
+	/// Set the storage of the units, before the page is initialized.
+	///
+	/// \param inUnitArena	storage of the units of the cache.
+	///
+	void SetUnitArena( TJITGenericUnitArena* inUnitArena ) {
+		mUnitArena = inUnitArena;
+	}
+
 	///
 	/// Init with the memory interface, a virtual address and a physical address.
 	///
@@ -81,10 +168,47 @@ public:
 			KUInt32 inVAddr,
 			KUInt32 inPAddr );
 
+#if JIT_TIERED_TRANSLATION
+	///
+	/// Translate the page again, with every optimization.
+	/// The units are replaced: links to them must be broken.
+	///
+	void TierUp( TMemory* inMemoryIntf );
+#endif
+
+	///
+	/// Determine if the page is translated with every optimization.
+	/// Without tiered translation and for pages of the ROM cache, always.
+	///
+	Boolean IsHot( void ) const {
+#if JIT_TIERED_TRANSLATION
+		return mHot;
+#else
+		return true;
+#endif
+	}
+
+	///
+	/// Number of entries into the page (branches and runs that continue
+	/// with a stub), counted while the page is cold.
+	///
+	KUInt32 GetExecCount( void ) const {
+#if JIT_TIERED_TRANSLATION
+		return mExecCount;
+#else
+		return 0;
+#endif
+	}
+
 	///
 	/// Push a unit in the table, resizing the table if required.
 	///
 	void PushUnit(KUInt16* ioUnitCrsr, JITFuncPtr inUnit) {
+#if JIT_ROM_CACHE
+		if (mFuncMap) {
+			MarkFuncUnit(*ioUnitCrsr);
+		}
+#endif
 		PushUnit(ioUnitCrsr, (KUIntPtr) inUnit);
 	}
 
@@ -92,7 +216,67 @@ public:
 	/// Push a unit in the table, resizing the table if required.
 	///
 	void PushUnit(KUInt16* ioUnitCrsr, KUIntPtr inUnit);
+
+	///
+	/// Grow the table of units, keeping its content.
+	///
+	/// \param inUnitCount	number of units required.
+	///
+	void GrowUnits( KUInt32 inUnitCount );
 	
+#if JIT_ROM_CACHE
+	///
+	/// Remember that a unit is a function, for the ROM cache.
+	///
+	void MarkFuncUnit(KUInt16 inUnitCrsr) {
+		mFuncMap[inUnitCrsr >> 5] |= 1 << (inUnitCrsr & 0x1F);
+	}
+#endif
+
+	/// \name Condition flags, for their liveness.
+	enum {
+		kFlagN		= 0x8,
+		kFlagZ		= 0x4,
+		kFlagC		= 0x2,
+		kFlagV		= 0x1,
+		kFlagsNZ	= kFlagN | kFlagZ,
+		kFlagsNZC	= kFlagN | kFlagZ | kFlagC,
+		kFlagsAll	= kFlagN | kFlagZ | kFlagC | kFlagV,
+	};
+
+	///
+	/// Determine if flags set by an instruction of this page are overwritten
+	/// before any instruction reads them.
+	///
+	/// \param inVAddr	virtual address of the instruction.
+	/// \param inFlags	flags set by the instruction.
+	/// \return \c true if none of the flags is read afterwards.
+	///
+	Boolean AreFlagsDead(KUInt32 inVAddr, KUInt8 inFlags) const {
+#if JIT_FLAGS_LIVENESS
+		if (!IsHot())
+		{
+			return false;
+		}
+		return (mFlagsLiveOut[(inVAddr >> 2) & (kInstructionCount - 1)]
+			& inFlags) == 0;
+#else
+		(void) inVAddr;
+		(void) inFlags;
+		return false;
+#endif
+	}
+
+	///
+	/// Read a word of the page, e.g. the literal of a PC-relative load.
+	///
+	/// \param inVAddr	virtual address of the word, in the page.
+	/// \return the word.
+	///
+	KUInt32 GetWord(KUInt32 inVAddr) {
+		return GetPointer()[(inVAddr >> 2) & (kInstructionCount - 1)];
+	}
+
 	///
 	/// Get the unit for a given (instruction) offset.
 	///
@@ -100,6 +284,21 @@ public:
 		return &mUnits[mUnitsTable[inOffset]];
 	}
 
+	///
+	/// Get a unit from its cursor.
+	///
+	inline JITUnit* GetUnit(KUInt16 inUnitCrsr) {
+		return &mUnits[inUnitCrsr];
+	}
+
+	///
+	/// Determine if a unit is the test of the condition of an instruction.
+	///
+	/// \param inUnitCrsr	cursor of the unit.
+	/// \return \c true if the unit is one of the Test functions.
+	///
+	Boolean IsTestUnit(KUInt16 inUnitCrsr) const;
+
 	///
 	/// Subroutine to translate an instruction.
 	///
@@ -113,7 +312,99 @@ public:
 				   KUInt32 inInstruction,
 				   KUInt32 inVAddr );
 	
+	///
+	/// Halt (used for stepping).
+	/// Superinstructions also check for it to execute a single instruction.
+	///
+	/// \param inInstruction	current instruction.
+	///
+	static JITUnit* Halt(
+					JITUnit* ioUnit,
+					TARMProcessor* ioObject );
+
+#if JIT_NATIVE_CODE
+	///
+	/// Execute native code from an instruction to the end of its block.
+	/// The unit is followed by the native code, the delta to the next
+	/// instruction and the delta to the end of the block, then by the
+	/// generic units of the instruction, used for single steps.
+	///
+	static JITUnit* NativeRun(
+					JITUnit* ioUnit,
+					TARMProcessor* ioObject );
+#endif
+
 protected:
+	///
+	/// Fill the units of the page, according to its tier.
+	///
+	/// \param inMemoryIntf	interface to memory.
+	///
+	void InitUnits( TMemory* inMemoryIntf );
+
+	///
+	/// Translate all the instructions of the page and push the end of page.
+	///
+	/// \param inMemoryIntf	interface to memory.
+	/// \param ioUnitCrsr		cursor in the unit table.
+	///
+	void TranslatePage(
+				TMemory* inMemoryIntf,
+				KUInt16* ioUnitCrsr );
+
+#if JIT_FLAGS_LIVENESS
+	///
+	/// Compute the flags that are live after each instruction of the page.
+	/// Flags are considered live at the end of the page and after any
+	/// instruction that may change the PC.
+	///
+	void ComputeFlagsLiveness( void );
+
+	///
+	/// Get the flags that are live before an instruction.
+	///
+	/// \param inInstruction	instruction.
+	/// \param inLiveOut		flags that are live after the instruction.
+	/// \return the flags that are live before the instruction.
+	///
+	static KUInt8 GetFlagsLiveIn(
+				KUInt32 inInstruction,
+				KUInt8 inLiveOut );
+#endif
+
+#if JIT_NATIVE_CODE
+	///
+	/// Translate an instruction to native code, with a NativeRun unit
+	/// followed by its generic units.
+	///
+	/// \param inMemoryIntf	interface to memory.
+	/// \param ioUnitCrsr		cursor in the unit table.
+	/// \param inInstruction	instruction to translate.
+	/// \param inVAddr			virtual address of the instruction.
+	/// \return \c true if the instruction was translated.
+	///
+	Boolean TranslateNative(
+				TMemory* inMemoryIntf,
+				KUInt16* ioUnitCrsr,
+				KUInt32 inInstruction,
+				KUInt32 inVAddr );
+
+	///
+	/// Terminate the current block of native code, if any, and set the
+	/// delta to its end in its units.
+	///
+	/// \param inUnitCrsr		unit following the block.
+	///
+	void CloseNativeBlock( KUInt16 inUnitCrsr );
+#endif
+
+	///
+	/// Push the units for the end of the page.
+	///
+	/// \param ioUnitCrsr		cursor in the unit table.
+	///
+	void PushEndOfPage( KUInt16* ioUnitCrsr );
+
 	/// Test bits.
 	enum ETestKind {
 		kTestEQ = 0x0,
@@ -143,15 +434,75 @@ protected:
 					JITUnit* ioUnit,
 					TARMProcessor* ioObject );
 
+#if JIT_LAZY_TRANSLATION
 	///
-	/// Halt (used for stepping).
+	/// Stub for an instruction that was not translated yet.
+	/// Translates it and the following instructions up to the next branch,
+	/// then executes them.
 	///
-	/// \param inInstruction	current instruction.
+	static JITUnit* LazyTranslate(
+					JITUnit* ioUnit,
+					TARMProcessor* ioObject );
+
 	///
-	static JITUnit* Halt(
+	/// Jump to a unit at a known delta (stub of a translated instruction or
+	/// end of a run of translated instructions).
+	///
+	static JITUnit* LazyJump(
+					JITUnit* ioUnit,
+					TARMProcessor* ioObject );
+
+	///
+	/// Translate a run of instructions, starting at a given index.
+	///
+	/// \param inMemoryIntf	interface to memory.
+	/// \param inIndex			index of the first instruction.
+	/// \return the unit of the first instruction.
+	///
+	JITUnit* TranslateRun(
+				TMemory* inMemoryIntf,
+				KUInt32 inIndex );
+#endif
+
+#if JIT_TIERED_TRANSLATION
+	///
+	/// Stub of a translated instruction of a cold page.
+	/// Counts the entry and jumps like LazyJump, or continues with a
+	/// Retranslate unit of the JIT once the page is hot.
+	///
+	static JITUnit* CountedLazyJump(
 					JITUnit* ioUnit,
 					TARMProcessor* ioObject );
 
+	///
+	/// Translate a page again and continue with one of its instructions.
+	/// The unit is followed by the page and by the index of the instruction.
+	///
+	static JITUnit* Retranslate(
+					JITUnit* ioUnit,
+					TARMProcessor* ioObject );
+
+	///
+	/// Get the unit an instruction starts with when the previous instruction
+	/// falls through: the stub of a cold page is skipped.
+	///
+	/// \param inUnit	unit for the PC of the instruction (or NULL).
+	/// \return the first unit of the instruction.
+	///
+	static JITUnit* SkipCountingStub( JITUnit* inUnit ) {
+		if (inUnit && (inUnit->fFuncPtr == CountedLazyJump))
+		{
+			return inUnit + 1 + (KSInt32) inUnit[1].fValue;
+		}
+		return inUnit;
+	}
+#endif
+
+	///
+	/// Determine if an instruction ends a run, i.e. if it may modify the PC.
+	///
+	static Boolean EndsRun( KUInt32 inInstruction );
+
 	///
 	/// Subroutine to put the test in the units table.
 	///
@@ -220,8 +571,20 @@ protected:
 	/// \name Constants
 	enum {
 		kInstructionCount = (TJITPage< TJITGeneric, TJITGenericPage >::kPageSize / 4),
+#if JIT_LAZY_TRANSLATION
+		kStubUnitCount = 3,			///< Units per stub.
+		kEndOfPageUnit = kStubUnitCount * kInstructionCount,
+		kFirstRunUnit = kEndOfPageUnit + 4,
+		/// Stubs, then runs of about 3 units per instruction, as for pages
+		/// translated at once. Pages that need more grow.
+		kDefaultUnitCount = kFirstRunUnit + (3 * kInstructionCount),
+#else
 		kDefaultUnitCount = 3 * kInstructionCount,
+#endif
 		kUnitIncrement = 32,
+#if JIT_TIERED_TRANSLATION
+		kHotThreshold = 1000,		///< Entries before a page is hot.
+#endif
 	};
 	
 	/// \name Variables
@@ -233,6 +596,29 @@ protected:
 								///< address. This is used to find out the
 								///< proper unit when jumping...
 	JITUnit*		mUnits;		///< Array with all the units.
+	TJITGenericUnitArena*	mUnitArena;	///< Storage of the units.
+#if JIT_LAZY_TRANSLATION
+	KUInt16			mUnitCrsr;	///< First free unit.
+#endif
+#if JIT_TIERED_TRANSLATION
+	KUInt32			mExecCount;	///< Entries while the page was cold.
+	Boolean			mHot;		///< Whether the page is translated with
+								///< every optimization.
+#endif
+#if JIT_FLAGS_LIVENESS
+	KUInt8			mFlagsLiveOut[kInstructionCount];
+								///< Flags that are live after each
+								///< instruction.
+#endif
+#if JIT_NATIVE_CODE
+	TJITX86_64Emitter	mEmitter;	///< Native code of the page.
+	KUInt16			mNativeBlockCrsr;	///< First unit of the current block.
+#endif
+#if JIT_ROM_CACHE
+	KUInt32*		mFuncMap;	///< Map of the units that are functions,
+								///< only set while the page is translated
+								///< for the ROM cache.
+#endif
 };
 
 #endif
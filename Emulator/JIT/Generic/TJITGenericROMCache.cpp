@@ -0,0 +1,577 @@
+// ==============================
+// File:			TJITGenericROMCache.cp
+// Project:			Einstein
+//
+// Copyright 2003-2007 by Paul Guyot (pguyot@kallisys.net).
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+#include <K/Defines/KDefinitions.h>
+#include "JIT.h"
+
+#if defined(JITTARGET_GENERIC) && JIT_ROM_CACHE
+
+#include "TJITGenericROMCache.h"
+
+// ANSI C & POSIX
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#if !TARGET_OS_WIN32
+	#include <dlfcn.h>
+#endif
+
+// K
+#include <K/Misc/TMappedFile.h>
+#include <K/Threads/TMutex.h>
+
+// Einstein
+#include "TARMProcessor.h"
+
+TJITGenericROMCache::SStore* TJITGenericROMCache::sStores = NULL;
+
+// -------------------------------------------------------------------------- //
+//  * GetMutex( void )
+// -------------------------------------------------------------------------- //
+static TMutex&
+GetMutex( void )
+{
+	static TMutex sMutex;
+	return sMutex;
+}
+
+// -------------------------------------------------------------------------- //
+//  * TJITGenericROMCache( const char*, const KUInt32[10] )
+// -------------------------------------------------------------------------- //
+TJITGenericROMCache::TJITGenericROMCache(
+			const char* inImagePath,
+			const KUInt32 inChecksums[10] )
+	:
+		mStore( NULL )
+{
+	char* thePath = (char*) ::malloc( ::strlen( inImagePath ) + 5 );
+	(void) ::sprintf( thePath, "%s.jit", inImagePath );
+	mStore = AcquireStore( thePath, inChecksums );
+	::free( thePath );
+}
+
+// -------------------------------------------------------------------------- //
+//  * ~TJITGenericROMCache( void )
+// -------------------------------------------------------------------------- //
+TJITGenericROMCache::~TJITGenericROMCache( void )
+{
+	ReleaseStore( mStore );
+}
+
+// -------------------------------------------------------------------------- //
+//  * AcquireStore( const char*, const KUInt32[10] )
+// -------------------------------------------------------------------------- //
+TJITGenericROMCache::SStore*
+TJITGenericROMCache::AcquireStore(
+			const char* inPath,
+			const KUInt32 inChecksums[10] )
+{
+	TMutex& theMutex = GetMutex();
+	theMutex.Lock();
+	SStore* theStore;
+	for (theStore = sStores; theStore != NULL; theStore = theStore->fNext)
+	{
+		if ((::strcmp( theStore->fPath, inPath ) == 0)
+			&& !::memcmp(
+					theStore->fChecksums,
+					inChecksums,
+					sizeof(theStore->fChecksums) ))
+		{
+			break;
+		}
+	}
+	if (theStore == NULL)
+	{
+		theStore = new SStore;
+		theStore->fRefCount = 0;
+		theStore->fPath = ::strdup( inPath );
+		(void) ::memcpy(
+			theStore->fChecksums, inChecksums, sizeof(theStore->fChecksums) );
+		theStore->fHasBuildID = ComputeBuildID( theStore->fBuildID );
+		theStore->fMappedFile = NULL;
+		theStore->fIndex = new std::atomic<const SEntry*>[kIndexSize]();
+		theStore->fNewEntries = NULL;
+		Open( theStore );
+		theStore->fNext = sStores;
+		sStores = theStore;
+	}
+	theStore->fRefCount++;
+	theMutex.Unlock();
+
+	return theStore;
+}
+
+// -------------------------------------------------------------------------- //
+//  * ReleaseStore( SStore* )
+// -------------------------------------------------------------------------- //
+void
+TJITGenericROMCache::ReleaseStore( SStore* inStore )
+{
+	TMutex& theMutex = GetMutex();
+	theMutex.Lock();
+	Boolean isLast = (--inStore->fRefCount == 0);
+	if (isLast)
+	{
+		SStore** theLink = &sStores;
+		while (*theLink != inStore)
+		{
+			theLink = &(*theLink)->fNext;
+		}
+		*theLink = inStore->fNext;
+	}
+	theMutex.Unlock();
+
+	if (isLast)
+	{
+		Save( inStore );
+
+		SNewEntry* theNewEntry = inStore->fNewEntries.load();
+		while (theNewEntry)
+		{
+			SNewEntry* theNext = theNewEntry->fNext;
+			::free( theNewEntry );
+			theNewEntry = theNext;
+		}
+		if (inStore->fMappedFile)
+		{
+			delete inStore->fMappedFile;
+		}
+		delete [] inStore->fIndex;
+		::free( inStore->fPath );
+		delete inStore;
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * Open( SStore* )
+// -------------------------------------------------------------------------- //
+void
+TJITGenericROMCache::Open( SStore* ioStore )
+{
+	struct stat theInfos;
+	if (!ioStore->fHasBuildID
+		|| (::stat( ioStore->fPath, &theInfos ) < 0)
+		|| (theInfos.st_size < (off_t) sizeof(SHeader)))
+	{
+		// No cache yet.
+		return;
+	}
+
+	TMappedFile* theMappedFile =
+		new TMappedFile( ioStore->fPath, (size_t) theInfos.st_size, O_RDONLY );
+	const KUInt8* theBuffer = (const KUInt8*) theMappedFile->GetBuffer();
+	const SHeader* theHeader = (const SHeader*) theBuffer;
+	if ((theBuffer == NULL)
+		|| (theHeader->fMagic != kMagic)
+		|| (theHeader->fVersion != kVersion)
+		|| (theHeader->fJITID != JITClass::GetID())
+		|| (theHeader->fJITVersion != JITClass::GetVersion())
+		|| (theHeader->fUnitSize != sizeof(JITUnit))
+		|| ::memcmp(
+				theHeader->fBuildID,
+				ioStore->fBuildID,
+				sizeof(ioStore->fBuildID) )
+		|| ::memcmp(
+				theHeader->fChecksums,
+				ioStore->fChecksums,
+				sizeof(ioStore->fChecksums) ))
+	{
+		// Outdated, it will be replaced when we save.
+		delete theMappedFile;
+		return;
+	}
+
+	// Index the entries.
+	const KUInt8* theCursor = theBuffer + sizeof(SHeader);
+	const KUInt8* theEnd = theBuffer + theMappedFile->GetSize();
+	Boolean isValid = true;
+	KUInt32 indexEntry;
+	for (indexEntry = 0;
+		isValid && (indexEntry < theHeader->fEntryCount);
+		indexEntry++)
+	{
+		const SEntry* theEntry = (const SEntry*) theCursor;
+		isValid = IsValid( theEntry, (KUIntPtr) (theEnd - theCursor) );
+		if (isValid)
+		{
+			ioStore->fIndex[theEntry->fPAddr >> kPageShift].store(
+				theEntry, std::memory_order_relaxed );
+			theCursor += EntrySize( theEntry->fUnitCount );
+		}
+	}
+
+	if (!isValid || (theCursor != theEnd))
+	{
+		// Damaged, forget the entries. It will be replaced when we save.
+		(void) ::fprintf( stderr,
+			"Ignoring the damaged JIT cache at %s\n", ioStore->fPath );
+		KUInt32 indexPage;
+		for (indexPage = 0; indexPage < kIndexSize; indexPage++)
+		{
+			ioStore->fIndex[indexPage].store( NULL, std::memory_order_relaxed );
+		}
+		delete theMappedFile;
+		return;
+	}
+
+	ioStore->fMappedFile = theMappedFile;
+}
+
+// -------------------------------------------------------------------------- //
+//  * Load( TJITGenericPage*, KUInt16* )
+// -------------------------------------------------------------------------- //
+Boolean
+TJITGenericROMCache::Load( TJITGenericPage* ioPage, KUInt16* outUnitCrsr )
+{
+	const SEntry* theEntry =
+		mStore->fIndex[ioPage->GetPAddr() >> kPageShift].load(
+			std::memory_order_acquire );
+	const KUInt32* thePointer = ioPage->GetPointer();
+	if ((theEntry == NULL)
+		|| (thePointer == NULL)
+		|| (theEntry->fVAddr != ioPage->GetVAddr())
+		|| (theEntry->fHash != HashPage( thePointer )))
+	{
+		return false;
+	}
+
+	KUInt32 theUnitCount = theEntry->fUnitCount;
+	if (theUnitCount > ioPage->mUnitCount)
+	{
+		ioPage->GrowUnits( theUnitCount );
+	}
+	(void) ::memcpy(
+		ioPage->mUnitsTable,
+		theEntry->fUnitsTable,
+		sizeof(theEntry->fUnitsTable) );
+
+	// Copy the units, relocating the functions.
+	const KUIntPtr* theUnits = (const KUIntPtr*) (theEntry + 1);
+	const KUInt32* theFuncMap = (const KUInt32*) (theUnits + theUnitCount);
+	const KUIntPtr theBase = (KUIntPtr) TJITGenericPage::EndOfPage;
+	JITUnit* theDest = ioPage->mUnits;
+	KUInt32 indexUnit;
+	for (indexUnit = 0; indexUnit < theUnitCount; indexUnit++)
+	{
+		KUIntPtr theValue = theUnits[indexUnit];
+		if (theFuncMap[indexUnit >> 5] & (1 << (indexUnit & 0x1F)))
+		{
+			theValue += theBase;
+		}
+		theDest[indexUnit].fPtr = theValue;
+	}
+
+	*outUnitCrsr = (KUInt16) theUnitCount;
+	return true;
+}
+
+// -------------------------------------------------------------------------- //
+//  * BeginStore( TJITGenericPage* )
+// -------------------------------------------------------------------------- //
+void
+TJITGenericROMCache::BeginStore( TJITGenericPage* ioPage )
+{
+	(void) ::memset( mFuncMap, 0, sizeof(mFuncMap) );
+	ioPage->mFuncMap = mFuncMap;
+}
+
+// -------------------------------------------------------------------------- //
+//  * Store( TJITGenericPage*, KUInt16 )
+// -------------------------------------------------------------------------- //
+void
+TJITGenericROMCache::Store( TJITGenericPage* ioPage, KUInt16 inUnitCount )
+{
+	ioPage->mFuncMap = NULL;
+
+	const KUInt32* thePointer = ioPage->GetPointer();
+	if (thePointer == NULL)
+	{
+		return;
+	}
+
+	SNewEntry* theNewEntry = (SNewEntry*) ::calloc(
+		1, sizeof(SNewEntry) + EntrySize( inUnitCount ) );
+	SEntry* theEntry = (SEntry*) (theNewEntry + 1);
+	theEntry->fPAddr = ioPage->GetPAddr();
+	theEntry->fVAddr = ioPage->GetVAddr();
+	theEntry->fHash = HashPage( thePointer );
+	theEntry->fUnitCount = inUnitCount;
+	(void) ::memcpy(
+		theEntry->fUnitsTable,
+		ioPage->mUnitsTable,
+		sizeof(theEntry->fUnitsTable) );
+
+	// Copy the units, saving the functions relative to EndOfPage.
+	KUIntPtr* theUnits = (KUIntPtr*) (theEntry + 1);
+	KUInt32* theFuncMap = (KUInt32*) (theUnits + inUnitCount);
+	const KUIntPtr theBase = (KUIntPtr) TJITGenericPage::EndOfPage;
+	const JITUnit* theSource = ioPage->mUnits;
+	KUInt32 indexUnit;
+	for (indexUnit = 0; indexUnit < inUnitCount; indexUnit++)
+	{
+		KUIntPtr theValue = theSource[indexUnit].fPtr;
+		if (mFuncMap[indexUnit >> 5] & (1 << (indexUnit & 0x1F)))
+		{
+			theValue -= theBase;
+		}
+		theUnits[indexUnit] = theValue;
+	}
+	(void) ::memcpy(
+		theFuncMap,
+		mFuncMap,
+		((inUnitCount + 31) / 32) * sizeof(KUInt32) );
+
+	// Keep the entry until the store is deleted.
+	SNewEntry* theHead = mStore->fNewEntries.load( std::memory_order_relaxed );
+	do {
+		theNewEntry->fNext = theHead;
+	} while (!mStore->fNewEntries.compare_exchange_weak(
+				theHead, theNewEntry, std::memory_order_relaxed ));
+
+	// Publish it, replacing any previous entry for this page.
+	mStore->fIndex[theEntry->fPAddr >> kPageShift].store(
+		theEntry, std::memory_order_release );
+}
+
+// -------------------------------------------------------------------------- //
+//  * Save( void )
+// -------------------------------------------------------------------------- //
+void
+TJITGenericROMCache::Save( void )
+{
+	Save( mStore );
+}
+
+// -------------------------------------------------------------------------- //
+//  * Save( SStore* )
+// -------------------------------------------------------------------------- //
+void
+TJITGenericROMCache::Save( SStore* inStore )
+{
+	if ((inStore->fNewEntries.load() == NULL) || !inStore->fHasBuildID)
+	{
+		return;
+	}
+
+	SHeader theHeader;
+	(void) ::memset( &theHeader, 0, sizeof(theHeader) );
+	theHeader.fMagic = kMagic;
+	theHeader.fVersion = kVersion;
+	theHeader.fJITID = JITClass::GetID();
+	theHeader.fJITVersion = JITClass::GetVersion();
+	theHeader.fUnitSize = sizeof(JITUnit);
+	(void) ::memcpy(
+		theHeader.fBuildID,
+		inStore->fBuildID,
+		sizeof(inStore->fBuildID) );
+	(void) ::memcpy(
+		theHeader.fChecksums,
+		inStore->fChecksums,
+		sizeof(inStore->fChecksums) );
+
+	// Other caches may still publish pages, take the index once.
+	const SEntry** theIndex =
+		(const SEntry**) ::calloc( kIndexSize, sizeof(SEntry*) );
+	KUInt32 indexPage;
+	for (indexPage = 0; indexPage < kIndexSize; indexPage++)
+	{
+		theIndex[indexPage] =
+			inStore->fIndex[indexPage].load( std::memory_order_acquire );
+		if (theIndex[indexPage])
+		{
+			theHeader.fEntryCount++;
+		}
+	}
+
+	// Write a new file and replace the mapped one. The name of the file is
+	// unique to this store.
+	const char* thePath = inStore->fPath;
+	char* theTempPath = (char*) ::malloc( ::strlen( thePath ) + 22 );
+	(void) ::sprintf( theTempPath, "%s.%lx.tmp", thePath,
+				(unsigned long) (KUIntPtr) inStore );
+	FILE* theFile = ::fopen( theTempPath, "wb" );
+	Boolean ok = (theFile != NULL);
+	if (ok)
+	{
+		ok = (::fwrite( &theHeader, sizeof(theHeader), 1, theFile ) == 1);
+		for (indexPage = 0; ok && (indexPage < kIndexSize); indexPage++)
+		{
+			const SEntry* theEntry = theIndex[indexPage];
+			if (theEntry)
+			{
+				ok = (::fwrite(
+						theEntry,
+						EntrySize( theEntry->fUnitCount ),
+						1,
+						theFile ) == 1);
+			}
+		}
+		ok = (::fclose( theFile ) == 0) && ok;
+	}
+	if (ok)
+	{
+#if TARGET_OS_WIN32
+		(void) ::remove( thePath );
+#endif
+		ok = (::rename( theTempPath, thePath ) == 0);
+	}
+	if (!ok)
+	{
+		(void) ::fprintf( stderr, "Can't save the JIT cache at %s\n", thePath );
+		(void) ::remove( theTempPath );
+	}
+	::free( theTempPath );
+	::free( theIndex );
+}
+
+// -------------------------------------------------------------------------- //
+//  * EntrySize( KUInt32 )
+// -------------------------------------------------------------------------- //
+KUIntPtr
+TJITGenericROMCache::EntrySize( KUInt32 inUnitCount )
+{
+	KUIntPtr theSize = sizeof(SEntry)
+		+ (inUnitCount * sizeof(KUIntPtr))
+		+ (((inUnitCount + 31) / 32) * sizeof(KUInt32));
+
+	// Keep the units of the next entry aligned.
+	return (theSize + sizeof(KUIntPtr) - 1) & ~(sizeof(KUIntPtr) - 1);
+}
+
+// -------------------------------------------------------------------------- //
+//  * HashPage( const KUInt32* )
+// -------------------------------------------------------------------------- //
+KUInt32
+TJITGenericROMCache::HashPage( const KUInt32* inPointer )
+{
+	// FNV-1a on the instructions.
+	KUInt32 theHash = 0x811C9DC5;
+	KUInt32 indexInstr;
+	for (indexInstr = 0;
+		indexInstr < TJITGenericPage::kInstructionCount;
+		indexInstr++)
+	{
+		theHash = (theHash ^ inPointer[indexInstr]) * 0x01000193;
+	}
+
+	return theHash;
+}
+
+// -------------------------------------------------------------------------- //
+//  * IsValid( const SEntry*, KUIntPtr )
+// -------------------------------------------------------------------------- //
+Boolean
+TJITGenericROMCache::IsValid( const SEntry* inEntry, KUIntPtr inSize )
+{
+	if (inSize < sizeof(SEntry))
+	{
+		return false;
+	}
+	
+	KUInt32 theUnitCount = inEntry->fUnitCount;
+	if ((theUnitCount == 0)
+		|| (theUnitCount > 0xFFFF)
+		|| (inSize < EntrySize( theUnitCount ))
+		|| !Covers( inEntry->fPAddr ))
+	{
+		return false;
+	}
+
+	// Every instruction must start within the units.
+	KUInt32 indexInstr;
+	for (indexInstr = 0;
+		indexInstr < TJITGenericPage::kInstructionCount;
+		indexInstr++)
+	{
+		if (inEntry->fUnitsTable[indexInstr] >= theUnitCount)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// -------------------------------------------------------------------------- //
+//  * ComputeBuildID( KUInt32[2] )
+// -------------------------------------------------------------------------- //
+Boolean
+TJITGenericROMCache::ComputeBuildID( KUInt32 outBuildID[2] )
+{
+#if TARGET_OS_WIN32
+	// Not implemented, the cache is not used.
+	(void) outBuildID;
+	return false;
+#else
+	// Find the module with the JIT functions.
+	Dl_info theInfo;
+	if ((::dladdr( (void*) (KUIntPtr) TJITGenericPage::EndOfPage, &theInfo ) == 0)
+		|| (theInfo.dli_fname == NULL))
+	{
+		return false;
+	}
+	const char* thePath = theInfo.dli_fname;
+#if TARGET_OS_LINUX
+	// The name of the executable may be relative to the launch directory.
+	if (thePath[0] != '/')
+	{
+		thePath = "/proc/self/exe";
+	}
+#endif
+	FILE* theFile = ::fopen( thePath, "rb" );
+	if (theFile == NULL)
+	{
+		return false;
+	}
+
+	// FNV-1a on the words of the file.
+	KUInt64 theHash = 0xCBF29CE484222325ULL;
+	KUInt32 theBuffer[4096];
+	size_t theCount;
+	do {
+		(void) ::memset( theBuffer, 0, sizeof(theBuffer) );
+		theCount = ::fread( theBuffer, 1, sizeof(theBuffer), theFile );
+		size_t indexWord;
+		for (indexWord = 0; indexWord < (theCount + 3) / 4; indexWord++)
+		{
+			theHash = (theHash ^ theBuffer[indexWord]) * 0x100000001B3ULL;
+		}
+	} while (theCount == sizeof(theBuffer));
+	Boolean ok = !::ferror( theFile );
+	(void) ::fclose( theFile );
+
+	outBuildID[0] = (KUInt32) theHash;
+	outBuildID[1] = (KUInt32) (theHash >> 32);
+	return ok;
+#endif
+}
+
+#endif
+	// JITTARGET_GENERIC && JIT_ROM_CACHE
+
+// ============================================================= //
+// The world is coming to an end.  Please log off.               //
+// ============================================================= //
@@ -0,0 +1,258 @@
+// ==============================
+// File:			TJITGenericROMCache.h
+// Project:			Einstein
+//
+// Copyright 2003-2007 by Paul Guyot (pguyot@kallisys.net).
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+#ifndef _TJITGENERICROMCACHE_H
+#define _TJITGENERICROMCACHE_H
+
+#include <K/Defines/KDefinitions.h>
+#include "Emulator/JIT/Generic/TJITGenericPage.h"
+
+#include <atomic>
+
+class TMappedFile;
+
+///
+/// Persistent cache of the units of translated ROM pages.
+///
+/// The cache lives in a file beside the ROM image. It is keyed by the
+/// checksums of the image and by a hash of the module (executable or
+/// library) with the JIT functions, so any other build replaces it. Function
+/// pointers are saved relative to TJITGenericPage::EndOfPage and relocated
+/// when a page is loaded. Entries are checked when the file is opened and a
+/// file with an invalid entry is ignored.
+/// The file is mapped when the emulator starts, pages translated during the
+/// session are kept in memory and the file is rewritten when the JIT is
+/// deleted.
+///
+/// Every entry also records a hash of the instructions of the page, so a
+/// modified page (e.g. with a breakpoint) is translated again.
+///
+/// The pages are kept in a store shared by the caches of every emulator of
+/// the process that runs the same image. The checksums are computed on the
+/// patched image, so the store is also specific to the ROM patches. Pages
+/// are looked up and published without locks: a page translated by one
+/// emulator is loaded by the others.
+///
+class TJITGenericROMCache
+{
+public:
+	///
+	/// Constructor from the path of the ROM image and its checksums.
+	/// The store of the image is shared with the other caches of the process
+	/// or created, and then the cache file is mapped if it exists and matches.
+	///
+	/// \param inImagePath	path to the ROM image.
+	/// \param inChecksums	checksums of the ROM image.
+	///
+	TJITGenericROMCache(
+			const char* inImagePath,
+			const KUInt32 inChecksums[10] );
+
+	///
+	/// Destructor.
+	/// The last cache of the store saves it if new pages were translated.
+	///
+	~TJITGenericROMCache( void );
+
+	///
+	/// Determine if a physical page can be cached.
+	///
+	/// \param inPAddr	physical address of the page.
+	/// \return \c true if the page is in ROM.
+	///
+	static Boolean Covers( KUInt32 inPAddr )
+		{
+			return inPAddr < kROMEnd;
+		}
+
+	///
+	/// Fill a page with the units from the cache.
+	///
+	/// \param ioPage		page to fill, with its addresses and pointer set.
+	/// \param outUnitCrsr	on output, first free unit.
+	/// \return \c true if the page was found in the cache.
+	///
+	Boolean	Load( TJITGenericPage* ioPage, KUInt16* outUnitCrsr );
+
+	///
+	/// Start the translation of a page that will be stored into the cache.
+	/// This clears the map of the function units and attaches it to the page.
+	///
+	/// \param ioPage		page that will be translated.
+	///
+	void	BeginStore( TJITGenericPage* ioPage );
+
+	///
+	/// Store a page that was just translated with BeginStore.
+	///
+	/// \param ioPage		page that was translated.
+	/// \param inUnitCount	number of units of the page.
+	///
+	void	Store( TJITGenericPage* ioPage, KUInt16 inUnitCount );
+
+	///
+	/// Write the cache file if new pages were translated.
+	///
+	void	Save( void );
+
+private:
+	///
+	/// Constructeur par copie volontairement indisponible.
+	///
+	/// \param inCopy		objet  copier
+	///
+	TJITGenericROMCache( const TJITGenericROMCache& inCopy );
+
+	///
+	/// Oprateur d'assignation volontairement indisponible.
+	///
+	/// \param inCopy		objet  copier
+	///
+	TJITGenericROMCache& operator = ( const TJITGenericROMCache& inCopy );
+
+	/// Header of the file.
+	struct SHeader {
+		KUInt32		fMagic;				///< kMagic
+		KUInt32		fVersion;			///< kVersion
+		KUInt32		fJITID;				///< ID of the JIT.
+		KUInt32		fJITVersion;		///< Version of the JIT.
+		KUInt32		fUnitSize;			///< sizeof(JITUnit)
+		KUInt32		fBuildID[2];		///< Hash of the module.
+		KUInt32		fChecksums[10];		///< Checksums of the ROM image.
+		KUInt32		fEntryCount;		///< Number of pages.
+	};
+
+	/// Entry for a page. It is followed by the units and by the map of the
+	/// function units (one bit per unit).
+	struct SEntry {
+		KUInt32		fPAddr;				///< Physical address of the page.
+		KUInt32		fVAddr;				///< Virtual address of the page.
+		KUInt32		fHash;				///< Hash of the instructions.
+		KUInt32		fUnitCount;			///< Number of units.
+		KUInt16		fUnitsTable[TJITGenericPage::kInstructionCount];
+	};
+
+	/// Page translated during the session, followed by its entry.
+	struct SNewEntry {
+		SNewEntry*	fNext;				///< Previously translated page.
+	};
+
+	/// Pages of an image, shared by the caches of the process.
+	struct SStore {
+		SStore*		fNext;				///< Next store of the process.
+		KUInt32		fRefCount;			///< Number of caches.
+		char*		fPath;				///< Path to the cache file.
+		KUInt32		fChecksums[10];		///< Checksums of the ROM image.
+		Boolean		fHasBuildID;		///< Whether the module was hashed.
+		KUInt32		fBuildID[2];		///< Hash of the module.
+		TMappedFile*	fMappedFile;	///< Mapped cache file (or NULL).
+		std::atomic<const SEntry*>*	fIndex;	///< Entries by physical page.
+		std::atomic<SNewEntry*>		fNewEntries;	///< Entries translated
+										///< this session. Replaced entries
+										///< are kept, other caches may be
+										///< loading them.
+	};
+
+	enum {
+		kMagic		= 0x4A495443,		///< 'JITC'
+		kVersion	= 6,
+		kROMEnd		= 0x01000000,		///< TMemoryConsts::kROMEnd
+		kPageShift	= 10,
+		kIndexSize	= kROMEnd >> kPageShift,
+		kFuncMapSize = 65536 / 32,		///< Units are indexed by KUInt16.
+	};
+
+	///
+	/// Size of an entry with its units and its map.
+	///
+	static KUIntPtr	EntrySize( KUInt32 inUnitCount );
+
+	///
+	/// Hash the instructions of a page.
+	///
+	static KUInt32	HashPage( const KUInt32* inPointer );
+
+	///
+	/// Check an entry of the file.
+	///
+	/// \param inEntry		entry to check.
+	/// \param inSize		bytes left in the file from the entry.
+	/// \return \c true if the entry can be loaded.
+	///
+	static Boolean	IsValid( const SEntry* inEntry, KUIntPtr inSize );
+
+	///
+	/// Hash the module with the JIT functions. Function pointers of the
+	/// cache are only valid with the same build.
+	///
+	/// \param outBuildID	on output, the hash.
+	/// \return \c true if the module could be read.
+	///
+	static Boolean	ComputeBuildID( KUInt32 outBuildID[2] );
+
+	///
+	/// Find the store of an image or create it.
+	///
+	/// \param inPath		path to the cache file.
+	/// \param inChecksums	checksums of the ROM image.
+	/// \return the store, with a new reference.
+	///
+	static SStore*	AcquireStore(
+						const char* inPath,
+						const KUInt32 inChecksums[10] );
+
+	///
+	/// Release a reference to a store. The last reference saves and deletes
+	/// the store.
+	///
+	/// \param inStore		store to release.
+	///
+	static void		ReleaseStore( SStore* inStore );
+
+	///
+	/// Open the file of a new store and index its entries.
+	///
+	/// \param ioStore		store to open.
+	///
+	static void		Open( SStore* ioStore );
+
+	///
+	/// Write the file of a store if new pages were translated.
+	///
+	/// \param inStore		store to save.
+	///
+	static void		Save( SStore* inStore );
+
+	/// \name Variables
+	static SStore*			sStores;		///< Stores of the process.
+	SStore*					mStore;			///< Pages of the image.
+	KUInt32					mFuncMap[kFuncMapSize];	///< Map of the function
+												///< units of the page being stored.
+};
+
+#endif
+		// _TJITGENERICROMCACHE_H
+
+// ================================================================== //
+// Memory fault - where am I?  Segmentation fault - who am I?         //
+// ================================================================== //
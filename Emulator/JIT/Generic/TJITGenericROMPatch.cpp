@@ -25,10 +25,12 @@
 #include "TJITGenericROMPatch.h"
 
 #include "Emulator/TEmulator.h"
+#include "Emulator/TMemory.h"
 #include "Emulator/TARMProcessor.h"
 #include "Emulator/TDMAManager.h"
 #include "Emulator/Screen/TScreenManager.h"
 #include "Emulator/JIT/Generic/TJITGeneric_Macros.h"
+#include "Emulator/ROM/PrecompiledPatches.h"
 
 
 // MARK: -
@@ -151,7 +153,8 @@ void TJITGenericPatchManager::DoPatchROM(KUInt32* inROMPtr, const std::string& i
 		for (KUInt32 i=0; i<mPatchListTop; i++) {
 			mPatchList[i]->Apply(inROMPtr);
 		}
-		fprintf(stderr, "%u patches applied\n", (unsigned)GetNumPatches());
+		fprintf(stderr, "%u patches applied, %u precompiled functions\n",
+				(unsigned)GetNumPatches(), (unsigned)gPrecompiledFunctionCount);
 	}
 }
 
@@ -343,6 +346,204 @@ void TJITGenericPatchNativeInjection::Apply(KUInt32 *ROM)
 
 
 
+// ========================================================================== //
+// MARK: -
+// TJITGenericPatchPrecompiled
+
+/**
+ \brief Apply the patch to the ROM words.
+
+ The translation replaces the instruction, or is injected before it when it
+ is verified.
+ */
+void TJITGenericPatchPrecompiled::Apply(KUInt32 *ROM)
+{
+	SetOrigialInstruction(ROM[GetOffsetInROM()]);
+	if (mVerify) {
+		ROM[GetOffsetInROM()] = kSWINativeInjection | GetIndex();
+	} else {
+		ROM[GetOffsetInROM()] = kSWINativeCall | GetIndex();
+	}
+}
+
+
+/**
+ \brief Call the translation, or verify it.
+ */
+JITUnit *TJITGenericPatchPrecompiled::Call(JITUnit *ioUnit, TARMProcessor *ioCPU)
+{
+	if (mVerify) {
+		return Verify(ioUnit, ioCPU);
+	}
+	return GetStub()(ioUnit, ioCPU);
+}
+
+
+/**
+ \brief State of the verification of the emulator of ioCPU.
+ */
+TJITGenericPatchPrecompiled::SVerifyState *TJITGenericPatchPrecompiled::GetVerifyState(TARMProcessor *ioCPU)
+{
+	return ioCPU->GetMemory()->GetJITObject()->GetVerifyState();
+}
+
+
+/**
+ \brief Log a write of the translation, in verify mode.
+
+ The old value is read before the translation writes the new one. Writes
+ that do not fit in the log are not logged, the translation is then not
+ verified.
+ */
+void TJITGenericPatchPrecompiled::LogWrite(TARMProcessor *ioCPU, KUInt32 inAddress, Boolean inByte)
+{
+	SVerifyState* theState = GetVerifyState(ioCPU);
+	if (theState->fWriteCount < kMaxWrites) {
+		SWrite* theWrite = &theState->fWrites[theState->fWriteCount];
+		theWrite->fAddress = inAddress;
+		theWrite->fByte = inByte;
+		theWrite->fOldValue = 0;
+		if (inByte) {
+			KUInt8 theByte = 0;
+			(void) ioCPU->GetMemory()->ReadB(inAddress, theByte);
+			theWrite->fOldValue = theByte;
+		} else {
+			(void) ioCPU->GetMemory()->Read(inAddress, theWrite->fOldValue);
+		}
+	}
+	theState->fWriteCount++;
+}
+
+
+/**
+ \brief Run the translation and the original code, and compare them.
+
+ \return the unit of the original instruction if the translation could not
+	be verified, NULL when the original code was stepped up to the end of the
+	translation.
+ */
+JITUnit *TJITGenericPatchPrecompiled::Verify(JITUnit *ioUnit, TARMProcessor *ioCPU)
+{
+	// The original code calls the injection again while it is stepped.
+	SVerifyState* theState = GetVerifyState(ioCPU);
+	if (theState->fStepping || ioCPU->IsThereAnyHardwareInterruptAsserted()) {
+		return ioUnit;
+	}
+
+	TMemory* theMemory = ioCPU->GetMemory();
+	KUInt32 theRegisters[16];
+	KUInt32 theCPSR = ioCPU->GetCPSR();
+	(void) ::memcpy(theRegisters, ioCPU->mCurrentRegisters, sizeof(theRegisters));
+
+	// Run the translation, with its writes logged.
+	theState->fLogging = true;
+	theState->fAborted = false;
+	theState->fInstructionCount = 0;
+	theState->fWriteCount = 0;
+	(void) GetStub()(ioUnit, ioCPU);
+	theState->fLogging = false;
+
+	if (theState->fWriteCount > kMaxWrites) {
+		// The writes cannot be undone, keep the result of the translation.
+		fprintf(stderr, "AOT: %s: too many writes, not verified\n", GetName());
+		return NULL;
+	}
+
+	KUInt32 theNativeRegisters[16];
+	KUInt32 theNativeCPSR = ioCPU->GetCPSR();
+	(void) ::memcpy(theNativeRegisters, ioCPU->mCurrentRegisters, sizeof(theNativeRegisters));
+	KUInt32 indexWrite;
+	for (indexWrite = 0; indexWrite < theState->fWriteCount; indexWrite++) {
+		SWrite* theWrite = &theState->fWrites[indexWrite];
+		if (theWrite->fByte) {
+			KUInt8 theByte = 0;
+			(void) theMemory->ReadB(theWrite->fAddress, theByte);
+			theWrite->fNewValue = theByte;
+		} else {
+			(void) theMemory->Read(theWrite->fAddress, theWrite->fNewValue);
+		}
+	}
+
+	// Undo the translation.
+	for (indexWrite = theState->fWriteCount; indexWrite > 0; indexWrite--) {
+		SWrite* theWrite = &theState->fWrites[indexWrite - 1];
+		if (theWrite->fByte) {
+			(void) theMemory->WriteB(theWrite->fAddress, (KUInt8) theWrite->fOldValue);
+		} else {
+			(void) theMemory->Write(theWrite->fAddress, theWrite->fOldValue);
+		}
+	}
+	(void) ::memcpy(ioCPU->mCurrentRegisters, theRegisters, sizeof(theRegisters));
+	ioCPU->SetCPSR(theCPSR);
+
+	if (theState->fAborted) {
+		// Let the original code take the data abort.
+		return ioUnit;
+	}
+
+	// Step the original code as far as the translation went. Steps that
+	// only translate do not change the PC and are not counted.
+	ioCPU->mCurrentRegisters[TARMProcessor::kR15] = GetAddress() + 4;
+	TARMProcessor::EMode theMode = ioCPU->GetMode();
+	KUInt32 theExecuted = 0;
+	KUInt32 theSteps = 0;
+	theState->fStepping = true;
+	while ((theExecuted < theState->fInstructionCount) && (theSteps < kMaxSteps)) {
+		KUInt32 thePC = ioCPU->mCurrentRegisters[TARMProcessor::kR15];
+		theMemory->GetJITObject()->Step(ioCPU, 1);
+		theSteps++;
+		if (ioCPU->GetMode() != theMode) {
+			break;
+		}
+		if (ioCPU->mCurrentRegisters[TARMProcessor::kR15] != thePC) {
+			theExecuted++;
+		}
+	}
+	theState->fStepping = false;
+
+	if (theExecuted < theState->fInstructionCount) {
+		fprintf(stderr, "AOT: %s: interrupted after %u of %u instructions, not verified\n",
+				GetName(), (unsigned int)theExecuted, (unsigned int)theState->fInstructionCount);
+		return NULL;
+	}
+
+	// Compare.
+	KUInt32 indexReg;
+	for (indexReg = 0; indexReg < 16; indexReg++) {
+		if (ioCPU->mCurrentRegisters[indexReg] != theNativeRegisters[indexReg]) {
+			fprintf(stderr, "AOT: %s: r%u is %08X, %08X when interpreted\n",
+					GetName(), (unsigned int)indexReg,
+					(unsigned int)theNativeRegisters[indexReg],
+					(unsigned int)ioCPU->mCurrentRegisters[indexReg]);
+		}
+	}
+	if (ioCPU->GetCPSR() != theNativeCPSR) {
+		fprintf(stderr, "AOT: %s: CPSR is %08X, %08X when interpreted\n",
+				GetName(), (unsigned int)theNativeCPSR, (unsigned int)ioCPU->GetCPSR());
+	}
+	for (indexWrite = 0; indexWrite < theState->fWriteCount; indexWrite++) {
+		SWrite* theWrite = &theState->fWrites[indexWrite];
+		KUInt32 theValue = 0;
+		if (theWrite->fByte) {
+			KUInt8 theByte = 0;
+			(void) theMemory->ReadB(theWrite->fAddress, theByte);
+			theValue = theByte;
+		} else {
+			(void) theMemory->Read(theWrite->fAddress, theValue);
+		}
+		if (theValue != theWrite->fNewValue) {
+			fprintf(stderr, "AOT: %s: [%08X] is %08X, %08X when interpreted\n",
+					GetName(), (unsigned int)theWrite->fAddress,
+					(unsigned int)theWrite->fNewValue, (unsigned int)theValue);
+		}
+	}
+
+	// Continue with the state of the JIT.
+	return NULL;
+}
+
+
+
 #if 0
 // The following code is here only for reference. The Simulation is currently
 // not working and waits to be reimplemented in a much nicer way.
@@ -114,6 +114,9 @@ public:
 	/// Return the name of this patch.
 	const char *GetName() { return mName; }
 
+	/// Return the address of the patched instruction.
+	KUInt32 GetAddress() { return mAddress; }
+
 	/// Return the data word at the patch address before the patch was applied.
 	KUInt32 GetOriginalInstruction() { return mOriginalInstruction; }
 
@@ -316,4 +319,88 @@ TJITGenericPatchNativeInjection i##addr(addr, p##addr, name); \
 JITInstructionProto(p##addr)
 
 
+/**
+ \brief This patch type calls a precompiled translation of a ROM routine.
+
+ Precompiled translations are C++ versions of hot ROM routines, written by
+ the ahead-of-time compiler (einsteinaot) with the `PRECOMPILED_FUNCTION`
+ macro. The translation replaces the first instruction of the routine and
+ runs until the code leaves the routine. It then sets the PC and returns
+ NULL.
+
+ In verify mode, the patch is applied as an injection. The translation runs
+ first, its writes to memory are logged and undone, and the registers are
+ restored. The original instructions are then stepped with the JIT, as
+ many as the translation executed, and the registers, the flags and the
+ written words are compared. Differences are reported on stderr. The
+ emulation continues with the state of the JIT.
+
+ The state of the verification belongs to the JIT of each emulator, so that
+ several emulators can verify their translations at the same time.
+
+ \see PrecompiledPatches.h
+ */
+class TJITGenericPatchPrecompiled : public TJITGenericPatchNativeCall
+{
+public:
+	/// Create and add a precompiled translation.
+	TJITGenericPatchPrecompiled(KUInt32 address, JITFuncPtr stub,
+								const char *name, Boolean verify)
+	: TJITGenericPatchNativeCall(address, stub, name), mVerify(verify) { }
+
+	/// Patch the ROM word
+	virtual void Apply(KUInt32 *ROM);
+
+	/// Call the translation, or verify it.
+	virtual JITUnit *Call(JITUnit *ioUnit, TARMProcessor *ioCPU);
+
+	enum {
+		kMaxWrites	= 1024,
+		kMaxSteps	= 100000,
+	};
+
+	/// Write logged in verify mode.
+	struct SWrite {
+		KUInt32		fAddress;
+		KUInt32		fOldValue;
+		KUInt32		fNewValue;		///< Set once the translation returned.
+		Boolean		fByte;
+	};
+
+	/// State of the verification, one per emulator (held by its JIT).
+	struct SVerifyState {
+		Boolean		fLogging;		///< A translation is being verified.
+		Boolean		fStepping;		///< The original code is being stepped.
+		Boolean		fAborted;		///< The translation had a data abort.
+		KUInt32		fInstructionCount;	///< Instructions of the translation.
+		KUInt32		fWriteCount;	///< Number of logged writes.
+		SWrite		fWrites[kMaxWrites];	///< Logged writes.
+	};
+
+	/// Log a write of the translation, in verify mode.
+	static void LogWrite(TARMProcessor *ioCPU, KUInt32 inAddress, Boolean inByte);
+
+	/// Count an instruction executed by the translation, in verify mode.
+	static void CountInstruction(TARMProcessor *ioCPU)
+		{ GetVerifyState(ioCPU)->fInstructionCount++; }
+
+	/// Notice a data abort of the translation, in verify mode.
+	static void Abort(TARMProcessor *ioCPU)
+		{ GetVerifyState(ioCPU)->fAborted = true; }
+
+	/// Determine if translations only log (verify mode).
+	static Boolean IsVerifying(TARMProcessor *ioCPU)
+		{ return GetVerifyState(ioCPU)->fLogging; }
+
+private:
+	/// State of the verification of the emulator of ioCPU.
+	static SVerifyState *GetVerifyState(TARMProcessor *ioCPU);
+
+	/// Run the translation and the original code, and compare them.
+	JITUnit *Verify(JITUnit *ioUnit, TARMProcessor *ioCPU);
+
+	Boolean mVerify;				///< Whether the patch is verified.
+};
+
+
 #endif
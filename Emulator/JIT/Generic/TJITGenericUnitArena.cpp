@@ -0,0 +1,194 @@
+// ==============================
+// File:			TJITGenericUnitArena.cp
+// Project:			Einstein
+//
+// Copyright 2003-2007 by Paul Guyot (pguyot@kallisys.net).
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+
+#include <K/Defines/KDefinitions.h>
+#include "JIT.h"
+
+#ifdef JITTARGET_GENERIC
+
+#include "TJITGenericUnitArena.h"
+
+// ANSI C & POSIX
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// -------------------------------------------------------------------------- //
+//  * TJITGenericUnitArena( void )
+// -------------------------------------------------------------------------- //
+TJITGenericUnitArena::TJITGenericUnitArena( void )
+	:
+		mBlock( NULL ),
+		mBlockSize( 0 ),
+		mTop( 0 ),
+		mHeapUnitCount( 0 )
+{
+}
+
+// -------------------------------------------------------------------------- //
+//  * ~TJITGenericUnitArena( void )
+// -------------------------------------------------------------------------- //
+TJITGenericUnitArena::~TJITGenericUnitArena( void )
+{
+	::free( mBlock );
+}
+
+// -------------------------------------------------------------------------- //
+//  * Init( KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TJITGenericUnitArena::Init( KUInt32 inPageCount )
+{
+	KUInt32 theUnitsPerPage = TJITGenericPage::kDefaultUnitCount;
+	// Pages grow in steps, reserve some room for them.
+	theUnitsPerPage += theUnitsPerPage / 8;
+	mBlockSize = inPageCount * theUnitsPerPage;
+	mBlock = (JITUnit*) ::malloc( mBlockSize * sizeof(JITUnit) );
+	if (mBlock == NULL)
+	{
+		mBlockSize = 0;
+	}
+	mTop = 0;
+}
+
+// -------------------------------------------------------------------------- //
+//  * Allocate( KUInt32* )
+// -------------------------------------------------------------------------- //
+JITUnit*
+TJITGenericUnitArena::Allocate( KUInt32* ioUnitCount )
+{
+	KUInt32 theCount = *ioUnitCount;
+
+	// Smallest freed span that is large enough, if it doesn't waste much.
+	TFreeSpans::iterator theSpan = mFreeSpans.lower_bound( theCount );
+	if ((theSpan != mFreeSpans.end())
+		&& (theSpan->first <= theCount + (theCount / 4)))
+	{
+		JITUnit* theResult = theSpan->second;
+		*ioUnitCount = theSpan->first;
+		mFreeSpans.erase( theSpan );
+		return theResult;
+	}
+
+	if (mBlockSize - mTop >= theCount)
+	{
+		JITUnit* theResult = &mBlock[mTop];
+		mTop += theCount;
+		return theResult;
+	}
+
+	// The block is full.
+	JITUnit* theResult = (JITUnit*) ::malloc( theCount * sizeof(JITUnit) );
+	if (theResult == NULL)
+	{
+		// Any freed span that is large enough, however much it wastes.
+		if (theSpan != mFreeSpans.end())
+		{
+			theResult = theSpan->second;
+			*ioUnitCount = theSpan->first;
+			mFreeSpans.erase( theSpan );
+			return theResult;
+		}
+		// The pages cannot be translated without units.
+		(void) ::fprintf( stderr, "Cannot allocate %u JIT units\n",
+			(unsigned int) theCount );
+		::abort();
+	}
+	mHeapUnitCount += theCount;
+	return theResult;
+}
+
+// -------------------------------------------------------------------------- //
+//  * Free( JITUnit*, KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TJITGenericUnitArena::Free( JITUnit* inUnits, KUInt32 inUnitCount )
+{
+	if (inUnits == NULL)
+	{
+		return;
+	}
+
+	if (IsInBlock( inUnits ))
+	{
+		if (inUnits + inUnitCount == &mBlock[mTop])
+		{
+			mTop -= inUnitCount;
+		} else {
+			mFreeSpans.insert( TFreeSpans::value_type( inUnitCount, inUnits ) );
+		}
+	} else {
+		mHeapUnitCount -= inUnitCount;
+		::free( inUnits );
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * IsInBlock( const JITUnit* ) const
+// -------------------------------------------------------------------------- //
+Boolean
+TJITGenericUnitArena::IsInBlock( const JITUnit* inUnits ) const
+{
+	return (inUnits >= mBlock) && (inUnits < mBlock + mBlockSize);
+}
+
+// -------------------------------------------------------------------------- //
+//  * Grow( JITUnit*, KUInt32*, KUInt32 )
+// -------------------------------------------------------------------------- //
+JITUnit*
+TJITGenericUnitArena::Grow(
+				JITUnit* inUnits,
+				KUInt32* ioUnitCount,
+				KUInt32 inNewCount )
+{
+	KUInt32 theOldCount = *ioUnitCount;
+
+	// The last span of the block grows in place.
+	if (IsInBlock( inUnits )
+		&& (inUnits + theOldCount == &mBlock[mTop])
+		&& (mBlockSize - mTop >= inNewCount - theOldCount))
+	{
+		mTop += inNewCount - theOldCount;
+		*ioUnitCount = inNewCount;
+		return inUnits;
+	}
+
+	*ioUnitCount = inNewCount;
+	JITUnit* theResult = Allocate( ioUnitCount );
+	if (inUnits)
+	{
+		(void) ::memcpy( theResult, inUnits, theOldCount * sizeof(JITUnit) );
+		Free( inUnits, theOldCount );
+	}
+	return theResult;
+}
+
+#endif
+	// JITTARGET_GENERIC
+
+// ===================================================================== //
+// We should forget about small efficiencies, say about 97% of the time: //
+// premature optimization is the root of all evil.                       //
+//                 -- Donald E. Knuth                                    //
+// ===================================================================== //
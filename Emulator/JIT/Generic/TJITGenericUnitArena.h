@@ -0,0 +1,138 @@
+// ==============================
+// File:			TJITGenericUnitArena.h
+// Project:			Einstein
+//
+// Copyright 2003-2007 by Paul Guyot (pguyot@kallisys.net).
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+
+#ifndef _TJITGENERICUNITARENA_H
+#define _TJITGENERICUNITARENA_H
+
+#include <K/Defines/KDefinitions.h>
+
+#include <map>
+
+union JITUnit;
+
+///
+/// Storage of the units of the pages of a JIT cache.
+///
+/// The units live in a single block, sized for the pages of the cache.
+/// Spans are bump-allocated from the block and freed spans are kept by size
+/// to be reused. A page keeps its span when it is recycled, unless it grew.
+/// If the block is full, spans are allocated from the heap.
+///
+class TJITGenericUnitArena
+{
+public:
+	///
+	/// Default constructor.
+	///
+	TJITGenericUnitArena( void );
+
+	///
+	/// Destructor.
+	///
+	~TJITGenericUnitArena( void );
+
+	///
+	/// Allocate the block for a number of pages.
+	///
+	/// \param inPageCount	number of pages of the cache.
+	///
+	void		Init( KUInt32 inPageCount );
+
+	///
+	/// Allocate a span of units, from the block, then from the heap, then
+	/// from any freed span. Aborts if there is no memory left.
+	///
+	/// \param ioUnitCount	on input, number of units required, on output,
+	///						number of units of the span (may be more).
+	/// \return the span.
+	///
+	JITUnit*	Allocate( KUInt32* ioUnitCount );
+
+	///
+	/// Free a span of units.
+	///
+	/// \param inUnits		span to free (may be NULL).
+	/// \param inUnitCount	number of units of the span.
+	///
+	void		Free( JITUnit* inUnits, KUInt32 inUnitCount );
+
+	///
+	/// Grow a span of units, keeping its content.
+	///
+	/// \param inUnits		span to grow.
+	/// \param ioUnitCount	on input, number of units of the span, on output,
+	///						number of units of the new span.
+	/// \param inNewCount	number of units required.
+	/// \return the new span, which may be the same.
+	///
+	JITUnit*	Grow(
+					JITUnit* inUnits,
+					KUInt32* ioUnitCount,
+					KUInt32 inNewCount );
+
+	///
+	/// Accessor on the number of units allocated from the heap because the
+	/// block was full.
+	///
+	KUInt32		GetHeapUnitCount( void ) const
+		{
+			return mHeapUnitCount;
+		}
+
+private:
+	///
+	/// Constructeur par copie volontairement indisponible.
+	///
+	/// \param inCopy		objet  copier
+	///
+	TJITGenericUnitArena( const TJITGenericUnitArena& inCopy );
+
+	///
+	/// Oprateur d'assignation volontairement indisponible.
+	///
+	/// \param inCopy		objet  copier
+	///
+	TJITGenericUnitArena& operator = ( const TJITGenericUnitArena& inCopy );
+
+	///
+	/// Determine if a span is in the block.
+	///
+	Boolean		IsInBlock( const JITUnit* inUnits ) const;
+
+	typedef std::multimap<KUInt32, JITUnit*> TFreeSpans;
+
+	/// \name Variables
+	JITUnit*		mBlock;			///< Block of units.
+	KUInt32			mBlockSize;		///< Number of units of the block.
+	KUInt32			mTop;			///< First unit that was never allocated.
+	TFreeSpans		mFreeSpans;		///< Freed spans of the block, by size.
+	KUInt32			mHeapUnitCount;	///< Units allocated from the heap.
+};
+
+#endif
+		// _TJITGENERICUNITARENA_H
+
+// =============================================================== //
+// A bad random number generator: 1, 1, 1, 1, 1, 4.33e+67, 1, 1, 1 //
+// =============================================================== //
@@ -117,6 +117,11 @@ Translate_BlockDataTransfer(
 	PUSHVALUE(inVAddr + 8);
 	// Push the reg list and the number of registers.
 	PUSHVALUE((nbRegs << 16) | regList);
+	// Loads into PC jump through a cache (LDM1 and LDM3).
+	if ((inInstruction & 0x00108000) == 0x00108000)
+	{
+		PUSHINDIRECTCACHE();
+	}
 }
 
 void TJITGeneric_BlockDataTransfer_assertions( void );
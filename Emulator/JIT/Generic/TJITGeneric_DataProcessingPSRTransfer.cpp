@@ -242,7 +242,30 @@ Translate_DataProcessingPSRTransfer(
 					KUInt32 inInstruction,
 					KUInt32 inVAddr )
 {
-	const Boolean theFlagS = (inInstruction & 0x00100000) != 0;
+	Boolean theFlagS = (inInstruction & 0x00100000) != 0;
+	if (theFlagS
+		&& ((inInstruction & 0x01800000) != 0x01000000)
+		&& ((inInstruction & 0x0000F000) != 0x0000F000))
+	{
+		// Use the variant without S if no instruction reads the flags before
+		// they are set again (not for test operations, or with Rd = 15).
+		const KUInt32 theOpcode = (inInstruction >> 21) & 0xF;
+		KUInt8 theFlags;
+		if ((theOpcode >= 0x2) && (theOpcode <= 0x7))
+		{
+			theFlags = JITPageClass::kFlagsAll;
+		} else if ((inInstruction & 0x02000F00) == 0x02000000) {
+			theFlags = JITPageClass::kFlagsNZ;
+		} else if ((inInstruction & 0x02000FF0) == 0x00000000) {
+			theFlags = JITPageClass::kFlagsNZ;
+		} else {
+			theFlags = JITPageClass::kFlagsNZC;
+		}
+		if (inPage->AreFlagsDead(inVAddr, theFlags))
+		{
+			theFlagS = false;
+		}
+	}
 	KUInt32 theMode;
 	KUInt32 thePushedValue;
 	Boolean doPush = true;
@@ -451,6 +474,12 @@ Translate_DataProcessingPSRTransfer(
 	{
 		PUSHVALUE(inVAddr + 8);
 	}
+	// Writes to PC jump through a cache (not for test operations).
+	if (((inInstruction & 0x0000F000) == 0x0000F000)
+		&& ((inInstruction & 0x01800000) != 0x01000000))
+	{
+		PUSHINDIRECTCACHE();
+	}
 }
 
 #endif
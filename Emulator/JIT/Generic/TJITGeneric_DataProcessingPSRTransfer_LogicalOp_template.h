@@ -125,11 +125,7 @@ LogicalOp(OP, MODE, FLAG_S, Rn, Rd)
 	#endif
 #endif
 #if Rd == 15
-	#if FLAG_S
-		MMUCALLNEXT_AFTERSETPC;
-	#else
-		FURTHERCALLNEXT_AFTERSETPC;
-	#endif
+	INDIRECTCALLNEXT_AFTERSETPC;
 #else
 	CALLNEXTUNIT;
 #endif
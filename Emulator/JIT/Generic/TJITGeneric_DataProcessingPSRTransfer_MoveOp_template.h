@@ -92,11 +92,7 @@ MoveOp(OP, MODE, FLAG_S, Rd)
 	#endif
 #endif
 #if Rd == 15
-	#if FLAG_S
-		MMUCALLNEXT_AFTERSETPC;
-	#else
-		FURTHERCALLNEXT_AFTERSETPC;
-	#endif
+	INDIRECTCALLNEXT_AFTERSETPC;
 #else
 	CALLNEXTUNIT;
 #endif
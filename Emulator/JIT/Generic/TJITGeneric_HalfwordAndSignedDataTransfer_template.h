@@ -78,14 +78,14 @@ HalfwordAndSignedDataTransferReg_Template(BITS_FLAGS, Rn, Rd)
 	#if !FLAG_S
 		// Unsigned half-word
 		KUInt8 highData;
-		if (theMemoryInterface->ReadB( theAddress, highData ))
+		if (theMemoryInterface->FastReadB( theAddress, highData ))
 		{
 			SETPC(GETPC());
 			ioCPU->DataAbort();
 			MMUCALLNEXT_AFTERSETPC;
 		}
 		KUInt8 lowData;
-		if (theMemoryInterface->ReadB( theAddress + 1, lowData ))
+		if (theMemoryInterface->FastReadB( theAddress + 1, lowData ))
 		{
 			SETPC(GETPC());
 			ioCPU->DataAbort();
@@ -95,7 +95,7 @@ HalfwordAndSignedDataTransferReg_Template(BITS_FLAGS, Rn, Rd)
 	#elif !FLAG_H
 	    // Signed byte
 		KUInt8 signedByte;
-		if (theMemoryInterface->ReadB( theAddress, signedByte ))
+		if (theMemoryInterface->FastReadB( theAddress, signedByte ))
 		{
 			SETPC(GETPC());
 			ioCPU->DataAbort();
@@ -105,14 +105,14 @@ HalfwordAndSignedDataTransferReg_Template(BITS_FLAGS, Rn, Rd)
 	#else
 	    // Signed halfwords
 		KUInt8 highData;
-		if (theMemoryInterface->ReadB( theAddress, highData ))
+		if (theMemoryInterface->FastReadB( theAddress, highData ))
 		{
 			SETPC(GETPC());
 			ioCPU->DataAbort();
 			MMUCALLNEXT_AFTERSETPC;
 		}
 		KUInt8 lowData;
-		if (theMemoryInterface->ReadB( theAddress + 1, lowData ))
+		if (theMemoryInterface->FastReadB( theAddress + 1, lowData ))
 		{
 			SETPC(GETPC());
 			ioCPU->DataAbort();
@@ -140,13 +140,13 @@ HalfwordAndSignedDataTransferReg_Template(BITS_FLAGS, Rn, Rd)
 
     // The L bit should not be set low (Store) when Signed (S=1) operations have been selected
     // Unsigned half-word
-    if (theMemoryInterface->WriteB( theAddress, (KUInt8) ((theValue > 8) & 0xFF) ))
+    if (theMemoryInterface->FastWriteB( theAddress, (KUInt8) ((theValue > 8) & 0xFF) ))
     {
         SETPC(GETPC());
         ioCPU->DataAbort();
         MMUCALLNEXT_AFTERSETPC;
     }
-    if (theMemoryInterface->WriteB( theAddress + 1, (KUInt8) (theValue & 0xFF) ))
+    if (theMemoryInterface->FastWriteB( theAddress + 1, (KUInt8) (theValue & 0xFF) ))
     {
         SETPC(GETPC());
         ioCPU->DataAbort();
@@ -69,6 +69,44 @@ LDM1_Template(FLAG_P, FLAG_U, FLAG_W, Rn)
 #endif
 
 	// Load.
+#if JIT_SOFT_TLB
+	// Stack pops are within a page of RAM: read the words from the host
+	// memory directly.
+	const KUInt32* theBlock = theMemoryInterface->GetReadBlock(
+			(TMemory::VAddr) baseAddress, (theImmValue >> 16) * 4 );
+	if (theBlock)
+	{
+		int indexReg = 0;
+		while (curRegList)
+		{
+			if (curRegList & 1)
+			{
+				ioCPU->mCurrentRegisters[indexReg] = *theBlock++;
+			}
+
+			curRegList >>= 1;
+			indexReg++;
+		}
+
+		if (theRegList & 0x8000)
+		{
+			SETPC( *theBlock + 4 );   // Prefetch.
+		}
+
+	#if FLAG_W
+		// Write back.
+		ioCPU->mCurrentRegisters[Rn] = wbAddress;
+	#endif
+
+		if (theRegList & 0x8000)
+		{
+			INDIRECTCALLNEXT_AFTERSETPC;
+		} else {
+			CALLNEXTUNIT;
+		}
+	}
+#endif
+
 #if 0
 	// 5460 loops in debug mode
 	int indexReg = 0;
@@ -177,7 +215,7 @@ LDM1_Template(FLAG_P, FLAG_U, FLAG_W, Rn)
 
 	if (theRegList & 0x8000)
 	{
-		MMUCALLNEXT_AFTERSETPC;
+		INDIRECTCALLNEXT_AFTERSETPC;
 	} else {
 		CALLNEXTUNIT;
 	}
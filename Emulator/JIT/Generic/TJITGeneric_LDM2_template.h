@@ -71,6 +71,36 @@ LDM2_Template(FLAG_P, FLAG_U, Rn)
 #endif
 
 	// Load.
+#if JIT_SOFT_TLB
+	// The block is usually within a page of RAM: read the words from the
+	// host memory directly.
+	const KUInt32* theBlock = theMemoryInterface->GetReadBlock(
+			(TMemory::VAddr) baseAddress, (theImmValue >> 16) * 4 );
+	if (theBlock)
+	{
+		int indexReg = 0;
+		while (curRegList)
+		{
+			if (curRegList & 1)
+			{
+				ioCPU->mCurrentRegisters[indexReg] = *theBlock++;
+			}
+
+			curRegList >>= 1;
+			indexReg++;
+		}
+		if (bankRegList & 0x0100) ioCPU->mR8_Bkup = *theBlock++;
+		if (bankRegList & 0x0200) ioCPU->mR9_Bkup = *theBlock++;
+		if (bankRegList & 0x0400) ioCPU->mR10_Bkup = *theBlock++;
+		if (bankRegList & 0x0800) ioCPU->mR11_Bkup = *theBlock++;
+		if (bankRegList & 0x1000) ioCPU->mR12_Bkup = *theBlock++;
+		if (bankRegList & 0x2000) ioCPU->mR13_Bkup = *theBlock++;
+		if (bankRegList & 0x4000) ioCPU->mR14_Bkup = *theBlock;
+
+		CALLNEXTUNIT;
+	}
+#endif
+
 	int indexReg = 0;
 	while (curRegList)
 	{
@@ -152,7 +182,7 @@ LDM2_Template(FLAG_P, FLAG_U, Rn)
 			}
 			baseAddress += 4;
 		}
-		if (bankRegList & 0x3000)
+		if (bankRegList & 0x2000)
 		{
 			if (theMemoryInterface->ReadAligned(
 				(TMemory::VAddr) baseAddress,
@@ -69,6 +69,37 @@ LDM3_Template(FLAG_P, FLAG_U, FLAG_W, Rn)
 #endif
 
 	// Load.
+#if JIT_SOFT_TLB
+	// Returns from exceptions pop from a page of RAM: read the words from
+	// the host memory directly.
+	const KUInt32* theBlock = theMemoryInterface->GetReadBlock(
+			(TMemory::VAddr) baseAddress, (theImmValue >> 16) * 4 );
+	if (theBlock)
+	{
+		int indexReg = 0;
+		while (curRegList)
+		{
+			if (curRegList & 1)
+			{
+				ioCPU->mCurrentRegisters[indexReg] = *theBlock++;
+			}
+
+			curRegList >>= 1;
+			indexReg++;
+		}
+		SETPC( *theBlock + 4 );   // Prefetch.
+
+	#if FLAG_W
+		// Write back should occur before the mode change.
+		ioCPU->mCurrentRegisters[Rn] = wbAddress;
+	#endif
+
+		ioCPU->SetCPSR( ioCPU->GetSPSR() );
+
+		INDIRECTCALLNEXT_AFTERSETPC;
+	}
+#endif
+
 	int indexReg = 0;
 	while (curRegList)
 	{
@@ -108,7 +139,7 @@ LDM3_Template(FLAG_P, FLAG_U, FLAG_W, Rn)
 
 	ioCPU->SetCPSR( ioCPU->GetSPSR() );
 
-	MMUCALLNEXT_AFTERSETPC;
+	INDIRECTCALLNEXT_AFTERSETPC;
 }
 #endif
 
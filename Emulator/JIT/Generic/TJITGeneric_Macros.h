@@ -95,6 +95,80 @@
 			ioCPU, theMemIntf, pc );						\
 	}
 
+// Jump to a unit on another page, linking the two pages directly.
+// The two units following the current one hold the target unit and the
+// generation of the cache when the link was made. The link is only trusted
+// while the generation is unchanged, i.e. until the next invalidation or until
+// a linked page is recycled. A link is only made if the lookup neither aborted
+// nor recycled a page, as this page may be the one that was recycled.
+#define MMULINKNEXT(pc) \
+	{														\
+		TMemory* theMemIntf = ioCPU->GetMemory();			\
+		JITClass* theJIT = theMemIntf->GetJITObject();		\
+		KUInt32 theGeneration = theJIT->GetCacheGeneration();	\
+		SETPC(pc);											\
+		if (ioUnit[2].fValue == theGeneration) {			\
+			return (JITUnit*) ioUnit[1].fPtr;				\
+		}													\
+		Boolean canLink;									\
+		JITUnit* theLinkedUnit = theJIT->GetJITUnitForLink(	\
+			ioCPU, theMemIntf, pc, &canLink );				\
+		if (canLink											\
+			&& (theJIT->GetCacheGeneration() == theGeneration)) {	\
+			ioUnit[1].fPtr = (KUIntPtr) theLinkedUnit;		\
+			ioUnit[2].fValue = theGeneration;				\
+		}													\
+		return theLinkedUnit;								\
+	}
+
+// Room for the link, to be pushed after the PC by units using MMULINKNEXT.
+#define PUSHLINK() \
+	{														\
+		PUSHVALUE((KUIntPtr) 0);							\
+		PUSHVALUE((KUIntPtr) 0);							\
+	}
+
+// Jump to the target of an indirect branch, once the PC was set.
+// The three units following the current one are an inline cache of the last
+// target: its PC, its unit and the generation of the cache when it was
+// filled. The cache is refilled when the target changes and is ignored after
+// an invalidation or the recycling of a linked page, like links.
+// Returns are first predicted with the return stack of the JIT.
+#define INDIRECTCALLNEXT_AFTERSETPC \
+	{														\
+		TMemory* theMemIntf = ioCPU->GetMemory();			\
+		JITClass* theJIT = theMemIntf->GetJITObject();		\
+		KUInt32 theTargetPC = THEPC;						\
+		JITUnit* theReturnUnit = theJIT->PopReturn( theTargetPC );	\
+		if (theReturnUnit) {								\
+			return theReturnUnit;							\
+		}													\
+		KUInt32 theGeneration = theJIT->GetCacheGeneration();	\
+		if ((ioUnit[1].fValue == theTargetPC)				\
+			&& (ioUnit[3].fValue == theGeneration)) {		\
+			return (JITUnit*) ioUnit[2].fPtr;				\
+		}													\
+		Boolean canLink;									\
+		JITUnit* theTargetUnit = theJIT->GetJITUnitForLink(	\
+			ioCPU, theMemIntf, theTargetPC, &canLink );		\
+		if (canLink											\
+			&& (theJIT->GetCacheGeneration() == theGeneration)) {	\
+			ioUnit[1].fValue = theTargetPC;					\
+			ioUnit[2].fPtr = (KUIntPtr) theTargetUnit;		\
+			ioUnit[3].fValue = theGeneration;				\
+		}													\
+		return theTargetUnit;								\
+	}
+
+// Room for the inline cache, to be pushed last by units using
+// INDIRECTCALLNEXT_AFTERSETPC.
+#define PUSHINDIRECTCACHE() \
+	{														\
+		PUSHVALUE((KUIntPtr) 0);							\
+		PUSHVALUE((KUIntPtr) 0);							\
+		PUSHVALUE((KUIntPtr) 0);							\
+	}
+
 #define MMUSMARTCALLNEXT(pc) \
 	{														\
 		static KSInt32 ioUnitOffset = kOffsetUnknown;		\
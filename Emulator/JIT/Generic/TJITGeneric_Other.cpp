@@ -29,6 +29,7 @@
 // Einstein
 #include "TARMProcessor.h"
 #include "TEmulator.h"
+#include "TInterruptManager.h"
 #include "TJITGenericROMPatch.h"
 #include "Monitor/TSymbolList.h"
 
@@ -52,6 +53,15 @@
  registers.
 */
 
+// -------------------------------------------------------------------------- //
+// Constantes
+// -------------------------------------------------------------------------- //
+#if JIT_IDLE_LOOPS
+static const KUInt32 kIdleLoopMaxLength = 8;	// Instructions before the branch.
+static const KUInt32 kIdleLoopPasses = 8;		// Passes before waiting.
+static const KUInt32 kIdleLoopLoadedShift = 8;	// Passes are below.
+static const KUInt32 kIdleLoopFlags = 1 << 16;	// The flags, after the PC.
+#endif
 
 // -------------------------------------------------------------------------- //
 //  * SWI
@@ -233,7 +243,7 @@ JITInstructionProto(Branch)
 	POPVALUE(theNewPC);
 	
 	// Branch.
-	MMUCALLNEXT(theNewPC);
+	MMULINKNEXT(theNewPC);
 }
 
 // -------------------------------------------------------------------------- //
@@ -286,8 +296,10 @@ JITInstructionProto(BranchWithLink)
 	POPVALUE(theNewPC);
 	
 	// BL
+	// The return continues with the unit after the link.
 	ioCPU->mCurrentRegisters[14] = theNewLR;
-	MMUCALLNEXT(theNewPC);
+	ioCPU->GetMemory()->GetJITObject()->PushReturn( theNewLR + 4, &ioUnit[3] );
+	MMULINKNEXT(theNewPC);
 }
 
 // -------------------------------------------------------------------------- //
@@ -304,6 +316,7 @@ JITInstructionProto(BranchWithLinkWithinPage)
 	
 	// BL
 	ioCPU->mCurrentRegisters[14] = theNewLR;
+	ioCPU->GetMemory()->GetJITObject()->PushReturn( theNewLR + 4, &ioUnit[1] );
 	SETPC(theNewPC);
 	return ioUnit+theDelta;
 }
@@ -325,6 +338,7 @@ JITInstructionProto(BranchWithLinkWithinPageFindDelta)
 	
 	// MMUCALLNEXT()
 	TMemory *theMemIntf = ioCPU->GetMemory();
+	theMemIntf->GetJITObject()->PushReturn( theNewLR + 4, &ioUnit[1] );
 	SETPC(theNewPC);
 	JITUnit *nextUnit = theMemIntf->GetJITObject()
 		->GetJITUnitForPC(ioCPU, theMemIntf, theNewPC);
@@ -336,6 +350,177 @@ JITInstructionProto(BranchWithLinkWithinPageFindDelta)
 }
 
 
+#if JIT_IDLE_LOOPS
+// -------------------------------------------------------------------------- //
+//  * IdleLoop
+// -------------------------------------------------------------------------- //
+JITInstructionProto(IdleLoop)
+{
+	// The two units that follow hold the signature of the registers at the
+	// previous pass, and the number of passes with the same signature below
+	// the registers (and flags) that depend on loaded values. Those change at
+	// every pass of a loop that polls the timer and are left out.
+	KUInt32 theLoaded = ioUnit[2].fValue >> kIdleLoopLoadedShift;
+	KUInt32 theSignature = ioCPU->GetCPSR();
+	if (theLoaded & kIdleLoopFlags)
+	{
+		theSignature &= ~(TARMProcessor::kPSR_NBit | TARMProcessor::kPSR_ZBit
+			| TARMProcessor::kPSR_CBit | TARMProcessor::kPSR_VBit);
+	}
+	KUInt32 indexReg;
+	for (indexReg = 0; indexReg < 15; indexReg++)
+	{
+		if (!(theLoaded & (1 << indexReg)))
+		{
+			theSignature =
+				(theSignature ^ ioCPU->mCurrentRegisters[indexReg]) * 0x01000193;
+		}
+	}
+	
+	// The loop is idle if it polled the hardware without changing anything.
+	TInterruptManager* theInterruptManager =
+		ioCPU->GetEmulator()->GetInterruptManager();
+	KUInt32 thePasses = 0;
+	if ((theInterruptManager->TakePollCount() != 0)
+		&& (theSignature == ioUnit[1].fValue))
+	{
+		thePasses = (ioUnit[2].fValue & ((1 << kIdleLoopLoadedShift) - 1)) + 1;
+		if (thePasses == kIdleLoopPasses)
+		{
+			if (!ioCPU->IsThereAnyHardwareInterruptAsserted())
+			{
+				theInterruptManager->WaitUntilNextMatch();
+			}
+			thePasses = 0;
+		}
+	}
+	ioUnit[1].fValue = theSignature;
+	ioUnit[2].fValue = (theLoaded << kIdleLoopLoadedShift) | thePasses;
+	ioUnit += 2;
+	
+	// Then branch.
+	EXECUTENEXTUNIT;
+}
+
+// -------------------------------------------------------------------------- //
+//  * IsIdleLoop
+// -------------------------------------------------------------------------- //
+static Boolean
+IsIdleLoop(
+		JITPageClass* inPage,
+		KUInt32 inVAddr,
+		KUInt32 inTarget,
+		KUInt32* outLoaded )
+{
+	// Short backward loops only.
+	if ((inTarget >= inVAddr)
+		|| ((inVAddr - inTarget) > (kIdleLoopMaxLength * 4)))
+	{
+		return false;
+	}
+	
+	// The body may only compute registers and load words or bytes, so the
+	// registers and the flags tell whether a pass changed anything.
+	KUInt32 theVAddr;
+	for (theVAddr = inTarget; theVAddr < inVAddr; theVAddr += 4)
+	{
+		KUInt32 theInstruction = inPage->GetWord(theVAddr);
+		// Never (NV).
+		if ((theInstruction >> 28) == 0xF)
+		{
+			return false;
+		}
+		if ((theInstruction & 0x0C000000) == 0x00000000)
+		{
+			// Data processing, not multiplications and extra loads and
+			// stores, not MRS and MSR, not into the PC.
+			if (((theInstruction & 0x02000090) == 0x00000090)
+				|| ((theInstruction & 0x01900000) == 0x01000000)
+				|| ((theInstruction & 0x0000F000) == 0x0000F000))
+			{
+				return false;
+			}
+		} else if ((theInstruction & 0x0E300000) == 0x04100000) {
+			// LDR or LDRB with an immediate offset and without write back,
+			// not into the PC. Post-indexed loads write back.
+			if (!(theInstruction & 0x01000000)
+				|| ((theInstruction & 0x0000F000) == 0x0000F000))
+			{
+				return false;
+			}
+		} else {
+			return false;
+		}
+	}
+	
+	// Find the registers and the flags that depend on loaded values (bit 16
+	// for the flags). Values are carried to the next pass, so go through the
+	// body until nothing changes.
+	KUInt32 theLoaded = 0;
+	KUInt32 thePrevious;
+	do {
+		thePrevious = theLoaded;
+		for (theVAddr = inTarget; theVAddr < inVAddr; theVAddr += 4)
+		{
+			KUInt32 theInstruction = inPage->GetWord(theVAddr);
+			KUInt32 theRd = (theInstruction >> 12) & 0xF;
+			if ((theInstruction & 0x0C000000) != 0x00000000)
+			{
+				// LDR or LDRB.
+				theLoaded |= 1 << theRd;
+				continue;
+			}
+
+			// A condition on loaded flags makes the result loaded too.
+			Boolean isConditional = ((theInstruction >> 28) != 0xE);
+			Boolean isLoaded = isConditional && (theLoaded & kIdleLoopFlags);
+			KUInt32 theOpCode = (theInstruction >> 21) & 0xF;
+			if ((theOpCode != 0xD) && (theOpCode != 0xF))
+			{
+				// Not MOV or MVN: Rn is an operand.
+				isLoaded |= (theLoaded >> ((theInstruction >> 16) & 0xF)) & 1;
+			}
+			if (!(theInstruction & 0x02000000))
+			{
+				isLoaded |= (theLoaded >> (theInstruction & 0xF)) & 1;
+				if (theInstruction & 0x10)
+				{
+					isLoaded |= (theLoaded >> ((theInstruction >> 8) & 0xF)) & 1;
+				} else if ((theInstruction & 0x00000FE0) == 0x00000060) {
+					// RRX reads the carry.
+					isLoaded |= (theLoaded & kIdleLoopFlags) != 0;
+				}
+			}
+			if ((theOpCode >= 0x5) && (theOpCode <= 0x7))
+			{
+				// ADC, SBC and RSC read the carry.
+				isLoaded |= (theLoaded & kIdleLoopFlags) != 0;
+			}
+
+			// A conditional instruction may keep the previous value.
+			KUInt32 theWritten = 0;
+			if ((theOpCode < 0x8) || (theOpCode > 0xB))
+			{
+				theWritten |= 1 << theRd;
+			}
+			if (theInstruction & 0x00100000)
+			{
+				theWritten |= kIdleLoopFlags;
+			}
+			if (isLoaded)
+			{
+				theLoaded |= theWritten;
+			} else if (!isConditional) {
+				theLoaded &= ~theWritten;
+			}
+		}
+	} while (theLoaded != thePrevious);
+	
+	*outLoaded = theLoaded;
+	return true;
+}
+#endif
+
 // -------------------------------------------------------------------------- //
 //  * Translate_Branch
 // -------------------------------------------------------------------------- //
@@ -384,11 +569,25 @@ Translate_Branch(
 			PUSHVALUE(inVAddr + 4);	
 			// The new PC
 			PUSHVALUE(inVAddr + delta + 4);
+			// The link to the target page, resolved later
+			PUSHLINK();
 		}
 	} else {
 		// optimizing branches within pages gave us a 10% speed increase
 		if ( (inVAddr+delta>=inPage->GetVAddr()) && (inVAddr+delta<inPage->GetVAddr()+inPage->kPageSize) ) 
 		{
+#if JIT_IDLE_LOOPS
+			KUInt32 theLoaded;
+			if (IsIdleLoop(inPage, inVAddr, inVAddr + delta, &theLoaded))
+			{
+				PUSHFUNC(IdleLoop);
+				// The signature of the previous pass
+				PUSHVALUE((KUIntPtr) 0);
+				// The registers left out of the signature and the number
+				// of passes
+				PUSHVALUE(theLoaded << kIdleLoopLoadedShift);
+			}
+#endif
 			PUSHFUNC(BranchWithinPageFindDelta);
 			// The new PC
 			PUSHVALUE(inVAddr + delta + 4);
@@ -398,6 +597,8 @@ Translate_Branch(
 			PUSHFUNC(Branch);
 			// The new PC
 			PUSHVALUE(inVAddr + delta + 4);
+			// The link to the target page, resolved later
+			PUSHLINK();
 		}
 	}
 }
@@ -53,6 +53,10 @@ Translate_Branch(
 					KUInt32 inInstruction,
 					KUInt32 inVAddr );
 
+#if JIT_IDLE_LOOPS
+JITInstructionProto(IdleLoop);
+#endif
+
 JITInstructionProto(SystemBootUND);
 JITInstructionProto(DebuggerUND);
 JITInstructionProto(TapFileCntlUND);
@@ -69,6 +69,40 @@ STM1_Template(FLAG_P, FLAG_U, FLAG_W, Rn)
 #endif
 
 	// Store.
+#if JIT_SOFT_TLB
+	// Stack pushes are within a page of RAM: write the words to the host
+	// memory directly.
+	KUInt32* theBlock = theMemoryInterface->GetWriteBlock(
+			(TMemory::VAddr) baseAddress, (theImmValue >> 16) * 4 );
+	if (theBlock)
+	{
+		int indexReg = 0;
+		while (curRegList)
+		{
+			if (curRegList & 1)
+			{
+				*theBlock++ = ioCPU->mCurrentRegisters[indexReg];
+			}
+
+			curRegList >>= 1;
+			indexReg++;
+		}
+
+		if (theRegList & 0x8000)
+		{
+			// Stored value is PC + 12
+			*theBlock = GETPC() + 4;
+		}
+
+	#if FLAG_W
+		// Write back.
+		ioCPU->mCurrentRegisters[Rn] = wbAddress;
+	#endif
+
+		CALLNEXTUNIT;
+	}
+#endif
+
 #if 0
 	// 4850 loops in debug mode
 	int indexReg = 0;
@@ -73,6 +73,41 @@ STM2_Template(FLAG_P, FLAG_U, Rn)
 #endif
 
 	// Store.
+#if JIT_SOFT_TLB
+	// The block is usually within a page of RAM: write the words to the
+	// host memory directly.
+	KUInt32* theBlock = theMemoryInterface->GetWriteBlock(
+			(TMemory::VAddr) baseAddress, (theImmValue >> 16) * 4 );
+	if (theBlock)
+	{
+		int indexReg = 0;
+		while (curRegList)
+		{
+			if (curRegList & 1)
+			{
+				*theBlock++ = ioCPU->mCurrentRegisters[indexReg];
+			}
+
+			curRegList >>= 1;
+			indexReg++;
+		}
+		if (bankRegList & 0x0100) *theBlock++ = ioCPU->mR8_Bkup;
+		if (bankRegList & 0x0200) *theBlock++ = ioCPU->mR9_Bkup;
+		if (bankRegList & 0x0400) *theBlock++ = ioCPU->mR10_Bkup;
+		if (bankRegList & 0x0800) *theBlock++ = ioCPU->mR11_Bkup;
+		if (bankRegList & 0x1000) *theBlock++ = ioCPU->mR12_Bkup;
+		if (bankRegList & 0x2000) *theBlock++ = ioCPU->mR13_Bkup;
+		if (bankRegList & 0x4000) *theBlock++ = ioCPU->mR14_Bkup;
+		if (theRegList & 0x8000)
+		{
+			// Stored value is PC + 12
+			*theBlock = GETPC() + 4;
+		}
+
+		CALLNEXTUNIT;
+	}
+#endif
+
 	int indexReg = 0;
 	while (curRegList)
 	{
@@ -108,6 +108,18 @@ Translate_SingleDataTransfer(
 		PUSHFUNC(DirectSingleDataTransfer_Funcs[theIndex]);
 		inMemoryIntf->Read(theAddress, theValue);
 		PUSHVALUE(theValue);
+	} else if (inPage->IsHot()
+		&& ((inInstruction & 0x0fff0000) == 0x059F0000)
+		&& ((inInstruction & 0x0000F000) != 0x0000F000)
+		&& ((((inInstruction & 0x00000fff) + inVAddr + 8) ^ inVAddr)
+			& TMemoryConsts::kMMUSmallestPageMask) == 0
+		&& ((inInstruction & 0x00000003) == 0)) {
+		// Same shortcut for a literal in the page of a hot page: writes to
+		// the page invalidate it, with the folded value.
+		KUInt32 theIndex = (inInstruction & 0x0000F000) >> 12;
+		KUInt32 theAddress = (inInstruction&0x00000fff)+inVAddr+8;
+		PUSHFUNC(DirectSingleDataTransfer_Funcs[theIndex]);
+		PUSHVALUE(inPage->GetWord(theAddress));
 	} else {
 		// Get the index.
 		KUInt32 theIndex = (inInstruction & 0x03FFF000) >> 12;
@@ -115,6 +127,11 @@ Translate_SingleDataTransfer(
 		PUSHVALUE(inInstruction);
 		// Always push PC, in case we have a dataabort we'll need it.
 		PUSHVALUE(inVAddr + 8);
+		// Loads into PC jump through a cache.
+		if ((inInstruction & 0x0010F000) == 0x0010F000)
+		{
+			PUSHINDIRECTCACHE();
+		}
 	}
 }
 
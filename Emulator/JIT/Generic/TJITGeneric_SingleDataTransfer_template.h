@@ -93,7 +93,7 @@ SingleDataTransfer_Template(BITS_FLAGS, Rn, Rd)
 	#if FLAG_B
 		// Byte
 		KUInt8 theData;
-		if (theMemoryInterface->ReadB( theAddress, theData ))
+		if (theMemoryInterface->FastReadB( theAddress, theData ))
 		{
 			// No need to restore mMemory->SetPrivilege since
 			// we'll access memory in privilege mode from now anyway.
@@ -104,7 +104,7 @@ SingleDataTransfer_Template(BITS_FLAGS, Rn, Rd)
 	#else
 		// Word
 		KUInt32 theData;
-		if (theMemoryInterface->Read( theAddress, theData ))
+		if (theMemoryInterface->FastRead( theAddress, theData ))
 		{
 			SETPC(GETPC());
 			ioCPU->DataAbort();
@@ -136,7 +136,7 @@ SingleDataTransfer_Template(BITS_FLAGS, Rn, Rd)
 	
 	#if FLAG_B
 		// Byte
-		if (theMemoryInterface->WriteB(
+		if (theMemoryInterface->FastWriteB(
 				theAddress, (KUInt8) (theValue & 0xFF) ))
 		{
 			SETPC(GETPC());
@@ -145,7 +145,7 @@ SingleDataTransfer_Template(BITS_FLAGS, Rn, Rd)
 		}
 	#else
 		// Word.
-		if (theMemoryInterface->Write( theAddress, theValue ))
+		if (theMemoryInterface->FastWrite( theAddress, theValue ))
 		{
 			SETPC(GETPC());
 			ioCPU->DataAbort();
@@ -182,7 +182,7 @@ SingleDataTransfer_Template(BITS_FLAGS, Rn, Rd)
 #endif
 
 #if (Rd == 15) && FLAG_L
-	FURTHERCALLNEXT_AFTERSETPC;
+	INDIRECTCALLNEXT_AFTERSETPC;
 #else
 	CALLNEXTUNIT;
 #endif
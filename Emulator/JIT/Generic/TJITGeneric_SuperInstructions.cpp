@@ -0,0 +1,469 @@
+// ==============================
+// File:			TJITGeneric_SuperInstructions.cp
+// Project:			Einstein
+//
+// Copyright 2003-2007 by Paul Guyot (pguyot@kallisys.net).
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+#include <K/Defines/KDefinitions.h>
+#include "JIT.h"
+
+#if defined(JITTARGET_GENERIC) && JIT_SUPERINSTRUCTIONS
+
+// Einstein
+#include "TARMProcessor.h"
+#include "TMemory.h"
+
+#include "TJITGeneric_Macros.h"
+#include "TJITGeneric_SuperInstructions.h"
+
+// A superinstruction executes two instructions with a single dispatch.
+// Its last value is the delta to the unit following the second instruction,
+// whose units come right after it. When stepping, the first unit of the
+// second instruction is replaced with Halt and the superinstruction only
+// executes the first instruction.
+
+#define IsHalted() \
+	(ioUnit[1].fFuncPtr == TJITGenericPage::Halt)
+
+// -------------------------------------------------------------------------- //
+//  * Compare (CMP followed by a conditional instruction)
+// -------------------------------------------------------------------------- //
+inline void
+Compare( TARMProcessor* ioCPU, KUInt32 Opnd1, KUInt32 Opnd2 )
+{
+	const KUInt32 theResult = Opnd1 - Opnd2;
+	const KUInt32 Negative1 = Opnd1 & 0x80000000;
+	const KUInt32 Negative2 = Opnd2 & 0x80000000;
+	const KUInt32 NegativeR = theResult & 0x80000000;
+	SetCPSRBitsForArithmeticOp(
+		ioCPU,
+		theResult,
+		(Negative1 && !Negative2)
+		|| (Negative1 && !NegativeR)
+		|| (!Negative2 && !NegativeR),
+		(Negative1 && !Negative2 && !NegativeR)
+		|| (!Negative1 && Negative2 && NegativeR));
+}
+
+#define Compare_Opnd2_Imm(value)	(value)
+#define Compare_Opnd2_Reg(value)	ioCPU->mCurrentRegisters[value]
+
+// The first unit of the second instruction is its test, skip it if the
+// condition holds, skip the whole instruction otherwise.
+#define Compare_Template(mode, cond, test)								\
+JITInstructionProto(Compare ## mode ## _ ## cond)						\
+{																		\
+	KUInt32 theRn;														\
+	POPVALUE(theRn);													\
+	KUInt32 theOpnd2;													\
+	POPVALUE(theOpnd2);													\
+	KUInt32 theSkip;													\
+	POPVALUE(theSkip);													\
+	Compare(															\
+		ioCPU,															\
+		ioCPU->mCurrentRegisters[theRn],								\
+		Compare_Opnd2_ ## mode(theOpnd2));								\
+	if (IsHalted())														\
+	{																	\
+		CALLNEXTUNIT;													\
+	}																	\
+	if (test)															\
+	{																	\
+		CALLUNIT(2);													\
+	} else {															\
+		CALLUNIT(theSkip);												\
+	}																	\
+}
+
+#define Compare_Templates(mode)											\
+	Compare_Template(mode, EQ, ioCPU->mCPSR_Z)							\
+	Compare_Template(mode, NE, !ioCPU->mCPSR_Z)							\
+	Compare_Template(mode, CS, ioCPU->mCPSR_C)							\
+	Compare_Template(mode, CC, !ioCPU->mCPSR_C)							\
+	Compare_Template(mode, MI, ioCPU->mCPSR_N)							\
+	Compare_Template(mode, PL, !ioCPU->mCPSR_N)							\
+	Compare_Template(mode, VS, ioCPU->mCPSR_V)							\
+	Compare_Template(mode, VC, !ioCPU->mCPSR_V)							\
+	Compare_Template(mode, HI, ioCPU->mCPSR_C && !ioCPU->mCPSR_Z)		\
+	Compare_Template(mode, LS, !ioCPU->mCPSR_C || ioCPU->mCPSR_Z)		\
+	Compare_Template(mode, GE, ioCPU->mCPSR_N == ioCPU->mCPSR_V)		\
+	Compare_Template(mode, LT, ioCPU->mCPSR_N != ioCPU->mCPSR_V)		\
+	Compare_Template(mode, GT,											\
+		!ioCPU->mCPSR_Z && (ioCPU->mCPSR_N == ioCPU->mCPSR_V))			\
+	Compare_Template(mode, LE,											\
+		ioCPU->mCPSR_Z || (ioCPU->mCPSR_N != ioCPU->mCPSR_V))
+
+Compare_Templates(Imm)
+Compare_Templates(Reg)
+
+#define Compare_Funcs(mode)												\
+static const JITFuncPtr Compare ## mode ## _Funcs[] = {					\
+	Compare ## mode ## _EQ, Compare ## mode ## _NE,						\
+	Compare ## mode ## _CS, Compare ## mode ## _CC,						\
+	Compare ## mode ## _MI, Compare ## mode ## _PL,						\
+	Compare ## mode ## _VS, Compare ## mode ## _VC,						\
+	Compare ## mode ## _HI, Compare ## mode ## _LS,						\
+	Compare ## mode ## _GE, Compare ## mode ## _LT,						\
+	Compare ## mode ## _GT, Compare ## mode ## _LE,						\
+}
+
+Compare_Funcs(Imm);
+Compare_Funcs(Reg);
+
+// Replacement of the fused unit when the second instruction does not start
+// with its test: compare, then execute the second instruction normally.
+#define Compare_Alone_Template(mode)									\
+JITInstructionProto(Compare ## mode ## _Alone)							\
+{																		\
+	KUInt32 theRn;														\
+	POPVALUE(theRn);													\
+	KUInt32 theOpnd2;													\
+	POPVALUE(theOpnd2);													\
+	KUInt32 theSkip;													\
+	POPVALUE(theSkip);													\
+	Compare(															\
+		ioCPU,															\
+		ioCPU->mCurrentRegisters[theRn],								\
+		Compare_Opnd2_ ## mode(theOpnd2));								\
+	CALLNEXTUNIT;														\
+}
+
+Compare_Alone_Template(Imm)
+Compare_Alone_Template(Reg)
+
+// -------------------------------------------------------------------------- //
+//  * Move (MOV followed by MOV)
+// -------------------------------------------------------------------------- //
+#define Move_Opnd2_Imm(value)	(value)
+#define Move_Opnd2_Reg(value)	ioCPU->mCurrentRegisters[value]
+
+#define Move_Template(mode1, mode2)										\
+JITInstructionProto(Move ## mode1 ## mode2)								\
+{																		\
+	KUInt32 theRd1;														\
+	POPVALUE(theRd1);													\
+	KUInt32 theOpnd1;													\
+	POPVALUE(theOpnd1);													\
+	KUInt32 theRd2;														\
+	POPVALUE(theRd2);													\
+	KUInt32 theOpnd2;													\
+	POPVALUE(theOpnd2);													\
+	KUInt32 theSkip;													\
+	POPVALUE(theSkip);													\
+	ioCPU->mCurrentRegisters[theRd1] = Move_Opnd2_ ## mode1(theOpnd1);	\
+	if (IsHalted())														\
+	{																	\
+		CALLNEXTUNIT;													\
+	}																	\
+	ioCPU->mCurrentRegisters[theRd2] = Move_Opnd2_ ## mode2(theOpnd2);	\
+	CALLUNIT(theSkip);													\
+}
+
+Move_Template(Imm, Imm)
+Move_Template(Imm, Reg)
+Move_Template(Reg, Imm)
+Move_Template(Reg, Reg)
+
+// -------------------------------------------------------------------------- //
+//  * Load (LDR followed by LDR with the same base)
+// -------------------------------------------------------------------------- //
+JITInstructionProto(LoadLoad)
+{
+	KUInt32 theRn;
+	POPVALUE(theRn);
+	KUInt32 theRd1;
+	POPVALUE(theRd1);
+	KUInt32 theOffset1;
+	POPVALUE(theOffset1);
+	KUInt32 thePC1;
+	POPVALUE(thePC1);
+	KUInt32 theRd2;
+	POPVALUE(theRd2);
+	KUInt32 theOffset2;
+	POPVALUE(theOffset2);
+	KUInt32 thePC2;
+	POPVALUE(thePC2);
+	KUInt32 theSkip;
+	POPVALUE(theSkip);
+	TMemory* theMemoryInterface = ioCPU->GetMemory();
+	KUInt32 theData;
+	if (theMemoryInterface->FastRead(
+			ioCPU->mCurrentRegisters[theRn] + theOffset1, theData ))
+	{
+		SETPC(thePC1);
+		ioCPU->DataAbort();
+		MMUCALLNEXT_AFTERSETPC;
+	}
+	ioCPU->mCurrentRegisters[theRd1] = theData;
+	if (IsHalted())
+	{
+		CALLNEXTUNIT;
+	}
+	if (theMemoryInterface->FastRead(
+			ioCPU->mCurrentRegisters[theRn] + theOffset2, theData ))
+	{
+		SETPC(thePC2);
+		ioCPU->DataAbort();
+		MMUCALLNEXT_AFTERSETPC;
+	}
+	ioCPU->mCurrentRegisters[theRd2] = theData;
+	CALLUNIT(theSkip);
+}
+
+// -------------------------------------------------------------------------- //
+//  * Translation
+// -------------------------------------------------------------------------- //
+#define __Rn(instr)		(((instr) & 0x000F0000) >> 16)
+#define __Rd(instr)		(((instr) & 0x0000F000) >> 12)
+#define __Rm(instr)		((instr) & 0x0000000F)
+
+// Value of a data processing immediate operand.
+static KUInt32
+GetImmediate( KUInt32 inInstruction )
+{
+	KUInt32 theImmValue = inInstruction & 0xFF;
+	KUInt32 theRotateAmount = ((inInstruction >> 8) & 0xF) * 2;
+	if (theRotateAmount != 0)
+	{
+		theImmValue =
+			(theImmValue >> theRotateAmount)
+			| (theImmValue << (32 - theRotateAmount));
+	}
+	return theImmValue;
+}
+
+// Offset of a LDR with an immediate offset.
+static KUInt32
+GetOffset( KUInt32 inInstruction )
+{
+	KUInt32 theOffset = inInstruction & 0x00000FFF;
+	if (!(inInstruction & 0x00800000))
+	{
+		theOffset = -theOffset;
+	}
+	return theOffset;
+}
+
+// CMP Rn, #imm or CMP Rn, Rm followed by a conditional instruction.
+static Boolean
+Translate_Compare(
+			JITPageClass* inPage,
+			KUInt16* ioUnitCrsr,
+			KUInt32 inInstruction,
+			KUInt32 inNextInstruction,
+			KUInt32 inVAddr )
+{
+	KUInt32 theCondition = inNextInstruction >> 28;
+	if ((theCondition >= 0xE) || (__Rn(inInstruction) == 15))
+	{
+		return false;
+	}
+	if (inInstruction & 0x02000000)
+	{
+		PUSHFUNC(CompareImm_Funcs[theCondition]);
+		PUSHVALUE(__Rn(inInstruction));
+		PUSHVALUE(GetImmediate(inInstruction));
+	} else {
+		if (__Rm(inInstruction) == 15)
+		{
+			return false;
+		}
+		PUSHFUNC(CompareReg_Funcs[theCondition]);
+		PUSHVALUE(__Rn(inInstruction));
+		PUSHVALUE(__Rm(inInstruction));
+	}
+	return true;
+}
+
+// MOV Rd, #imm or MOV Rd, Rm twice.
+static Boolean
+Translate_Move(
+			JITPageClass* inPage,
+			KUInt16* ioUnitCrsr,
+			KUInt32 inInstruction,
+			KUInt32 inNextInstruction,
+			KUInt32 inVAddr )
+{
+	const Boolean isImm1 = (inInstruction & 0x02000000) != 0;
+	const Boolean isImm2 = (inNextInstruction & 0x02000000) != 0;
+	if (((inNextInstruction & 0xFFFF0000) != 0xE3A00000)
+		&& ((inNextInstruction & 0xFFFF0FF0) != 0xE1A00000))
+	{
+		return false;
+	}
+	if ((__Rd(inInstruction) == 15) || (__Rd(inNextInstruction) == 15)
+		|| (!isImm1 && (__Rm(inInstruction) == 15))
+		|| (!isImm2 && (__Rm(inNextInstruction) == 15)))
+	{
+		return false;
+	}
+	if (isImm1)
+	{
+		if (isImm2)
+		{
+			PUSHFUNC(MoveImmImm);
+		} else {
+			PUSHFUNC(MoveImmReg);
+		}
+	} else {
+		if (isImm2)
+		{
+			PUSHFUNC(MoveRegImm);
+		} else {
+			PUSHFUNC(MoveRegReg);
+		}
+	}
+	PUSHVALUE(__Rd(inInstruction));
+	PUSHVALUE(isImm1 ? GetImmediate(inInstruction) : __Rm(inInstruction));
+	PUSHVALUE(__Rd(inNextInstruction));
+	PUSHVALUE(isImm2 ? GetImmediate(inNextInstruction) : __Rm(inNextInstruction));
+	return true;
+}
+
+// LDR Rd, [Rn, #offset] twice with the same Rn.
+static Boolean
+Translate_Load(
+			JITPageClass* inPage,
+			KUInt16* ioUnitCrsr,
+			KUInt32 inInstruction,
+			KUInt32 inNextInstruction,
+			KUInt32 inVAddr )
+{
+	if (((inNextInstruction & 0xFF700000) != 0xE5100000)
+		|| (__Rn(inInstruction) != __Rn(inNextInstruction))
+		|| (__Rn(inInstruction) == 15)
+		|| (__Rd(inInstruction) == 15)
+		|| (__Rd(inNextInstruction) == 15))
+	{
+		return false;
+	}
+	PUSHFUNC(LoadLoad);
+	PUSHVALUE(__Rn(inInstruction));
+	PUSHVALUE(__Rd(inInstruction));
+	PUSHVALUE(GetOffset(inInstruction));
+	PUSHVALUE(inVAddr + 8);
+	PUSHVALUE(__Rd(inNextInstruction));
+	PUSHVALUE(GetOffset(inNextInstruction));
+	PUSHVALUE(inVAddr + 12);
+	return true;
+}
+
+// Pairs, in the order of their hits in branchDestCount when booting the
+// 717006 ROM. The first instruction must be matched by the mask and value
+// and is always unconditional, the function checks the second one.
+// Every pair needs its own units, so the table is fixed at build time: a
+// profile can only order pairs that are already implemented, and the masks
+// do not overlap, so the order only changes the time of the lookup.
+static const struct {
+	KUInt32		fMask;
+	KUInt32		fValue;
+	Boolean		(*fTranslate)(
+					JITPageClass* inPage,
+					KUInt16* ioUnitCrsr,
+					KUInt32 inInstruction,
+					KUInt32 inNextInstruction,
+					KUInt32 inVAddr );
+} kSuperInstructions[] = {
+	{ 0xFFF0F000, 0xE3500000, Translate_Compare },	// CMP Rn, #imm ; Bcc
+	{ 0xFFF0FFF0, 0xE1500000, Translate_Compare },	// CMP Rn, Rm ; Bcc
+	{ 0xFF700000, 0xE5100000, Translate_Load },		// LDR ; LDR
+	{ 0xFFFF0FF0, 0xE1A00000, Translate_Move },		// MOV Rd, Rm ; MOV
+	{ 0xFFFF0000, 0xE3A00000, Translate_Move },		// MOV Rd, #imm ; MOV
+};
+
+// -------------------------------------------------------------------------- //
+//  * Translate_SuperInstruction
+// -------------------------------------------------------------------------- //
+Boolean
+Translate_SuperInstruction(
+					JITPageClass* inPage,
+					KUInt16* ioUnitCrsr,
+					KUInt32 inInstruction,
+					KUInt32 inNextInstruction,
+					KUInt32 inVAddr,
+					KUInt16* outSkipCrsr )
+{
+	KUInt32 indexPair;
+	for (indexPair = 0;
+		indexPair < sizeof(kSuperInstructions) / sizeof(kSuperInstructions[0]);
+		indexPair++)
+	{
+		if (((inInstruction & kSuperInstructions[indexPair].fMask)
+				== kSuperInstructions[indexPair].fValue)
+			&& kSuperInstructions[indexPair].fTranslate(
+				inPage,
+				ioUnitCrsr,
+				inInstruction,
+				inNextInstruction,
+				inVAddr ))
+		{
+			// The delta to the unit after the second instruction, set later.
+			*outSkipCrsr = *ioUnitCrsr;
+			PUSHVALUE((KUIntPtr) 0);
+			return true;
+		}
+	}
+	
+	return false;
+}
+
+// -------------------------------------------------------------------------- //
+//  * Finish_SuperInstruction
+// -------------------------------------------------------------------------- //
+void
+Finish_SuperInstruction(
+					JITPageClass* inPage,
+					KUInt16 inFuncCrsr,
+					KUInt16 inSkipCrsr,
+					KUInt16 inNextCrsr )
+{
+	inPage->GetUnit(inSkipCrsr)->fValue = inNextCrsr - inSkipCrsr;
+
+	// The fused compare skips the first unit of the second instruction when
+	// the condition holds: check that it is the test of the condition (it is
+	// not, e.g., after a native call injection).
+	if (inPage->IsTestUnit(inSkipCrsr + 1))
+	{
+		return;
+	}
+	JITUnit* theUnit = inPage->GetUnit(inFuncCrsr);
+	KUInt32 indexCond;
+	for (indexCond = 0;
+		indexCond < sizeof(CompareImm_Funcs) / sizeof(CompareImm_Funcs[0]);
+		indexCond++)
+	{
+		if (theUnit->fFuncPtr == CompareImm_Funcs[indexCond])
+		{
+			theUnit->fFuncPtr = CompareImm_Alone;
+			return;
+		}
+		if (theUnit->fFuncPtr == CompareReg_Funcs[indexCond])
+		{
+			theUnit->fFuncPtr = CompareReg_Alone;
+			return;
+		}
+	}
+}
+
+#endif
+
+// ================================================= //
+// Two wrongs don't make a right, but three lefts do. //
+// ================================================= //
@@ -0,0 +1,83 @@
+// ==============================
+// File:			TJITGeneric_SuperInstructions.h
+// Project:			Einstein
+//
+// Copyright 2003-2007 by Paul Guyot (pguyot@kallisys.net).
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+#ifndef _TJITGENERIC_SUPERINSTRUCTIONS_H
+#define _TJITGENERIC_SUPERINSTRUCTIONS_H
+
+#include <K/Defines/KDefinitions.h>
+#include "JIT.h"
+
+// Einstein
+#include "TARMProcessor.h"
+
+#include "TJITGeneric_Macros.h"
+
+///
+/// Translate an instruction and the next one as a single unit, if they form
+/// one of the pairs of the superinstructions table.
+/// The unit only replaces the first instruction. The second instruction must
+/// still be translated right after it (it may be the target of a branch),
+/// and Finish_SuperInstruction must then be called.
+///
+/// \param inPage				page being translated.
+/// \param ioUnitCrsr			cursor in the unit table.
+/// \param inInstruction		instruction to translate.
+/// \param inNextInstruction	instruction that follows.
+/// \param inVAddr				virtual address of the instruction.
+/// \param outSkipCrsr			on output, unit of the delta to set.
+/// \return \c true if the pair was translated.
+///
+Boolean
+Translate_SuperInstruction(
+					JITPageClass* inPage,
+					KUInt16* ioUnitCrsr,
+					KUInt32 inInstruction,
+					KUInt32 inNextInstruction,
+					KUInt32 inVAddr,
+					KUInt16* outSkipCrsr );
+
+///
+/// Finish a superinstruction once its second instruction was translated.
+/// Set the delta to the unit that follows the second instruction and check
+/// that the units of the second instruction are the ones the superinstruction
+/// expects, replacing it with a unit for the first instruction alone if they
+/// are not.
+///
+/// \param inPage				page being translated.
+/// \param inFuncCrsr			unit of the superinstruction.
+/// \param inSkipCrsr			unit of the delta, from Translate_SuperInstruction.
+/// \param inNextCrsr			unit that follows the second instruction.
+///
+void
+Finish_SuperInstruction(
+					JITPageClass* inPage,
+					KUInt16 inFuncCrsr,
+					KUInt16 inSkipCrsr,
+					KUInt16 inNextCrsr );
+
+#endif
+		// _TJITGENERIC_SUPERINSTRUCTIONS_H
+
+// ================================================= //
+// Two wrongs don't make a right, but three lefts do. //
+// ================================================= //
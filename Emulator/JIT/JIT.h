@@ -28,11 +28,20 @@
 
 // Includes the proper header depending on the platform and define the JIT
 // class accordingly.
+#if JIT_X86_64 && defined(__x86_64__) && !defined(_WIN32)
+	// Generic JIT with native x86-64 code for runs of simple instructions.
+	#define JITTARGET_X86_64
+	#include "Emulator/JIT/Generic/TJITGeneric.h"
+	#define	JITClass		TJITGeneric
+	#define	JITPageClass	TJITGenericPage
+	#define JITTARGET_GENERIC
+#else
 	// Default case.
 	#include "Emulator/JIT/Generic/TJITGeneric.h"
 	#define	JITClass		TJITGeneric
 	#define	JITPageClass	TJITGenericPage
 	#define JITTARGET_GENERIC
+#endif
 
 #endif
 		// _JIT_H
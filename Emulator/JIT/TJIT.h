@@ -52,12 +52,14 @@ public:
 	/// \param inROMSize	size of ROM bank
 	/// \param inRAMBase	base of RAM bank
 	/// \param inRAMSize	size of RAM bank
+	/// \param inCachePageCount	number of pages of the cache (0 for default)
 	///
 	TJIT(
 		TMemory* inMemoryIntf,
-		 TMMU* inMMUIntf )
+		 TMMU* inMMUIntf,
+		 KUInt32 inCachePageCount = 0 )
 		:
-		mCache( inMemoryIntf, inMMUIntf ) {};
+		mCache( inMemoryIntf, inMMUIntf, inCachePageCount ) {};
 
 	///
 	/// Destructor.
@@ -83,6 +85,92 @@ public:
 			mCache.InvalidateTLB();
 		}
 
+	///
+	/// Change of the access permission mode of the MMU.
+	///
+	void			InvalidatePerms( void )
+		{
+			mCache.InvalidatePerms();
+		}
+
+	///
+	/// Generation of the cache, used to validate direct links between pages.
+	///
+	KUInt32			GetCacheGeneration( void ) const
+		{
+			return mCache.GetGeneration();
+		}
+
+	///
+	/// Access permission mode recorded by the cache.
+	///
+	KUInt32			GetAPMode( void ) const
+		{
+			return mCache.GetAPMode();
+		}
+
+	///
+	/// Counters of the cache (hits, misses, evictions, invalidations).
+	///
+	const typename TJITCache<TPage>::SStats&	GetCacheStats( void ) const
+		{
+			return mCache.GetStats();
+		}
+
+	///
+	/// Reset the counters of the cache.
+	///
+	void			ResetCacheStats( void )
+		{
+			mCache.ResetStats();
+		}
+
+	///
+	/// Number of pages of the cache.
+	///
+	KUInt32			GetCachePageCount( void ) const
+		{
+			return mCache.GetPageCount();
+		}
+
+	///
+	/// Accessor on a page of the cache, bound or not.
+	///
+	/// \param inIndex	index of the page, lower than GetCachePageCount().
+	///
+	TPage*			GetCachedPage( KUInt32 inIndex )
+		{
+			return mCache.GetPageAtIndex( inIndex );
+		}
+
+	///
+	/// Determine if a page of the cache holds a valid translation.
+	///
+	/// \param inIndex	index of the page, lower than GetCachePageCount().
+	///
+	Boolean			IsCachedPageBound( KUInt32 inIndex )
+		{
+			return mCache.IsPageBound( inIndex );
+		}
+
+	///
+	/// Break all direct links between pages.
+	///
+	void			InvalidateLinks( void )
+		{
+			mCache.InvalidateLinks();
+		}
+
+	///
+	/// Record that a unit of a page was linked to.
+	///
+	/// \param inPage	page that was linked to.
+	///
+	void			MarkLinked( TPage* inPage )
+		{
+			mCache.MarkLinked( inPage );
+		}
+
 	///
 	/// One or more steps with JIT.
 	///
@@ -39,12 +39,8 @@ using namespace std;
 //#define kTJITCacheStats	1
 #undef kTJITCacheStats
 
-#if kTJITCacheStats
-static KUInt32 gNbHits = 0;					///< Nombre de hits.
-static KUInt32 gNbInvalidatePage = 0;		///< Nombre d'invalidations (pages)
-static KUInt32 gNbInvalidateTLB = 0;		///< Nombre d'invalidations (tlb)
-static KUInt32 gNbMiss = 0;					///< Nombre de ratés.
-#endif
+// The counters are kept in mStats (see GetStats), kTJITCacheStats also dumps
+// them every 256 lookups.
 
 // -------------------------------------------------------------------------- //
 //  * InsertInPMap( KUInt32, SEntry* )
@@ -136,27 +132,45 @@ TJITCache<JITPageClass>::DeletePMap( void )
 }
 
 // -------------------------------------------------------------------------- //
-//  * TJITCache( TMemory*, TMMU* )
+//  * TJITCache( TMemory*, TMMU*, KUInt32 )
 // -------------------------------------------------------------------------- //
 template<>
 TJITCache<JITPageClass>::TJITCache(
 		TMemory* inMemoryIntf,
-		TMMU* inMMUIntf )
+		TMMU* inMMUIntf,
+		KUInt32 inPageCount /* = 0 */ )
 	:
 		mMemoryIntf( inMemoryIntf ),
-		mMMUIntf( inMMUIntf )
+		mMMUIntf( inMMUIntf ),
+		mVMap(
+			inPageCount == 0 ? (KUInt32) kDefaultPageCount
+				: (inPageCount > kMaxPageCount ? (KUInt32) kMaxPageCount
+					: inPageCount),
+			kWays ),
+		mGeneration( 1 ),
+		mAPMode( inMMUIntf->GetAPMode() )
 {
+	ResetStats();
 	InitPMap();
 	
 	// Init the entries.
-	// We create up to one entry per ROM page.
+	// The units of all the pages are allocated together.
 	SEntry* theEntries = mVMap.GetValues();
 	KUInt32 indexEntry = 0;
 	KUInt32 theAddress = 0;
-	while (theAddress < TMemoryConsts::kROMEnd && indexEntry < THashMapCache<SEntry>::kCacheSize) {
+	KUInt32 theCacheSize = mVMap.GetCacheSize();
+	mUnitArena.Init( theCacheSize );
+	for (indexEntry = 0; indexEntry < theCacheSize; indexEntry++) {
+		theEntries[indexEntry].mPage.SetUnitArena( &mUnitArena );
+	}
+
+	// We create up to one entry per ROM page.
+	indexEntry = 0;
+	while (theAddress < TMemoryConsts::kROMEnd && indexEntry < theCacheSize) {
 		SEntry* theEntry = &theEntries[indexEntry];
 		theEntry->key = theAddress;
 		theEntry->mPhysicalAddress = theAddress;
+		theEntry->mAPModes = kAllAPModes;
 		theEntry->mPage.Init( inMemoryIntf, theAddress, theAddress);
 		
 		mVMap.Insert(theAddress, theEntry);
@@ -176,15 +190,16 @@ TJITCache<JITPageClass>::~TJITCache( void )
 }
 
 // -------------------------------------------------------------------------- //
-//  * PageMiss( KUInt32, KUInt32 )
+//  * PageMiss( KUInt32, KUInt32, KUInt32 )
 // -------------------------------------------------------------------------- //
 template<>
 JITPageClass*
-TJITCache<JITPageClass>::PageMiss( KUInt32 inVAddr, KUInt32 inPAddr )
+TJITCache<JITPageClass>::PageMiss(
+					KUInt32 inVAddr,
+					KUInt32 inPAddr,
+					KUInt32 inAPModes )
 {
-#if kTJITCacheStats
-	gNbMiss++;
-#endif
+	mStats.fMisses++;
 
 	SEntry** theEntryPtr = GetPMapEntryPtr( inPAddr );
 	if (theEntryPtr == NULL)
@@ -194,9 +209,21 @@ TJITCache<JITPageClass>::PageMiss( KUInt32 inVAddr, KUInt32 inPAddr )
 		
 	// Take last page.
 	SEntry* theEntry = mVMap.GetLastValue();
+	if (LookupInPMap( theEntry->key, theEntry->mPhysicalAddress ) == theEntry) {
+		// The page was still valid (it wasn't invalidated).
+		mStats.fEvictions++;
+	}
 	
 	// Remove it from tables.
 	mVMap.Erase( theEntry->key );
+
+	// Units of the recycled page are about to be overwritten. Links to them
+	// only need to be broken if any were made in this generation.
+	if (theEntry->mPage.GetLinkGeneration() == mGeneration)
+	{
+		BumpGeneration();
+	}
+	mMemoryIntf->GetJITObject()->ForgetReturns( &theEntry->mPage );
 	
 #if 0
 	// Do not remove entries from the ROM cache.
@@ -216,6 +243,7 @@ TJITCache<JITPageClass>::PageMiss( KUInt32 inVAddr, KUInt32 inPAddr )
 	// Modify the entry.
 	theEntry->mPage.Init( mMemoryIntf, inVAddr, inPAddr );
 	theEntry->key = inVAddr;
+	theEntry->mAPModes = inAPModes;
 	
 	// Add it into the tables.
 	mVMap.Insert(inVAddr, theEntry);
@@ -235,30 +263,34 @@ JITPageClass*
 TJITCache<JITPageClass>::GetPage( KUInt32 inVAddr )
 {
 #if kTJITCacheStats
-	if ((gNbHits & 0xFF) == 0) {
+	if (((mStats.fHits + mStats.fMisses) & 0xFF) == 0) {
 		fprintf(
 			stderr,
-			"Hits: %i, Miss: %i, InvP: %i, InvT: %i\n",
-			gNbHits,
-			gNbMiss,
-			gNbInvalidatePage,
-			gNbInvalidateTLB);
+			"Hits: %u, Miss: %u, Evict: %u, InvP: %u, InvT: %u\n",
+			(unsigned int) mStats.fHits,
+			(unsigned int) mStats.fMisses,
+			(unsigned int) mStats.fEvictions,
+			(unsigned int) mStats.fInvalidatePages,
+			(unsigned int) mStats.fInvalidateTLBs);
 	}
-	gNbHits++;
 #endif
 
 	KUInt32 baseVAddr = inVAddr & kPageMask;
 	SEntry* theEntry;
 	KUInt32 thePAddr;
 
+	KUInt32 theAPModes;
+
 	// Get a page.
 	// Let's look if we already have it in the cache.
-	theEntry = mVMap.Lookup( baseVAddr );
-	if (theEntry)
+	SEntry* theBoundEntry = mVMap.Lookup( baseVAddr );
+	if (theBoundEntry && (theBoundEntry->mAPModes & (1 << mAPMode)))
 	{
+		mStats.fHits++;
+
 		// Touch the entry.
-		mVMap.MakeFirst(theEntry);
-		return &theEntry->mPage;
+		mVMap.MakeFirst(theBoundEntry);
+		return &theBoundEntry->mPage;
 	}
 
 	if (mMMUIntf->IsMMUEnabled() && !TMemory::IsPageInROM(baseVAddr))
@@ -268,16 +300,32 @@ TJITCache<JITPageClass>::GetPage( KUInt32 inVAddr )
 			// An error occurred.
 			return NULL;
 		}
+		theAPModes = 1 << mAPMode;
 	} else {
 		thePAddr = baseVAddr;
+		theAPModes = kAllAPModes;
+	}
+
+	// The binding was made in another mode, it is now checked for this one.
+	if (theBoundEntry && (theBoundEntry->mPhysicalAddress == thePAddr))
+	{
+		mStats.fHits++;
+		theBoundEntry->mAPModes |= theAPModes;
+
+		// Touch the entry.
+		mVMap.MakeFirst(theBoundEntry);
+		return &theBoundEntry->mPage;
 	}
 	
+	// The translation may have survived a change of the mappings.
 	theEntry = LookupInPMap( baseVAddr, thePAddr );
 	if (theEntry)
 	{
 		// If the VMap matches, only the mapping was altered.
 		if (theEntry->key == baseVAddr) {
 			// Re-branch the cache in the table of virtual adresses.
+			mStats.fHits++;
+			theEntry->mAPModes = theAPModes;
 			mVMap.Insert(baseVAddr, theEntry);
 
 			// Touch the entry.
@@ -287,7 +335,7 @@ TJITCache<JITPageClass>::GetPage( KUInt32 inVAddr )
 	}
 	
 	// The page is not in the cache.
-	return PageMiss( baseVAddr, thePAddr );
+	return PageMiss( baseVAddr, thePAddr, theAPModes );
 }
 
 // -------------------------------------------------------------------------- //
@@ -297,12 +345,64 @@ template<>
 void
 TJITCache<JITPageClass>::InvalidateTLB( void )
 {
-#if kTJITCacheStats
-	gNbInvalidateTLB++;
-#endif
+	mStats.fInvalidateTLBs++;
 
 	// Erase all bindings.
+	// The pages stay in the PMap, they are bound again by GetPage.
 	mVMap.Clear();
+	mAPMode = mMMUIntf->GetAPMode();
+	BumpGeneration();
+}
+
+// -------------------------------------------------------------------------- //
+//  * InvalidatePerms( void )
+// -------------------------------------------------------------------------- //
+template<>
+void
+TJITCache<JITPageClass>::InvalidatePerms( void )
+{
+	mStats.fInvalidatePerms++;
+
+	// The mode is part of the generation, links made in other modes are
+	// ignored until the mode comes back.
+	mAPMode = mMMUIntf->GetAPMode();
+}
+
+// -------------------------------------------------------------------------- //
+//  * FlushLinks( void )
+// -------------------------------------------------------------------------- //
+template<>
+void
+TJITCache<JITPageClass>::FlushLinks( void )
+{
+	// Links and inline caches hold generations of the previous cycle.
+	// Unbind every page: a page is translated again, which clears them,
+	// before it is entered again.
+	mVMap.Clear();
+	::memset( mPMap, 0, mPMapSize * sizeof(SEntry*) );
+	SEntry* theEntries = mVMap.GetValues();
+	KUInt32 theCacheSize = mVMap.GetCacheSize();
+	KUInt32 indexEntry;
+	for (indexEntry = 0; indexEntry < theCacheSize; indexEntry++)
+	{
+		theEntries[indexEntry].mNextPAEntry = NULL;
+		theEntries[indexEntry].mPage.SetLinkGeneration( 0 );
+	}
+	mMemoryIntf->GetJITObject()->FlushReturns();
+	mGeneration = 1;
+}
+
+// -------------------------------------------------------------------------- //
+//  * IsPageBound( KUInt32 )
+// -------------------------------------------------------------------------- //
+template<>
+Boolean
+TJITCache<JITPageClass>::IsPageBound( KUInt32 inIndex )
+{
+	// Invalidated pages are removed from the PMap.
+	SEntry* theEntry = &mVMap.GetValues()[inIndex];
+	return LookupInPMap( theEntry->key, theEntry->mPhysicalAddress )
+		== theEntry;
 }
 
 // -------------------------------------------------------------------------- //
@@ -318,12 +418,11 @@ TJITCache<JITPageClass>::InvalidatePage( KUInt32 inPAddr )
 	// Remove it/them from the tables.
 	SEntry** theEntryPtr = GetPMapEntryPtr( basePAddr );
 	SEntry* theEntry = *theEntryPtr;
-#if kTJITCacheStats
 	if (theEntry)
 	{
-		gNbInvalidatePage++;
+		mStats.fInvalidatePages++;
+		BumpGeneration();
 	}
-#endif
 	while (theEntry)
 	{
 		// Erase the bindings.
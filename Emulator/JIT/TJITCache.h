@@ -48,9 +48,15 @@ public:
 	///
 	/// Constructor from the memory and the MMU interfaces.
 	///
+	/// \param inMemoryIntf	interface to memory.
+	/// \param inMMUIntf		interface to the MMU.
+	/// \param inPageCount		number of translated pages to keep, 0 for
+	///							the default.
+	///
 	TJITCache(
 		TMemory* inMemoryIntf,
-		TMMU* inMMUIntf );
+		TMMU* inMMUIntf,
+		KUInt32 inPageCount = 0 );
 
 	///
 	/// Destructor.
@@ -77,10 +83,117 @@ public:
 		}
 	
 	///
-	/// Invalidate all translations.
+	/// Accessor on the generation of the cache.
+	/// The generation changes whenever a page may have been invalidated or
+	/// recycled. Units that link directly to another page record it and
+	/// consider the link broken when it no longer matches.
+	/// The access permission mode of the MMU is part of the generation, so a
+	/// link made in a mode is only followed in that mode, and is followed
+	/// again when the mode comes back.
+	///
+	/// \return the current generation, never 0.
+	///
+	KUInt32		GetGeneration( void ) const
+		{
+			return (mGeneration << kAPModeBits) | mAPMode;
+		}
+
+	///
+	/// Accessor on the access permission mode the cache last recorded.
+	///
+	KUInt32		GetAPMode( void ) const
+		{
+			return mAPMode;
+		}
+
+	///
+	/// Counters of the cache, since it was created or reset.
+	///
+	struct SStats {
+		KUInt32		fHits;				///< Pages found in the cache.
+		KUInt32		fMisses;			///< Pages that were not found.
+		KUInt32		fEvictions;			///< Pages recycled for a miss.
+		KUInt32		fInvalidatePages;	///< Pages invalidated by a write.
+		KUInt32		fInvalidateTLBs;	///< Invalidations of all bindings.
+		KUInt32		fInvalidatePerms;	///< Changes of the permission mode.
+	};
+
+	///
+	/// Accessor on the counters.
+	///
+	const SStats&	GetStats( void ) const
+		{
+			return mStats;
+		}
+
+	///
+	/// Reset the counters.
+	///
+	void		ResetStats( void )
+		{
+			::memset( &mStats, 0, sizeof(mStats) );
+		}
+
+	///
+	/// Accessor on the number of pages of the cache.
+	///
+	KUInt32		GetPageCount( void ) const
+		{
+			return mVMap.GetCacheSize();
+		}
+
+	///
+	/// Accessor on a page of the cache, bound or not.
+	///
+	/// \param inIndex	index of the page, lower than GetPageCount().
+	///
+	TPage*		GetPageAtIndex( KUInt32 inIndex )
+		{
+			return &mVMap.GetValues()[inIndex].mPage;
+		}
+
+	///
+	/// Determine if a page of the cache holds a translation that was not
+	/// recycled or invalidated.
+	///
+	/// \param inIndex	index of the page, lower than GetPageCount().
+	///
+	Boolean		IsPageBound( KUInt32 inIndex );
+
+	///
+	/// Break all direct links between pages, because the units of a page
+	/// were replaced.
+	///
+	void		InvalidateLinks( void )
+		{
+			BumpGeneration();
+		}
+
+	///
+	/// Record that a unit of a page was linked to, by a link or an inline
+	/// cache. Recycling the page then breaks the links.
+	///
+	/// \param inPage	page that was linked to.
+	///
+	void		MarkLinked( TPage* inPage )
+		{
+			inPage->SetLinkGeneration( mGeneration );
+		}
+
+	///
+	/// Invalidate all virtual to physical bindings.
+	/// Translated pages are kept by physical address, a page is bound again
+	/// to its virtual address with a lookup in the PMap.
 	///
 	void		InvalidateTLB( void );
 
+	///
+	/// Take a change of the access permission mode of the MMU into account.
+	/// Bindings are kept, each remembers the modes it was checked in and is
+	/// checked again the first time it is used in a new mode.
+	///
+	void		InvalidatePerms( void );
+
 	///
 	/// Invalidate a page by physical address.
 	///
@@ -93,6 +206,7 @@ protected:
 		TPage			mPage;
 		KUInt32			mPhysicalAddress;
 		KUInt32			key;
+		KUInt32			mAPModes;		///< Modes the binding was checked in.
 		SEntry*			next;
 		SEntry*			prev;
 		SEntry*			mNextPAEntry;
@@ -103,6 +217,11 @@ private:
 		kPageSize	= TMemoryConsts::kMMUSmallestPageSize,
 		kPageMask	= TMemoryConsts::kMMUSmallestPageMask,
 		kOffsetMask	= TMemoryConsts::kMMUSmallestPageMaskNeg,
+		kDefaultPageCount	= 128,
+		kMaxPageCount		= 16384,	///< One per page of the ROM.
+		kWays		= 4,	///< Addresses of a set are 1 MB apart or more.
+		kAPModeBits	= 3,	///< Bits of the permission mode of TMMU.
+		kAllAPModes	= 0xFF,	///< Binding valid in every mode.
 	};
 
 	///
@@ -124,8 +243,29 @@ private:
 	///
 	/// \param inVAddr		new virtual address.
 	/// \param inPAddr		new physical address.
+	/// \param inAPModes	permission modes the binding is valid in.
+	///
+	inline TPage* PageMiss(
+						KUInt32 inVAddr,
+						KUInt32 inPAddr,
+						KUInt32 inAPModes );
+
+	///
+	/// Break all direct links between pages.
+	///
+	void	BumpGeneration( void )
+		{
+			mGeneration = (mGeneration + 1) & (0xFFFFFFFF >> kAPModeBits);
+			if (mGeneration == 0)
+			{
+				FlushLinks();
+			}
+		}
+
+	///
+	/// Generations wrapped: make sure no stored generation is trusted again.
 	///
-	inline TPage* PageMiss( KUInt32 inVAddr, KUInt32 inPAddr );
+	void	FlushLinks( void );
 
 	///
 	/// Insert into PMap.
@@ -184,10 +324,17 @@ private:
 	/// \name Variables
 	TMemory*				mMemoryIntf;			///< Interface to memory.
 	TMMU*					mMMUIntf;				///< Interface to MMU.
+	typename TPage::TUnitArena	mUnitArena;			///< Units of the pages,
+													///< destroyed after them.
 	THashMapCache<SEntry>	mVMap;					///< Cache.
 	SEntry**				mPMap;					///< Association by
 													///< physical address.
 	KUInt32					mPMapSize;				///< Size of the PMap.
+	KUInt32					mGeneration;			///< Generation of the
+													///< direct links.
+	KUInt32					mAPMode;				///< Current permission
+													///< mode of the MMU.
+	SStats					mStats;					///< Counters.
 };
 
 #endif
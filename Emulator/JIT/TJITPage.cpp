@@ -39,7 +39,8 @@ TJITPage<JITClass, JITPageClass>::TJITPage( void )
 	:
 		mPointer( NULL ),
 		mVAddr( 0 ),
-		mPAddr( 0 )
+		mPAddr( 0 ),
+		mLinkGeneration( 0 )
 {
 }
 
@@ -64,6 +65,7 @@ TJITPage<JITClass, JITPageClass>::Init(
 	mPointer = inMemoryIntf->GetDirectPointerToPage( inPAddr );
 	mVAddr = inVAddr;
 	mPAddr = inPAddr;
+	mLinkGeneration = 0;
 }
 
 // =========================== //
@@ -107,6 +107,27 @@ public:
 			return mPointer[inOffset];
 		}
 
+	///
+	/// Accessor on the generation of the cache when a unit of the page was
+	/// last linked to.
+	///
+	/// \return the generation, 0 if the page was not linked to.
+	///
+	inline KUInt32 GetLinkGeneration( void ) const
+		{
+			return mLinkGeneration;
+		}
+
+	///
+	/// Record that a unit of the page was linked to.
+	///
+	/// \param inGeneration	current generation of the cache.
+	///
+	inline void SetLinkGeneration( KUInt32 inGeneration )
+		{
+			mLinkGeneration = inGeneration;
+		}
+
 protected:
 	///
 	/// Accessor on the pointer.
@@ -136,6 +157,8 @@ private:
 							///< is dirty.
 	KUInt32		mVAddr;		///< Virtual address of the page.
 	KUInt32		mPAddr;		///< Physical address of the page.
+	KUInt32		mLinkGeneration;	///< Generation of the last link to
+									///< the page.
 };
 
 #endif
@@ -0,0 +1,184 @@
+// ==============================
+// File:			TJITX86_64Arena.cp
+// Project:			Einstein
+//
+// Copyright 2003-2007 by Paul Guyot (pguyot@kallisys.net).
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+#include <K/Defines/KDefinitions.h>
+#include "JIT.h"
+
+#ifdef JITTARGET_X86_64
+
+#include "TJITX86_64Arena.h"
+
+// ANSI C & POSIX
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/mman.h>
+
+// K
+#include <K/Threads/TMutex.h>
+
+// -------------------------------------------------------------------------- //
+// Constantes
+// -------------------------------------------------------------------------- //
+#ifndef MAP_ANONYMOUS
+	#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+// The hardened runtime of macOS only executes MAP_JIT regions, which must be
+// mapped executable. Slots are then switched with mprotect like elsewhere.
+#ifdef MAP_JIT
+	#define kArenaMapFlags	(MAP_PRIVATE | MAP_ANONYMOUS | MAP_JIT)
+	#define kArenaMapProt	(PROT_READ | PROT_WRITE | PROT_EXEC)
+#else
+	#define kArenaMapFlags	(MAP_PRIVATE | MAP_ANONYMOUS)
+	#define kArenaMapProt	(PROT_READ | PROT_WRITE)
+#endif
+
+/// Free slots, linked through their first bytes. They are writable.
+static KUInt8* gFreeSlots = NULL;
+
+/// Whether the system refused to make a chunk executable.
+static Boolean gNoExecutableMemory = false;
+
+// -------------------------------------------------------------------------- //
+//  * GetMutex( void )
+// -------------------------------------------------------------------------- //
+static TMutex&
+GetMutex( void )
+{
+	static TMutex sMutex;
+	return sMutex;
+}
+
+// -------------------------------------------------------------------------- //
+//  * Allocate( void )
+// -------------------------------------------------------------------------- //
+KUInt8*
+TJITX86_64Arena::Allocate( void )
+{
+	TMutex& theMutex = GetMutex();
+	theMutex.Lock();
+	if ((gFreeSlots == NULL) && !gNoExecutableMemory)
+	{
+		void* theChunk = ::mmap(
+			NULL,
+			kSlotSize * kSlotsPerChunk,
+			kArenaMapProt,
+			kArenaMapFlags,
+			-1,
+			0 );
+		// Systems that enforce W^X may refuse to make it executable later.
+		if ((theChunk != MAP_FAILED)
+			&& ((::mprotect(
+					theChunk,
+					kSlotSize * kSlotsPerChunk,
+					PROT_READ | PROT_EXEC ) != 0)
+				|| (::mprotect(
+					theChunk,
+					kSlotSize * kSlotsPerChunk,
+					PROT_READ | PROT_WRITE ) != 0)))
+		{
+			(void) ::fprintf( stderr,
+				"Native code is disabled, memory cannot be made executable (%s)\n",
+				::strerror( errno ) );
+			(void) ::munmap( theChunk, kSlotSize * kSlotsPerChunk );
+			gNoExecutableMemory = true;
+			theChunk = MAP_FAILED;
+		}
+		if (theChunk != MAP_FAILED)
+		{
+			KUInt8* theSlot = (KUInt8*) theChunk;
+			KUInt32 indexSlot;
+			for (indexSlot = 0; indexSlot < kSlotsPerChunk; indexSlot++)
+			{
+				*((KUInt8**) theSlot) = gFreeSlots;
+				gFreeSlots = theSlot;
+				theSlot += kSlotSize;
+			}
+		}
+	}
+	KUInt8* theResult = gFreeSlots;
+	if (theResult)
+	{
+		gFreeSlots = *((KUInt8**) theResult);
+	}
+	theMutex.Unlock();
+	
+	return theResult;
+}
+
+// -------------------------------------------------------------------------- //
+//  * Free( KUInt8* )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Arena::Free( KUInt8* inSlot )
+{
+	if (inSlot)
+	{
+		MakeWritable( inSlot );
+		TMutex& theMutex = GetMutex();
+		theMutex.Lock();
+		*((KUInt8**) inSlot) = gFreeSlots;
+		gFreeSlots = inSlot;
+		theMutex.Unlock();
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * MakeWritable( KUInt8* )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Arena::MakeWritable( KUInt8* inSlot )
+{
+	if (::mprotect( inSlot, kSlotSize, PROT_READ | PROT_WRITE ) != 0)
+	{
+		(void) ::fprintf( stderr,
+			"Cannot make native code writable (%s)\n", ::strerror( errno ) );
+		::abort();
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * MakeExecutable( KUInt8* )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Arena::MakeExecutable( KUInt8* inSlot )
+{
+	// The units already point to the code, it must run.
+	if (::mprotect( inSlot, kSlotSize, PROT_READ | PROT_EXEC ) != 0)
+	{
+		(void) ::fprintf( stderr,
+			"Cannot make native code executable (%s)\n", ::strerror( errno ) );
+		::abort();
+	}
+}
+
+#endif
+	// JITTARGET_X86_64
+
+// ================================================ //
+// Real programmers don't draw flowcharts.          //
+// Flowcharts are, after all, the illiterate's form //
+// of documentation.                                //
+// ================================================ //
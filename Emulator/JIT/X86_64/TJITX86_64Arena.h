@@ -0,0 +1,83 @@
+// ==============================
+// File:			TJITX86_64Arena.h
+// Project:			Einstein
+//
+// Copyright 2003-2007 by Paul Guyot (pguyot@kallisys.net).
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+#ifndef _TJITX86_64ARENA_H
+#define _TJITX86_64ARENA_H
+
+#include <K/Defines/KDefinitions.h>
+
+///
+/// Executable memory for the native code of the pages.
+///
+/// Memory is mapped by chunks and split into slots of a fixed size, one per
+/// page. Slots are recycled with the pages and never unmapped. The arena is
+/// shared by all the JIT objects of the process.
+///
+/// Slots are never writable and executable at once: they are writable when
+/// they are allocated and the emitter switches them between writing and
+/// executing. If the system refuses to make memory executable, no slot is
+/// allocated and the pages keep their generic units.
+///
+class TJITX86_64Arena
+{
+public:
+	enum {
+		kSlotSize		= 64 * 1024,	///< Size of the code of a page.
+		kSlotsPerChunk	= 32,			///< Slots mapped at once.
+	};
+
+	///
+	/// Allocate a slot.
+	///
+	/// \return a slot of kSlotSize bytes or NULL if mapping failed.
+	///
+	static KUInt8*	Allocate( void );
+
+	///
+	/// Free a slot.
+	///
+	/// \param inSlot	slot returned by Allocate (may be NULL).
+	///
+	static void		Free( KUInt8* inSlot );
+
+	///
+	/// Make a slot writable (and not executable).
+	///
+	/// \param inSlot	slot returned by Allocate.
+	///
+	static void		MakeWritable( KUInt8* inSlot );
+
+	///
+	/// Make a slot executable (and not writable).
+	///
+	/// \param inSlot	slot returned by Allocate.
+	///
+	static void		MakeExecutable( KUInt8* inSlot );
+};
+
+#endif
+		// _TJITX86_64ARENA_H
+
+// ============================================================= //
+// The world is coming to an end.  Please log off.               //
+// ============================================================= //
@@ -0,0 +1,950 @@
+// ==============================
+// File:			TJITX86_64Emitter.cp
+// Project:			Einstein
+//
+// Copyright 2003-2007 by Paul Guyot (pguyot@kallisys.net).
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+#include <K/Defines/KDefinitions.h>
+#include "JIT.h"
+
+#ifdef JITTARGET_X86_64
+
+#include "TJITX86_64Emitter.h"
+#include "TJITX86_64Arena.h"
+
+// Einstein
+#include "TARMProcessor.h"
+#include "TMemory.h"
+
+// -------------------------------------------------------------------------- //
+// Constantes
+// -------------------------------------------------------------------------- //
+
+// Offset of a field of the processor, relative to rbx.
+#define kOffsetBase		0x1000
+#define CPUOffset(field)	\
+	((KSInt32) (((KUIntPtr) &(((TARMProcessor*) kOffsetBase)->field)) - kOffsetBase))
+
+#define RegisterOffset(reg)	(CPUOffset(mCurrentRegisters[0]) + (KSInt32) (4 * (reg)))
+
+#define __Rn(instr)		(((instr) & 0x000F0000) >> 16)
+#define __Rd(instr)		(((instr) & 0x0000F000) >> 12)
+#define __Rm(instr)		((instr) & 0x0000000F)
+
+/// Register that is not written back by the helpers.
+#define kNoWriteBack	16
+
+// -------------------------------------------------------------------------- //
+//  * TJITX86_64Emitter( void )
+// -------------------------------------------------------------------------- //
+TJITX86_64Emitter::TJITX86_64Emitter( void )
+	:
+		mCode( NULL ),
+		mCrsr( 0 ),
+		mBlockOpen( false ),
+		mWritable( false )
+{
+}
+
+// -------------------------------------------------------------------------- //
+//  * ~TJITX86_64Emitter( void )
+// -------------------------------------------------------------------------- //
+TJITX86_64Emitter::~TJITX86_64Emitter( void )
+{
+	TJITX86_64Arena::Free( mCode );
+}
+
+// -------------------------------------------------------------------------- //
+//  * Reset( void )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Emitter::Reset( void )
+{
+	mCrsr = 0;
+	mBlockOpen = false;
+}
+
+// -------------------------------------------------------------------------- //
+//  * CanTranslate( KUInt32 )
+// -------------------------------------------------------------------------- //
+Boolean
+TJITX86_64Emitter::CanTranslate( KUInt32 inInstruction )
+{
+	if ((inInstruction >> 28) == 0xF)
+	{
+		return false;
+	}
+
+	switch ((inInstruction >> 26) & 0x3)
+	{
+		case 0x0:
+			// Data processing with an immediate or an immediate shift.
+			// Others are multiplies, swaps, halfwords or shifts by a
+			// register.
+			if ((inInstruction & 0x02000010) == 0x00000010)
+			{
+				return false;
+			}
+			// Test operations without S are PSR transfers.
+			if (((inInstruction & 0x01900000) == 0x01000000)
+				|| (__Rd(inInstruction) == 15))
+			{
+				return false;
+			}
+			return true;
+
+		case 0x1:
+			// Single data transfer.
+			if ((inInstruction & 0x02000010) == 0x02000010)
+			{
+				// Undefined.
+				return false;
+			}
+			if (__Rd(inInstruction) == 15)
+			{
+				return false;
+			}
+			if ((inInstruction & 0x01200000) == 0x00200000)
+			{
+				// Unprivileged (T) access.
+				return false;
+			}
+			if ((__Rn(inInstruction) == 15)
+				&& ((inInstruction & 0x01200000) != 0x01000000))
+			{
+				// Write back to PC.
+				return false;
+			}
+			if ((inInstruction & 0x02000000)
+				&& (__Rm(inInstruction) == 15))
+			{
+				return false;
+			}
+			return true;
+	}
+
+	return false;
+}
+
+// -------------------------------------------------------------------------- //
+//  * Translate( KUInt32, KUInt32, KUInt8 )
+// -------------------------------------------------------------------------- //
+KUInt8*
+TJITX86_64Emitter::Translate(
+				KUInt32 inInstruction,
+				KUInt32 inVAddr,
+				KUInt8 inDeadFlags )
+{
+	if (!CanTranslate( inInstruction ))
+	{
+		return NULL;
+	}
+	if (mCode == NULL)
+	{
+		mCode = TJITX86_64Arena::Allocate();
+		if (mCode == NULL)
+		{
+			return NULL;
+		}
+		mWritable = true;
+	}
+	if (mCrsr + kMaxInstructionSize + kEpilogueSize
+		> (KUInt32) TJITX86_64Arena::kSlotSize)
+	{
+		return NULL;
+	}
+	if (!mWritable)
+	{
+		TJITX86_64Arena::MakeWritable( mCode );
+		mWritable = true;
+	}
+
+	if (mBlockOpen)
+	{
+		// Jump over the prologue when coming from the previous instruction.
+		Emit8(0xEB);	// jmp +4
+		Emit8(0x04);
+	}
+
+	// Prologue: save rbx and load it with the processor.
+	KUInt8* theEntry = &mCode[mCrsr];
+	Emit8(0x53);		// push rbx
+	Emit8(0x48);		// mov rbx, rdi
+	Emit8(0x89);
+	Emit8(0xFB);
+	mBlockOpen = true;
+
+	KUInt32 theSkips[kMaxSkips];
+	KUInt32 nbSkips = DoCondition( inInstruction >> 28, theSkips );
+
+	if (((inInstruction >> 26) & 0x3) == 0x0)
+	{
+		DoDataProcessing( inInstruction, inVAddr, inDeadFlags );
+	} else {
+		DoSingleDataTransfer( inInstruction, inVAddr );
+	}
+
+	KUInt32 indexSkip;
+	for (indexSkip = 0; indexSkip < nbSkips; indexSkip++)
+	{
+		PatchJump( theSkips[indexSkip] );
+	}
+
+	return theEntry;
+}
+
+// -------------------------------------------------------------------------- //
+//  * CloseBlock( void )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Emitter::CloseBlock( void )
+{
+	if (mBlockOpen)
+	{
+		Emit8(0x31);	// xor eax, eax
+		Emit8(0xC0);
+		Emit8(0x5B);	// pop rbx
+		Emit8(0xC3);	// ret
+		mBlockOpen = false;
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * MakeExecutable( void )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Emitter::MakeExecutable( void )
+{
+	if (mWritable)
+	{
+		TJITX86_64Arena::MakeExecutable( mCode );
+		mWritable = false;
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * DoCondition( KUInt32, KUInt32[] )
+// -------------------------------------------------------------------------- //
+KUInt32
+TJITX86_64Emitter::DoCondition(
+				KUInt32 inCondition,
+				KUInt32 outSkips[kMaxSkips] )
+{
+	const KSInt32 theN = CPUOffset(mCPSR_N);
+	const KSInt32 theZ = CPUOffset(mCPSR_Z);
+	const KSInt32 theC = CPUOffset(mCPSR_C);
+	const KSInt32 theV = CPUOffset(mCPSR_V);
+	KUInt32 nbSkips = 0;
+	KUInt32 theBody;
+
+	// Jump over the instruction when the condition fails.
+	switch (inCondition)
+	{
+		case 0x0:	// EQ
+			EmitCompareFlag( theZ );
+			outSkips[nbSkips++] = EmitJump( kCondE );
+			break;
+
+		case 0x1:	// NE
+			EmitCompareFlag( theZ );
+			outSkips[nbSkips++] = EmitJump( kCondNE );
+			break;
+
+		case 0x2:	// CS
+			EmitCompareFlag( theC );
+			outSkips[nbSkips++] = EmitJump( kCondE );
+			break;
+
+		case 0x3:	// CC
+			EmitCompareFlag( theC );
+			outSkips[nbSkips++] = EmitJump( kCondNE );
+			break;
+
+		case 0x4:	// MI
+			EmitCompareFlag( theN );
+			outSkips[nbSkips++] = EmitJump( kCondE );
+			break;
+
+		case 0x5:	// PL
+			EmitCompareFlag( theN );
+			outSkips[nbSkips++] = EmitJump( kCondNE );
+			break;
+
+		case 0x6:	// VS
+			EmitCompareFlag( theV );
+			outSkips[nbSkips++] = EmitJump( kCondE );
+			break;
+
+		case 0x7:	// VC
+			EmitCompareFlag( theV );
+			outSkips[nbSkips++] = EmitJump( kCondNE );
+			break;
+
+		case 0x8:	// HI
+			EmitCompareFlag( theC );
+			outSkips[nbSkips++] = EmitJump( kCondE );
+			EmitCompareFlag( theZ );
+			outSkips[nbSkips++] = EmitJump( kCondNE );
+			break;
+
+		case 0x9:	// LS
+			EmitCompareFlag( theC );
+			theBody = EmitJump( kCondE );
+			EmitCompareFlag( theZ );
+			outSkips[nbSkips++] = EmitJump( kCondE );
+			PatchJump( theBody );
+			break;
+
+		case 0xA:	// GE
+		case 0xB:	// LT
+			EmitModRMDisp( 0x8A, kEAX, theN );	// mov al, [N]
+			EmitModRMDisp( 0x3A, kEAX, theV );	// cmp al, [V]
+			outSkips[nbSkips++] =
+				EmitJump( (inCondition == 0xA) ? kCondNE : kCondE );
+			break;
+
+		case 0xC:	// GT
+			EmitCompareFlag( theZ );
+			outSkips[nbSkips++] = EmitJump( kCondNE );
+			EmitModRMDisp( 0x8A, kEAX, theN );
+			EmitModRMDisp( 0x3A, kEAX, theV );
+			outSkips[nbSkips++] = EmitJump( kCondNE );
+			break;
+
+		case 0xD:	// LE
+			EmitCompareFlag( theZ );
+			theBody = EmitJump( kCondNE );
+			EmitModRMDisp( 0x8A, kEAX, theN );
+			EmitModRMDisp( 0x3A, kEAX, theV );
+			outSkips[nbSkips++] = EmitJump( kCondE );
+			PatchJump( theBody );
+			break;
+	}
+
+	return nbSkips;
+}
+
+// -------------------------------------------------------------------------- //
+//  * DoShifter( KUInt32, KUInt32, Boolean )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Emitter::DoShifter(
+				KUInt32 inInstruction,
+				KUInt32 inVAddr,
+				Boolean inSetCarry )
+{
+	// The operand goes to ecx.
+	const KSInt32 theC = CPUOffset(mCPSR_C);
+	if (inInstruction & 0x02000000)
+	{
+		KUInt32 theImmValue = inInstruction & 0xFF;
+		KUInt32 theRotateAmount = ((inInstruction >> 8) & 0xF) * 2;
+		if (theRotateAmount != 0)
+		{
+			theImmValue =
+				(theImmValue >> theRotateAmount)
+				| (theImmValue << (32 - theRotateAmount));
+		}
+		EmitLoadImm( kECX, theImmValue );
+		if (inSetCarry && (theRotateAmount != 0))
+		{
+			EmitModRMDisp( 0xC6, 0, theC );		// mov byte [C], imm8
+			Emit8( (KUInt8) (theImmValue >> 31) );
+		}
+		return;
+	}
+
+	EmitLoadReg( kECX, __Rm(inInstruction), inVAddr );
+	KUInt32 theAmount = (inInstruction >> 7) & 0x1F;
+	switch ((inInstruction >> 5) & 0x3)
+	{
+		case 0x0:	// LSL
+			if (theAmount == 0)
+			{
+				return;
+			}
+			Emit8(0xC1);	// shl ecx, imm8
+			Emit8(0xE1);
+			Emit8( (KUInt8) theAmount );
+			break;
+
+		case 0x1:	// LSR
+			if (theAmount == 0)
+			{
+				// LSR #32
+				if (inSetCarry)
+				{
+					Emit8(0x0F);	// bt ecx, 31
+					Emit8(0xBA);
+					Emit8(0xE1);
+					Emit8(0x1F);
+					EmitSetFlag( kCondB, theC );
+				}
+				Emit8(0x31);	// xor ecx, ecx
+				Emit8(0xC9);
+				return;
+			}
+			Emit8(0xC1);	// shr ecx, imm8
+			Emit8(0xE9);
+			Emit8( (KUInt8) theAmount );
+			break;
+
+		case 0x2:	// ASR
+			if (theAmount == 0)
+			{
+				// ASR #32
+				if (inSetCarry)
+				{
+					Emit8(0x0F);	// bt ecx, 31
+					Emit8(0xBA);
+					Emit8(0xE1);
+					Emit8(0x1F);
+					EmitSetFlag( kCondB, theC );
+				}
+				Emit8(0xC1);	// sar ecx, 31
+				Emit8(0xF9);
+				Emit8(0x1F);
+				return;
+			}
+			Emit8(0xC1);	// sar ecx, imm8
+			Emit8(0xF9);
+			Emit8( (KUInt8) theAmount );
+			break;
+
+		case 0x3:	// ROR
+			if (theAmount == 0)
+			{
+				// RRX
+				EmitCarryIn( false );
+				Emit8(0xD1);	// rcr ecx, 1
+				Emit8(0xD9);
+			} else {
+				Emit8(0xC1);	// ror ecx, imm8
+				Emit8(0xC9);
+				Emit8( (KUInt8) theAmount );
+			}
+			break;
+	}
+
+	if (inSetCarry)
+	{
+		// The last bit shifted out is in CF.
+		EmitSetFlag( kCondB, theC );
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * DoDataProcessing( KUInt32, KUInt32, KUInt8 )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Emitter::DoDataProcessing(
+				KUInt32 inInstruction,
+				KUInt32 inVAddr,
+				KUInt8 inDeadFlags )
+{
+	const KUInt32 theOp = (inInstruction >> 21) & 0xF;
+	const Boolean isLogical =
+		(theOp <= 0x1) || (theOp == 0x8) || (theOp == 0x9) || (theOp >= 0xC);
+	const Boolean isTest = (theOp >= 0x8) && (theOp <= 0xB);
+	KUInt8 theFlags = 0;
+	if (inInstruction & 0x00100000)
+	{
+		if (isLogical)
+		{
+			theFlags = kFlagN | kFlagZ | kFlagC;
+		} else {
+			theFlags = kFlagN | kFlagZ | kFlagC | kFlagV;
+		}
+		theFlags &= ~inDeadFlags;
+	}
+
+	// Operand 2 in ecx, Rn in eax.
+	DoShifter( inInstruction, inVAddr, isLogical && (theFlags & kFlagC) );
+	if ((theOp != 0xD) && (theOp != 0xF))
+	{
+		EmitLoadReg( kEAX, __Rn(inInstruction), inVAddr );
+	}
+
+	Boolean isAddition = false;
+	switch (theOp)
+	{
+		case 0x0:	// AND
+		case 0x8:	// TST
+			Emit8(0x21);	// and eax, ecx
+			Emit8(0xC8);
+			break;
+
+		case 0x1:	// EOR
+		case 0x9:	// TEQ
+			Emit8(0x31);	// xor eax, ecx
+			Emit8(0xC8);
+			break;
+
+		case 0x2:	// SUB
+		case 0xA:	// CMP
+			Emit8(0x29);	// sub eax, ecx
+			Emit8(0xC8);
+			break;
+
+		case 0x3:	// RSB
+			Emit8(0x29);	// sub ecx, eax
+			Emit8(0xC1);
+			Emit8(0x89);	// mov eax, ecx
+			Emit8(0xC8);
+			break;
+
+		case 0x4:	// ADD
+		case 0xB:	// CMN
+			Emit8(0x01);	// add eax, ecx
+			Emit8(0xC8);
+			isAddition = true;
+			break;
+
+		case 0x5:	// ADC
+			EmitCarryIn( false );
+			Emit8(0x11);	// adc eax, ecx
+			Emit8(0xC8);
+			isAddition = true;
+			break;
+
+		case 0x6:	// SBC
+			EmitCarryIn( true );
+			Emit8(0x19);	// sbb eax, ecx
+			Emit8(0xC8);
+			break;
+
+		case 0x7:	// RSC
+			EmitCarryIn( true );
+			Emit8(0x19);	// sbb ecx, eax
+			Emit8(0xC1);
+			Emit8(0x89);	// mov eax, ecx
+			Emit8(0xC8);
+			break;
+
+		case 0xC:	// ORR
+			Emit8(0x09);	// or eax, ecx
+			Emit8(0xC8);
+			break;
+
+		case 0xD:	// MOV
+			Emit8(0x89);	// mov eax, ecx
+			Emit8(0xC8);
+			break;
+
+		case 0xE:	// BIC
+			Emit8(0xF7);	// not ecx
+			Emit8(0xD1);
+			Emit8(0x21);	// and eax, ecx
+			Emit8(0xC8);
+			break;
+
+		case 0xF:	// MVN
+			Emit8(0x89);	// mov eax, ecx
+			Emit8(0xC8);
+			Emit8(0xF7);	// not eax
+			Emit8(0xD0);
+			break;
+	}
+
+	if (isLogical)
+	{
+		// C was set by the shifter, V is unchanged.
+		if (theFlags & (kFlagN | kFlagZ))
+		{
+			Emit8(0x85);	// test eax, eax
+			Emit8(0xC0);
+		}
+	}
+	if (theFlags & kFlagN)
+	{
+		EmitSetFlag( kCondS, CPUOffset(mCPSR_N) );
+	}
+	if (theFlags & kFlagZ)
+	{
+		EmitSetFlag( kCondE, CPUOffset(mCPSR_Z) );
+	}
+	if (!isLogical)
+	{
+		// ARM C is the carry of additions and the opposite of the borrow
+		// of subtractions.
+		if (theFlags & kFlagC)
+		{
+			EmitSetFlag( isAddition ? kCondB : kCondAE, CPUOffset(mCPSR_C) );
+		}
+		if (theFlags & kFlagV)
+		{
+			EmitSetFlag( kCondO, CPUOffset(mCPSR_V) );
+		}
+	}
+
+	if (!isTest)
+	{
+		EmitStoreReg( __Rd(inInstruction), kEAX );
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * DoSingleDataTransfer( KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Emitter::DoSingleDataTransfer(
+				KUInt32 inInstruction,
+				KUInt32 inVAddr )
+{
+	const Boolean theFlagP = (inInstruction & 0x01000000) != 0;
+	const Boolean theFlagU = (inInstruction & 0x00800000) != 0;
+	const Boolean theFlagB = (inInstruction & 0x00400000) != 0;
+	const Boolean theFlagW = (inInstruction & 0x00200000) != 0;
+	const Boolean theFlagL = (inInstruction & 0x00100000) != 0;
+	const Boolean theWriteBack = !theFlagP || theFlagW;
+	const KUInt8 theAddOp = theFlagU ? 0x01 : 0x29;	// add or sub
+
+	// Offset in ecx, base in eax.
+	if (inInstruction & 0x02000000)
+	{
+		// The I bit selects a shifted register here, unlike data processing.
+		DoShifter( inInstruction & ~0x02000000, inVAddr, false );
+	} else {
+		EmitLoadImm( kECX, inInstruction & 0x00000FFF );
+	}
+	EmitLoadReg( kEAX, __Rn(inInstruction), inVAddr );
+
+	// Address in esi, written back base in r9d.
+	if (theFlagP)
+	{
+		Emit8(theAddOp);	// add/sub eax, ecx
+		Emit8(0xC8);
+		Emit8(0x89);		// mov esi, eax
+		Emit8(0xC6);
+	} else {
+		Emit8(0x89);		// mov esi, eax
+		Emit8(0xC6);
+		Emit8(theAddOp);	// add/sub eax, ecx
+		Emit8(0xC8);
+	}
+	if (theWriteBack)
+	{
+		Emit8(0x41);		// mov r9d, eax
+		Emit8(0x89);
+		Emit8(0xC1);
+	}
+	Emit8(0x41);			// mov r8d, Rn
+	Emit8(0xB8);
+	Emit32( theWriteBack ? __Rn(inInstruction) : kNoWriteBack );
+
+	// Rd or the value in edx.
+	if (theFlagL)
+	{
+		EmitLoadImm( kEDX, __Rd(inInstruction) );
+	} else {
+		EmitLoadReg( kEDX, __Rd(inInstruction), inVAddr );
+	}
+	EmitLoadImm( kECX, inVAddr + 8 );
+	Emit8(0x48);			// mov rdi, rbx
+	Emit8(0x89);
+	Emit8(0xDF);
+
+	if (theFlagL)
+	{
+		EmitCall( theFlagB ? (const void*) LoadByte : (const void*) LoadWord );
+	} else {
+		EmitCall( theFlagB ? (const void*) StoreByte : (const void*) StoreWord );
+	}
+
+	// Return on data abort.
+	Emit8(0x85);			// test eax, eax
+	Emit8(0xC0);
+	Emit8(0x74);			// jz +2
+	Emit8(0x02);
+	Emit8(0x5B);			// pop rbx
+	Emit8(0xC3);			// ret
+}
+
+// -------------------------------------------------------------------------- //
+//  * Emit32( KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Emitter::Emit32( KUInt32 inWord )
+{
+	Emit8( (KUInt8) inWord );
+	Emit8( (KUInt8) (inWord >> 8) );
+	Emit8( (KUInt8) (inWord >> 16) );
+	Emit8( (KUInt8) (inWord >> 24) );
+}
+
+// -------------------------------------------------------------------------- //
+//  * Emit64( KUInt64 )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Emitter::Emit64( KUInt64 inWord )
+{
+	Emit32( (KUInt32) inWord );
+	Emit32( (KUInt32) (inWord >> 32) );
+}
+
+// -------------------------------------------------------------------------- //
+//  * EmitModRMDisp( KUInt8, KUInt32, KSInt32 )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Emitter::EmitModRMDisp(
+				KUInt8 inOpcode,
+				KUInt32 inReg,
+				KSInt32 inDisp )
+{
+	// op reg, [rbx + disp32]
+	Emit8( inOpcode );
+	Emit8( (KUInt8) (0x83 | (inReg << 3)) );
+	Emit32( (KUInt32) inDisp );
+}
+
+// -------------------------------------------------------------------------- //
+//  * EmitLoadReg( EHostReg, KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Emitter::EmitLoadReg(
+				EHostReg inHostReg,
+				KUInt32 inReg,
+				KUInt32 inVAddr )
+{
+	if (inReg == 15)
+	{
+		EmitLoadImm( inHostReg, inVAddr + 8 );
+	} else {
+		EmitModRMDisp( 0x8B, inHostReg, RegisterOffset(inReg) );
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * EmitStoreReg( KUInt32, EHostReg )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Emitter::EmitStoreReg(
+				KUInt32 inReg,
+				EHostReg inHostReg )
+{
+	EmitModRMDisp( 0x89, inHostReg, RegisterOffset(inReg) );
+}
+
+// -------------------------------------------------------------------------- //
+//  * EmitLoadImm( EHostReg, KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Emitter::EmitLoadImm(
+				EHostReg inHostReg,
+				KUInt32 inValue )
+{
+	// mov doesn't change the flags.
+	Emit8( (KUInt8) (0xB8 + inHostReg) );
+	Emit32( inValue );
+}
+
+// -------------------------------------------------------------------------- //
+//  * EmitSetFlag( EHostCond, KSInt32 )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Emitter::EmitSetFlag(
+				EHostCond inCond,
+				KSInt32 inFlagOffset )
+{
+	// setcc byte [rbx + disp32]
+	Emit8(0x0F);
+	EmitModRMDisp( (KUInt8) (0x90 | inCond), 0, inFlagOffset );
+}
+
+// -------------------------------------------------------------------------- //
+//  * EmitCarryIn( Boolean )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Emitter::EmitCarryIn( Boolean inInverted )
+{
+	const KSInt32 theC = CPUOffset(mCPSR_C);
+	if (inInverted)
+	{
+		// CF = (C < 1)
+		EmitModRMDisp( 0x80, 7, theC );		// cmp byte [C], 1
+		Emit8(0x01);
+	} else {
+		// CF = (C + 0xFF > 0xFF)
+		EmitModRMDisp( 0x8A, kEDX, theC );	// mov dl, [C]
+		Emit8(0x80);						// add dl, 0xFF
+		Emit8(0xC2);
+		Emit8(0xFF);
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * EmitCompareFlag( KSInt32 )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Emitter::EmitCompareFlag( KSInt32 inFlagOffset )
+{
+	EmitModRMDisp( 0x80, 7, inFlagOffset );	// cmp byte [flag], 0
+	Emit8(0x00);
+}
+
+// -------------------------------------------------------------------------- //
+//  * EmitJump( EHostCond )
+// -------------------------------------------------------------------------- //
+KUInt32
+TJITX86_64Emitter::EmitJump( EHostCond inCond )
+{
+	// jcc rel32, patched later.
+	Emit8(0x0F);
+	Emit8( (KUInt8) (0x80 | inCond) );
+	KUInt32 theJump = mCrsr;
+	Emit32( 0 );
+	return theJump;
+}
+
+// -------------------------------------------------------------------------- //
+//  * PatchJump( KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Emitter::PatchJump( KUInt32 inJump )
+{
+	KUInt32 theCrsr = mCrsr;
+	mCrsr = inJump;
+	Emit32( theCrsr - (inJump + 4) );
+	mCrsr = theCrsr;
+}
+
+// -------------------------------------------------------------------------- //
+//  * EmitCall( const void* )
+// -------------------------------------------------------------------------- //
+void
+TJITX86_64Emitter::EmitCall( const void* inFunction )
+{
+	Emit8(0x48);	// mov rax, imm64
+	Emit8(0xB8);
+	Emit64( (KUInt64) (KUIntPtr) inFunction );
+	Emit8(0xFF);	// call rax
+	Emit8(0xD0);
+}
+
+// -------------------------------------------------------------------------- //
+//  * LoadWord( TARMProcessor*, KUInt32, KUInt32, KUInt32, KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+KUInt32
+TJITX86_64Emitter::LoadWord(
+				TARMProcessor* ioCPU,
+				KUInt32 inAddress,
+				KUInt32 inRd,
+				KUInt32 inPC,
+				KUInt32 inRn,
+				KUInt32 inBase )
+{
+	KUInt32 theData;
+	if (ioCPU->GetMemory()->FastRead( inAddress, theData ))
+	{
+		ioCPU->mCurrentRegisters[TARMProcessor::kR15] = inPC;
+		ioCPU->DataAbort();
+		return 1;
+	}
+	ioCPU->mCurrentRegisters[inRd] = theData;
+	if (inRn != kNoWriteBack)
+	{
+		ioCPU->mCurrentRegisters[inRn] = inBase;
+	}
+	return 0;
+}
+
+// -------------------------------------------------------------------------- //
+//  * LoadByte( TARMProcessor*, KUInt32, KUInt32, KUInt32, KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+KUInt32
+TJITX86_64Emitter::LoadByte(
+				TARMProcessor* ioCPU,
+				KUInt32 inAddress,
+				KUInt32 inRd,
+				KUInt32 inPC,
+				KUInt32 inRn,
+				KUInt32 inBase )
+{
+	KUInt8 theData;
+	if (ioCPU->GetMemory()->FastReadB( inAddress, theData ))
+	{
+		ioCPU->mCurrentRegisters[TARMProcessor::kR15] = inPC;
+		ioCPU->DataAbort();
+		return 1;
+	}
+	ioCPU->mCurrentRegisters[inRd] = theData;
+	if (inRn != kNoWriteBack)
+	{
+		ioCPU->mCurrentRegisters[inRn] = inBase;
+	}
+	return 0;
+}
+
+// -------------------------------------------------------------------------- //
+//  * StoreWord( TARMProcessor*, KUInt32, KUInt32, KUInt32, KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+KUInt32
+TJITX86_64Emitter::StoreWord(
+				TARMProcessor* ioCPU,
+				KUInt32 inAddress,
+				KUInt32 inValue,
+				KUInt32 inPC,
+				KUInt32 inRn,
+				KUInt32 inBase )
+{
+	if (ioCPU->GetMemory()->FastWrite( inAddress, inValue ))
+	{
+		ioCPU->mCurrentRegisters[TARMProcessor::kR15] = inPC;
+		ioCPU->DataAbort();
+		return 1;
+	}
+	if (inRn != kNoWriteBack)
+	{
+		ioCPU->mCurrentRegisters[inRn] = inBase;
+	}
+	return 0;
+}
+
+// -------------------------------------------------------------------------- //
+//  * StoreByte( TARMProcessor*, KUInt32, KUInt32, KUInt32, KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+KUInt32
+TJITX86_64Emitter::StoreByte(
+				TARMProcessor* ioCPU,
+				KUInt32 inAddress,
+				KUInt32 inValue,
+				KUInt32 inPC,
+				KUInt32 inRn,
+				KUInt32 inBase )
+{
+	if (ioCPU->GetMemory()->FastWriteB( inAddress, (KUInt8) (inValue & 0xFF) ))
+	{
+		ioCPU->mCurrentRegisters[TARMProcessor::kR15] = inPC;
+		ioCPU->DataAbort();
+		return 1;
+	}
+	if (inRn != kNoWriteBack)
+	{
+		ioCPU->mCurrentRegisters[inRn] = inBase;
+	}
+	return 0;
+}
+
+#endif
+	// JITTARGET_X86_64
+
+// ====================================================================== //
+// Nobody said computers were going to be polite.                         //
+// ====================================================================== //
@@ -0,0 +1,234 @@
+// ==============================
+// File:			TJITX86_64Emitter.h
+// Project:			Einstein
+//
+// Copyright 2003-2007 by Paul Guyot (pguyot@kallisys.net).
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+#ifndef _TJITX86_64EMITTER_H
+#define _TJITX86_64EMITTER_H
+
+#include <K/Defines/KDefinitions.h>
+
+class TARMProcessor;
+
+/// Native code of a block, returns non zero if a data abort occurred.
+typedef KUInt32 (*JITNativeFuncPtr)(TARMProcessor* ioCPU);
+
+///
+/// Emitter of x86-64 code for the generic JIT.
+///
+/// Each page has an emitter that translates runs of simple instructions
+/// (data processing with immediate shifts and single data transfers) into
+/// blocks of native code. Every instruction of a block is an entry point
+/// and the code runs to the end of the block. Memory accesses are calls to
+/// helpers on TMemory. Other instructions are left to the generic units.
+///
+/// Registers: rbx holds the processor, eax, ecx and edx are scratch.
+/// The code follows the System V calling convention.
+///
+class TJITX86_64Emitter
+{
+public:
+	///
+	/// Default constructor.
+	///
+	TJITX86_64Emitter( void );
+
+	///
+	/// Destructor.
+	///
+	~TJITX86_64Emitter( void );
+
+	///
+	/// Forget all the code, when the page is recycled.
+	///
+	void		Reset( void );
+
+	///
+	/// Translate an instruction, appending it to the current block.
+	///
+	/// \param inInstruction	instruction to translate.
+	/// \param inVAddr			virtual address of the instruction.
+	/// \param inDeadFlags		flags (TJITGenericPage::kFlagN...) that are
+	///							not read before they are set again.
+	/// \return the entry point of the instruction or NULL if it cannot be
+	///			translated.
+	///
+	KUInt8*		Translate(
+					KUInt32 inInstruction,
+					KUInt32 inVAddr,
+					KUInt8 inDeadFlags );
+
+	///
+	/// Terminate the current block.
+	///
+	void		CloseBlock( void );
+
+	///
+	/// Make the code executable, at the end of a translation. The code is
+	/// made writable again when the next instruction is translated.
+	///
+	void		MakeExecutable( void );
+
+	///
+	/// Determine if a block is being translated.
+	///
+	/// \return \c true if instructions were added since the last CloseBlock.
+	///
+	Boolean		IsBlockOpen( void ) const
+		{
+			return mBlockOpen;
+		}
+
+private:
+	///
+	/// Constructeur par copie volontairement indisponible.
+	///
+	/// \param inCopy		objet  copier
+	///
+	TJITX86_64Emitter( const TJITX86_64Emitter& inCopy );
+
+	///
+	/// Oprateur d'assignation volontairement indisponible.
+	///
+	/// \param inCopy		objet  copier
+	///
+	TJITX86_64Emitter& operator = ( const TJITX86_64Emitter& inCopy );
+
+	/// Host registers.
+	enum EHostReg {
+		kEAX	= 0,
+		kECX	= 1,
+		kEDX	= 2,
+		kEBX	= 3,
+		kESI	= 6,
+		kEDI	= 7,
+	};
+
+	/// x86 condition codes.
+	enum EHostCond {
+		kCondO	= 0x0,
+		kCondB	= 0x2,
+		kCondAE	= 0x3,
+		kCondE	= 0x4,
+		kCondNE	= 0x5,
+		kCondS	= 0x8,
+	};
+
+	/// Flags, as TJITGenericPage.
+	enum {
+		kFlagN = 8,
+		kFlagZ = 4,
+		kFlagC = 2,
+		kFlagV = 1,
+	};
+
+	enum {
+		kMaxInstructionSize	= 160,	///< Upper bound of the code of an
+									///< instruction.
+		kEpilogueSize		= 4,
+		kMaxSkips			= 3,	///< Jumps of a condition.
+	};
+
+	///
+	/// Determine if an instruction can be translated.
+	///
+	static Boolean	CanTranslate( KUInt32 inInstruction );
+
+	/// \name Translation of instructions
+	void	DoDataProcessing(
+				KUInt32 inInstruction,
+				KUInt32 inVAddr,
+				KUInt8 inDeadFlags );
+	void	DoSingleDataTransfer(
+				KUInt32 inInstruction,
+				KUInt32 inVAddr );
+	void	DoShifter(
+				KUInt32 inInstruction,
+				KUInt32 inVAddr,
+				Boolean inSetCarry );
+	KUInt32	DoCondition(
+				KUInt32 inCondition,
+				KUInt32 outSkips[kMaxSkips] );
+
+	/// \name Emission
+	void	Emit8( KUInt8 inByte )
+		{
+			mCode[mCrsr++] = inByte;
+		}
+	void	Emit32( KUInt32 inWord );
+	void	Emit64( KUInt64 inWord );
+	void	EmitModRMDisp( KUInt8 inOpcode, KUInt32 inReg, KSInt32 inDisp );
+	void	EmitLoadReg( EHostReg inHostReg, KUInt32 inReg, KUInt32 inVAddr );
+	void	EmitStoreReg( KUInt32 inReg, EHostReg inHostReg );
+	void	EmitLoadImm( EHostReg inHostReg, KUInt32 inValue );
+	void	EmitSetFlag( EHostCond inCond, KSInt32 inFlagOffset );
+	void	EmitCarryIn( Boolean inInverted );
+	void	EmitCompareFlag( KSInt32 inFlagOffset );
+	KUInt32	EmitJump( EHostCond inCond );
+	void	PatchJump( KUInt32 inJump );
+	void	EmitCall( const void* inFunction );
+
+	/// \name Helpers called by the native code
+	static KUInt32	LoadWord(
+						TARMProcessor* ioCPU,
+						KUInt32 inAddress,
+						KUInt32 inRd,
+						KUInt32 inPC,
+						KUInt32 inRn,
+						KUInt32 inBase );
+	static KUInt32	LoadByte(
+						TARMProcessor* ioCPU,
+						KUInt32 inAddress,
+						KUInt32 inRd,
+						KUInt32 inPC,
+						KUInt32 inRn,
+						KUInt32 inBase );
+	static KUInt32	StoreWord(
+						TARMProcessor* ioCPU,
+						KUInt32 inAddress,
+						KUInt32 inValue,
+						KUInt32 inPC,
+						KUInt32 inRn,
+						KUInt32 inBase );
+	static KUInt32	StoreByte(
+						TARMProcessor* ioCPU,
+						KUInt32 inAddress,
+						KUInt32 inValue,
+						KUInt32 inPC,
+						KUInt32 inRn,
+						KUInt32 inBase );
+
+	/// \name Variables
+	KUInt8*			mCode;			///< Slot in the arena.
+	KUInt32			mCrsr;			///< First free byte.
+	Boolean			mBlockOpen;		///< Whether a block is being translated.
+	Boolean			mWritable;		///< Whether the slot is writable (and
+									///< not executable).
+};
+
+#endif
+		// _TJITX86_64EMITTER_H
+
+// ====================================================================== //
+// The bugs you have to avoid are the ones that give the user not only    //
+// the inclination to get on a plane, but also the time.                  //
+//                 -- Kay Bostic                                          //
+// ====================================================================== //
@@ -74,6 +74,7 @@ TPlatformManager::TPlatformManager(
 		mPowerOn( true ),
 		mQueueLockCount( 0 ),
 		mMutex( nil ),
+		mNetworkCard( nil ),
 		mDocDir( nil )
 {
 	mEventQueue = (SEvent*) ::malloc( sizeof(SEvent) * mEventQueueSize );
@@ -345,18 +346,16 @@ TPlatformManager::SendAEvent( EPort inPortId, KUInt32 inSize, const KUInt8* inDa
 void
 TPlatformManager::SendNetworkCardEvent( void )
 {
-	static TNE2000Card *theCard = NULL;
-
 	// FIXME: Change check mark in Menu.
 	if (mMemory) {
 		TPCMCIAController *theController = mMemory->GetPCMCIAController(0);
 		if (theController) {
-			if (theCard==0L) {
-				theCard = new TNE2000Card();
-				theController->InsertCard(theCard);
+			if (mNetworkCard==0L) {
+				mNetworkCard = new TNE2000Card();
+				theController->InsertCard(mNetworkCard);
 			} else {
 				theController->RemoveCard();
-				theCard = NULL;
+				mNetworkCard = NULL;
 			}
 		}
 	}
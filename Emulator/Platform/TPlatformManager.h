@@ -37,6 +37,7 @@ class TScreenManager;
 class TMemory;
 class TLog;
 class TMutex;
+class TNE2000Card;
 
 
 ///
@@ -296,6 +297,7 @@ private:
 	Boolean				mPowerOn;			///< If power is on.
 	KUInt32				mQueueLockCount;	///< Lock count for the queue.
 	TMutex*				mMutex;				///< Mutex of the queue.
+	TNE2000Card*		mNetworkCard;		///< Inserted network card (or nil).
 	char*				mDocDir;			///< Directory on host containing all kinds of documents
 };
 
@@ -0,0 +1,45 @@
+// ==============================
+// File:			PrecompiledPatches.cp
+// Project:			Einstein
+//
+// Copyright 2012 by Matthias Melcher (einstein@matthiasm.com).
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+//
+// This file is replaced by the output of einsteinaot:
+//
+//	einsteinaot -o Emulator/ROM/PrecompiledPatches.cpp rom.bin hits.txt
+//
+// No functions are translated by default.
+//
+
+#include <K/Defines/KDefinitions.h>
+#include "JIT.h"
+
+#ifdef JITTARGET_GENERIC
+
+#include "Emulator/ROM/PrecompiledPatches.h"
+
+KUInt32 gPrecompiledFunctionCount = 0;
+
+#endif
+
+// ================================================================== //
+// MAC user's dynamic debugging list evaluator?  Never heard of that. //
+// ================================================================== //
@@ -26,19 +26,127 @@
 
 
 #include <K/Defines/KDefinitions.h>
-#include "TROMImage.h"
-#include "TARMProcessor.h"
-#include "TJITGeneric_Macros.h"
+#include "Emulator/TARMProcessor.h"
+#include "Emulator/TMemory.h"
+#include "Emulator/JIT/Generic/TJITGeneric_Macros.h"
+#include "Emulator/JIT/Generic/TJITGenericROMPatch.h"
 
+//
+// Translations of ROM functions into C++, as emitted by einsteinaot.
+//
+// Every function is a native call patch at its entry point. It runs until
+// it reaches an instruction it does not translate, a call, or the end of the
+// function, sets R15 to the address of the next instruction (+4, as the JIT)
+// and returns NULL so the JIT continues from there.
+//
+// If PRECOMPILED_VERIFY is 1 when PrecompiledPatches.cpp is compiled, the
+// translations are injected before the original instructions and checked
+// against them (see TJITGenericPatchPrecompiled).
+//
+
+#ifndef PRECOMPILED_VERIFY
+	#define PRECOMPILED_VERIFY 0
+#endif
+
+/// Number of backward branches a translation takes before it leaves the
+/// rest of a loop to the JIT, so interrupts are not held off forever.
+#define AOT_MAX_LOOPS 4096
+
+/// Number of translated functions, defined by PrecompiledPatches.cpp.
+extern KUInt32 gPrecompiledFunctionCount;
 
 #define PRECOMPILED_FUNCTION(address) \
 JITInstructionProto(pcf_##address); \
-TROMPatch p##address(address, pcf_##address, #address); \
+TJITGenericPatchPrecompiled p##address(address, pcf_##address, #address, PRECOMPILED_VERIFY); \
 JITInstructionProto(pcf_##address)
 
-//CALLNEXTUNIT;
-//SETPC(GETPC());
-//MMUCALLNEXT_AFTERSETPC;
+/// Register of the processor.
+#define AOT_R(reg) \
+	ioCPU->mCurrentRegisters[reg]
+
+/// Leave the translation, the JIT continues at target.
+#define AOT_EXIT(target) \
+	{ SETPC((target) + 4); return NULL; }
+
+/// Start of an instruction.
+#if PRECOMPILED_VERIFY
+	#define AOT_INSN() \
+		TJITGenericPatchPrecompiled::CountInstruction(ioCPU)
+#else
+	#define AOT_INSN() \
+		{}
+#endif
+
+/// Data abort of the instruction at inst.
+#if PRECOMPILED_VERIFY
+	#define AOT_ABORT(inst) \
+		{ \
+			SETPC((inst) + 8); \
+			if (TJITGenericPatchPrecompiled::IsVerifying(ioCPU)) \
+				TJITGenericPatchPrecompiled::Abort(ioCPU); \
+			else \
+				ioCPU->DataAbort(); \
+			return NULL; \
+		}
+#else
+	#define AOT_ABORT(inst) \
+		{ SETPC((inst) + 8); ioCPU->DataAbort(); return NULL; }
+#endif
+
+/// Memory accesses of the instruction at inst.
+#define AOT_READ(inst, addr, value) \
+	if (ioCPU->GetMemory()->FastRead((addr), (value))) AOT_ABORT(inst)
+#define AOT_READB(inst, addr, value) \
+	if (ioCPU->GetMemory()->FastReadB((addr), (value))) AOT_ABORT(inst)
+#if PRECOMPILED_VERIFY
+	#define AOT_LOGWRITE(addr, byte) \
+		if (TJITGenericPatchPrecompiled::IsVerifying(ioCPU)) \
+			TJITGenericPatchPrecompiled::LogWrite(ioCPU, (addr), (byte))
+#else
+	#define AOT_LOGWRITE(addr, byte) \
+		{}
+#endif
+#define AOT_WRITE(inst, addr, value) \
+	{ \
+		AOT_LOGWRITE(addr, false); \
+		if (ioCPU->GetMemory()->FastWrite((addr), (value))) AOT_ABORT(inst) \
+	}
+#define AOT_WRITEB(inst, addr, value) \
+	{ \
+		AOT_LOGWRITE(addr, true); \
+		if (ioCPU->GetMemory()->FastWriteB((addr), (KUInt8) (value))) AOT_ABORT(inst) \
+	}
+
+/// Set N and Z from a result.
+inline KUInt32 AOT_NZ(TARMProcessor* ioCPU, KUInt32 inResult)
+{
+	ioCPU->mCPSR_N = ((inResult & 0x80000000) != 0);
+	ioCPU->mCPSR_Z = (inResult == 0);
+	return inResult;
+}
+
+/// Set N, Z and the carry of the shifter from a result.
+inline KUInt32 AOT_NZC(TARMProcessor* ioCPU, KUInt32 inResult, Boolean inCarry)
+{
+	ioCPU->mCPSR_C = inCarry;
+	return AOT_NZ(ioCPU, inResult);
+}
+
+/// Add with carry in and set the flags (ADDS, ADCS, CMN).
+inline KUInt32 AOT_ADDS(TARMProcessor* ioCPU, KUInt32 inA, KUInt32 inB, KUInt32 inCarry)
+{
+	KUInt64 theResult64 = (KUInt64) inA + (KUInt64) inB + inCarry;
+	KUInt32 theResult = (KUInt32) theResult64;
+	ioCPU->mCPSR_C = ((theResult64 >> 32) != 0);
+	ioCPU->mCPSR_V = (((inA ^ theResult) & (inB ^ theResult) & 0x80000000) != 0);
+	return AOT_NZ(ioCPU, theResult);
+}
+
+/// Subtract with carry (not borrow) in and set the flags (SUBS, SBCS, CMP).
+inline KUInt32 AOT_SUBS(TARMProcessor* ioCPU, KUInt32 inA, KUInt32 inB, KUInt32 inCarry)
+{
+	return AOT_ADDS(ioCPU, inA, ~inB, inCarry);
+}
 
 #endif
 
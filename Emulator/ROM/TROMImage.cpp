@@ -60,7 +60,8 @@
 TROMImage::TROMImage( void )
 	:
 		mMappedFile( NULL ),
-		mImage( NULL )
+		mImage( NULL ),
+		mImagePath( NULL )
 {
 	// I'll create the mmap file later, when asked to.
 }
@@ -79,6 +80,11 @@ TROMImage::~TROMImage( void )
 		::free( mImage );
 		mImage = NULL;
 	}
+	if (mImagePath)
+	{
+		::free( mImagePath );
+		mImagePath = NULL;
+	}
 }
 
 // -------------------------------------------------------------------------- //
@@ -192,17 +198,11 @@ TROMImage::CreateImage(
 	// Write this at the start of the image.
 	
 #if TARGET_RT_LITTLE_ENDIAN
-	{
-		// Endian swap it first
-		
-		KUInt32* src = (KUInt32*) inBuffer;
-		KUInt32* dest = (KUInt32*) theImagePtr;
-		KUInt32* end = (KUInt32*) &inBuffer[inBufferSize];
-		do {
-			*dest = UByteSex::Swap( *src );
-			++dest;
-		} while (++src < end);
-	}
+	// Endian swap it first
+	UByteSex::SwapArray(
+		(KUInt32*) theImagePtr,
+		(const KUInt32*) inBuffer,
+		inBufferSize / sizeof( KUInt32 ) );
 #else
 	(void) ::memcpy(theImagePtr, inBuffer, inBufferSize);
 #endif
@@ -251,6 +251,7 @@ TROMImage::Init( const char* inPath, Boolean inMonitorMode )
 		mMappedFile = theMappedFile;
 		mImage = theImage;
 	}
+	mImagePath = ::strdup( inPath );
 }
 
 // -------------------------------------------------------------------------- //
@@ -65,6 +65,16 @@ public:
 			return mImage->fROM;
 		}
 
+	///
+	/// Accessor to the path of the image.
+	///
+	/// \return the path of the image file, NULL if no image was loaded.
+	///
+	const char* GetImagePath( void ) const
+		{
+			return mImagePath;
+		}
+
 	///
 	/// Compute the checksums.
 	///
@@ -178,6 +188,7 @@ private:
 	
 	TMappedFile*	mMappedFile;	///< mapped file with the rom.
 	SImage*			mImage; 		///< image structure.
+	char*			mImagePath;		///< path of the image file.
 };
 
 #endif
@@ -36,6 +36,8 @@
 #include "../Log/TLog.h"
 #include "../TInterruptManager.h"
 #include "../TDMAManager.h"
+#include "../TMemory.h"
+#include "../TMemoryConsts.h"
 
 #include "TEmulator.h"
 
@@ -85,6 +87,57 @@ TSerialPortManager *TSerialPorts::GetDriverFor(EPortIndex ix)
 	return mDriver[ix];
 }
 
+/**
+ Map the registers of the four ports to their drivers.
+
+ Each port has 64k of byte registers. The driver is looked up at each access,
+ so drivers can be replaced without mapping the registers again.
+
+ @param inMemory memory to map the registers into
+ */
+void TSerialPorts::MapRegisters(TMemory *inMemory)
+{
+	static const KUInt32 kPortBase[kNPortIndex] = {
+		TMemoryConsts::kExternalSerialBase,
+		TMemoryConsts::kInfraredSerialBase,
+		TMemoryConsts::kBuiltInSerialBase,
+		TMemoryConsts::kModemSerialBase
+	};
+	for (KUInt32 i = 0; i < kNPortIndex; i++)
+	{
+		inMemory->MapByteRegisters(kPortBase[i], 0x00010000, this, i,
+								   ReadRegister, WriteRegister);
+	}
+}
+
+/**
+ Read a register of a serial port.
+
+ @param inObject the serial port superviser
+ @param inPort index of the port
+ @param inAddress physical address of the register
+ @return the byte read by the driver
+ */
+KUInt32 TSerialPorts::ReadRegister(void *inObject, KUInt32 inPort, KUInt32 inAddress)
+{
+	TSerialPortManager *driver = ((TSerialPorts*)inObject)->GetDriverFor((EPortIndex)inPort);
+	return driver->ReadRegister(inAddress & 0x0000FFFF);
+}
+
+/**
+ Write a register of a serial port.
+
+ @param inObject the serial port superviser
+ @param inPort index of the port
+ @param inAddress physical address of the register
+ @param inValue byte to write
+ */
+void TSerialPorts::WriteRegister(void *inObject, KUInt32 inPort, KUInt32 inAddress, KUInt32 inValue)
+{
+	TSerialPortManager *driver = ((TSerialPorts*)inObject)->GetDriverFor((EPortIndex)inPort);
+	driver->WriteRegister(inAddress & 0x0000FFFF, (KUInt8)inValue);
+}
+
 /**
  Initialize all drivers and run them
 
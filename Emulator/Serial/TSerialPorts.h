@@ -35,6 +35,7 @@
 class TLog;
 class TEmulator;
 class TSerialPortManager;
+class TMemory;
 
 
 /**
@@ -100,6 +101,9 @@ public:
 	// Replace an existing driver with a new driver
 	TSerialPortManager *ReplaceDriver(EPortIndex inPort, EDriverID inDriverId);
 
+	// Map the registers of the four ports to their drivers
+	void MapRegisters(TMemory *inMemory);
+
 	// NewtonScript call to return all driver names
 	static NewtRef NSGetDriverNames(TNewt::RefArg arg);
 
@@ -117,6 +121,10 @@ public:
 	}
 
 private:
+	// Procs for the registers of the ports (see TMemory::MapByteRegisters)
+	static KUInt32 ReadRegister(void *inObject, KUInt32 inPort, KUInt32 inAddress);
+	static void WriteRegister(void *inObject, KUInt32 inPort, KUInt32 inAddress, KUInt32 inValue);
+
 	TSerialPortManager 	*mDriver[4] = { nullptr, nullptr, nullptr, nullptr };
 	TLog				*mLog = nullptr;
 	TEmulator 			*mEmulator = nullptr;
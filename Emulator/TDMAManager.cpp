@@ -27,6 +27,7 @@
 // Einstein
 #include "TInterruptManager.h"
 #include "TMemory.h"
+#include "TMemoryConsts.h"
 #include "TEmulator.h"
 #include "Serial/TSerialPortManager.h"
 #include "Log/TLog.h"
@@ -273,6 +274,107 @@ TDMAManager::WriteChannel2Register(
 }
 
 
+// -------------------------------------------------------------------------- //
+//  * MapRegisters( TMemory* )
+// -------------------------------------------------------------------------- //
+void
+TDMAManager::MapRegisters( TMemory* inMemory )
+{
+	inMemory->MapRegisters(
+		TMemoryConsts::kHdWr_DMAChan1Base,
+		TMemoryConsts::kHdWr_DMAChan1End - TMemoryConsts::kHdWr_DMAChan1Base,
+		this, kRegChannel1, ReadRegister, WriteRegister );
+	inMemory->MapRegisters(
+		TMemoryConsts::kHdWr_DMAChan2Base,
+		TMemoryConsts::kHdWr_DMAChan2End - TMemoryConsts::kHdWr_DMAChan2Base,
+		this, kRegChannel2, ReadRegister, WriteRegister );
+	inMemory->MapRegisters( TMemoryConsts::kHdWr_DMAAssgmnt, 0,
+		this, kRegAssignment, ReadRegister, WriteRegister );
+	inMemory->MapRegisters( TMemoryConsts::kHdWr_DMAEnableStat, 0,
+		this, kRegEnableStatus, ReadRegister, WriteRegister );
+	inMemory->MapRegisters( TMemoryConsts::kHdWr_DMADisable, 0,
+		this, kRegDisable, NULL, WriteRegister );
+	inMemory->MapRegisters( TMemoryConsts::kHdWr_DMAWordStat, 0,
+		this, kRegWordStatus, ReadRegister, NULL );
+}
+
+// -------------------------------------------------------------------------- //
+//  * ReadRegister( void*, KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+KUInt32
+TDMAManager::ReadRegister(
+			void* inObject,
+			KUInt32 inRegister,
+			KUInt32 inAddress )
+{
+	TDMAManager* theManager = (TDMAManager*) inObject;
+	switch (inRegister)
+	{
+		case kRegChannel1:
+			return theManager->ReadChannel1Register(
+				(inAddress - TMemoryConsts::kHdWr_DMAChan1Base) >> 13,
+				(inAddress & 0x1C00) >> 10 );
+
+		case kRegChannel2:
+			return theManager->ReadChannel2Register(
+				(inAddress - TMemoryConsts::kHdWr_DMAChan2Base) >> 12,
+				(inAddress & 0x0C00) >> 10 );
+
+		case kRegAssignment:
+			return theManager->ReadChannelAssignmentRegister();
+
+		case kRegEnableStatus:
+			return theManager->ReadStatusRegister();
+
+		case kRegWordStatus:
+			return theManager->ReadWordStatusRegister();
+
+		default:
+			return 0;
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * WriteRegister( void*, KUInt32, KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TDMAManager::WriteRegister(
+			void* inObject,
+			KUInt32 inRegister,
+			KUInt32 inAddress,
+			KUInt32 inValue )
+{
+	TDMAManager* theManager = (TDMAManager*) inObject;
+	switch (inRegister)
+	{
+		case kRegChannel1:
+			theManager->WriteChannel1Register(
+				(inAddress - TMemoryConsts::kHdWr_DMAChan1Base) >> 13,
+				(inAddress & 0x1C00) >> 10,
+				inValue );
+			break;
+
+		case kRegChannel2:
+			theManager->WriteChannel2Register(
+				(inAddress - TMemoryConsts::kHdWr_DMAChan2Base) >> 12,
+				(inAddress & 0x0C00) >> 10,
+				inValue );
+			break;
+
+		case kRegAssignment:
+			theManager->WriteChannelAssignmentRegister( inValue );
+			break;
+
+		case kRegEnableStatus:
+			theManager->WriteEnableRegister( inValue );
+			break;
+
+		case kRegDisable:
+			theManager->WriteDisableRegister( inValue );
+			break;
+	}
+}
+
 // -------------------------------------------------------------------------- //
 //  * void TransferState( TStream* )
 // -------------------------------------------------------------------------- //
@@ -159,12 +159,42 @@ public:
 					KUInt32 inRegister,
 					KUInt32 inValue );
 
+	///
+	/// Map the DMA registers.
+	///
+	/// \param inMemory		memory to map the registers into.
+	///
+	void		MapRegisters( TMemory* inMemory );
+
 	///
 	/// Save or restore the state to or from a file.
 	///
 	void		TransferState( TStream* inStream );
 
 private:
+	/// Hardware registers.
+	enum ERegister {
+		kRegChannel1,
+		kRegChannel2,
+		kRegAssignment,
+		kRegEnableStatus,
+		kRegDisable,
+		kRegWordStatus
+	};
+
+	///
+	/// Procs for the hardware registers (see TMemory::MapRegisters).
+	///
+	static KUInt32	ReadRegister(
+						void* inObject,
+						KUInt32 inRegister,
+						KUInt32 inAddress );
+	static void		WriteRegister(
+						void* inObject,
+						KUInt32 inRegister,
+						KUInt32 inAddress,
+						KUInt32 inValue );
+
 	///
 	/// Constructeur par copie volontairement indisponible.
 	///
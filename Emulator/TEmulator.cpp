@@ -75,9 +75,12 @@ TEmulator::TEmulator(
 			TSoundManager* inSoundManager,
 			TScreenManager* inScreenManager,
 			TNetworkManager* inNetworkManager,
-			KUInt32 inRAMSize /* = 4194304 */ )
+			KUInt32 inRAMSize /* = 4194304 */,
+			KUInt32 inJITCacheSize /* = 0 */,
+			KUInt32 inTLBSize /* = 0 */ )
 	:
-		mMemory( inLog, inROMImage, inFlashPath, inRAMSize ),
+		mMemory( inLog, inROMImage, inFlashPath, inRAMSize, inJITCacheSize,
+				inTLBSize ),
 		mProcessor( inLog, &mMemory ),
 		mInterruptManager( nil ),
 		mDMAManager( nil ),
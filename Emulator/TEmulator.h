@@ -71,6 +71,10 @@ public:
 	/// \param inSoundManager		sound manager.
 	/// \param inScreenManager		screen manager.
 	/// \param inRAMSize			size of the RAM installed (in bytes)
+	/// \param inJITCacheSize		number of pages of the JIT cache (0 for
+	///								the default)
+	/// \param inTLBSize			number of entries of the TLB of the MMU
+	///								(0 for the default)
 	///
 	TEmulator(
 			TLog* inLog,
@@ -79,7 +83,9 @@ public:
 			TSoundManager* inSoundManager,
 			TScreenManager* inScreenManager,
 			TNetworkManager* inNetworkManager,
-			KUInt32 inRAMSize = 0x00400000);
+			KUInt32 inRAMSize = 0x00400000,
+			KUInt32 inJITCacheSize = 0,
+			KUInt32 inTLBSize = 0);
 
 	///
 	/// Constructor from a rom image buffer.
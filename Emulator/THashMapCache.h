@@ -38,18 +38,22 @@
 /// Single key hash-backed cache for virtual adresses.
 /// This isn't a "real" hash-map:
 /// - the hash function is extremely simple;
-/// - collision are not handled here.
+/// - each bucket is a set of a few ways, collisions beyond that are not
+///   handled here.
 ///
 /// Instead, all entries are allocated here and are stored within a double
 /// linked list. These links are used as a double end queue through
 /// MakeFirst and MakeLast.
 ///
-/// "Insert" actually stores a new entry as the head of the
-/// given bucket, and "Erase" erases the entry at the bucket. Consequently,
-/// "Lookup" may return NULL while the entry is still live. The entry should
-/// be accessible from another structure, typically a map by physical
-/// addresses.
+/// "Insert" actually stores a new entry as the head of the set of the
+/// given bucket, pushing out the least recently used way if the set is full,
+/// and "Erase" erases the entry from the set. Consequently, "Lookup" may
+/// return NULL while the entry is still live. The entry should be accessible
+/// from another structure, typically a map by physical addresses.
 ///
+/// The number of entries and the number of ways are set at construction.
+/// With a single way, the cache is direct-mapped. There are at least
+/// kMinSetCount sets, and more if needed for every entry to fit in a set.
 ///
 template <class TValue>
 class THashMapCache
@@ -58,7 +62,12 @@ public:
 	///
 	/// Initialization (links the values together)
 	///
-	inline THashMapCache( void );
+	/// \param inCacheSize	number of entries.
+	/// \param inWays		number of ways of each set.
+	///
+	inline THashMapCache(
+				KUInt32 inCacheSize = kDefaultCacheSize,
+				KUInt32 inWays = kDefaultWays );
 	
 	///
 	/// Destruction.
@@ -124,51 +133,105 @@ public:
 			return mLastValue;
 		}
 
+	///
+	/// Accessor on the number of entries.
+	///
+	KUInt32		GetCacheSize( void ) const
+		{
+			return mCacheSize;
+		}
+
+	///
+	/// Accessor on the number of ways of each set.
+	///
+	KUInt32		GetWays( void ) const
+		{
+			return mWays;
+		}
+
 	enum {
-		kCacheSize				= 128,
-		kHashFunctionMask		= 0x000FFC00,
+		kDefaultCacheSize		= 128,
+		kDefaultWays			= 1,
+		kMaxWays				= 16,
+		kMinSetCount			= 1024,
 		kHashFunctionShift		= 10,
-		kHashTableSize			= (kHashFunctionMask >> kHashFunctionShift) + 1,
 	};
 	
 	///
 	/// Hash function.
 	///
-	static inline KUInt32 HashFunction(const KUInt32 val)
+	inline KUInt32 HashFunction(const KUInt32 val) const
 		{
-			return (val & kHashFunctionMask) >> kHashFunctionShift;
+			return (val >> kHashFunctionShift) & mSetMask;
 		}
 
 private:
+	///
+	/// Constructeur par copie volontairement indisponible.
+	///
+	/// \param inCopy		objet  copier
+	///
+	THashMapCache( const THashMapCache& inCopy );
+
+	///
+	/// Oprateur d'assignation volontairement indisponible.
+	///
+	/// \param inCopy		objet  copier
+	///
+	THashMapCache& operator = ( const THashMapCache& inCopy );
+
+	///
+	/// Get the ways of the set of a key.
+	///
+	TValue**	GetSet( KUInt32 inKey ) const
+		{
+			return &mHashTable[HashFunction( inKey ) * mWays];
+		}
+
 	/// \name Variables
 	TValue*		mFirstValue;				///< First element.
 	TValue*		mLastValue;					///< Last element.
-	TValue		mValues[kCacheSize];		///< Values.
-	TValue**	mHashTable;					///< Hash table.
+	TValue*		mValues;					///< Values.
+	TValue**	mHashTable;					///< Hash table, sets of mWays
+											///< entries, most recent first.
+	KUInt32		mCacheSize;					///< Number of values.
+	KUInt32		mWays;						///< Number of ways of each set.
+	KUInt32		mSetMask;					///< Number of sets minus one.
 };
 
 // -------------------------------------------------------------------------- //
-//  * THashMapCache( void )
+//  * THashMapCache( KUInt32, KUInt32 )
 // -------------------------------------------------------------------------- //
 template<class TValue>
-THashMapCache<TValue>::THashMapCache( void )
+THashMapCache<TValue>::THashMapCache( KUInt32 inCacheSize, KUInt32 inWays )
+	:
+		mCacheSize( inCacheSize < 2 ? 2 : inCacheSize ),
+		mWays( inWays < 1 ? 1 : (inWays > (KUInt32) kMaxWays ? (KUInt32) kMaxWays : inWays) )
 {
+	// A power of two of sets, enough for every value.
+	KUInt32 theSetCount = kMinSetCount;
+	while (theSetCount * mWays < mCacheSize) {
+		theSetCount <<= 1;
+	}
+	mSetMask = theSetCount - 1;
+
 	// Init the map.
-	mHashTable = (TValue**) ::calloc(kHashTableSize, sizeof(TValue*));
+	mHashTable = (TValue**) ::calloc(theSetCount * mWays, sizeof(TValue*));
+	mValues = new TValue[mCacheSize];
 
 	// Link the values.
 	mFirstValue = &mValues[0];
 	mValues[0].prev = NULL;
 	mValues[0].next = &mValues[1];
 	KUInt32 indexValue;
-	for (indexValue = 1; indexValue < (kCacheSize - 1); indexValue++) {
+	for (indexValue = 1; indexValue < (mCacheSize - 1); indexValue++) {
 		TValue* theValue = &mValues[indexValue];
 		theValue->prev = &mValues[indexValue - 1];
 		theValue->next = &mValues[indexValue + 1];
 	}
-	mValues[kCacheSize - 1].prev = &mValues[kCacheSize - 2];
-	mValues[kCacheSize - 1].next = NULL;
-	mLastValue = &mValues[kCacheSize - 1];
+	mValues[mCacheSize - 1].prev = &mValues[mCacheSize - 2];
+	mValues[mCacheSize - 1].next = NULL;
+	mLastValue = &mValues[mCacheSize - 1];
 }
 
 // -------------------------------------------------------------------------- //
@@ -179,6 +242,7 @@ THashMapCache<TValue>::~THashMapCache( void )
 {
 	// Free the map.
 	::free(mHashTable);
+	delete [] mValues;
 }
 
 // -------------------------------------------------------------------------- //
@@ -188,8 +252,22 @@ template<class TValue>
 void
 THashMapCache<TValue>::Insert( KUInt32 inKey, TValue* inValue )
 {
-	KUInt32 index = HashFunction( inKey );
-	mHashTable[index] = inValue;
+	TValue** theSet = GetSet( inKey );
+
+	// Find the way to reuse: the same key, a free way or the oldest one.
+	KUInt32 indexWay;
+	for (indexWay = 0; indexWay < mWays - 1; indexWay++) {
+		TValue* theEntry = theSet[indexWay];
+		if ((theEntry == NULL) || (theEntry->key == inKey)) {
+			break;
+		}
+	}
+
+	// Shift the more recent ways and put the value first.
+	for (; indexWay > 0; indexWay--) {
+		theSet[indexWay] = theSet[indexWay - 1];
+	}
+	theSet[0] = inValue;
 }
 
 // -------------------------------------------------------------------------- //
@@ -199,9 +277,21 @@ template<class TValue>
 void
 THashMapCache<TValue>::Erase( KUInt32 inKey )
 {
-	KUInt32 index = HashFunction( inKey );
-	if (mHashTable[index] != NULL && mHashTable[index]->key == inKey) {
-		mHashTable[index] = NULL;
+	TValue** theSet = GetSet( inKey );
+	KUInt32 indexWay;
+	for (indexWay = 0; indexWay < mWays; indexWay++) {
+		TValue* theEntry = theSet[indexWay];
+		if (theEntry == NULL) {
+			break;
+		}
+		if (theEntry->key == inKey) {
+			// Keep the free ways at the end.
+			for (; indexWay < mWays - 1; indexWay++) {
+				theSet[indexWay] = theSet[indexWay + 1];
+			}
+			theSet[mWays - 1] = NULL;
+			break;
+		}
 	}
 }
 
@@ -212,12 +302,28 @@ template<class TValue>
 TValue*
 THashMapCache<TValue>::Lookup( KUInt32 inKey )
 {
-	KUInt32 index = HashFunction( inKey );
-	TValue* theEntry = mHashTable[index];
+	TValue** theSet = GetSet( inKey );
+	TValue* theEntry = theSet[0];
 	if (theEntry && (theEntry->key == inKey))
 	{
 		return theEntry;
 	}
+
+	// Other ways are moved first when they hit.
+	KUInt32 indexWay;
+	for (indexWay = 1; indexWay < mWays; indexWay++) {
+		theEntry = theSet[indexWay];
+		if (theEntry == NULL) {
+			break;
+		}
+		if (theEntry->key == inKey) {
+			for (; indexWay > 0; indexWay--) {
+				theSet[indexWay] = theSet[indexWay - 1];
+			}
+			theSet[0] = theEntry;
+			return theEntry;
+		}
+	}
 	return NULL;
 }
 
@@ -228,7 +334,7 @@ template<class TValue>
 void
 THashMapCache<TValue>::Clear( void )
 {
-	memset(mHashTable, 0, kHashTableSize * sizeof(TValue*));
+	memset(mHashTable, 0, (mSetMask + 1) * mWays * sizeof(TValue*));
 }
 
 // -------------------------------------------------------------------------- //
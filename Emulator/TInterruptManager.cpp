@@ -47,10 +47,13 @@
 
 // Einstein
 #include "Log/TLog.h"
+#include "TMemory.h"
+#include "TMemoryConsts.h"
 
 // -------------------------------------------------------------------------- //
 // Constantes
 // -------------------------------------------------------------------------- //
+static const KUInt32 kMaxIdleTicks = 36864;		// 10 ms at 3.6864 MHz.
 
 // -------------------------------------------------------------------------- //
 //  * TInterruptManager( TLog*, TARMProcessor* )
@@ -61,6 +64,17 @@ TInterruptManager::TInterruptManager( TLog* inLog, TARMProcessor* inProcessor )
 		mProcessor( inProcessor ),
 		mExiting( false ),
 		mWaiting( false ),
+		mIdling( false ),
+		mNextMatch( 0 ),
+		mHasNextMatch( false ),
+		mPollCount( 0 ),
+		mIdleCount( 0 ),
+#if JIT_VIRTUAL_TIME
+		mVirtualInstructions( 0 ),
+		mSliceLength( kMaxSliceTicks << kInstructionsPerTickShift ),
+		mInstructionsLeft( kMaxSliceTicks << kInstructionsPerTickShift ),
+		mFiredTicks( 0 ),
+#endif
 		mMaskIRQ( false ),
 		mMaskFIQ( false ),
 		mIntRaised( 0 ),
@@ -92,6 +106,17 @@ TInterruptManager::TInterruptManager(
 		mProcessor( inProcessor ),
 		mExiting( false ),
 		mWaiting( false ),
+		mIdling( false ),
+		mNextMatch( 0 ),
+		mHasNextMatch( false ),
+		mPollCount( 0 ),
+		mIdleCount( 0 ),
+#if JIT_VIRTUAL_TIME
+		mVirtualInstructions( 0 ),
+		mSliceLength( kMaxSliceTicks << kInstructionsPerTickShift ),
+		mInstructionsLeft( kMaxSliceTicks << kInstructionsPerTickShift ),
+		mFiredTicks( 0 ),
+#endif
 		mMaskIRQ( false ),
 		mMaskFIQ( false ),
 		mIntRaised( 0 ),
@@ -108,6 +133,7 @@ TInterruptManager::TInterruptManager(
 		mTimer( inTimer ),
 		mTimerCondVar( nil ),
 		mEmulatorCondVar( nil ),
+		mIdleCondVar( nil ),
 		mMutex( nil ),
 		mThread( nil )
 {
@@ -143,6 +169,10 @@ TInterruptManager::~TInterruptManager( void )
 	{
 		delete mEmulatorCondVar;
 	}
+	if (mIdleCondVar)
+	{
+		delete mIdleCondVar;
+	}
 	if (mMutex)
 	{
 		delete mMutex;
@@ -163,6 +193,7 @@ TInterruptManager::Init( void )
 
 	mTimerCondVar = new TCondVar();
 	mEmulatorCondVar = new TCondVar();
+	mIdleCondVar = new TCondVar();
 	mMutex = new TMutex();
 
 	mMutex->Lock();
@@ -262,13 +293,27 @@ TInterruptManager::WaitUntilInterrupt( Boolean inMaskIRQ, Boolean inMaskFIQ )
 	mMaskIRQ = inMaskIRQ;
 	mMaskFIQ = inMaskFIQ;
 
-	// Wake the thread now, but it will actually wait until we go to sleep.
-	mTimerCondVar->Signal();
+#if JIT_VIRTUAL_TIME
+	// Jump from match to match until one resumes the processor.
+	Boolean gotAnInterrupt = false;
+	while (mRunning && mHasNextMatch && !gotAnInterrupt)
+	{
+		gotAnInterrupt =
+			SkipVirtualTime( mNextMatch - GetTimeInTicks() );
+	}
 	
-	// Wait for the thread to signal us.
-//	fprintf(stderr, "%i-Emulator-Sleep-4\n", (int) time(NULL));
-	mEmulatorCondVar->Wait(mMutex);
-//	fprintf(stderr, "%i-Emulator-WakeUp-4\n", (int) time(NULL));
+	// Without any match, only the host can raise an interrupt.
+	if (!gotAnInterrupt)
+#endif
+	{
+		// Wake the thread now, but it will actually wait until we go to sleep.
+		mTimerCondVar->Signal();
+		
+		// Wait for the thread to signal us.
+//		fprintf(stderr, "%i-Emulator-Sleep-4\n", (int) time(NULL));
+		mEmulatorCondVar->Wait(mMutex);
+//		fprintf(stderr, "%i-Emulator-WakeUp-4\n", (int) time(NULL));
+	}
 	
 	// We're no longer waiting.
 	mWaiting = false;
@@ -277,6 +322,56 @@ TInterruptManager::WaitUntilInterrupt( Boolean inMaskIRQ, Boolean inMaskFIQ )
 	mMutex->Unlock();
 }
 
+// -------------------------------------------------------------------------- //
+//  * WaitUntilNextMatch( void )
+// -------------------------------------------------------------------------- //
+void
+TInterruptManager::WaitUntilNextMatch( void )
+{
+	mIdleCount++;
+	mMutex->Lock();
+	
+	// Here the timer is waiting (since we have the mutex).
+
+	// Don't wait if the time is suspended or if an interrupt is pending:
+	// the processor may not have taken it yet.
+	if (mRunning && !(mIntRaised & mIntCtrlReg))
+	{
+#if JIT_VIRTUAL_TIME
+		// Move the time forward instead.
+		if (mHasNextMatch)
+		{
+			(void) SkipVirtualTime( mNextMatch - GetTimeInTicks() );
+		} else {
+			(void) SkipVirtualTime( kMaxIdleTicks );
+		}
+#else
+		KUInt32 theTicks = kMaxIdleTicks;
+		if (mHasNextMatch)
+		{
+			KSInt32 theDelta = (KSInt32) (mNextMatch - GetTimeInTicks());
+			if (theDelta <= 0)
+			{
+				theTicks = 0;
+			} else if ((KUInt32) theDelta < theTicks) {
+				theTicks = (KUInt32) theDelta;
+			}
+		}
+		
+		if (theTicks)
+		{
+			// The timer thread signals us when it raises the interrupts.
+			mIdling = true;
+			TicksWaitOnCondVar( mIdleCondVar, theTicks );
+			mIdling = false;
+		}
+#endif
+	}
+
+	// Release the mutex, so the timer thread will get it back.
+	mMutex->Unlock();
+}
+
 // -------------------------------------------------------------------------- //
 //  * RaiseInterrupt( KUInt32 )
 // -------------------------------------------------------------------------- //
@@ -303,7 +398,7 @@ TInterruptManager::RaiseInterrupt( KUInt32 inIntMask )
 KUInt32
 TInterruptManager::GetRealTimeClock( void ) const
 {
-	time_t now = time(NULL);
+	KUInt32 now = GetCalendarSeconds();
 
 	return (KUInt32) (now - mCalendarDelta);
 }
@@ -321,11 +416,11 @@ TInterruptManager::SetRealTimeClock( KUInt32 inValue )
 	// newton = host - delta
 	// delta = host - newton
 //  fprintf(stderr, "mCalendarDelta was %i\n", (int) mCalendarDelta);
-	mCalendarDelta = (KSInt32) (time(NULL) - inValue);
+	mCalendarDelta = (KSInt32) (GetCalendarSeconds() - inValue);
 //  fprintf(stderr, "mCalendarDelta now is %i\n", (int) mCalendarDelta);
 	
-	// Signal the condition variable to wake the timer thread.
-	mTimerCondVar->Signal();
+	// Wake the timer thread (or fire the timers).
+	SignalTimer();
 
 	// Release the mutex, so the timer thread will get it back.
 	mMutex->Unlock();
@@ -345,8 +440,8 @@ TInterruptManager::SetAlarm( KUInt32 inValue )
 	
 	if (mIntCtrlReg & kRTCAlarmIntMask)
 	{
-		// Signal the condition variable to wake the timer thread.
-		mTimerCondVar->Signal();
+		// Wake the timer thread (or fire the timers).
+		SignalTimer();
 	}
 
 	// Release the mutex, so the timer thread will get it back.
@@ -376,8 +471,8 @@ TInterruptManager::SetTimerMatchRegister( KUInt32 inMatchReg, KUInt32 inValue )
 
 	if (mIntCtrlReg & (kTimer0IntMask << inMatchReg))
 	{
-		// Signal the condition variable to wake the timer thread.
-		mTimerCondVar->Signal();
+		// Wake the timer thread (or fire the timers).
+		SignalTimer();
 	}
 
 	// Release the mutex, so the timer thread will get it back.
@@ -399,8 +494,8 @@ TInterruptManager::SetIntCtrlReg( KUInt32 inValue )
 		// Set the control register.
 		mIntCtrlReg = inValue;
 	
-		// Signal the condition variable to wake the timer thread.
-		mTimerCondVar->Signal();
+		// Wake the timer thread (or fire the timers).
+		SignalTimer();
 	}
 
 	// Release the mutex, so the timer thread will get it back.
@@ -422,8 +517,8 @@ TInterruptManager::SetIntEDReg1( KUInt32 inValue )
 		// Set the ED register.
 		mIntEDReg1 = inValue;
 	
-		// Signal the condition variable to wake the timer thread.
-		mTimerCondVar->Signal();
+		// Wake the timer thread (or fire the timers).
+		SignalTimer();
 	}
 
 	// Release the mutex, so the timer thread will get it back.
@@ -445,8 +540,8 @@ TInterruptManager::SetIntEDReg2( KUInt32 inValue )
 		// Set the ED register.
 		mIntEDReg2 = inValue;
 	
-		// Signal the condition variable to wake the timer thread.
-		mTimerCondVar->Signal();
+		// Wake the timer thread (or fire the timers).
+		SignalTimer();
 	}
 
 	// Release the mutex, so the timer thread will get it back.
@@ -468,8 +563,8 @@ TInterruptManager::SetIntEDReg3( KUInt32 inValue )
 		// Set the ED register.
 		mIntEDReg3 = inValue;
 	
-		// Signal the condition variable to wake the timer thread.
-		mTimerCondVar->Signal();
+		// Wake the timer thread (or fire the timers).
+		SignalTimer();
 	}
 
 	// Release the mutex, so the timer thread will get it back.
@@ -489,8 +584,8 @@ TInterruptManager::ClearInterrupts( KUInt32 inMask )
 	// Clear the interrupts.
 	mIntRaised &= ~inMask;
 	
-	// Signal the condition variable to wake the timer thread.
-	mTimerCondVar->Signal();
+	// Wake the timer thread (or fire the timers).
+	SignalTimer();
 
 	// Release the mutex, so the timer thread will get it back.
 	mMutex->Unlock();
@@ -550,6 +645,164 @@ TInterruptManager::ClearGPIO( KUInt32 inValue )
 	mGPIORaised &= ~inValue;
 }
 
+// -------------------------------------------------------------------------- //
+//  * MapRegisters( TMemory* )
+// -------------------------------------------------------------------------- //
+void
+TInterruptManager::MapRegisters( TMemory* inMemory )
+{
+	static const struct {
+		KUInt32						fAddress;
+		KUInt32						fRegister;
+		TMemory::ReadRegisterProc	fRead;
+		TMemory::WriteRegisterProc	fWrite;
+	} kRegisters[] = {
+		{ TMemoryConsts::kHdWr_CalendarReg, kRegCalendar, ReadRegister, WriteRegister },
+		{ TMemoryConsts::kHdWr_AlarmReg, kRegAlarm, ReadRegister, WriteRegister },
+		{ TMemoryConsts::kHdWr_Ticks, kRegTicks, ReadRegister, NULL },
+		{ TMemoryConsts::kHdWr_MatchReg0, kRegMatch0, NULL, WriteRegister },
+		{ TMemoryConsts::kHdWr_MatchReg1, kRegMatch1, NULL, WriteRegister },
+		{ TMemoryConsts::kHdWr_MatchReg2, kRegMatch2, NULL, WriteRegister },
+		{ TMemoryConsts::kHdWr_MatchReg3, kRegMatch3, NULL, WriteRegister },
+		{ TMemoryConsts::kHdWr_IntPresent, kRegIntPresent, ReadRegister, NULL },
+		{ TMemoryConsts::kHdWr_IntCtrlReg, kRegIntCtrl, ReadRegister, WriteRegister },
+		{ TMemoryConsts::kHdWr_IntClear, kRegIntClear, NULL, WriteRegister },
+		{ TMemoryConsts::kHdWr_FIQMaskReg, kRegFIQMask, ReadRegister, WriteRegister },
+		{ TMemoryConsts::kHdWr_IntEDReg1, kRegIntED1, ReadRegister, WriteRegister },
+		{ TMemoryConsts::kHdWr_IntEDReg2, kRegIntED2, ReadRegister, WriteRegister },
+		{ TMemoryConsts::kHdWr_IntEDReg3, kRegIntED3, ReadRegister, WriteRegister },
+		{ TMemoryConsts::kHdWr_GPIO_RReg, kRegGPIORaised, ReadRegister, NULL },
+		{ TMemoryConsts::kHdWr_GPIO_EReg, kRegGPIOCtrl, ReadRegister, WriteRegister },
+		{ TMemoryConsts::kHdWr_GPIO_CReg, kRegGPIOClear, NULL, WriteRegister },
+	};
+
+	KUInt32 indexRegister;
+	for (indexRegister = 0;
+		indexRegister < sizeof(kRegisters) / sizeof(kRegisters[0]);
+		indexRegister++)
+	{
+		inMemory->MapRegisters(
+			kRegisters[indexRegister].fAddress,
+			0,
+			this,
+			kRegisters[indexRegister].fRegister,
+			kRegisters[indexRegister].fRead,
+			kRegisters[indexRegister].fWrite );
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * ReadRegister( void*, KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+KUInt32
+TInterruptManager::ReadRegister(
+			void* inObject,
+			KUInt32 inRegister,
+			KUInt32 /* inAddress */ )
+{
+	TInterruptManager* theManager = (TInterruptManager*) inObject;
+	switch (inRegister)
+	{
+		case kRegCalendar:
+			return theManager->GetRealTimeClock();
+
+		case kRegAlarm:
+			return theManager->GetAlarm();
+
+		case kRegTicks:
+			return theManager->GetTimer();
+
+		case kRegIntPresent:
+			return theManager->GetIntRaised();
+
+		case kRegIntCtrl:
+			return theManager->GetIntCtrlReg();
+
+		case kRegFIQMask:
+			return theManager->GetFIQMask();
+
+		case kRegIntED1:
+			return theManager->GetIntEDReg1();
+
+		case kRegIntED2:
+			return theManager->GetIntEDReg2();
+
+		case kRegIntED3:
+			return theManager->GetIntEDReg3();
+
+		case kRegGPIORaised:
+			return theManager->GetGPIORaised();
+
+		case kRegGPIOCtrl:
+			return theManager->GetGPIOCtrlReg();
+
+		default:
+			return 0;
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * WriteRegister( void*, KUInt32, KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TInterruptManager::WriteRegister(
+			void* inObject,
+			KUInt32 inRegister,
+			KUInt32 /* inAddress */,
+			KUInt32 inValue )
+{
+	TInterruptManager* theManager = (TInterruptManager*) inObject;
+	switch (inRegister)
+	{
+		case kRegCalendar:
+			theManager->SetRealTimeClock( inValue );
+			break;
+
+		case kRegAlarm:
+			theManager->SetAlarm( inValue );
+			break;
+
+		case kRegMatch0:
+		case kRegMatch1:
+		case kRegMatch2:
+		case kRegMatch3:
+			theManager->SetTimerMatchRegister( inRegister - kRegMatch0, inValue );
+			break;
+
+		case kRegIntCtrl:
+			theManager->SetIntCtrlReg( inValue );
+			break;
+
+		case kRegIntClear:
+			theManager->ClearInterrupts( inValue );
+			break;
+
+		case kRegFIQMask:
+			theManager->SetFIQMask( inValue );
+			break;
+
+		case kRegIntED1:
+			theManager->SetIntEDReg1( inValue );
+			break;
+
+		case kRegIntED2:
+			theManager->SetIntEDReg2( inValue );
+			break;
+
+		case kRegIntED3:
+			theManager->SetIntEDReg3( inValue );
+			break;
+
+		case kRegGPIOCtrl:
+			theManager->SetGPIOCtrlReg( inValue );
+			break;
+
+		case kRegGPIOClear:
+			theManager->ClearGPIO( inValue );
+			break;
+	}
+}
+
 // -------------------------------------------------------------------------- //
 //  * Run( void )
 // -------------------------------------------------------------------------- //
@@ -596,34 +849,21 @@ TInterruptManager::Run( void )
 		{
 			// We are running.
 			// How long should we sleep?
-			if (FireTimersAndFindNext( ticks, newTicks, &nextMatch ))
+#if JIT_VIRTUAL_TIME
+			// The emulator thread fires the timers as it retires the
+			// instructions: only raise the interrupts.
+			Boolean hasNextMatch = false;
+#else
+			Boolean hasNextMatch =
+				FireTimersAndFindNext( ticks, newTicks, &nextMatch );
+#endif
+			if (hasNextMatch)
 			{
 				// Shift the ticks.
 				ticks = newTicks;
 
 				// Raise the interrupts.
-				Boolean gotAnInterrupt = false;
-				if (mIntRaised & mIntCtrlReg & mFIQMask)
-				{
-					mProcessor->FIQInterrupt();
-					if ((!mWaiting) || (!mMaskFIQ))
-					{
-						gotAnInterrupt = true;
-					}
-				} else {
-					mProcessor->ClearFIQInterrupt();
-				}
-				
-				if (mIntRaised & mIntCtrlReg & ~mFIQMask)
-				{
-					mProcessor->IRQInterrupt();
-					if ((!mWaiting) || (!mMaskIRQ))
-					{
-						gotAnInterrupt = true;
-					}
-				} else {
-					mProcessor->ClearIRQInterrupt();
-				}
+				Boolean gotAnInterrupt = UpdateProcessorInterrupts();
 				
 				if (gotAnInterrupt && mWaiting)
 				{
@@ -632,38 +872,28 @@ TInterruptManager::Run( void )
 					mEmulatorCondVar->Signal();
 				}
 
+				if (mIdling)
+				{
+					// Resume the processor if it was waiting in an idle
+					// loop: it will poll the registers again.
+					mIdleCondVar->Signal();
+				}
+
 				// Save the timer value.
 				mTimer = newTicks - mTimerDelta;
 
+				// Remember the match for the idle loops.
+				mNextMatch = nextMatch;
+				mHasNextMatch = true;
+
 				// Wait.
-				TicksWaitOnCondVar( nextMatch - newTicks );
+				TicksWaitOnCondVar( mTimerCondVar, nextMatch - newTicks );
 			} else {
 				// Shift the ticks.
 				ticks = newTicks;
 
 				// Raise the interrupts.
-				Boolean gotAnInterrupt = false;
-				if (mIntRaised & mIntCtrlReg & mFIQMask)
-				{
-					mProcessor->FIQInterrupt();
-					if ((!mWaiting) || (!mMaskFIQ))
-					{
-						gotAnInterrupt = true;
-					}
-				} else {
-					mProcessor->ClearFIQInterrupt();
-				}
-				
-				if (mIntRaised & mIntCtrlReg & ~mFIQMask)
-				{
-					mProcessor->IRQInterrupt();
-					if ((!mWaiting) || (!mMaskIRQ))
-					{
-						gotAnInterrupt = true;
-					}
-				} else {
-					mProcessor->ClearIRQInterrupt();
-				}
+				Boolean gotAnInterrupt = UpdateProcessorInterrupts();
 				
 				if (gotAnInterrupt && mWaiting)
 				{
@@ -672,10 +902,20 @@ TInterruptManager::Run( void )
 					mEmulatorCondVar->Signal();
 				}
 
+				if (mIdling)
+				{
+					// Resume the processor if it was waiting in an idle
+					// loop: it will poll the registers again.
+					mIdleCondVar->Signal();
+				}
+
 				// Save the timer value.
 				mTimer = newTicks - mTimerDelta;
 
 				// No interrupt is planned.
+#if !JIT_VIRTUAL_TIME
+				mHasNextMatch = false;
+#endif
 				// Wait forever on the condition variable.
 				mTimerCondVar->Wait(mMutex);
 //				fprintf(stderr, "%i-Timer-WakeUp-1\n", (int) time(NULL));
@@ -729,6 +969,7 @@ TInterruptManager::Run( void )
 	mExiting = false;
 }
 
+#if !JIT_VIRTUAL_TIME
 // -------------------------------------------------------------------------- //
 //  * GetTimeInTicks( void )
 // -------------------------------------------------------------------------- //
@@ -798,6 +1039,21 @@ TInterruptManager::GetTimeInTicks( void )
 	return theResult;
 #endif
 }
+#endif
+
+// -------------------------------------------------------------------------- //
+//  * GetCalendarSeconds( void ) const
+// -------------------------------------------------------------------------- //
+KUInt32
+TInterruptManager::GetCalendarSeconds( void ) const
+{
+#if JIT_VIRTUAL_TIME
+	// Always start at the same date, so runs replay.
+	return kVirtualEpoch + (KUInt32) (GetVirtualTicks() / 3686400);
+#else
+	return (KUInt32) time(NULL);
+#endif
+}
 
 // -------------------------------------------------------------------------- //
 //  * GetTimer( void ) const
@@ -805,6 +1061,8 @@ TInterruptManager::GetTimeInTicks( void )
 KUInt32
 TInterruptManager::GetTimer( void ) const
 {
+	mPollCount.fetch_add( 1, std::memory_order_relaxed );
+
 	// Get the time now and substract with the correction.
 	KUInt32 theResult = GetTimeInTicks() - mTimerDelta;
 //	if (mLog)
@@ -819,10 +1077,10 @@ TInterruptManager::GetTimer( void ) const
 }
 
 // -------------------------------------------------------------------------- //
-//  * TimedWaitOnCondVar( KUInt32 )
+//  * TicksWaitOnCondVar( TCondVar*, KUInt32 )
 // -------------------------------------------------------------------------- //
 inline void
-TInterruptManager::TicksWaitOnCondVar( KUInt32 inTicks )
+TInterruptManager::TicksWaitOnCondVar( TCondVar* inCondVar, KUInt32 inTicks )
 {
 	// Translate from ticks:
 #if 1
@@ -843,7 +1101,7 @@ TInterruptManager::TicksWaitOnCondVar( KUInt32 inTicks )
 #endif
 
 //	fprintf(stderr, "TicksWaitOnCondVar begin (%f)\n", inTicks/4000000.0f);
-	mTimerCondVar->TimedWaitRelative( mMutex, &amount );
+	inCondVar->TimedWaitRelative( mMutex, &amount );
 //	fprintf(stderr, "TicksWaitOnCondVar\n" );
 //	fprintf(stderr, "%i-Timer-WakeUp-3\n", (int) time(NULL));
 }
@@ -1101,6 +1359,118 @@ TInterruptManager::GetNextTimer(
 	}
 }
 
+// -------------------------------------------------------------------------- //
+//  * UpdateProcessorInterrupts( void )
+// -------------------------------------------------------------------------- //
+Boolean
+TInterruptManager::UpdateProcessorInterrupts( void )
+{
+	Boolean gotAnInterrupt = false;
+	if (mIntRaised & mIntCtrlReg & mFIQMask)
+	{
+		mProcessor->FIQInterrupt();
+		if ((!mWaiting) || (!mMaskFIQ))
+		{
+			gotAnInterrupt = true;
+		}
+	} else {
+		mProcessor->ClearFIQInterrupt();
+	}
+	
+	if (mIntRaised & mIntCtrlReg & ~mFIQMask)
+	{
+		mProcessor->IRQInterrupt();
+		if ((!mWaiting) || (!mMaskIRQ))
+		{
+			gotAnInterrupt = true;
+		}
+	} else {
+		mProcessor->ClearIRQInterrupt();
+	}
+	
+	return gotAnInterrupt;
+}
+
+// -------------------------------------------------------------------------- //
+//  * SignalTimer( void )
+// -------------------------------------------------------------------------- //
+void
+TInterruptManager::SignalTimer( void )
+{
+#if JIT_VIRTUAL_TIME
+	// The registers are written by the emulator thread: fire the timers and
+	// raise the interrupts before the next instruction.
+	(void) FireVirtualTimers();
+#else
+	mTimerCondVar->Signal();
+#endif
+}
+
+#if JIT_VIRTUAL_TIME
+// -------------------------------------------------------------------------- //
+//  * FireVirtualTimers( void )
+// -------------------------------------------------------------------------- //
+Boolean
+TInterruptManager::FireVirtualTimers( void )
+{
+	// The current slice ends now.
+	mVirtualInstructions += mSliceLength - mInstructionsLeft;
+	KUInt64 theTicks = mVirtualInstructions >> kInstructionsPerTickShift;
+	KUInt32 theNow = (KUInt32) theTicks;
+
+	KUInt32 theNextMatch;
+	mHasNextMatch =
+		FireTimersAndFindNext( mFiredTicks, theNow, &theNextMatch );
+	mNextMatch = theNextMatch;
+	mFiredTicks = theNow;
+	Boolean gotAnInterrupt = UpdateProcessorInterrupts();
+
+	// The next slice ends at the next match, or a while later.
+	KUInt32 theSliceTicks = kMaxSliceTicks;
+	if (mHasNextMatch && ((theNextMatch - theNow) < theSliceTicks))
+	{
+		theSliceTicks = theNextMatch - theNow;
+	}
+	if (theSliceTicks == 0)
+	{
+		theSliceTicks = 1;
+	}
+	mSliceLength = (KUInt32) (((theTicks + theSliceTicks)
+						<< kInstructionsPerTickShift) - mVirtualInstructions);
+	mInstructionsLeft = mSliceLength;
+	
+	return gotAnInterrupt;
+}
+
+// -------------------------------------------------------------------------- //
+//  * AdvanceVirtualTime( void )
+// -------------------------------------------------------------------------- //
+void
+TInterruptManager::AdvanceVirtualTime( void )
+{
+	mMutex->Lock();
+	
+	(void) FireVirtualTimers();
+	
+	mMutex->Unlock();
+}
+
+// -------------------------------------------------------------------------- //
+//  * SkipVirtualTime( KUInt32 )
+// -------------------------------------------------------------------------- //
+Boolean
+TInterruptManager::SkipVirtualTime( KUInt32 inTicks )
+{
+	// End the slice and start the time at the beginning of the tick.
+	mVirtualInstructions =
+		(GetVirtualTicks() + inTicks) << kInstructionsPerTickShift;
+	mSliceLength = 0;
+	mInstructionsLeft = 0;
+	
+	return FireVirtualTimers();
+}
+#endif
+
 // -------------------------------------------------------------------------- //
 //  * GetSyncedCalendarDelta( void )
 // -------------------------------------------------------------------------- //
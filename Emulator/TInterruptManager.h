@@ -28,12 +28,22 @@
 
 // ANSI C & POSIX
 #include <stdio.h>
+#include <atomic>
 
 // K
 #include <K/Threads/TCondVar.h>
 
+// Derive the time of the emulator from the instructions retired by the JIT
+// instead of the host clock. The timers fire on the emulator thread, so a run
+// goes as fast as the host allows and replays exactly (unless the host raises
+// interrupts, e.g. for the screen or the serial ports).
+#ifndef JIT_VIRTUAL_TIME
+	#define JIT_VIRTUAL_TIME 0
+#endif
+
 class TARMProcessor;
 class TLog;
+class TMemory;
 class TThread;
 class TMutex;
 class TStream;
@@ -160,6 +170,50 @@ public:
 	///
 	void	WaitUntilInterrupt( Boolean inMaskIRQ, Boolean inMaskFIQ );
 
+	///
+	/// Wait until the next timer match, for at most 10 ms.
+	/// This method is called by the JIT when the emulated code spins in a
+	/// loop that polls the timer or interrupt registers. It returns early
+	/// when an interrupt is raised, and at once if the timer is suspended
+	/// or if an enabled interrupt is already raised.
+	///
+	void	WaitUntilNextMatch( void );
+
+	///
+	/// Get and reset the number of reads of the timer and interrupt
+	/// registers.
+	///
+	/// \return the number of reads since the previous call.
+	///
+	KUInt32	TakePollCount( void )
+		{
+			return mPollCount.exchange( 0, std::memory_order_relaxed );
+		}
+
+	///
+	/// Accessor on the number of calls to WaitUntilNextMatch.
+	///
+	/// \return the number of calls since the manager was created.
+	///
+	KUInt32	GetIdleCount( void ) const
+		{
+			return mIdleCount;
+		}
+
+#if JIT_VIRTUAL_TIME
+	///
+	/// Count an instruction retired by the JIT.
+	/// The timers are fired when the time reaches the next match.
+	///
+	void	RetireInstruction( void )
+		{
+			if (--mInstructionsLeft == 0)
+			{
+				AdvanceVirtualTime();
+			}
+		}
+#endif
+
 	///
 	/// Wake the emulator, if it's waiting in the loop.
 	///
@@ -233,6 +287,7 @@ public:
 	///
 	KUInt32	GetIntRaised( void ) const
 		{
+			mPollCount.fetch_add( 1, std::memory_order_relaxed );
 			return mIntRaised;
 		}
 
@@ -345,6 +400,7 @@ public:
 	///
 	KUInt32	GetGPIORaised( void ) const
 		{
+			mPollCount.fetch_add( 1, std::memory_order_relaxed );
 			return mGPIORaised;
 		}
 
@@ -372,6 +428,14 @@ public:
 	///
 	void	ClearGPIO( KUInt32 inIntMask );
 
+	///
+	/// Map the registers of the timer, of the real time clock and of the
+	/// interrupt controller.
+	///
+	/// \param inMemory		memory to map the registers into.
+	///
+	void	MapRegisters( TMemory* inMemory );
+
 	///
 	/// Save or restore the state to or from a stream.
 	///
@@ -402,6 +466,40 @@ private:
 	///
 	void	Init( void );
 
+	/// Hardware registers.
+	enum ERegister {
+		kRegCalendar,
+		kRegAlarm,
+		kRegTicks,
+		kRegMatch0,
+		kRegMatch1,
+		kRegMatch2,
+		kRegMatch3,
+		kRegIntPresent,
+		kRegIntCtrl,
+		kRegIntClear,
+		kRegFIQMask,
+		kRegIntED1,
+		kRegIntED2,
+		kRegIntED3,
+		kRegGPIORaised,
+		kRegGPIOCtrl,
+		kRegGPIOClear
+	};
+
+	///
+	/// Procs for the hardware registers (see TMemory::MapRegisters).
+	///
+	static KUInt32	ReadRegister(
+						void* inObject,
+						KUInt32 inRegister,
+						KUInt32 inAddress );
+	static void		WriteRegister(
+						void* inObject,
+						KUInt32 inRegister,
+						KUInt32 inAddress,
+						KUInt32 inValue );
+
 	///
 	/// Fire and find next interrupts.
 	///
@@ -425,21 +523,89 @@ private:
 								KUInt32 inTimerA,
 								KUInt32 inTimerB );
 
+	///
+	/// Assert or clear the interrupts of the processor depending on the
+	/// interrupts that were raised and that are enabled.
+	/// The mutex must be held.
+	///
+	/// \return \c true if a thread in WaitUntilInterrupt should be resumed.
+	///
+	Boolean	UpdateProcessorInterrupts( void );
+
+	///
+	/// Tell the timer thread that the timers or the interrupts changed.
+	/// With JIT_VIRTUAL_TIME, fire the timers at once instead.
+	/// The mutex must be held.
+	///
+	void	SignalTimer( void );
+
+#if JIT_VIRTUAL_TIME
+	///
+	/// Fire the timers at the current time and start a new slice of
+	/// instructions that ends at the next match.
+	/// The mutex must be held.
+	///
+	/// \return \c true if a thread in WaitUntilInterrupt should be resumed.
+	///
+	Boolean	FireVirtualTimers( void );
+
+	///
+	/// Fire the timers at the end of a slice.
+	///
+	void	AdvanceVirtualTime( void );
+
+	///
+	/// Move the time forward as if the processor had been waiting, and fire
+	/// the timers.
+	/// The mutex must be held.
+	///
+	/// \param inTicks		number of ticks to skip.
+	/// \return \c true if a thread in WaitUntilInterrupt should be resumed.
+	///
+	Boolean	SkipVirtualTime( KUInt32 inTicks );
+
+	///
+	/// Accessor on the number of ticks since the emulator started.
+	///
+	/// \return the ticks derived from the retired instructions.
+	///
+	KUInt64	GetVirtualTicks( void ) const
+		{
+			return (mVirtualInstructions + mSliceLength - mInstructionsLeft)
+				>> kInstructionsPerTickShift;
+		}
+#endif
+
+	///
+	/// Accessor on the time of the calendar (host or virtual).
+	///
+	/// \return the number of seconds since 1/1/1970.
+	///
+	KUInt32	GetCalendarSeconds( void ) const;
+
 	/// \name Platform threading primitives
 
 	///
-	/// Wait for some ticks on the condition variable.
+	/// Wait for some ticks on a condition variable.
 	///
-	/// \param inTicks	number of ticks to sleep.
+	/// \param inCondVar	condition variable to wait on.
+	/// \param inTicks		number of ticks to sleep.
 	///
-	void	TicksWaitOnCondVar( KUInt32 inTicks );
+	void	TicksWaitOnCondVar( TCondVar* inCondVar, KUInt32 inTicks );
 
 	///
 	/// Accessor on the time in ticks.
 	///
 	/// \return the time (any base) in ticks.
 	///
+#if JIT_VIRTUAL_TIME
+	KUInt32	GetTimeInTicks( void ) const
+		{
+			return (KUInt32) GetVirtualTicks();
+		}
+#else
 	static KUInt32	GetTimeInTicks( void );
+#endif
 
 	///
 	/// Get the a calendar delta such that the current RTC is the current
@@ -449,6 +615,15 @@ private:
 	///
 	static KUInt32	GetSyncedCalendarDelta( void );
 
+#if JIT_VIRTUAL_TIME
+	enum {
+		kInstructionsPerTickShift = 5,	///< 32 instructions per tick, about
+										///< 118 MIPS at 3.6864 MHz.
+		kMaxSliceTicks = 36864,			///< 10 ms.
+		kVirtualEpoch = 946684800,		///< January 1st, 2000 (since 1970).
+	};
+
+#endif
 	/// \name Variables
 	TLog*			mLog;				///< Interface for logging.
 	TARMProcessor*	mProcessor;			///< Reference to the processor.
@@ -457,6 +632,20 @@ private:
 										///< destroyed.
 	volatile KUInt32	mWaiting;		///< Whether some thread is waiting
 										///< in WaitUntilInterrupt.
+	volatile KUInt32	mIdling;		///< Whether some thread is waiting
+										///< in WaitUntilNextMatch.
+	KUInt32			mNextMatch;			///< Next timer match (host based).
+	KUInt32			mHasNextMatch;		///< Whether a timer match is planned.
+	mutable std::atomic<KUInt32>	mPollCount;	///< Reads of the timer and
+										///< interrupt registers, from any thread.
+	KUInt32			mIdleCount;			///< Calls to WaitUntilNextMatch.
+#if JIT_VIRTUAL_TIME
+	KUInt64			mVirtualInstructions;	///< Instructions retired before
+										///< the current slice.
+	KUInt32			mSliceLength;		///< Instructions in the slice.
+	KUInt32			mInstructionsLeft;	///< Instructions left in the slice.
+	KUInt32			mFiredTicks;		///< Time the timers were fired at.
+#endif
 	KUInt32			mMaskIRQ;			///< Whether the processor masks IRQ.
 	KUInt32			mMaskFIQ;			///< Whether the processor masks FIQ.
 	KUInt32			mIntRaised;			///< Interrupts that were raised.
@@ -476,6 +665,7 @@ private:
 	KUInt32			mMatchRegisters[4]; ///< Timer match registers (newton).
 	TCondVar*		mTimerCondVar;		///< Condition variable (timer thread).
 	TCondVar*		mEmulatorCondVar;	///< Condition variable (emulator).
+	TCondVar*		mIdleCondVar;		///< Condition variable (idle loops).
 	TMutex*			mMutex;				///< Mutex of the thread.
 	TThread*		mThread;			///< The actual thread.
 };
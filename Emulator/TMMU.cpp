@@ -33,55 +33,34 @@
 // -------------------------------------------------------------------------- //
 // Constantes
 // -------------------------------------------------------------------------- //
-#define kTMMUStats	0
 #define MMUDebug	0
 
-
-#if kTMMUStats
-static KUInt32 gNbHits = 0;				///< Nombre de hits.
-static KUInt32 gNbPerm = 0;				///< Nombre d'erreurs de permission.
-static KUInt32 gNbInvalidate = 0;		///< Nombre d'invalidations.
-static KUInt32 gNbMiss = 0;				///< Nombre de rat�s.
-static KUInt32 gNbHitsTotal = 0;
-static KUInt32 gNbMissTotal = 0;
-
-static void printMMUStats()
-{
-	gNbHitsTotal += gNbHits;
-	gNbMissTotal += gNbMiss;
-	fprintf(
-			stderr,
-			"MMU: Hits: %4i, Miss: %4i, Perm: %4i, Inv: %4i (H/M = %4i:1 Avg: %4i:1)\n",
-			(gNbHits-gNbMiss),
-			gNbMiss,
-			gNbPerm,
-			gNbInvalidate,
-			(gNbHits-gNbMiss)/(gNbMiss+1),
-			(gNbHitsTotal-gNbMissTotal)/(gNbMissTotal+1)
-			);
-	gNbHits = 0;
-	gNbMiss = 0;
-	gNbPerm = 0;
-	gNbInvalidate = 0;
-}
-
-#endif
+// The counters are kept in mStats (see GetStats).
 
 // -------------------------------------------------------------------------- //
-//  * TMMU( TMemory* )
+//  * TMMU( TMemory*, KUInt32 )
 // -------------------------------------------------------------------------- //
-TMMU::TMMU( TMemory* inMemoryIntf )
+TMMU::TMMU( TMemory* inMemoryIntf, KUInt32 inCacheSize /* = 0 */ )
 	:
 		mMemoryIntf( inMemoryIntf ),
 		mMMUEnabled( false ),
 		mCurrentAPMode( kAPMagic_Privileged ),
 		mTTBase( 0 ),
-		mDomainAC( 0xFFFFFFFF )
+		mDomainAC( 0xFFFFFFFF ),
+		mCache(
+			inCacheSize == 0 ? (KUInt32) kDefaultCacheSize
+				: (inCacheSize > kMaxCacheSize ? (KUInt32) kMaxCacheSize
+					: inCacheSize),
+			kWays )
 {
+	ResetStats();
+	ClearBlockCache();
+
 	// Init the cache entries with unprobable values.
 	SEntry* theEntries = mCache.GetValues();
 	KUInt32 indexEntry;
-	for (indexEntry = 0; indexEntry < THashMapCache<SEntry>::kCacheSize; indexEntry++) {
+	KUInt32 theCacheSize = mCache.GetCacheSize();
+	for (indexEntry = 0; indexEntry < theCacheSize; indexEntry++) {
 		SEntry* theEntry = &theEntries[indexEntry];
 		theEntry->key = 1;
 		theEntry->mPhysicalAddress = 1;
@@ -101,12 +80,19 @@ TMMU::~TMMU( void )
 void
 TMMU::SetPrivilege( Boolean inPrivilege )
 {
+	KUInt8 theAPMode = mCurrentAPMode;
 	if (inPrivilege)
 	{
-		mCurrentAPMode |= kAPMagic_Privileged;
+		theAPMode |= kAPMagic_Privileged;
 	} else {
-		mCurrentAPMode &= ~kAPMagic_Privileged;
+		theAPMode &= ~kAPMagic_Privileged;
+	}
+	if (theAPMode == mCurrentAPMode)
+	{
+		// Same permissions, keep the caches.
+		return;
 	}
+	mCurrentAPMode = theAPMode;
 	mCurrentAPRead = (kAPMagic_Bits_Read >> (4 * mCurrentAPMode)) & 0xF;
 	mCurrentAPWrite = (kAPMagic_Bits_Write >> (4 * mCurrentAPMode)) & 0xF;
 	InvalidatePerms();
@@ -118,12 +104,19 @@ TMMU::SetPrivilege( Boolean inPrivilege )
 void
 TMMU::SetSystemProtection( Boolean inProtection )
 {
+	KUInt8 theAPMode = mCurrentAPMode;
 	if (inProtection)
 	{
-		mCurrentAPMode |= kAPMagic_System;
+		theAPMode |= kAPMagic_System;
 	} else {
-		mCurrentAPMode &= ~kAPMagic_System;
+		theAPMode &= ~kAPMagic_System;
+	}
+	if (theAPMode == mCurrentAPMode)
+	{
+		// Same permissions, keep the caches.
+		return;
 	}
+	mCurrentAPMode = theAPMode;
 	mCurrentAPRead = (kAPMagic_Bits_Read >> (4 * mCurrentAPMode)) & 0xF;
 	mCurrentAPWrite = (kAPMagic_Bits_Write >> (4 * mCurrentAPMode)) & 0xF;
 	InvalidatePerms();
@@ -135,12 +128,19 @@ TMMU::SetSystemProtection( Boolean inProtection )
 void
 TMMU::SetROMProtection( Boolean inProtection )
 {
+	KUInt8 theAPMode = mCurrentAPMode;
 	if (inProtection)
 	{
-		mCurrentAPMode |= kAPMagic_ROM;
+		theAPMode |= kAPMagic_ROM;
 	} else {
-		mCurrentAPMode &= ~kAPMagic_ROM;
+		theAPMode &= ~kAPMagic_ROM;
 	}
+	if (theAPMode == mCurrentAPMode)
+	{
+		// Same permissions, keep the caches.
+		return;
+	}
+	mCurrentAPMode = theAPMode;
 	mCurrentAPRead = (kAPMagic_Bits_Read >> (4 * mCurrentAPMode)) & 0xF;
 	mCurrentAPWrite = (kAPMagic_Bits_Write >> (4 * mCurrentAPMode)) & 0xF;
 	InvalidatePerms();
@@ -160,13 +160,6 @@ TMMU::TranslateR( KUInt32 inVAddress, KUInt32& outPAddress )
 	KUInt32 theDomain_times2;
 	KUInt32 theAccessPermissionMask;
 
-#if kTMMUStats
-	if ((gNbHits & 0xFFF) == 0) {
-		printMMUStats();
-	}
-	gNbHits++;
-#endif
-	
 	// Lookup in the cache.
 	KUInt32 pageAddress = inVAddress & TMemoryConsts::kMMUSmallestPageMask;
 	SEntry* theEntry = mCache.Lookup(pageAddress);
@@ -176,37 +169,48 @@ TMMU::TranslateR( KUInt32 inVAddress, KUInt32& outPAddress )
 		// If they are incorrect, fall thru to properly handle the error.
 		theAccessPermissionMask = kAPMagic_Bits_Manager;
 		theDomain_times2 = theEntry->mDomainTimes2;
-		
 		if (mDomainAC & (1 << theDomain_times2))
 		{
 			if (!(mDomainAC & (1 << (theDomain_times2 + 1))))
 			{
 				theAccessPermissionMask = mCurrentAPRead;
 			}
-			
 			if (theAccessPermissionMask & (1 << theEntry->mEntryPermIndex))
 			{
 				outPAddress = theEntry->mPhysicalAddress
 					| (inVAddress & TMemoryConsts::kMMUSmallestPageMaskNeg);
+				mStats.fHits++;
 				return false;
 			}
-#if kTMMUStats
-			else
-				gNbPerm++;
-#endif
 		}
-#if kTMMUStats
-		else
-			gNbPerm++;
-#endif
-	} // if (theEntry)
-	
-#if kTMMUStats
-	else
-		gNbMiss++;
-#endif
+	} else {
+		// Sections and large pages are only in the cache of blocks.
+		SBlockEntry* theBlock =
+			&mBlockCache[(inVAddress >> kBlockCacheShift) & kBlockCacheMask];
+		if ((inVAddress & theBlock->fMask) == theBlock->fVirtualBase)
+		{
+			theAccessPermissionMask = kAPMagic_Bits_Manager;
+			theDomain_times2 = theBlock->fDomainTimes2;
+			if (mDomainAC & (1 << theDomain_times2))
+			{
+				if (!(mDomainAC & (1 << (theDomain_times2 + 1))))
+				{
+					theAccessPermissionMask = mCurrentAPRead;
+				}
+				if (theAccessPermissionMask & (1 << theBlock->fEntryPermIndex))
+				{
+					outPAddress = theBlock->fPhysicalBase
+						| (inVAddress & ~theBlock->fMask);
+					mStats.fBlockHits++;
+					return false;
+				}
+			}
+		}
+	}
+	mStats.fWalks++;
 
 	KUInt32 entryPermIndex = 0;
+	KUInt32 theBlockMask = 0;
 	// Bits 31-20 of target address are catenated with bits 31-14 of the
 	// TTB.
 	Boolean fault = false;
@@ -266,6 +270,7 @@ TMMU::TranslateR( KUInt32 inVAddress, KUInt32& outPAddress )
 					(tableEntry & 0xFFFFFC00)
 					| ((inVAddress & 0x000FF000) >> 10) );
 #endif
+				mStats.fLevel2Walks++;
 				tableEntry = mMemoryIntf->ReadROMRAMP(
 					(tableEntry & 0xFFFFFC00)
 					| ((inVAddress & 0x000FF000) >> 10), fault );
@@ -312,6 +317,7 @@ TMMU::TranslateR( KUInt32 inVAddress, KUInt32& outPAddress )
 #if MMUDebug > 1
 							(void) ::fprintf( stderr, "large page access permission error\n" );
 #endif
+							mStats.fPermissionFaults++;
 							mFaultAddress = inVAddress;
 							mFaultStatus =
 								TMemoryConsts::kFSR_PermissionPage
@@ -320,6 +326,7 @@ TMMU::TranslateR( KUInt32 inVAddress, KUInt32& outPAddress )
 						}
 						outPAddress = (tableEntry & TMemoryConsts::kMMULargePageMask)
 									| (inVAddress & TMemoryConsts::kMMULargePageMaskNeg);
+						theBlockMask = kLargeSubpageMask;
 						break;
 					
 					case 0x02:
@@ -338,6 +345,7 @@ TMMU::TranslateR( KUInt32 inVAddress, KUInt32& outPAddress )
 										(int) entryPermIndex,
 										(unsigned int) theAccessPermissionMask );
 #endif
+							mStats.fPermissionFaults++;
 							mFaultAddress = inVAddress;
 							mFaultStatus =
 								TMemoryConsts::kFSR_PermissionPage
@@ -364,6 +372,7 @@ TMMU::TranslateR( KUInt32 inVAddress, KUInt32& outPAddress )
 
 				if (!(theAccessPermissionMask & (1 << entryPermIndex)))
 				{
+					mStats.fPermissionFaults++;
 					mFaultAddress = inVAddress;
 					mFaultStatus =
 						TMemoryConsts::kFSR_PermissionSection
@@ -372,11 +381,13 @@ TMMU::TranslateR( KUInt32 inVAddress, KUInt32& outPAddress )
 				}
 				outPAddress = (tableEntry & TMemoryConsts::kMMUSectionMask)
 					| (inVAddress & TMemoryConsts::kMMUSectionMaskNeg);
+				theBlockMask = TMemoryConsts::kMMUSectionMask;
 				break;
 			
 			case 0x3:
 				// 11
 				// Fine second level table.
+				mStats.fLevel2Walks++;
 				tableEntry = mMemoryIntf->ReadROMRAMP(
 					(tableEntry & 0xFFFFF000)
 					| ((inVAddress & 0x000FFC00) >> 10), fault );
@@ -417,6 +428,7 @@ TMMU::TranslateR( KUInt32 inVAddress, KUInt32& outPAddress )
 
 						if (!(theAccessPermissionMask & (1 << entryPermIndex)))
 						{
+							mStats.fPermissionFaults++;
 							mFaultAddress = inVAddress;
 							mFaultStatus =
 								TMemoryConsts::kFSR_PermissionPage
@@ -425,6 +437,7 @@ TMMU::TranslateR( KUInt32 inVAddress, KUInt32& outPAddress )
 						}
 						outPAddress = (tableEntry & TMemoryConsts::kMMULargePageMask)
 									| (inVAddress & TMemoryConsts::kMMULargePageMaskNeg);
+						theBlockMask = kLargeSubpageMask;
 						break;
 					
 					case 0x02:
@@ -437,6 +450,7 @@ TMMU::TranslateR( KUInt32 inVAddress, KUInt32& outPAddress )
 								>> subpageIndexShift;
 						if (!(theAccessPermissionMask & (1 << entryPermIndex)))
 						{
+							mStats.fPermissionFaults++;
 							mFaultAddress = inVAddress;
 							mFaultStatus =
 								TMemoryConsts::kFSR_PermissionPage
@@ -453,6 +467,7 @@ TMMU::TranslateR( KUInt32 inVAddress, KUInt32& outPAddress )
 							(tableEntry & 0x00000030) >> 4;
 						if (!(theAccessPermissionMask & (1 << entryPermIndex)))
 						{
+							mStats.fPermissionFaults++;
 							mFaultAddress = inVAddress;
 							mFaultStatus =
 								TMemoryConsts::kFSR_PermissionPage
@@ -476,6 +491,7 @@ TMMU::TranslateR( KUInt32 inVAddress, KUInt32& outPAddress )
 				return true;
 
 			case 0x2:
+				mStats.fPermissionFaults++;
 				mFaultAddress = inVAddress;
 				mFaultStatus =
 					TMemoryConsts::kFSR_DomainSection
@@ -484,6 +500,7 @@ TMMU::TranslateR( KUInt32 inVAddress, KUInt32& outPAddress )
 
 			case 0x1:
 			case 0x3:
+				mStats.fPermissionFaults++;
 				mFaultAddress = inVAddress;
 				mFaultStatus =
 					TMemoryConsts::kFSR_DomainPage
@@ -493,9 +510,10 @@ TMMU::TranslateR( KUInt32 inVAddress, KUInt32& outPAddress )
 	}
 
 	// Add the value to the cache.
-	AddToCache(
-		pageAddress,
-		outPAddress & TMemoryConsts::kMMUSmallestPageMask,
+	AddTranslation(
+		inVAddress,
+		outPAddress,
+		theBlockMask,
 		theDomain_times2,
 		entryPermIndex );
 
@@ -519,13 +537,7 @@ TMMU::TranslateW( KUInt32 inVAddress, KUInt32& outPAddress )
 	KUInt32 theDomain_times2;
 	KUInt32 theAccessPermissionMask;
 	KUInt32 entryPermIndex = 0;
-
-#if kTMMUStats
-	if ((gNbHits & 0xFFF) == 0) {
-		printMMUStats();
-	}
-	gNbHits++;
-#endif
+	KUInt32 theBlockMask = 0;
 
 	// Lookup in the cache.
 	KUInt32 pageAddress = inVAddress & TMemoryConsts::kMMUSmallestPageMask;
@@ -536,35 +548,45 @@ TMMU::TranslateW( KUInt32 inVAddress, KUInt32& outPAddress )
 		// If they are incorrect, fall thru to properly handle the error.
 		theAccessPermissionMask = kAPMagic_Bits_Manager;
 		theDomain_times2 = theEntry->mDomainTimes2;
-		
 		if (mDomainAC & (1 << theDomain_times2))
 		{
 			if (!(mDomainAC & (1 << (theDomain_times2 + 1))))
 			{
 				theAccessPermissionMask = mCurrentAPWrite;
 			}
-			
 			if (theAccessPermissionMask & (1 << theEntry->mEntryPermIndex))
 			{
 				outPAddress = theEntry->mPhysicalAddress
 					| (inVAddress & TMemoryConsts::kMMUSmallestPageMaskNeg);
+				mStats.fHits++;
 				return false;
 			}
-#if kTMMUStats
-			else
-				gNbPerm++;
-#endif
 		}
-#if kTMMUStats
-		else
-			gNbPerm++;
-#endif
-	} // if (theEntry)
-
-#if kTMMUStats
-	else
-		gNbMiss++;
-#endif
+	} else {
+		// Sections and large pages are only in the cache of blocks.
+		SBlockEntry* theBlock =
+			&mBlockCache[(inVAddress >> kBlockCacheShift) & kBlockCacheMask];
+		if ((inVAddress & theBlock->fMask) == theBlock->fVirtualBase)
+		{
+			theAccessPermissionMask = kAPMagic_Bits_Manager;
+			theDomain_times2 = theBlock->fDomainTimes2;
+			if (mDomainAC & (1 << theDomain_times2))
+			{
+				if (!(mDomainAC & (1 << (theDomain_times2 + 1))))
+				{
+					theAccessPermissionMask = mCurrentAPWrite;
+				}
+				if (theAccessPermissionMask & (1 << theBlock->fEntryPermIndex))
+				{
+					outPAddress = theBlock->fPhysicalBase
+						| (inVAddress & ~theBlock->fMask);
+					mStats.fBlockHits++;
+					return false;
+				}
+			}
+		}
+	}
+	mStats.fWalks++;
 
 	// Bits 31-20 of target address are catenated with bits 31-14 of the
 	// TTB.
@@ -624,6 +646,7 @@ TMMU::TranslateW( KUInt32 inVAddress, KUInt32& outPAddress )
 					(tableEntry & 0xFFFFFC00)
 					| ((inVAddress & 0x000FF000) >> 10) );
 #endif
+				mStats.fLevel2Walks++;
 				tableEntry = mMemoryIntf->ReadROMRAMP(
 					(tableEntry & 0xFFFFFC00)
 					| ((inVAddress & 0x000FF000) >> 10), fault );
@@ -670,6 +693,7 @@ TMMU::TranslateW( KUInt32 inVAddress, KUInt32& outPAddress )
 #if MMUDebug > 1
 							(void) ::fprintf( stderr, "large page access permission error\n" );
 #endif
+							mStats.fPermissionFaults++;
 							mFaultAddress = inVAddress;
 							mFaultStatus =
 								TMemoryConsts::kFSR_PermissionPage
@@ -678,6 +702,7 @@ TMMU::TranslateW( KUInt32 inVAddress, KUInt32& outPAddress )
 						}
 						outPAddress = (tableEntry & TMemoryConsts::kMMULargePageMask)
 									| (inVAddress & TMemoryConsts::kMMULargePageMaskNeg);
+						theBlockMask = kLargeSubpageMask;
 						break;
 					
 					case 0x02:
@@ -696,6 +721,7 @@ TMMU::TranslateW( KUInt32 inVAddress, KUInt32& outPAddress )
 										(int) entryPermIndex,
 										(unsigned int) theAccessPermissionMask );
 #endif
+							mStats.fPermissionFaults++;
 							mFaultAddress = inVAddress;
 							mFaultStatus =
 								TMemoryConsts::kFSR_PermissionPage
@@ -722,6 +748,7 @@ TMMU::TranslateW( KUInt32 inVAddress, KUInt32& outPAddress )
 
 				if (!(theAccessPermissionMask & (1 << entryPermIndex)))
 				{
+					mStats.fPermissionFaults++;
 					mFaultAddress = inVAddress;
 					mFaultStatus =
 						TMemoryConsts::kFSR_PermissionSection
@@ -730,11 +757,13 @@ TMMU::TranslateW( KUInt32 inVAddress, KUInt32& outPAddress )
 				}
 				outPAddress = (tableEntry & TMemoryConsts::kMMUSectionMask)
 					| (inVAddress & TMemoryConsts::kMMUSectionMaskNeg);
+				theBlockMask = TMemoryConsts::kMMUSectionMask;
 				break;
 			
 			case 0x3:
 				// 11
 				// Fine second level table.
+				mStats.fLevel2Walks++;
 				tableEntry = mMemoryIntf->ReadROMRAMP(
 					(tableEntry & 0xFFFFF000)
 					| ((inVAddress & 0x000FFC00) >> 10), fault );
@@ -775,6 +804,7 @@ TMMU::TranslateW( KUInt32 inVAddress, KUInt32& outPAddress )
 
 						if (!(theAccessPermissionMask & (1 << entryPermIndex)))
 						{
+							mStats.fPermissionFaults++;
 							mFaultAddress = inVAddress;
 							mFaultStatus =
 								TMemoryConsts::kFSR_PermissionPage
@@ -783,6 +813,7 @@ TMMU::TranslateW( KUInt32 inVAddress, KUInt32& outPAddress )
 						}
 						outPAddress = (tableEntry & TMemoryConsts::kMMULargePageMask)
 									| (inVAddress & TMemoryConsts::kMMULargePageMaskNeg);
+						theBlockMask = kLargeSubpageMask;
 						break;
 					
 					case 0x02:
@@ -795,6 +826,7 @@ TMMU::TranslateW( KUInt32 inVAddress, KUInt32& outPAddress )
 								>> subpageIndexShift;
 						if (!(theAccessPermissionMask & (1 << entryPermIndex)))
 						{
+							mStats.fPermissionFaults++;
 							mFaultAddress = inVAddress;
 							mFaultStatus =
 								TMemoryConsts::kFSR_PermissionPage
@@ -811,6 +843,7 @@ TMMU::TranslateW( KUInt32 inVAddress, KUInt32& outPAddress )
 							(tableEntry & 0x00000030) >> 4;
 						if (!(theAccessPermissionMask & (1 << entryPermIndex)))
 						{
+							mStats.fPermissionFaults++;
 							mFaultAddress = inVAddress;
 							mFaultStatus =
 								TMemoryConsts::kFSR_PermissionPage
@@ -834,6 +867,7 @@ TMMU::TranslateW( KUInt32 inVAddress, KUInt32& outPAddress )
 				return true;
 
 			case 0x2:
+				mStats.fPermissionFaults++;
 				mFaultAddress = inVAddress;
 				mFaultStatus =
 					TMemoryConsts::kFSR_DomainSection
@@ -842,6 +876,7 @@ TMMU::TranslateW( KUInt32 inVAddress, KUInt32& outPAddress )
 
 			case 0x1:
 			case 0x3:
+				mStats.fPermissionFaults++;
 				mFaultAddress = inVAddress;
 				mFaultStatus =
 					TMemoryConsts::kFSR_DomainPage
@@ -851,9 +886,10 @@ TMMU::TranslateW( KUInt32 inVAddress, KUInt32& outPAddress )
 	}
 
 	// Add the value to the cache.
-	AddToCache(
-		pageAddress,
-		outPAddress & TMemoryConsts::kMMUSmallestPageMask,
+	AddTranslation(
+		inVAddress,
+		outPAddress,
+		theBlockMask,
 		theDomain_times2,
 		entryPermIndex );
 
@@ -949,17 +985,62 @@ TMMU::AddToCache(
 	mCache.MakeFirst( theEntry );
 }
 
+// -------------------------------------------------------------------------- //
+//  * AddTranslation( KUInt32, KUInt32, KUInt32, KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TMMU::AddTranslation(
+			KUInt32 inVAddr,
+			KUInt32 inPAddr,
+			KUInt32 inBlockMask,
+			KUInt32 inDomainT2,
+			KUInt32 inEntryPermIndex )
+{
+	if (inBlockMask == 0)
+	{
+		AddToCache(
+			inVAddr & TMemoryConsts::kMMUSmallestPageMask,
+			inPAddr & TMemoryConsts::kMMUSmallestPageMask,
+			inDomainT2,
+			inEntryPermIndex );
+	} else {
+		// A section would take up to 1024 entries of the cache of pages.
+		SBlockEntry* theBlock =
+			&mBlockCache[(inVAddr >> kBlockCacheShift) & kBlockCacheMask];
+		theBlock->fVirtualBase = inVAddr & inBlockMask;
+		theBlock->fMask = inBlockMask;
+		theBlock->fPhysicalBase = inPAddr & inBlockMask;
+		theBlock->fDomainTimes2 = inDomainT2;
+		theBlock->fEntryPermIndex = inEntryPermIndex;
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * ClearBlockCache( void )
+// -------------------------------------------------------------------------- //
+void
+TMMU::ClearBlockCache( void )
+{
+	// An empty entry matches no address.
+	KUInt32 indexBlock;
+	for (indexBlock = 0; indexBlock < kBlockCacheSize; indexBlock++)
+	{
+		mBlockCache[indexBlock].fVirtualBase = 1;
+		mBlockCache[indexBlock].fMask = 0;
+	}
+}
+
 // -------------------------------------------------------------------------- //
 //  * InvalidateTLB( void )
 // -------------------------------------------------------------------------- //
 void
 TMMU::InvalidateTLB( void )
 {
-#if kTMMUStats
-	gNbInvalidate++;
-#endif
+	mStats.fInvalidateTLBs++;
 
 	mCache.Clear();
+	ClearBlockCache();
+	mMemoryIntf->InvalidateSoftTLB();
 	mMemoryIntf->GetJITObject()->InvalidateTLB();
 }
 
@@ -969,7 +1050,10 @@ TMMU::InvalidateTLB( void )
 void
 TMMU::InvalidatePerms( void )
 {
-	mMemoryIntf->GetJITObject()->InvalidateTLB();
+	// Mappings are unchanged, the JIT keeps its bindings.
+	// The software TLB also records the permissions.
+	mMemoryIntf->InvalidateSoftTLB();
+	mMemoryIntf->GetJITObject()->InvalidatePerms();
 }
 
 
@@ -979,10 +1063,6 @@ TMMU::InvalidatePerms( void )
 void
 TMMU::TransferState( TStream* inStream )
 {
-	// Do not load or save any cached data.
-	InvalidateTLB();
-	InvalidatePerms();
-
 	// The various registers.
 	inStream->TransferBoolean( mMMUEnabled );
 	inStream->TransferByte( mCurrentAPMode );
@@ -992,6 +1072,18 @@ TMMU::TransferState( TStream* inStream )
 	inStream->TransferInt32BE( mDomainAC );
 	inStream->TransferInt32BE( mFaultAddress );
 	inStream->TransferInt32BE( mFaultStatus );
+
+	if (inStream->IsReading())
+	{
+		// The permissions follow the restored mode.
+		mCurrentAPRead = (kAPMagic_Bits_Read >> (4 * mCurrentAPMode)) & 0xF;
+		mCurrentAPWrite = (kAPMagic_Bits_Write >> (4 * mCurrentAPMode)) & 0xF;
+	}
+
+	// Do not keep any cached data. This is done once the mode is restored,
+	// so the JIT records it with its bindings.
+	InvalidateTLB();
+	InvalidatePerms();
 }
 
 
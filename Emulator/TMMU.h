@@ -29,6 +29,7 @@
 // ANSI C & POSIX
 #include <limits.h>
 #include <stdio.h>
+#include <string.h>
 
 #if !TARGET_OS_WIN32
 	#include <sys/time.h>
@@ -56,8 +57,10 @@ public:
 	/// Constructor from the memory interface.
 	///
 	/// \param inMemoryIntf	memory interface.
+	/// \param inCacheSize	number of entries of the cache of small pages (0
+	///						for the default).
 	///
-	TMMU( TMemory* inMemoryIntf );
+	TMMU( TMemory* inMemoryIntf, KUInt32 inCacheSize = 0 );
 
 	///
 	/// Destructeur.
@@ -174,6 +177,16 @@ public:
 			return mCurrentAPMode & kAPMagic_ROM;
 		}
 
+	///
+	/// Get the access permission mode (system, ROM and privileged bits).
+	///
+	/// \return the mode, between 0 and 7.
+	///
+	KUInt32		GetAPMode( void ) const
+		{
+			return mCurrentAPMode;
+		}
+
 	///
 	/// Accessor on the translation table base.
 	///
@@ -284,7 +297,54 @@ public:
 	/// Dump the entire MMU Lookup Table to a File
 	///
 	void		FDump(FILE *f);
-	
+
+	///
+	/// Counters of the translations, since the MMU was created or reset.
+	///
+	struct SStats {
+		KUInt32		fHits;				///< Found in the cache of pages.
+		KUInt32		fBlockHits;			///< Found in the cache of sections
+										///< and large pages.
+		KUInt32		fWalks;				///< Walks of the tables (misses and
+										///< cached entries refused by the
+										///< permissions).
+		KUInt32		fLevel2Walks;		///< Walks that read a second level
+										///< table.
+		KUInt32		fPermissionFaults;	///< Permission and domain faults.
+		KUInt32		fInvalidateTLBs;	///< Invalidations of the caches.
+	};
+
+	///
+	/// Accessor on the counters.
+	///
+	const SStats&	GetStats( void ) const
+		{
+			return mStats;
+		}
+
+	///
+	/// Reset the counters.
+	///
+	void		ResetStats( void )
+		{
+			::memset( &mStats, 0, sizeof(mStats) );
+		}
+
+	///
+	/// Accessor on the number of entries of the cache of pages.
+	///
+	KUInt32		GetCacheSize( void ) const
+		{
+			return mCache.GetCacheSize();
+		}
+
+	enum {
+		kDefaultCacheSize	= 256,
+		kMaxCacheSize		= 16384,
+		kWays				= 4,	///< Addresses of a set are 1 MB apart or more.
+		kBlockCacheSize		= 64,	///< Sections and large pages.
+	};
+
 private:
 	///
 	/// New magic.
@@ -315,6 +375,23 @@ private:
 		SEntry*			next;
 	};
 
+	/// Translation of a section or of the 16 KB subpage of a large page,
+	/// which share their permissions. The cache is direct-mapped on the
+	/// megabyte of the virtual address.
+	struct SBlockEntry {
+		KUInt32			fVirtualBase;	///< Virtual address & fMask.
+		KUInt32			fMask;			///< Mask of the block (0 if empty).
+		KUInt32			fPhysicalBase;	///< Physical address & fMask.
+		KUInt32			fDomainTimes2;
+		KUInt32			fEntryPermIndex;
+	};
+
+	enum {
+		kBlockCacheShift	= 20,
+		kBlockCacheMask		= kBlockCacheSize - 1,
+		kLargeSubpageMask	= 0xFFFFC000,	///< AP bits are per 16 KB.
+	};
+
 	///
 	/// Constructeur par copie volontairement indisponible.
 	///
@@ -343,6 +420,28 @@ private:
 				KUInt32 inDomainT2,
 				KUInt32 inEntryPermIndex );
 
+	///
+	/// Add the translation of a section or of a large page to the cache of
+	/// blocks, or of a small or tiny page to the cache of pages.
+	///
+	/// \param inVAddr			translated virtual address.
+	/// \param inPAddr			physical address.
+	/// \param inBlockMask		mask of the block, 0 for a small or tiny page.
+	/// \param inDomainT2		domain * 2.
+	/// \param inEntryPermIndex	AP bits.
+	///
+	inline void	AddTranslation(
+				KUInt32 inVAddr,
+				KUInt32 inPAddr,
+				KUInt32 inBlockMask,
+				KUInt32 inDomainT2,
+				KUInt32 inEntryPermIndex );
+
+	///
+	/// Empty the cache of blocks.
+	///
+	void		ClearBlockCache( void );
+
 	/// \name Variables
 	TMemory*			mMemoryIntf;		///< Interface to the memory.
 	Boolean				mMMUEnabled;		///< If the MMU is currently
@@ -354,7 +453,12 @@ private:
 	KUInt32				mDomainAC;			///< Domain Access Control.
 	KUInt32				mFaultAddress;		///< Address of the last fault.
 	KUInt32				mFaultStatus;		///< Status.
-	THashMapCache<SEntry>	mCache;			///< TLB cache.
+	THashMapCache<SEntry>	mCache;			///< TLB cache of small and tiny
+											///< pages.
+	SBlockEntry			mBlockCache[kBlockCacheSize];
+											///< TLB cache of sections and
+											///< large pages.
+	SStats				mStats;				///< Counters.
 };
 
 #endif
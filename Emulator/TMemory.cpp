@@ -30,6 +30,10 @@
 #include <stdlib.h>
 #include <errno.h>
 
+// ISO C++
+#include <algorithm>
+#include <vector>
+
 #if !TARGET_OS_WIN32
 	#include <sys/time.h>
 	#include <unistd.h>
@@ -97,59 +101,72 @@ const int TMemory::kSerialNumberCRC[256] =
 #define min(a,b) (a) < (b) ? (a) : (b)
 
 // -------------------------------------------------------------------------- //
-//  * TMemory( TLog*, KUInt8*, const char*, KUInt32 )
+//  * TMemory( TLog*, KUInt8*, const char*, KUInt32, KUInt32, KUInt32 )
 // -------------------------------------------------------------------------- //
 TMemory::TMemory(
 			TLog* inLog,
 			KUInt8* inROMImageBuffer,
 			const char* inFlashPath,
-			KUInt32 inRAMSize /* = 4194304 */ )
+			KUInt32 inRAMSize /* = 4194304 */,
+			KUInt32 inJITCacheSize /* = 0 */,
+			KUInt32 inTLBSize /* = 0 */ )
 	:
 		mProcessor( nil ),
 		mLog( inLog ),
 		mFlash( inLog, inFlashPath, NULL ),
 		mROMImagePtr( inROMImageBuffer ),
+		mROMCopy( nil ),
 		mRAM( nil ),
 		mRAMSize( inRAMSize ),
 		mRAMEnd( TMemoryConsts::kRAMStart + inRAMSize ),
-		mMMU( this ),
-		mJIT( this, &mMMU ),
+		mMMU( this, inTLBSize ),
+		mJIT( this, &mMMU, inJITCacheSize ),
 		mBankCtrlRegister( 0 ),
 		mInterruptManager( 0 ),
 		mDMAManager( 0 ),
 		mSerialNumberIx( 64 ),
 		mBPCount( 0 ),
-		mWPCount( 0 )
+		mWPCount( 0 ),
+		mWatchedPages( NULL ),
+		mTLBStamp( kTLBStampStep )
 {
 	Init();
 }
 
 // -------------------------------------------------------------------------- //
-//  * TMemory( TLog*, TROMImage*, const char*, KUInt32 )
+//  * TMemory( TLog*, TROMImage*, const char*, KUInt32, KUInt32, KUInt32 )
 // -------------------------------------------------------------------------- //
 TMemory::TMemory(
 			TLog* inLog,
 			TROMImage* inROMImage,
 			const char* inFlashPath,
-			KUInt32 inRAMSize /* = 4194304 */ )
+			KUInt32 inRAMSize /* = 4194304 */,
+			KUInt32 inJITCacheSize /* = 0 */,
+			KUInt32 inTLBSize /* = 0 */ )
 	:
 		mProcessor( nil ),
 		mLog( inLog ),
 		mFlash( inLog, inFlashPath, inROMImage ),
 		mROMImagePtr( inROMImage->GetPointer() ),
+		mROMCopy( nil ),
 		mRAM( nil ),
 		mRAMSize( inRAMSize ),
 		mRAMEnd( TMemoryConsts::kRAMStart + inRAMSize ),
-		mMMU( this ),
-		mJIT( this, &mMMU ),
+		mMMU( this, inTLBSize ),
+		mJIT( this, &mMMU, inJITCacheSize ),
 		mBankCtrlRegister( 0 ),
 		mInterruptManager( 0 ),
 		mDMAManager( 0 ),
 		mSerialNumberIx( 64 ),
 		mBPCount( 0 ),
-		mWPCount( 0 )
+		mWPCount( 0 ),
+		mWatchedPages( NULL ),
+		mTLBStamp( kTLBStampStep )
 {
 	Init();
+
+	// Reuse the translations of the ROM from a previous launch.
+	mJIT.OpenROMCache( inROMImage );
 }
 
 // -------------------------------------------------------------------------- //
@@ -161,6 +178,22 @@ TMemory::~TMemory( void )
 	{
 		::free( mRAM );
 	}
+
+	if (mROMCopy)
+	{
+		::free( mROMCopy );
+	}
+
+	if (mBreakpoints)
+	{
+		::free( mBreakpoints );
+	}
+	::free( mBPIndex );
+	::free( mWatchpoints );
+	if (mWatchedPages)
+	{
+		::free( mWatchedPages );
+	}
 	
 	int socketsIx;
 	for (socketsIx = 0; socketsIx < kNbSockets; socketsIx++)
@@ -190,12 +223,20 @@ TMemory::SetEmulator( TEmulator* inEmulator )
 			mPCMCIACtrls[socketIx] =
 				new TPCMCIAController( mLog, mEmulator, socketIx );
 		}
+
+		// Hardware registers.
+		UnmapRegisters();
+		MapMemoryRegisters();
+		mInterruptManager->MapRegisters( this );
+		mDMAManager->MapRegisters( this );
+		inEmulator->SerialPorts.MapRegisters( this );
 		
 		ComputeSerialNumber( inEmulator->GetNewtonID() );
 	} else {
 		mInterruptManager = nil;
 		mDMAManager = nil;
 		mEmulator = nil;
+		UnmapRegisters();
 
 		int socketIx;
 		for (socketIx = 0; socketIx < kNbSockets; socketIx++)
@@ -209,6 +250,212 @@ TMemory::SetEmulator( TEmulator* inEmulator )
 	}
 }
 
+// -------------------------------------------------------------------------- //
+//  * MapRegisters( PAddr, KUInt32, void*, KUInt32, ReadRegisterProc, ... )
+// -------------------------------------------------------------------------- //
+void
+TMemory::MapRegisters(
+			PAddr inAddress,
+			KUInt32 inSize,
+			void* inObject,
+			KUInt32 inRegister,
+			ReadRegisterProc inReadProc,
+			WriteRegisterProc inWriteProc )
+{
+	SRegisterHandler theHandler;
+	theHandler.fObject = inObject;
+	theHandler.fRegister = inRegister;
+	if (inSize == 0)
+	{
+		// The register only, not the rest of its page.
+		theHandler.fOffsetMask = (1 << kRegisterPageShift) - 1;
+		theHandler.fOffset = inAddress & theHandler.fOffsetMask;
+	} else {
+		theHandler.fOffsetMask = 0;
+		theHandler.fOffset = 0;
+	}
+	theHandler.fRead = inReadProc;
+	theHandler.fWrite = inWriteProc;
+	theHandler.fReadByte = NULL;
+	theHandler.fWriteByte = NULL;
+	MapHandler( inAddress, inSize, theHandler );
+}
+
+// -------------------------------------------------------------------------- //
+//  * MapByteRegisters( PAddr, KUInt32, void*, KUInt32, ReadRegisterProc, ... )
+// -------------------------------------------------------------------------- //
+void
+TMemory::MapByteRegisters(
+			PAddr inAddress,
+			KUInt32 inSize,
+			void* inObject,
+			KUInt32 inRegister,
+			ReadRegisterProc inReadProc,
+			WriteRegisterProc inWriteProc )
+{
+	SRegisterHandler theHandler;
+	theHandler.fObject = inObject;
+	theHandler.fRegister = inRegister;
+	theHandler.fOffsetMask = 0;
+	theHandler.fOffset = 0;
+	theHandler.fRead = NULL;
+	theHandler.fWrite = NULL;
+	theHandler.fReadByte = inReadProc;
+	theHandler.fWriteByte = inWriteProc;
+	MapHandler( inAddress, inSize, theHandler );
+}
+
+// -------------------------------------------------------------------------- //
+//  * MapHandler( PAddr, KUInt32, const SRegisterHandler& )
+// -------------------------------------------------------------------------- //
+void
+TMemory::MapHandler(
+			PAddr inAddress,
+			KUInt32 inSize,
+			const SRegisterHandler& inHandler )
+{
+	if ((inAddress < TMemoryConsts::kHardwareBase)
+		|| (inAddress + inSize > kRegistersEnd)
+		|| (mRegisterHandlerCount == kMaxRegisterHandlers))
+	{
+		if (mLog)
+		{
+			mLog->FLogLine(
+				"Cannot map hardware registers at P0x%.8X",
+				(unsigned int) inAddress );
+		}
+		return;
+	}
+
+	KUInt32 thePage =
+		(inAddress - TMemoryConsts::kHardwareBase) >> kRegisterPageShift;
+	KUInt32 theEnd = thePage + (inSize >> kRegisterPageShift);
+	if (inSize == 0)
+	{
+		theEnd = thePage + 1;
+	}
+	mRegisterHandlers[mRegisterHandlerCount] = inHandler;
+	for (; thePage < theEnd; thePage++)
+	{
+		mRegisterPages[thePage] = (KUInt8) mRegisterHandlerCount;
+	}
+	mRegisterHandlerCount++;
+}
+
+// -------------------------------------------------------------------------- //
+//  * UnmapRegisters( void )
+// -------------------------------------------------------------------------- //
+void
+TMemory::UnmapRegisters( void )
+{
+	// The first handler is the empty one, it matches any address.
+	(void) ::memset( &mRegisterHandlers[0], 0, sizeof(SRegisterHandler) );
+	mRegisterHandlerCount = 1;
+	(void) ::memset( mRegisterPages, 0, sizeof(mRegisterPages) );
+}
+
+// -------------------------------------------------------------------------- //
+//  * MapMemoryRegisters( void )
+// -------------------------------------------------------------------------- //
+void
+TMemory::MapMemoryRegisters( void )
+{
+	MapRegisters( TMemoryConsts::kHdWr_04RAMSize, 0, this,
+		kRegRAMSize04, ReadMemoryRegister, NULL );
+	MapRegisters( TMemoryConsts::kHdWr_08RAMSize, 0, this,
+		kRegRAMSize08, ReadMemoryRegister, NULL );
+	MapRegisters( TMemoryConsts::kHdWr_PlatformVers, 0, this,
+		kRegPlatformVersion, ReadMemoryRegister, NULL );
+	MapRegisters( TMemoryConsts::kHdWr_HighSpeedClck, 0, this,
+		kRegHighSpeedClock, ReadMemoryRegister, NULL );
+	MapRegisters( TMemoryConsts::kHdWr_P0F18D400, 0, this,
+		kRegPCMCIADoorLock, ReadMemoryRegister, NULL );
+	MapRegisters( TMemoryConsts::kHdWr_ExtDataAbt1, 0, this,
+		kRegExtDataAbort1, ReadMemoryRegister, NULL );
+	MapRegisters( TMemoryConsts::kHdWr_ExtDataAbt2, 0, this,
+		kRegExtDataAbort2, NULL, WriteMemoryRegister );
+	MapRegisters( TMemoryConsts::kHdWr_ExtDataAbt3, 0, this,
+		kRegExtDataAbort3, ReadMemoryRegister, NULL );
+	MapRegisters( TMemoryConsts::kHdWr_BankCtrlReg, 0, this,
+		kRegBankCtrl, ReadMemoryRegister, WriteMemoryRegister );
+	MapRegisters( TMemoryConsts::kROMSerialChip, 0, this,
+		kRegROMSerialChip, ReadMemoryRegister, WriteMemoryRegister );
+}
+
+// -------------------------------------------------------------------------- //
+//  * ReadMemoryRegister( void*, KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+KUInt32
+TMemory::ReadMemoryRegister(
+			void* inObject,
+			KUInt32 inRegister,
+			KUInt32 /* inAddress */ )
+{
+	TMemory* theMemory = (TMemory*) inObject;
+	switch (inRegister)
+	{
+		case kRegRAMSize04:
+			{
+				KUInt32 thePageCount = (theMemory->mRAMSize >> 16) & 0xFF;
+				return
+					(thePageCount << 24)
+					| (thePageCount << 16)
+					| thePageCount;
+			}
+
+		case kRegPlatformVersion:
+			return theMemory->mEmulator->GetPlatformManager()->GetVersion();
+
+		case kRegHighSpeedClock:
+			return TMemoryConsts::kHighSpeedClockVal;
+
+		case kRegPCMCIADoorLock:
+			return 0xffffffff; // PCMCIA Door Locked?
+
+		case kRegBankCtrl:
+			return theMemory->mBankCtrlRegister;
+
+		case kRegROMSerialChip:
+			{
+				KUInt32 bit;
+				KUInt32 theIndex = theMemory->mSerialNumberIx;
+				if (theIndex == 64)
+				{
+					bit = 0;
+				} else if (theIndex >= 32) {
+					bit = theMemory->mSerialNumber[0] >> (theIndex - 32);
+				} else {
+					bit = theMemory->mSerialNumber[1] >> theIndex;
+				}
+				theMemory->mSerialNumberIx = (theIndex + 1) % 65;
+				bit = bit & 0x1;
+				return (bit << 1);
+			}
+
+		default:
+			// RAM size of the second bank, external data aborts.
+			return 0;
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * WriteMemoryRegister( void*, KUInt32, KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TMemory::WriteMemoryRegister(
+			void* inObject,
+			KUInt32 inRegister,
+			KUInt32 /* inAddress */,
+			KUInt32 inValue )
+{
+	TMemory* theMemory = (TMemory*) inObject;
+	if (inRegister == kRegBankCtrl)
+	{
+		theMemory->mBankCtrlRegister = inValue;
+	}
+	// The external data abort and the serial chip are ignored.
+}
+
 // -------------------------------------------------------------------------- //
 //  * GetDirectPointerToRAM( VAddr, KUInt8** )
 // -------------------------------------------------------------------------- //
@@ -319,15 +566,8 @@ TMemory::FastReadBuffer( VAddr inAddress, KUInt32 inAmount, KUInt8* outBuffer )
 		do {
 			KUInt32 amount = min(alignedLen, maxCopy);
 #if TARGET_RT_LITTLE_ENDIAN
-			{
-				KUInt32 nbWords = amount / 4;
-				KUInt32* dstCrsr = (KUInt32*) dst;
-				KUInt32* srcCrsr = (KUInt32*) pointer;
-				while (nbWords-- > 0)
-				{
-					*dstCrsr++ = UByteSex_ToBigEndian(*srcCrsr++);
-				}
-			}
+			UByteSex::SwapArray(
+				(KUInt32*) dst, (const KUInt32*) pointer, amount / 4 );
 #else
 			(void) ::memcpy(dst, pointer, amount);
 #endif
@@ -550,15 +790,8 @@ TMemory::FastWriteBuffer( VAddr inAddress, KUInt32 inAmount, const KUInt8* inBuf
 		do {
 			KUInt32 amount = min(alignedLen, maxCopy);
 #if TARGET_RT_LITTLE_ENDIAN
-			{
-				KUInt32 nbWords = amount / 4;
-				KUInt32* dstCrsr = (KUInt32*) pointer;
-				KUInt32* srcCrsr = (KUInt32*) src;
-				while (nbWords-- > 0)
-				{
-					*dstCrsr++ = UByteSex_ToBigEndian(*srcCrsr++);
-				}
-			}
+			UByteSex::SwapArray(
+				(KUInt32*) pointer, (const KUInt32*) src, amount / 4 );
 #else
 			(void) ::memcpy(pointer, src, amount);
 #endif
@@ -690,13 +923,7 @@ Boolean
 TMemory::Read( VAddr inAddress, KUInt32& outWord )
 {
 #ifdef _DEBUG
-	int i;
-	for (i=0; i<mWPCount; i++) {
-		if ((mWatchpoints[i].fAddress==inAddress) && (mWatchpoints[i].fMode&1)) {
-			fprintf(stderr, "Watchpoint 0x%08X read around 0x%08X\n", (unsigned int)inAddress, (unsigned int)mProcessor->mCurrentRegisters[15]);
-			mEmulator->BreakInMonitor();
-		}
-	}
+	CheckWatchpoint( inAddress, 1 );
 #endif
 	
 	PAddr theAddress;
@@ -719,6 +946,7 @@ TMemory::Read( VAddr inAddress, KUInt32& outWord )
 		mMMU.SetHardwareFault( inAddress );
 		return true;
 	}
+	FillSoftTLB( false, inAddress, theAddress );
 	
 	return false;
 }
@@ -730,13 +958,7 @@ Boolean
 TMemory::ReadAligned( VAddr inAddress, KUInt32& outWord )
 {
 #ifdef _DEBUG
-	int i;
-	for (i=0; i<mWPCount; i++) {
-		if ((mWatchpoints[i].fAddress==inAddress) && (mWatchpoints[i].fMode&1)) {
-			fprintf(stderr, "Watchpoint 0x%08X read around 0x%08X\n", (unsigned int)inAddress, (unsigned int)mProcessor->mCurrentRegisters[15]);
-			mEmulator->BreakInMonitor();
-		}
-	}
+	CheckWatchpoint( inAddress, 1 );
 #endif
 
 	PAddr theAddress;
@@ -770,13 +992,7 @@ inline Boolean
 TMemory::ReadROMRAM( VAddr inAddress, KUInt32& outWord )
 {
 #ifdef _DEBUG
-	int i;
-	for (i=0; i<mWPCount; i++) {
-		if ((mWatchpoints[i].fAddress==inAddress) && (mWatchpoints[i].fMode&1)) {
-			fprintf(stderr, "Watchpoint 0x%08X read around 0x%08X\n", (unsigned int)inAddress, (unsigned int)mProcessor->mCurrentRegisters[15]);
-			mEmulator->BreakInMonitor();
-		}
-	}
+	CheckWatchpoint( inAddress, 1 );
 #endif
 
 	PAddr theAddress;
@@ -882,111 +1098,9 @@ TMemory::ReadP( PAddr inAddress, Boolean& outFault )
 		}
 		// mEmulator->BreakInMonitor();
 		return 0;
-	} else if (inAddress < TMemoryConsts::kExternalSerialBase) {
-		// Bank #3
-		if (inAddress == TMemoryConsts::kHdWr_04RAMSize) {
-			KUInt32 thePageCount = (mRAMSize >> 16) & 0xFF;
-			return
-				(thePageCount << 24)
-				| (thePageCount << 16)
-				| thePageCount;
-		} else if (inAddress == TMemoryConsts::kHdWr_08RAMSize) {
-			return 0;
-		} else if ((inAddress >= TMemoryConsts::kHdWr_DMAChan1Base)
-			&& (inAddress < TMemoryConsts::kHdWr_DMAChan1End)) {
-			KUInt32 channel = (inAddress - TMemoryConsts::kHdWr_DMAChan1Base) >> 13;
-			KUInt32 reg = (inAddress & 0x1C00) >> 10;
-			return mDMAManager->ReadChannel1Register( channel, reg );
-		} else if ((inAddress >= TMemoryConsts::kHdWr_DMAChan2Base)
-			&& (inAddress < TMemoryConsts::kHdWr_DMAChan2End)) {
-			KUInt32 channel = (inAddress - TMemoryConsts::kHdWr_DMAChan2Base) >> 12;
-			KUInt32 reg = (inAddress & 0x0C00) >> 10;
-			return mDMAManager->ReadChannel2Register( channel, reg );
-		} else if (inAddress == TMemoryConsts::kHdWr_DMAAssgmnt) {
-			return mDMAManager->ReadChannelAssignmentRegister();
-		} else if (inAddress == TMemoryConsts::kHdWr_DMAEnableStat) {
-			return mDMAManager->ReadStatusRegister();
-		} else if (inAddress == TMemoryConsts::kHdWr_DMAWordStat) {
-			return mDMAManager->ReadWordStatusRegister();
-		} else if (inAddress == TMemoryConsts::kHdWr_HighSpeedClck) {
-			return TMemoryConsts::kHighSpeedClockVal;
-		} else if (inAddress == TMemoryConsts::kHdWr_CalendarReg) {
-			return mInterruptManager->GetRealTimeClock();
-		} else if (inAddress == TMemoryConsts::kHdWr_AlarmReg) {
-			return mInterruptManager->GetAlarm();
-		} else if (inAddress == TMemoryConsts::kHdWr_Ticks) {
-			return mInterruptManager->GetTimer();
-		} else if (inAddress == TMemoryConsts::kHdWr_IntPresent) {
-			return mInterruptManager->GetIntRaised();
-		} else if (inAddress == TMemoryConsts::kHdWr_IntCtrlReg) {
-			return mInterruptManager->GetIntCtrlReg();
-		} else if (inAddress == TMemoryConsts::kHdWr_FIQMaskReg) {
-			return mInterruptManager->GetFIQMask();
-		} else if (inAddress == TMemoryConsts::kHdWr_IntEDReg1) {
-			return mInterruptManager->GetIntEDReg1();
-		} else if (inAddress == TMemoryConsts::kHdWr_IntEDReg2) {
-			return mInterruptManager->GetIntEDReg2();
-		} else if (inAddress == TMemoryConsts::kHdWr_IntEDReg3) {
-			return mInterruptManager->GetIntEDReg3();
-		} else if (inAddress == TMemoryConsts::kHdWr_GPIO_RReg) {
-			return mInterruptManager->GetGPIORaised();
-		} else if (inAddress == TMemoryConsts::kHdWr_GPIO_EReg) {
-			return mInterruptManager->GetGPIOCtrlReg();
-		} else if (inAddress == TMemoryConsts::kHdWr_P0F18D400) {
-			return 0xffffffff; // PCMCIA Door Locked?
-		} else if (inAddress == TMemoryConsts::kHdWr_PlatformVers) {
-			return mEmulator->GetPlatformManager()->GetVersion();
-		} else {
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Read word access to unknown bank #3 at P0x%.8X",
-					(unsigned int) inAddress );
-			}
-			// mEmulator->BreakInMonitor();
-			return 0;
-		}
-	} else if (inAddress < TMemoryConsts::kSerialEnd) {
-		// Serial bank
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Read word access to serial bank at P0x%.8X",
-				(unsigned int) inAddress );
-		}
-		// mEmulator->BreakInMonitor();
-		return 0;
 	} else if (inAddress < TMemoryConsts::kFlashBank2) {
-		// Bank #4
-		if (inAddress == TMemoryConsts::kHdWr_ExtDataAbt1) {
-			return 0;
-		} else if (inAddress == TMemoryConsts::kHdWr_ExtDataAbt3) {
-			return 0;
-		} else if (inAddress == TMemoryConsts::kHdWr_BankCtrlReg) {
-			return mBankCtrlRegister;
-		} else if (inAddress == TMemoryConsts::kROMSerialChip) {
-			KUInt32 bit;
-			if (mSerialNumberIx == 64)
-			{
-				bit = 0;
-			} else if (mSerialNumberIx >= 32) {
-				bit = mSerialNumber[0] >> (mSerialNumberIx - 32);
-			} else {
-				bit = mSerialNumber[1] >> mSerialNumberIx;
-			}
-			mSerialNumberIx = (mSerialNumberIx + 1) % 65;
-			bit = bit & 0x1;
-			return (bit << 1);
-		} else {
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Read word access to unknown bank #4 at P0x%.8X",
-					(unsigned int) inAddress );
-			}
-			// mEmulator->BreakInMonitor();
-			return 0;
-		}
+		// Banks #3 and #4, serial ports.
+		return ReadRegister( inAddress );
 	} else if (inAddress < TMemoryConsts::kFlashBank2End) {
 		KUInt32 theResult = mFlash.Read(
 								inAddress - TMemoryConsts::kFlashBank2,
@@ -1009,30 +1123,13 @@ TMemory::ReadP( PAddr inAddress, Boolean& outFault )
 				(unsigned int) inAddress );
 		}
 		return 0;
-	} else if (inAddress < TMemoryConsts::kPCMCIA1Base) {
-#if kNbSockets > 0
-		return mPCMCIACtrls[0]->Read( inAddress - TMemoryConsts::kPCMCIA0Base );
-#else
-		return 0;
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA2Base) {
-#if kNbSockets > 1
-		return mPCMCIACtrls[1]->Read( inAddress - TMemoryConsts::kPCMCIA1Base );
-#else
-		return 0;
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA3Base) {
-#if kNbSockets > 2
-		return mPCMCIACtrls[2]->Read( inAddress - TMemoryConsts::kPCMCIA2Base );
-#else
-		return 0;
-#endif
 	} else if (inAddress < TMemoryConsts::kPCMCIA3End) {
-#if kNbSockets > 3
-		return mPCMCIACtrls[3]->Read( inAddress - TMemoryConsts::kPCMCIA3Base );
-#else
+		TPCMCIAController* theController = GetSocketController( inAddress );
+		if (theController)
+		{
+			return theController->Read( inAddress & kSocketOffsetMask );
+		}
 		return 0;
-#endif
 	} else {
 		if (mLog)
 		{
@@ -1103,109 +1200,9 @@ TMemory::ReadPAligned( PAddr inAddress, Boolean& outFault )
 		}
 		// mEmulator->BreakInMonitor();
 		return 0;
-	} else if (inAddress < TMemoryConsts::kExternalSerialBase) {
-		// Bank #3
-		if (inAddress == TMemoryConsts::kHdWr_04RAMSize) {
-			KUInt32 thePageCount = (mRAMSize >> 16) & 0xFF;
-			return
-				(thePageCount << 24)
-				| (thePageCount << 16)
-				| thePageCount;
-		} else if (inAddress == TMemoryConsts::kHdWr_08RAMSize) {
-			return 0;
-		} else if ((inAddress >= TMemoryConsts::kHdWr_DMAChan1Base)
-			&& (inAddress < TMemoryConsts::kHdWr_DMAChan1End)) {
-			KUInt32 channel = (inAddress - TMemoryConsts::kHdWr_DMAChan1Base) >> 13;
-			KUInt32 reg = (inAddress & 0x1C00) >> 10;
-			return mDMAManager->ReadChannel1Register( channel, reg );
-		} else if ((inAddress >= TMemoryConsts::kHdWr_DMAChan2Base)
-			&& (inAddress < TMemoryConsts::kHdWr_DMAChan2End)) {
-			KUInt32 channel = (inAddress - TMemoryConsts::kHdWr_DMAChan2Base) >> 12;
-			KUInt32 reg = (inAddress & 0x0C00) >> 10;
-			return mDMAManager->ReadChannel2Register( channel, reg );
-		} else if (inAddress == TMemoryConsts::kHdWr_DMAAssgmnt) {
-			return mDMAManager->ReadChannelAssignmentRegister();
-		} else if (inAddress == TMemoryConsts::kHdWr_DMAEnableStat) {
-			return mDMAManager->ReadStatusRegister();
-		} else if (inAddress == TMemoryConsts::kHdWr_DMAWordStat) {
-			return mDMAManager->ReadWordStatusRegister();
-		} else if (inAddress == TMemoryConsts::kHdWr_HighSpeedClck) {
-			return TMemoryConsts::kHighSpeedClockVal;
-		} else if (inAddress == TMemoryConsts::kHdWr_CalendarReg) {
-			return mInterruptManager->GetRealTimeClock();
-		} else if (inAddress == TMemoryConsts::kHdWr_AlarmReg) {
-			return mInterruptManager->GetAlarm();
-		} else if (inAddress == TMemoryConsts::kHdWr_Ticks) {
-			return mInterruptManager->GetTimer();
-		} else if (inAddress == TMemoryConsts::kHdWr_IntPresent) {
-			return mInterruptManager->GetIntRaised();
-		} else if (inAddress == TMemoryConsts::kHdWr_IntCtrlReg) {
-			return mInterruptManager->GetIntCtrlReg();
-		} else if (inAddress == TMemoryConsts::kHdWr_FIQMaskReg) {
-			return mInterruptManager->GetFIQMask();
-		} else if (inAddress == TMemoryConsts::kHdWr_IntEDReg1) {
-			return mInterruptManager->GetIntEDReg1();
-		} else if (inAddress == TMemoryConsts::kHdWr_IntEDReg2) {
-			return mInterruptManager->GetIntEDReg2();
-		} else if (inAddress == TMemoryConsts::kHdWr_IntEDReg3) {
-			return mInterruptManager->GetIntEDReg3();
-		} else if (inAddress == TMemoryConsts::kHdWr_GPIO_RReg) {
-			return mInterruptManager->GetGPIORaised();
-		} else if (inAddress == TMemoryConsts::kHdWr_GPIO_EReg) {
-			return mInterruptManager->GetGPIOCtrlReg();
-		} else if (inAddress == TMemoryConsts::kHdWr_PlatformVers) {
-			return mEmulator->GetPlatformManager()->GetVersion();
-		} else {
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Read word access to unknown bank #3 at P0x%.8X",
-					(unsigned int) inAddress );
-			}
-			// mEmulator->BreakInMonitor();
-			return 0;
-		}
-	} else if (inAddress < TMemoryConsts::kSerialEnd) {
-		// Serial bank
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Read word access to serial bank at P0x%.8X",
-				(unsigned int) inAddress );
-		}
-		// mEmulator->BreakInMonitor();
-		return 0;
 	} else if (inAddress < TMemoryConsts::kFlashBank2) {
-		// Bank #4
-		if (inAddress == TMemoryConsts::kHdWr_ExtDataAbt1) {
-			return 0;
-		} else if (inAddress == TMemoryConsts::kHdWr_ExtDataAbt3) {
-			return 0;
-		} else if (inAddress == TMemoryConsts::kHdWr_BankCtrlReg) {
-			return mBankCtrlRegister;
-		} else if (inAddress == TMemoryConsts::kROMSerialChip) {
-			KUInt32 bit;
-			if (mSerialNumberIx == 64)
-			{
-				bit = 0;
-			} else if (mSerialNumberIx >= 32) {
-				bit = mSerialNumber[0] >> (mSerialNumberIx - 32);
-			} else {
-				bit = mSerialNumber[1] >> mSerialNumberIx;
-			}
-			mSerialNumberIx = (mSerialNumberIx + 1) % 65;
-			bit = bit & 0x1;
-			return (bit << 1);
-		} else {
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Read word access to unknown bank #4 at P0x%.8X",
-					(unsigned int) inAddress );
-			}
-			// mEmulator->BreakInMonitor();
-			return 0;
-		}
+		// Banks #3 and #4, serial ports.
+		return ReadRegister( inAddress );
 	} else if (inAddress < TMemoryConsts::kFlashBank2End) {
 		KUInt32 theResult = mFlash.Read(
 								inAddress - TMemoryConsts::kFlashBank2,
@@ -1228,30 +1225,13 @@ TMemory::ReadPAligned( PAddr inAddress, Boolean& outFault )
 				(unsigned int) inAddress );
 		}
 		return 0;
-	} else if (inAddress < TMemoryConsts::kPCMCIA1Base) {
-#if kNbSockets > 0
-		return mPCMCIACtrls[0]->Read( inAddress - TMemoryConsts::kPCMCIA0Base );
-#else
-		return 0;
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA2Base) {
-#if kNbSockets > 1
-		return mPCMCIACtrls[1]->Read( inAddress - TMemoryConsts::kPCMCIA1Base );
-#else
-		return 0;
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA3Base) {
-#if kNbSockets > 2
-		return mPCMCIACtrls[2]->Read( inAddress - TMemoryConsts::kPCMCIA2Base );
-#else
-		return 0;
-#endif
 	} else if (inAddress < TMemoryConsts::kPCMCIA3End) {
-#if kNbSockets > 3
-		return mPCMCIACtrls[3]->Read( inAddress - TMemoryConsts::kPCMCIA3Base );
-#else
+		TPCMCIAController* theController = GetSocketController( inAddress );
+		if (theController)
+		{
+			return theController->Read( inAddress & kSocketOffsetMask );
+		}
 		return 0;
-#endif
 	} else {
 		if (mLog)
 		{
@@ -1332,13 +1312,7 @@ Boolean
 TMemory::ReadB( VAddr inAddress, KUInt8& outByte )
 {
 #ifdef _DEBUG
-	int i;
-	for (i=0; i<mWPCount; i++) {
-		if ((mWatchpoints[i].fAddress==inAddress) && (mWatchpoints[i].fMode&1)) {
-			fprintf(stderr, "Watchpoint 0x%08X read around 0x%08X\n", (unsigned int)inAddress, (unsigned int)mProcessor->mCurrentRegisters[15]);
-			mEmulator->BreakInMonitor();
-		}
-	}
+	CheckWatchpoint( inAddress, 1 );
 #endif
 
 	PAddr theAddress;
@@ -1358,6 +1332,7 @@ TMemory::ReadB( VAddr inAddress, KUInt8& outByte )
 		mMMU.SetHardwareFault( inAddress );
 		return true;
 	}
+	FillSoftTLB( false, inAddress, theAddress );
 	
 	return false;
 }
@@ -1425,39 +1400,9 @@ TMemory::ReadBP( PAddr inAddress, KUInt8& outByte )
 		}
 		// mEmulator->BreakInMonitor();
 		outByte = 0;
-	} else if (inAddress < TMemoryConsts::kExternalSerialBase) {
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Read byte access to unknown bank #3 at P0x%.8X",
-				(unsigned int) inAddress );
-		}
-		// mEmulator->BreakInMonitor();
-		outByte = 0;
-	} else if (inAddress < TMemoryConsts::kSerialEnd) {
-		if (inAddress < TMemoryConsts::kInfraredSerialBase)
-		{
-			TSerialPortManager *driver = mEmulator->SerialPorts.GetDriverFor(TSerialPorts::kExtr);
-			outByte = driver->ReadRegister(inAddress - TMemoryConsts::kExternalSerialBase );
-		} else if (inAddress < TMemoryConsts::kBuiltInSerialBase) {
-			TSerialPortManager *driver = mEmulator->SerialPorts.GetDriverFor(TSerialPorts::kInfr);
-			outByte = driver->ReadRegister(inAddress - TMemoryConsts::kInfraredSerialBase );
-		} else if (inAddress < TMemoryConsts::kModemSerialBase) {
-			TSerialPortManager *driver = mEmulator->SerialPorts.GetDriverFor(TSerialPorts::kTblt);
-			outByte = driver->ReadRegister(inAddress - TMemoryConsts::kBuiltInSerialBase );
-		} else {
-			TSerialPortManager *driver = mEmulator->SerialPorts.GetDriverFor(TSerialPorts::kMdem);
-			outByte = driver->ReadRegister(inAddress - TMemoryConsts::kModemSerialBase );
-		}
 	} else if (inAddress < TMemoryConsts::kFlashBank2) {
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Read byte access to unknown bank #4 at P0x%.8X",
-				(unsigned int) inAddress );
-		}
-		// mEmulator->BreakInMonitor();
-		outByte = 0;
+		// Banks #3 and #4, serial ports.
+		outByte = ReadByteRegister( inAddress );
 	} else if (inAddress < TMemoryConsts::kFlashBank2End) {
 		outByte = mFlash.ReadB( inAddress - TMemoryConsts::kFlashBank2, 1 );
 #if debugFlash
@@ -1478,57 +1423,9 @@ TMemory::ReadBP( PAddr inAddress, KUInt8& outByte )
 		}
 		// mEmulator->BreakInMonitor();
 		outByte = 0;
-	} else if (inAddress < TMemoryConsts::kPCMCIA1Base) {
-#if kNbSockets > 0
-		if (mPCMCIACtrls[0] == NULL) {
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Read byte access to PCMCIA with missing controller, at P0x%.8X",
-					(unsigned int) inAddress );
-			}
-			outByte = 0;
-		} else {
-			outByte = mPCMCIACtrls[0]->ReadB( inAddress - TMemoryConsts::kPCMCIA0Base );
-		}
-#else
-		outByte = 0;
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA2Base) {
-#if kNbSockets > 1
-		if (mPCMCIACtrls[1] == NULL) {
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Read byte access to PCMCIA with missing controller, at P0x%.8X",
-					(unsigned int) inAddress );
-			}
-			outByte = 0;
-		} else {
-			outByte = mPCMCIACtrls[1]->ReadB( inAddress - TMemoryConsts::kPCMCIA1Base );
-		}
-#else
-		outByte = 0;
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA3Base) {
-#if kNbSockets > 2
-		if (mPCMCIACtrls[2] == NULL) {
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Read byte access to PCMCIA with missing controller, at P0x%.8X",
-					(unsigned int) inAddress );
-			}
-			outByte = 0;
-		} else {
-			outByte = mPCMCIACtrls[2]->ReadB( inAddress - TMemoryConsts::kPCMCIA2Base );
-		}
-#else
-		outByte = 0;
-#endif
 	} else if (inAddress < TMemoryConsts::kPCMCIA3End) {
-#if kNbSockets > 3
-		if (mPCMCIACtrls[3] == NULL) {
+		TPCMCIAController* theController = GetSocketController( inAddress );
+		if (theController == NULL) {
 			if (mLog)
 			{
 				mLog->FLogLine(
@@ -1537,11 +1434,8 @@ TMemory::ReadBP( PAddr inAddress, KUInt8& outByte )
 			}
 			outByte = 0;
 		} else {
-			outByte = mPCMCIACtrls[3]->ReadB( inAddress - TMemoryConsts::kPCMCIA3Base );
+			outByte = theController->ReadB( inAddress & kSocketOffsetMask );
 		}
-#else
-		outByte = 0;
-#endif
 	} else {
 		if (mLog)
 		{
@@ -1567,13 +1461,7 @@ Boolean
 TMemory::Write( VAddr inAddress, KUInt32 inWord )
 {
 #ifdef _DEBUG
-	int i;
-	for (i=0; i<mWPCount; i++) {
-		if ((mWatchpoints[i].fAddress==inAddress) && (mWatchpoints[i].fMode&2)) {
-			fprintf(stderr, "Watchpoint 0x%08X written around 0x%08X\n", (unsigned int)inAddress, (unsigned int)mProcessor->mCurrentRegisters[15]);
-			mEmulator->BreakInMonitor();
-		}
-	}
+	CheckWatchpoint( inAddress, 2 );
 #endif
 
 	PAddr theAddress;
@@ -1593,6 +1481,7 @@ TMemory::Write( VAddr inAddress, KUInt32 inWord )
 		mMMU.SetHardwareFault( inAddress );
 		return true;
 	}
+	FillSoftTLB( true, inAddress, theAddress );
 	
 	return false;
 }
@@ -1604,13 +1493,7 @@ Boolean
 TMemory::WriteAligned( VAddr inAddress, KUInt32 inWord )
 {
 #ifdef _DEBUG
-	int i;
-	for (i=0; i<mWPCount; i++) {
-		if ((mWatchpoints[i].fAddress==inAddress) && (mWatchpoints[i].fMode&2)) {
-			fprintf(stderr, "Watchpoint 0x%08X written around 0x%08X\n", (unsigned int)inAddress, (unsigned int)mProcessor->mCurrentRegisters[15]);
-			mEmulator->BreakInMonitor();
-		}
-	}
+	CheckWatchpoint( inAddress, 2 );
 #endif
 
 	PAddr theAddress;
@@ -1641,13 +1524,7 @@ inline Boolean
 TMemory::WriteRAM( VAddr inAddress, KUInt32 inWord )
 {
 #ifdef _DEBUG
-	int i;
-	for (i=0; i<mWPCount; i++) {
-		if ((mWatchpoints[i].fAddress==inAddress) && (mWatchpoints[i].fMode&2)) {
-			fprintf(stderr, "Watchpoint 0x%08lX written around 0x%08lX\n", (unsigned long)inAddress, (unsigned long)mProcessor->mCurrentRegisters[15]);
-			mEmulator->BreakInMonitor();
-		}
-	}
+	CheckWatchpoint( inAddress, 2 );
 #endif
 
 	PAddr theAddress;
@@ -1747,102 +1624,9 @@ TMemory::WriteP( PAddr inAddress, KUInt32 inWord )
 		}
 //		if (inWord == 0x00000411)
 //			mEmulator->BreakInMonitor();
-	} else if (inAddress < TMemoryConsts::kExternalSerialBase) {
-		if ((inAddress >= TMemoryConsts::kHdWr_DMAChan1Base)
-			&& (inAddress < TMemoryConsts::kHdWr_DMAChan1End)) {
-			KUInt32 channel = (inAddress - TMemoryConsts::kHdWr_DMAChan1Base) >> 13;
-			KUInt32 reg = (inAddress & 0x1C00) >> 10;
-			mDMAManager->WriteChannel1Register( channel, reg, inWord );
-		} else if ((inAddress >= TMemoryConsts::kHdWr_DMAChan2Base)
-			&& (inAddress < TMemoryConsts::kHdWr_DMAChan2End)) {
-			KUInt32 channel = (inAddress - TMemoryConsts::kHdWr_DMAChan2Base) >> 12;
-			KUInt32 reg = (inAddress & 0x0C00) >> 10;
-			mDMAManager->WriteChannel2Register( channel, reg, inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_DMAAssgmnt) {
-			mDMAManager->WriteChannelAssignmentRegister( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_DMAEnableStat) {
-			mDMAManager->WriteEnableRegister( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_DMADisable) {
-			mDMAManager->WriteDisableRegister( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_CalendarReg) {
-			mInterruptManager->SetRealTimeClock(inWord);
-		} else if (inAddress == TMemoryConsts::kHdWr_AlarmReg) {
-			mInterruptManager->SetAlarm(inWord);
-		} else if (inAddress == TMemoryConsts::kHdWr_MatchReg0) {
-			mInterruptManager->SetTimerMatchRegister( 0, inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_MatchReg1) {
-			mInterruptManager->SetTimerMatchRegister( 1, inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_MatchReg2) {
-			mInterruptManager->SetTimerMatchRegister( 2, inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_MatchReg3) {
-			mInterruptManager->SetTimerMatchRegister( 3, inWord );
-//			if (mLog)
-//			{
-//				mLog->FLogLine(
-//					"Set scheduler timer to %.8X (now = %.8X)",
-//					(unsigned int) inWord,
-//					(unsigned int) mInterruptManager->GetTimer() );
-//			}
-		} else if (inAddress == TMemoryConsts::kHdWr_IntCtrlReg) {
-			mInterruptManager->SetIntCtrlReg( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_IntClear) {
-			mInterruptManager->ClearInterrupts( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_FIQMaskReg) {
-			mInterruptManager->SetFIQMask( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_IntEDReg1) {
-			mInterruptManager->SetIntEDReg1( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_IntEDReg2) {
-			mInterruptManager->SetIntEDReg2( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_IntEDReg3) {
-			mInterruptManager->SetIntEDReg3( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_GPIO_EReg) {
-			mInterruptManager->SetGPIOCtrlReg( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_GPIO_CReg) {
-			mInterruptManager->ClearGPIO( inWord );
-		} else {
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Write word access to unknown bank #3 at P0x%.8X (%.8X)",
-					(unsigned int) inAddress,
-					(unsigned int) inWord );
-			}
-			// mEmulator->BreakInMonitor();
-		}
-	} else if (inAddress < TMemoryConsts::kSerialEnd) {
-		// Serial bank
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Write word access to serial bank at P0x%.8X (%.8X)",
-				(unsigned int) inAddress,
-				(unsigned int) inWord);
-		}
-		// mEmulator->BreakInMonitor();
 	} else if (inAddress < TMemoryConsts::kFlashBank2) {
-		if (inAddress == TMemoryConsts::kHdWr_ExtDataAbt2) {
-			// Ignore it.
-		} else if (inAddress == TMemoryConsts::kHdWr_BankCtrlReg) {
-			mBankCtrlRegister = inWord;
-//			if (mLog)
-//			{
-//				mLog->FLogLine(
-//					"Changed bank control register to %.8X",
-//					(unsigned int) inWord );
-//				mEmulator->BreakInMonitor();
-//			}
-		} else if (inAddress == TMemoryConsts::kROMSerialChip) {
-			// Ignore it.
-		} else {
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Write word access to unknown bank #4 at P0x%.8X (%.8X)",
-					(unsigned int) inAddress,
-					(unsigned int) inWord );
-			}
-			// mEmulator->BreakInMonitor();
-		}
+		// Banks #3 and #4, serial ports.
+		WriteRegister( inAddress, inWord );
 	} else if (inAddress < TMemoryConsts::kFlashBank2End) {
 #if debugFlash
 		if (mLog)
@@ -1862,22 +1646,12 @@ TMemory::WriteP( PAddr inAddress, KUInt32 inWord )
 				(unsigned int) inWord );
 		}
 		// mEmulator->BreakInMonitor();
-	} else if (inAddress < TMemoryConsts::kPCMCIA1Base) {
-#if kNbSockets > 0
-		mPCMCIACtrls[0]->Write( inAddress - TMemoryConsts::kPCMCIA0Base, inWord );
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA2Base) {
-#if kNbSockets > 1
-		mPCMCIACtrls[1]->Write( inAddress - TMemoryConsts::kPCMCIA1Base, inWord );
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA3Base) {
-#if kNbSockets > 2
-		mPCMCIACtrls[2]->Write( inAddress - TMemoryConsts::kPCMCIA2Base, inWord );
-#endif
 	} else if (inAddress < TMemoryConsts::kPCMCIA3End) {
-#if kNbSockets > 3
-		mPCMCIACtrls[3]->Write( inAddress - TMemoryConsts::kPCMCIA3Base, inWord );
-#endif
+		TPCMCIAController* theController = GetSocketController( inAddress );
+		if (theController)
+		{
+			theController->Write( inAddress & kSocketOffsetMask, inWord );
+		}
 	} else {
 		if (mLog)
 		{
@@ -1959,102 +1733,9 @@ TMemory::WritePAligned( PAddr inAddress, KUInt32 inWord )
 		}
 //		if (inWord == 0x00000411)
 //			mEmulator->BreakInMonitor();
-	} else if (inAddress < TMemoryConsts::kExternalSerialBase) {
-		if ((inAddress >= TMemoryConsts::kHdWr_DMAChan1Base)
-			&& (inAddress < TMemoryConsts::kHdWr_DMAChan1End)) {
-			KUInt32 channel = (inAddress - TMemoryConsts::kHdWr_DMAChan1Base) >> 13;
-			KUInt32 reg = (inAddress & 0x1C00) >> 10;
-			mDMAManager->WriteChannel1Register( channel, reg, inWord );
-		} else if ((inAddress >= TMemoryConsts::kHdWr_DMAChan2Base)
-			&& (inAddress < TMemoryConsts::kHdWr_DMAChan2End)) {
-			KUInt32 channel = (inAddress - TMemoryConsts::kHdWr_DMAChan2Base) >> 12;
-			KUInt32 reg = (inAddress & 0x0C00) >> 10;
-			mDMAManager->WriteChannel2Register( channel, reg, inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_DMAAssgmnt) {
-			mDMAManager->WriteChannelAssignmentRegister( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_DMAEnableStat) {
-			mDMAManager->WriteEnableRegister( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_DMADisable) {
-			mDMAManager->WriteDisableRegister( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_CalendarReg) {
-			mInterruptManager->SetRealTimeClock(inWord);
-		} else if (inAddress == TMemoryConsts::kHdWr_AlarmReg) {
-			mInterruptManager->SetAlarm(inWord);
-		} else if (inAddress == TMemoryConsts::kHdWr_MatchReg0) {
-			mInterruptManager->SetTimerMatchRegister( 0, inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_MatchReg1) {
-			mInterruptManager->SetTimerMatchRegister( 1, inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_MatchReg2) {
-			mInterruptManager->SetTimerMatchRegister( 2, inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_MatchReg3) {
-			mInterruptManager->SetTimerMatchRegister( 3, inWord );
-//			if (mLog)
-//			{
-//				mLog->FLogLine(
-//					"Set scheduler timer to %.8X (now = %.8X)",
-//					(unsigned int) inWord,
-//					(unsigned int) mInterruptManager->GetTimer() );
-//			}
-		} else if (inAddress == TMemoryConsts::kHdWr_IntCtrlReg) {
-			mInterruptManager->SetIntCtrlReg( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_IntClear) {
-			mInterruptManager->ClearInterrupts( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_FIQMaskReg) {
-			mInterruptManager->SetFIQMask( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_IntEDReg1) {
-			mInterruptManager->SetIntEDReg1( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_IntEDReg2) {
-			mInterruptManager->SetIntEDReg2( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_IntEDReg3) {
-			mInterruptManager->SetIntEDReg3( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_GPIO_EReg) {
-			mInterruptManager->SetGPIOCtrlReg( inWord );
-		} else if (inAddress == TMemoryConsts::kHdWr_GPIO_CReg) {
-			mInterruptManager->ClearGPIO( inWord );
-		} else {
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Write word access to unknown bank #3 at P0x%.8X (%.8X)",
-					(unsigned int) inAddress,
-					(unsigned int) inWord );
-			}
-			// mEmulator->BreakInMonitor();
-		}
-	} else if (inAddress < TMemoryConsts::kSerialEnd) {
-		// Serial bank
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Write word access to serial bank at P0x%.8X (%.8X)",
-				(unsigned int) inAddress,
-				(unsigned int) inWord);
-		}
-		// mEmulator->BreakInMonitor();
 	} else if (inAddress < TMemoryConsts::kFlashBank2) {
-		if (inAddress == TMemoryConsts::kHdWr_ExtDataAbt2) {
-			// Ignore it.
-		} else if (inAddress == TMemoryConsts::kHdWr_BankCtrlReg) {
-			mBankCtrlRegister = inWord;
-//			if (mLog)
-//			{
-//				mLog->FLogLine(
-//					"Changed bank control register to %.8X",
-//					(unsigned int) inWord );
-//				mEmulator->BreakInMonitor();
-//			}
-		} else if (inAddress == TMemoryConsts::kROMSerialChip) {
-			// Ignore it.
-		} else {
-			if (mLog)
-			{
-				mLog->FLogLine(
-					"Write word access to unknown bank #4 at P0x%.8X (%.8X)",
-					(unsigned int) inAddress,
-					(unsigned int) inWord );
-			}
-			// mEmulator->BreakInMonitor();
-		}
+		// Banks #3 and #4, serial ports.
+		WriteRegister( inAddress, inWord );
 	} else if (inAddress < TMemoryConsts::kFlashBank2End) {
 #if debugFlash
 		if (mLog)
@@ -2074,22 +1755,12 @@ TMemory::WritePAligned( PAddr inAddress, KUInt32 inWord )
 				(unsigned int) inWord );
 		}
 		// mEmulator->BreakInMonitor();
-	} else if (inAddress < TMemoryConsts::kPCMCIA1Base) {
-#if kNbSockets > 0
-		mPCMCIACtrls[0]->Write( inAddress - TMemoryConsts::kPCMCIA0Base, inWord );
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA2Base) {
-#if kNbSockets > 1
-		mPCMCIACtrls[1]->Write( inAddress - TMemoryConsts::kPCMCIA1Base, inWord );
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA3Base) {
-#if kNbSockets > 2
-		mPCMCIACtrls[2]->Write( inAddress - TMemoryConsts::kPCMCIA2Base, inWord );
-#endif
 	} else if (inAddress < TMemoryConsts::kPCMCIA3End) {
-#if kNbSockets > 3
-		mPCMCIACtrls[3]->Write( inAddress - TMemoryConsts::kPCMCIA3Base, inWord );
-#endif
+		TPCMCIAController* theController = GetSocketController( inAddress );
+		if (theController)
+		{
+			theController->Write( inAddress & kSocketOffsetMask, inWord );
+		}
 	} else {
 		if (mLog)
 		{
@@ -2155,13 +1826,7 @@ Boolean
 TMemory::WriteB( VAddr inAddress, KUInt8 inByte )
 {
 #ifdef _DEBUG
-	int i;
-	for (i=0; i<mWPCount; i++) {
-		if ((mWatchpoints[i].fAddress==inAddress) && (mWatchpoints[i].fMode&2)) {
-			fprintf(stderr, "Watchpoint 0x%08X written around 0x%08X\n", (unsigned int)inAddress, (unsigned int)mProcessor->mCurrentRegisters[15]);
-			mEmulator->BreakInMonitor();
-		}
-	}
+	CheckWatchpoint( inAddress, 2 );
 #endif
 
 	PAddr theAddress;
@@ -2180,6 +1845,7 @@ TMemory::WriteB( VAddr inAddress, KUInt8 inByte )
 		mMMU.SetHardwareFault( inAddress );
 		return true;
 	}
+	FillSoftTLB( true, inAddress, theAddress );
 	
 //	if (inAddress == 0x0C105548)
 //	{
@@ -2257,39 +1923,9 @@ TMemory::WriteBP( PAddr inAddress, KUInt8 inByte )
 				(unsigned int) inByte );
 		}
 		// mEmulator->BreakInMonitor();
-	} else if (inAddress < TMemoryConsts::kExternalSerialBase) {
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Write byte access to unknown bank #3 at P0x%.8X = %.2X",
-				(unsigned int) inAddress,
-				(unsigned int) inByte );
-		}
-		// mEmulator->BreakInMonitor();
-	} else if (inAddress < TMemoryConsts::kSerialEnd) {
-		if (inAddress < TMemoryConsts::kInfraredSerialBase)
-		{
-			TSerialPortManager *driver = mEmulator->SerialPorts.GetDriverFor(TSerialPorts::kExtr);
-			driver->WriteRegister( inAddress - TMemoryConsts::kExternalSerialBase, inByte );
-		} else if (inAddress < TMemoryConsts::kBuiltInSerialBase) {
-			TSerialPortManager *driver = mEmulator->SerialPorts.GetDriverFor(TSerialPorts::kInfr);
-			driver->WriteRegister( inAddress - TMemoryConsts::kInfraredSerialBase, inByte );
-		} else if (inAddress < TMemoryConsts::kModemSerialBase) {
-			TSerialPortManager *driver = mEmulator->SerialPorts.GetDriverFor(TSerialPorts::kTblt);
-			driver->WriteRegister( inAddress - TMemoryConsts::kBuiltInSerialBase, inByte );
-		} else {
-			TSerialPortManager *driver = mEmulator->SerialPorts.GetDriverFor(TSerialPorts::kMdem);
-			driver->WriteRegister( inAddress - TMemoryConsts::kModemSerialBase, inByte );
-		}
 	} else if (inAddress < TMemoryConsts::kFlashBank2) {
-		if (mLog)
-		{
-			mLog->FLogLine(
-				"Write byte access to unknown bank #4 at P0x%.8X = %.2X",
-				(unsigned int) inAddress,
-				(unsigned int) inByte );
-		}
-		// mEmulator->BreakInMonitor();
+		// Banks #3 and #4, serial ports.
+		WriteByteRegister( inAddress, inByte );
 	} else if (inAddress < TMemoryConsts::kFlashBank2End) {
 #if debugFlash
 		if (mLog)
@@ -2309,22 +1945,12 @@ TMemory::WriteBP( PAddr inAddress, KUInt8 inByte )
 				(unsigned int) inByte );
 		}
 		// mEmulator->BreakInMonitor();
-	} else if (inAddress < TMemoryConsts::kPCMCIA1Base) {
-#if kNbSockets > 0
-		mPCMCIACtrls[0]->WriteB( inAddress - TMemoryConsts::kPCMCIA0Base, inByte );
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA2Base) {
-#if kNbSockets > 1
-		mPCMCIACtrls[1]->WriteB( inAddress - TMemoryConsts::kPCMCIA1Base, inByte );
-#endif
-	} else if (inAddress < TMemoryConsts::kPCMCIA3Base) {
-#if kNbSockets > 2
-		mPCMCIACtrls[2]->WriteB( inAddress - TMemoryConsts::kPCMCIA2Base, inByte );
-#endif
 	} else if (inAddress < TMemoryConsts::kPCMCIA3End) {
-#if kNbSockets > 3
-		mPCMCIACtrls[3]->WriteB( inAddress - TMemoryConsts::kPCMCIA3Base, inByte );
-#endif
+		TPCMCIAController* theController = GetSocketController( inAddress );
+		if (theController)
+		{
+			theController->WriteB( inAddress & kSocketOffsetMask, inByte );
+		}
 	} else {
 		if (mLog)
 		{
@@ -2344,6 +1970,100 @@ TMemory::WriteBP( PAddr inAddress, KUInt8 inByte )
 	return false;
 }
 
+// -------------------------------------------------------------------------- //
+//  * ReadRegister( PAddr )
+// -------------------------------------------------------------------------- //
+KUInt32
+TMemory::ReadRegister( PAddr inAddress )
+{
+	const SRegisterHandler& theHandler = GetRegisterHandler( inAddress );
+	if (theHandler.fRead)
+	{
+		return theHandler.fRead(
+			theHandler.fObject, theHandler.fRegister, inAddress );
+	}
+
+	if (mLog)
+	{
+		mLog->FLogLine(
+			"Read word access to unknown register at P0x%.8X",
+			(unsigned int) inAddress );
+	}
+	// mEmulator->BreakInMonitor();
+	return 0;
+}
+
+// -------------------------------------------------------------------------- //
+//  * WriteRegister( PAddr, KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TMemory::WriteRegister( PAddr inAddress, KUInt32 inWord )
+{
+	const SRegisterHandler& theHandler = GetRegisterHandler( inAddress );
+	if (theHandler.fWrite)
+	{
+		theHandler.fWrite(
+			theHandler.fObject, theHandler.fRegister, inAddress, inWord );
+		return;
+	}
+
+	if (mLog)
+	{
+		mLog->FLogLine(
+			"Write word access to unknown register at P0x%.8X (%.8X)",
+			(unsigned int) inAddress,
+			(unsigned int) inWord );
+	}
+	// mEmulator->BreakInMonitor();
+}
+
+// -------------------------------------------------------------------------- //
+//  * ReadByteRegister( PAddr )
+// -------------------------------------------------------------------------- //
+KUInt8
+TMemory::ReadByteRegister( PAddr inAddress )
+{
+	const SRegisterHandler& theHandler = GetRegisterHandler( inAddress );
+	if (theHandler.fReadByte)
+	{
+		return (KUInt8) theHandler.fReadByte(
+			theHandler.fObject, theHandler.fRegister, inAddress );
+	}
+
+	if (mLog)
+	{
+		mLog->FLogLine(
+			"Read byte access to unknown register at P0x%.8X",
+			(unsigned int) inAddress );
+	}
+	// mEmulator->BreakInMonitor();
+	return 0;
+}
+
+// -------------------------------------------------------------------------- //
+//  * WriteByteRegister( PAddr, KUInt8 )
+// -------------------------------------------------------------------------- //
+void
+TMemory::WriteByteRegister( PAddr inAddress, KUInt8 inByte )
+{
+	const SRegisterHandler& theHandler = GetRegisterHandler( inAddress );
+	if (theHandler.fWriteByte)
+	{
+		theHandler.fWriteByte(
+			theHandler.fObject, theHandler.fRegister, inAddress, inByte );
+		return;
+	}
+
+	if (mLog)
+	{
+		mLog->FLogLine(
+			"Write byte access to unknown register at P0x%.8X = %.2X",
+			(unsigned int) inAddress,
+			(unsigned int) inByte );
+	}
+	// mEmulator->BreakInMonitor();
+}
+
 // -------------------------------------------------------------------------- //
 //  * TranslateAndCheckFlashAddress( KUInt32, PAddr*)
 // -------------------------------------------------------------------------- //
@@ -2583,45 +2303,19 @@ TMemory::ComputeSerialNumber( const KUInt32 inNewtonID[2] )
 Boolean
 TMemory::ReadBreakpoint( VAddr inAddress, KUInt32& outWord )
 {
-	// Translate the address (priviledged).
-	Boolean savedPrivilege = GetPrivilege();
-	if (!savedPrivilege)
-	{
-		SetPrivilege( true );
-	}
-	
 	PAddr theAddress;
-	Boolean theResult = false;
-	
-	if (IsMMUEnabled())
-	{
-		theResult = TranslateR( inAddress, theAddress );
-	} else {
-		theAddress = inAddress;
-	}
-	if (!theResult)
+	if (TranslateBreakpoint( inAddress, theAddress ))
 	{
-		// Iterate on the BP.
-		theResult = true;
-		SBreakpoint* endBP = &mBreakpoints[mBPCount];
-		SBreakpoint* cursor;
-		for (cursor = mBreakpoints; cursor < endBP; cursor++)
-		{
-			if (cursor->fAddress == theAddress)
-			{
-				theResult = false;
-				outWord = cursor->fOriginalValue;
-				break;
-			}
-		}
+		return true;
 	}
-	
-	if (!savedPrivilege)
+
+	SBreakpoint* theBP = FindBreakpoint( theAddress );
+	if (theBP == NULL)
 	{
-		SetPrivilege(false);
+		return true;
 	}
-	
-	return theResult;
+	outWord = theBP->fOriginalValue;
+	return false;
 }
 
 // -------------------------------------------------------------------------- //
@@ -2630,88 +2324,13 @@ TMemory::ReadBreakpoint( VAddr inAddress, KUInt32& outWord )
 Boolean
 TMemory::SetBreakpoint( VAddr inAddress, KUInt16 inID )
 {
-	// Translate the address (priviledged).
-	Boolean savedPrivilege = GetPrivilege();
-	if (!savedPrivilege)
-	{
-		SetPrivilege(true);
-	}
-	
 	PAddr theAddress;
-	Boolean theResult = false;
-	
-	if (IsMMUEnabled())
+	if (TranslateBreakpoint( inAddress, theAddress ))
 	{
-		theResult = TranslateR( inAddress, theAddress );
-	} else {
-		theAddress = inAddress;
+		return true;
 	}
-	do {
-		if (theResult)
-		{
-			break;
-		}
-		
-		// Iterate on the BP to find it.
-		Boolean weAlreadyHaveIt = false;
-		SBreakpoint* endBP = &mBreakpoints[mBPCount];
-		SBreakpoint* cursor;
-		for (cursor = mBreakpoints; cursor < endBP; cursor++)
-		{
-			if (cursor->fAddress == theAddress)
-			{
-				weAlreadyHaveIt = true;
-				break;
-			}
-		}
-		
-		if (weAlreadyHaveIt)
-		{
-			break;
-		}
-		
-		// Add it.
-		Boolean fault = false;
-		KUInt32 originalValue =	ReadROMRAMP( theAddress, fault );
-		if (fault)
-		{
-			break;
-		}
 
-		KUInt32 theValue = 0xE1200070;
-		theValue |= inID & 0x000F;
-		theValue |= (inID & 0xFFF0) << 4;
-
-		if (!(theAddress & TMemoryConsts::kROMEndMask))
-		{
-			*((KUInt32*) ((KUIntPtr) mROMImagePtr + theAddress)) = theValue;
-
-			// Invalidate JIT.
-			mJIT.Invalidate( theAddress );
-		} else {
-			theResult = WriteP( theAddress, theValue );
-
-			if (theResult)
-			{
-				break;
-			}
-		}
-		
-		KUInt32 theBPCount = mBPCount + 1;
-		mBreakpoints = (SBreakpoint*) ::realloc( mBreakpoints,
-			sizeof(SBreakpoint) * theBPCount);
-		mBPCount = theBPCount;
-		mBreakpoints[theBPCount - 1].fAddress = theAddress;
-		mBreakpoints[theBPCount - 1].fOriginalValue = originalValue;
-		mBreakpoints[theBPCount - 1].fBPValue = theValue;
-	} while (false);
-	
-	if (!savedPrivilege)
-	{
-		SetPrivilege(false);
-	}
-	
-	return theResult;
+	return AddBreakpoint( theAddress, inID, true );
 }
 
 // -------------------------------------------------------------------------- //
@@ -2720,66 +2339,13 @@ TMemory::SetBreakpoint( VAddr inAddress, KUInt16 inID )
 Boolean
 TMemory::ClearBreakpoint( VAddr inAddress )
 {
-	// Translate the address (priviledged).
-	Boolean savedPrivilege = GetPrivilege();
-	if (!savedPrivilege)
-	{
-		SetPrivilege(true);
-	}
-	
 	PAddr theAddress;
-	Boolean theResult = false;
-	
-	if (IsMMUEnabled())
+	if (TranslateBreakpoint( inAddress, theAddress ))
 	{
-		theResult = TranslateR( inAddress, theAddress );
-	} else {
-		theAddress = inAddress;
+		return true;
 	}
-	if (!theResult)
-	{
-		// Iterate on the BP.
-		theResult = true;
-		SBreakpoint* endBP = &mBreakpoints[mBPCount];
-		SBreakpoint* cursor;
-		for (cursor = mBreakpoints; cursor < endBP; cursor++)
-		{
-			if (cursor->fAddress == theAddress)
-			{
-				theResult = false;
-				
-				KUInt32 theOriginalValue = cursor->fOriginalValue;
-				
-				(void) ::memmove(
-					cursor, &cursor[1],
-					(endBP - cursor) * sizeof (SBreakpoint) );
-				KUInt32 theBPCount = mBPCount - 1;
-				mBreakpoints = (SBreakpoint*) ::realloc( mBreakpoints,
-					sizeof(SBreakpoint) * theBPCount);
-				mBPCount = theBPCount;
-				
-				if (!(theAddress & TMemoryConsts::kROMEndMask))
-				{
-					*((KUInt32*) ((KUIntPtr) mROMImagePtr + theAddress))
-						= theOriginalValue;
 
-					// Invalidate JIT.
-					mJIT.Invalidate( theAddress );
-				} else {
-					theResult = WriteRAMP( theAddress, theOriginalValue );
-				}
-				
-				break;
-			}
-		}
-	}
-	
-	if (!savedPrivilege)
-	{
-		SetPrivilege(false);
-	}
-	
-	return theResult;
+	return RemoveBreakpoint( theAddress, true );
 }
 
 // -------------------------------------------------------------------------- //
@@ -2788,115 +2354,332 @@ TMemory::ClearBreakpoint( VAddr inAddress )
 Boolean
 TMemory::DisableBreakpoint( VAddr inAddress )
 {
-	// Translate the address (priviledged).
-	Boolean savedPrivilege = GetPrivilege();
-	if (!savedPrivilege)
-	{
-		SetPrivilege(true);
-	}
-	
 	PAddr theAddress;
-	Boolean theResult = false;
-	
-	if (IsMMUEnabled())
+	if (TranslateBreakpoint( inAddress, theAddress ))
 	{
-		theResult = TranslateR( inAddress, theAddress );
-	} else {
-		theAddress = inAddress;
+		return true;
 	}
-	if (!theResult)
+
+	SBreakpoint* theBP = FindBreakpoint( theAddress );
+	if (theBP == NULL)
 	{
-		// Iterate on the BP.
-		theResult = true;
-		SBreakpoint* endBP = &mBreakpoints[mBPCount];
-		SBreakpoint* cursor;
-		for (cursor = mBreakpoints; cursor < endBP; cursor++)
-		{
-			if (cursor->fAddress == theAddress)
-			{
-				theResult = false;
-				
-				KUInt32 theOriginalValue = cursor->fOriginalValue;
-				
-				if (!(theAddress & TMemoryConsts::kROMEndMask))
-				{
-					*((KUInt32*) ((KUIntPtr) mROMImagePtr + theAddress))
-						= theOriginalValue;
+		return true;
+	}
+	return WriteBreakpointWord( theAddress, theBP->fOriginalValue, true );
+}
 
-					// Invalidate JIT.
-					mJIT.Invalidate( theAddress );
-				} else {
-					theResult = WriteRAMP( theAddress, theOriginalValue );
-				}
-				break;
-			}
+// -------------------------------------------------------------------------- //
+//  * EnableBreakpoint( VAddr )
+// -------------------------------------------------------------------------- //
+Boolean
+TMemory::EnableBreakpoint( VAddr inAddress)
+{
+	PAddr theAddress;
+	if (TranslateBreakpoint( inAddress, theAddress ))
+	{
+		return true;
+	}
+
+	SBreakpoint* theBP = FindBreakpoint( theAddress );
+	if (theBP == NULL)
+	{
+		return true;
+	}
+	return WriteBreakpointWord( theAddress, theBP->fBPValue, true );
+}
+
+// -------------------------------------------------------------------------- //
+//  * SetBreakpoints( const VAddr*, KUInt32, KUInt16 )
+// -------------------------------------------------------------------------- //
+Boolean
+TMemory::SetBreakpoints(
+				const VAddr* inAddresses,
+				KUInt32 inCount,
+				KUInt16 inID )
+{
+	Boolean theResult = false;
+	std::vector<PAddr> thePages;
+	thePages.reserve( inCount );
+	ReserveBreakpoints( mBPCount + inCount );
+
+	KUInt32 indexAddress;
+	for (indexAddress = 0; indexAddress < inCount; indexAddress++)
+	{
+		PAddr theAddress;
+		if (TranslateBreakpoint( inAddresses[indexAddress], theAddress )
+			|| AddBreakpoint( theAddress, inID, false ))
+		{
+			theResult = true;
+		} else {
+			thePages.push_back(
+				theAddress & TMemoryConsts::kMMUSmallestPageMask );
 		}
 	}
-	
-	if (!savedPrivilege)
+
+	// Invalidate each page once.
+	std::sort( thePages.begin(), thePages.end() );
+	std::vector<PAddr>::const_iterator thePagesEnd =
+		std::unique( thePages.begin(), thePages.end() );
+	std::vector<PAddr>::const_iterator it;
+	for (it = thePages.begin(); it != thePagesEnd; ++it)
 	{
-		SetPrivilege(false);
+		mJIT.Invalidate( *it );
 	}
-	
+
 	return theResult;
 }
 
 // -------------------------------------------------------------------------- //
-//  * EnableBreakpoint( VAddr )
+//  * ClearBreakpoints( const VAddr*, KUInt32 )
 // -------------------------------------------------------------------------- //
 Boolean
-TMemory::EnableBreakpoint( VAddr inAddress)
+TMemory::ClearBreakpoints( const VAddr* inAddresses, KUInt32 inCount )
+{
+	Boolean theResult = false;
+	std::vector<PAddr> thePages;
+	thePages.reserve( inCount );
+
+	KUInt32 indexAddress;
+	for (indexAddress = 0; indexAddress < inCount; indexAddress++)
+	{
+		PAddr theAddress;
+		if (TranslateBreakpoint( inAddresses[indexAddress], theAddress )
+			|| RemoveBreakpoint( theAddress, false ))
+		{
+			theResult = true;
+		} else {
+			thePages.push_back(
+				theAddress & TMemoryConsts::kMMUSmallestPageMask );
+		}
+	}
+
+	// Invalidate each page once.
+	std::sort( thePages.begin(), thePages.end() );
+	std::vector<PAddr>::const_iterator thePagesEnd =
+		std::unique( thePages.begin(), thePages.end() );
+	std::vector<PAddr>::const_iterator it;
+	for (it = thePages.begin(); it != thePagesEnd; ++it)
+	{
+		mJIT.Invalidate( *it );
+	}
+
+	return theResult;
+}
+
+// -------------------------------------------------------------------------- //
+//  * TranslateBreakpoint( VAddr, PAddr& )
+// -------------------------------------------------------------------------- //
+Boolean
+TMemory::TranslateBreakpoint( VAddr inAddress, PAddr& outAddress )
 {
+	if (!IsMMUEnabled())
+	{
+		outAddress = inAddress;
+		return false;
+	}
+
 	// Translate the address (priviledged).
 	Boolean savedPrivilege = GetPrivilege();
 	if (!savedPrivilege)
 	{
-		SetPrivilege(true);
+		SetPrivilege( true );
 	}
-	
-	PAddr theAddress;
-	Boolean theResult = false;
-	
-	if (IsMMUEnabled())
+
+	Boolean theResult = TranslateR( inAddress, outAddress );
+
+	if (!savedPrivilege)
 	{
-		theResult = TranslateR( inAddress, theAddress );
-	} else {
-		theAddress = inAddress;
+		SetPrivilege( false );
+	}
+
+	return theResult;
+}
+
+// -------------------------------------------------------------------------- //
+//  * FindBreakpointSlot( PAddr ) const
+// -------------------------------------------------------------------------- //
+KUInt32
+TMemory::FindBreakpointSlot( PAddr inAddress ) const
+{
+	// Linear probing. The index is never more than half full.
+	KUInt32 theSlot = ((inAddress >> 2) * 0x9E3779B1) >> 8;
+	while (true)
+	{
+		theSlot &= mBPIndexMask;
+		KUInt32 theIndex = mBPIndex[theSlot];
+		if ((theIndex == 0) || (mBreakpoints[theIndex - 1].fAddress == inAddress))
+		{
+			return theSlot;
+		}
+		theSlot++;
 	}
-	if (!theResult)
+}
+
+// -------------------------------------------------------------------------- //
+//  * ReserveBreakpoints( KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TMemory::ReserveBreakpoints( KUInt32 inCount )
+{
+	if (inCount > mBPCapacity)
 	{
-		// Iterate on the BP.
-		theResult = true;
-		SBreakpoint* endBP = &mBreakpoints[mBPCount];
-		SBreakpoint* cursor;
-		for (cursor = mBreakpoints; cursor < endBP; cursor++)
+		KUInt32 theCapacity = mBPCapacity ? mBPCapacity : kMinBPIndexSize / 2;
+		while (theCapacity < inCount)
 		{
-			if (cursor->fAddress == theAddress)
-			{
-				theResult = false;
-				
-				if (!(theAddress & TMemoryConsts::kROMEndMask))
-				{
-					*((KUInt32*) ((KUIntPtr) mROMImagePtr + theAddress))
-						= cursor->fBPValue;
+			theCapacity *= 2;
+		}
+		mBreakpoints = (SBreakpoint*) ::realloc(
+			mBreakpoints, sizeof(SBreakpoint) * theCapacity );
+		mBPCapacity = theCapacity;
+	}
 
-					// Invalidate JIT.
-					mJIT.Invalidate( theAddress );
-				} else {
-					theResult = WriteRAMP( theAddress, cursor->fBPValue );
-				}
-				
-				break;
-			}
+	KUInt32 theIndexSize = mBPIndexMask + 1;
+	if (inCount * 2 > theIndexSize)
+	{
+		while (inCount * 2 > theIndexSize)
+		{
+			theIndexSize *= 2;
 		}
+		::free( mBPIndex );
+		mBPIndex = (KUInt32*) ::malloc( sizeof(KUInt32) * theIndexSize );
+		mBPIndexMask = theIndexSize - 1;
+		RebuildBreakpointIndex();
 	}
-	
-	if (!savedPrivilege)
+}
+
+// -------------------------------------------------------------------------- //
+//  * RebuildBreakpointIndex( void )
+// -------------------------------------------------------------------------- //
+void
+TMemory::RebuildBreakpointIndex( void )
+{
+	(void) ::memset( mBPIndex, 0, sizeof(KUInt32) * (mBPIndexMask + 1) );
+	KUInt32 indexBP;
+	for (indexBP = 0; indexBP < mBPCount; indexBP++)
 	{
-		SetPrivilege(true);
+		mBPIndex[FindBreakpointSlot( mBreakpoints[indexBP].fAddress )] =
+			indexBP + 1;
 	}
-	
-	return theResult;
+}
+
+// -------------------------------------------------------------------------- //
+//  * AddBreakpoint( PAddr, KUInt16, Boolean )
+// -------------------------------------------------------------------------- //
+Boolean
+TMemory::AddBreakpoint( PAddr inAddress, KUInt16 inID, Boolean inInvalidate )
+{
+	if (FindBreakpoint( inAddress ))
+	{
+		return false;
+	}
+
+	Boolean fault = false;
+	KUInt32 originalValue = ReadROMRAMP( inAddress, fault );
+	if (fault)
+	{
+		return true;
+	}
+
+	KUInt32 theValue = 0xE1200070;
+	theValue |= inID & 0x000F;
+	theValue |= (inID & 0xFFF0) << 4;
+
+	if (WriteBreakpointWord( inAddress, theValue, inInvalidate ))
+	{
+		return true;
+	}
+
+	ReserveBreakpoints( mBPCount + 1 );
+	SBreakpoint* theBP = &mBreakpoints[mBPCount];
+	theBP->fAddress = inAddress;
+	theBP->fOriginalValue = originalValue;
+	theBP->fBPValue = theValue;
+	mBPCount++;
+	mBPIndex[FindBreakpointSlot( inAddress )] = mBPCount;
+
+	return false;
+}
+
+// -------------------------------------------------------------------------- //
+//  * RemoveBreakpoint( PAddr, Boolean )
+// -------------------------------------------------------------------------- //
+Boolean
+TMemory::RemoveBreakpoint( PAddr inAddress, Boolean inInvalidate )
+{
+	KUInt32 theSlot = FindBreakpointSlot( inAddress );
+	KUInt32 theIndex = mBPIndex[theSlot];
+	if (theIndex == 0)
+	{
+		return true;
+	}
+	theIndex--;
+	KUInt32 theOriginalValue = mBreakpoints[theIndex].fOriginalValue;
+
+	// Remove the slot, moving back the following entries of the cluster
+	// that may go there.
+	KUInt32 theNextSlot = theSlot;
+	while (true)
+	{
+		theNextSlot = (theNextSlot + 1) & mBPIndexMask;
+		KUInt32 theNextIndex = mBPIndex[theNextSlot];
+		if (theNextIndex == 0)
+		{
+			break;
+		}
+		KUInt32 theHome = (((mBreakpoints[theNextIndex - 1].fAddress >> 2)
+			* 0x9E3779B1) >> 8) & mBPIndexMask;
+		if (((theNextSlot - theHome) & mBPIndexMask)
+			>= ((theNextSlot - theSlot) & mBPIndexMask))
+		{
+			mBPIndex[theSlot] = theNextIndex;
+			theSlot = theNextSlot;
+		}
+	}
+	mBPIndex[theSlot] = 0;
+
+	// Move the last Breakpoint into the hole.
+	mBPCount--;
+	if (theIndex != mBPCount)
+	{
+		mBreakpoints[theIndex] = mBreakpoints[mBPCount];
+		mBPIndex[FindBreakpointSlot( mBreakpoints[theIndex].fAddress )] =
+			theIndex + 1;
+	}
+
+	return WriteBreakpointWord( inAddress, theOriginalValue, inInvalidate );
+}
+
+// -------------------------------------------------------------------------- //
+//  * WriteBreakpointWord( PAddr, KUInt32, Boolean )
+// -------------------------------------------------------------------------- //
+Boolean
+TMemory::WriteBreakpointWord(
+				PAddr inAddress,
+				KUInt32 inValue,
+				Boolean inInvalidate )
+{
+	if (!(inAddress & TMemoryConsts::kROMEndMask))
+	{
+		if (MakeROMPrivate())
+		{
+			return true;
+		}
+		*((KUInt32*) ((KUIntPtr) mROMImagePtr + inAddress)) = inValue;
+	} else if ((inAddress >= TMemoryConsts::kRAMStart)
+		&& (inAddress < mRAMEnd)
+		&& !(inAddress & 0x3)) {
+		*((KUInt32*) (mRAMOffset + inAddress)) = inValue;
+	} else {
+		// WriteP invalidates the JIT itself.
+		return WriteP( inAddress, inValue );
+	}
+
+	if (inInvalidate)
+	{
+		// Invalidate JIT.
+		mJIT.Invalidate( inAddress );
+	}
+	return false;
 }
 
 // -------------------------------------------------------------------------- //
@@ -2915,6 +2698,11 @@ TMemory::TransferState( TStream* inStream )
 	inStream->TransferInt32BE( mBPCount );
 	
 	// The ROM.
+	if (inStream->IsReading() && MakeROMPrivate()) {
+		// The rest of the stream cannot be read without it.
+		(void) ::fprintf( stderr, "Cannot restore the state without the ROM\n" );
+		::abort();
+	}
 	inStream->TransferInt32ArrayBE( (KUInt32*) mROMImagePtr, 0x01000000 / sizeof( KUInt32 ) );
 
 	// The RAM
@@ -2925,17 +2713,22 @@ TMemory::TransferState( TStream* inStream )
 	inStream->TransferInt32ArrayBE( (KUInt32*) mRAM, mRAMSize / sizeof( KUInt32 ) );
 
 	// The breakpoints.
+	KUInt32 theBPCount = mBPCount;
 	if (inStream->IsReading()) {
-		KUInt32 BPSize = sizeof(SBreakpoint) * mBPCount;
-		mBreakpoints = (SBreakpoint*) ::realloc( mBreakpoints, BPSize );
+		mBPCount = 0;
+		ReserveBreakpoints( theBPCount );
 	}
 	KUInt32 indexBP;
-	for (indexBP = 0; indexBP < mBPCount; indexBP++)
+	for (indexBP = 0; indexBP < theBPCount; indexBP++)
 	{
 		inStream->TransferInt32BE( mBreakpoints[indexBP].fAddress );
 		inStream->TransferInt32BE( mBreakpoints[indexBP].fOriginalValue );
 		inStream->TransferInt32BE( mBreakpoints[indexBP].fBPValue );
 	}
+	if (inStream->IsReading()) {
+		mBPCount = theBPCount;
+		RebuildBreakpointIndex();
+	}
 
 	// The MMU
 	mMMU.TransferState( inStream );
@@ -2961,58 +2754,279 @@ TMemory::Init( void )
 	}
 	mRAM = (KUInt8*) ::calloc( 1, mRAMSize );	// Default is 4 MB
 	mRAMOffset = ((KUIntPtr) mRAM) - TMemoryConsts::kRAMStart;	// Difference between our RAM base address and a real Newton's
-	mBreakpoints = (SBreakpoint*) ::malloc( 1 );
+	mBPCapacity = 0;
+	mBreakpoints = NULL;
+	mBPIndexMask = kMinBPIndexSize - 1;
+	mBPIndex = (KUInt32*) ::calloc( kMinBPIndexSize, sizeof(KUInt32) );
 	mSerialNumber[0] = 0;
 	mSerialNumber[1] = 0;
 	mWPCount = 0;
 	mWatchpoints = (struct SWatchpoint*)::calloc(kMaxWatchpoints, sizeof(struct SWatchpoint));
+	mTLBStamp = kTLBStampStep;
+	(void) ::memset( mReadTLB, 0, sizeof(mReadTLB) );
+	(void) ::memset( mWriteTLB, 0, sizeof(mWriteTLB) );
+	UnmapRegisters();
 }
 
+// -------------------------------------------------------------------------- //
+//  * FillSoftTLB( Boolean, VAddr, PAddr )
+// -------------------------------------------------------------------------- //
+Boolean
+TMemory::FillSoftTLB( Boolean inWrite, VAddr inVAddress, PAddr inPAddress )
+{
+#if JIT_SOFT_TLB
+#ifdef _DEBUG
+	// Watched pages must go through Read and Write.
+	if (IsPageWatched( inVAddress ))
+	{
+		return false;
+	}
+#endif
+
+	KUIntPtr theBase;
+	if (inPAddress >= TMemoryConsts::kRAMStart)
+	{
+		if (inPAddress >= mRAMEnd)
+		{
+			return false;
+		}
+		theBase = mRAMOffset;
+	} else if (!inWrite && !(inPAddress & TMemoryConsts::kROMEndMask)) {
+		theBase = (KUIntPtr) mROMImagePtr;
+	} else {
+		return false;
+	}
 
-Boolean TMemory::AddWatchpoint(VAddr inAddr, KUInt8 inMode)
+	KUInt32 theVPage = inVAddress & TMemoryConsts::kMMUSmallestPageMask;
+	KUInt32 thePPage = inPAddress & TMemoryConsts::kMMUSmallestPageMask;
+	STLBEntry& theEntry = inWrite
+		? mWriteTLB[(inVAddress >> kTLBPageShift) & kTLBIndexMask]
+		: mReadTLB[(inVAddress >> kTLBPageShift) & kTLBIndexMask];
+	theEntry.fTag = theVPage | mTLBStamp;
+	theEntry.fPOffset = thePPage - theVPage;
+	theEntry.fHost = theBase + thePPage - theVPage;
+	return true;
+#else
+	(void) inWrite;
+	(void) inVAddress;
+	(void) inPAddress;
+	return false;
+#endif
+}
+
+// -------------------------------------------------------------------------- //
+//  * FillSoftTLB( Boolean, VAddr )
+// -------------------------------------------------------------------------- //
+Boolean
+TMemory::FillSoftTLB( Boolean inWrite, VAddr inVAddress )
 {
-	// if there is already a wp, replace it
-	int i;
-	for (i=0; i<mWPCount; i++) {
-		if (mWatchpoints[i].fAddress==inAddr) {
-			mWatchpoints[i].fAddress = inAddr;
-			mWatchpoints[i].fMode = inMode;
+	PAddr theAddress;
+
+	// Like Read and Write. A fault is raised again by the word accesses.
+	if (IsMMUEnabled() && (inWrite || !IsPageInROM( inVAddress )))
+	{
+		Boolean fault = inWrite
+			? TranslateW( inVAddress, theAddress )
+			: TranslateR( inVAddress, theAddress );
+		if (fault)
+		{
 			return false;
 		}
+	} else {
+		theAddress = inVAddress;
+	}
+
+	return FillSoftTLB( inWrite, inVAddress, theAddress );
+}
+
+// -------------------------------------------------------------------------- //
+//  * InvalidateSoftTLB( void )
+// -------------------------------------------------------------------------- //
+void
+TMemory::InvalidateSoftTLB( void )
+{
+	// Entries with another stamp no longer match. The tables are only
+	// cleared when the stamp wraps.
+	mTLBStamp = (mTLBStamp + kTLBStampStep) & kTLBStampMask;
+	if (mTLBStamp == 0)
+	{
+		mTLBStamp = kTLBStampStep;
+		(void) ::memset( mReadTLB, 0, sizeof(mReadTLB) );
+		(void) ::memset( mWriteTLB, 0, sizeof(mWriteTLB) );
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * MakeROMPrivate( void )
+// -------------------------------------------------------------------------- //
+Boolean
+TMemory::MakeROMPrivate( void )
+{
+	if (mROMCopy)
+	{
+		return false;
+	}
+
+	// The image is mapped once and shared by every emulator of the process.
+	// Breakpoints and restored states go into a copy.
+	mROMCopy = (KUInt8*) ::malloc( TMemoryConsts::kHighROMEnd );
+	if (mROMCopy == NULL)
+	{
+		(void) ::fprintf( stderr,
+			"Cannot allocate a copy of the ROM (%u bytes)\n",
+			(unsigned int) TMemoryConsts::kHighROMEnd );
+		return true;
+	}
+	(void) ::memcpy( mROMCopy, mROMImagePtr, TMemoryConsts::kHighROMEnd );
+	mROMImagePtr = mROMCopy;
+
+	// Forget the pointers to the shared image.
+	InvalidateSoftTLB();
+	KUInt32 thePage;
+	for (thePage = 0; thePage < TMemoryConsts::kHighROMEnd;
+			thePage += TMemoryConsts::kMMUSmallestPageSize)
+	{
+		mJIT.Invalidate( thePage );
+	}
+
+	return false;
+}
+
+
+// -------------------------------------------------------------------------- //
+//  * AddWatchpoint( VAddr, KUInt8 )
+// -------------------------------------------------------------------------- //
+Boolean
+TMemory::AddWatchpoint( VAddr inAddr, KUInt8 inMode )
+{
+	// if there is already a wp, replace it
+	KUInt32 theIndex = LowerWatchpoint( inAddr );
+	if ((theIndex < mWPCount) && (mWatchpoints[theIndex].fAddress == inAddr))
+	{
+		mWatchpoints[theIndex].fMode = inMode;
+		return false;
 	}
 	// if there is no more room for wp's, fail.
-	if (mWPCount==kMaxWatchpoints) return true;
-	// add a wp to the end of the list
-	mWatchpoints[mWPCount].fAddress = inAddr;
-	mWatchpoints[mWPCount].fMode = inMode;
+	if (mWPCount == kMaxWatchpoints) return true;
+	// one bit per page tells Read and Write to check the list
+	if (mWatchedPages == NULL)
+	{
+		mWatchedPages = (KUInt32*) ::calloc( kWatchMapSize, sizeof(KUInt32) );
+		if (mWatchedPages == NULL)
+		{
+			(void) ::fprintf( stderr,
+				"Cannot allocate the map of the watched pages\n" );
+			return true;
+		}
+	}
+	// insert the wp, keeping the list sorted
+	(void) ::memmove(
+		&mWatchpoints[theIndex + 1],
+		&mWatchpoints[theIndex],
+		(mWPCount - theIndex) * sizeof(SWatchpoint) );
+	mWatchpoints[theIndex].fAddress = inAddr;
+	mWatchpoints[theIndex].fMode = inMode;
 	mWPCount++;
+
+	KUInt32 thePage = inAddr >> kWatchPageShift;
+	mWatchedPages[thePage >> 5] |= (1U << (thePage & 0x1F));
+
+	// Accesses to the watched page must not bypass Read and Write.
+	InvalidateSoftTLB();
 	return false;
 }
 
-
-Boolean TMemory::ClearWatchpoint(VAddr inAddr)
+// -------------------------------------------------------------------------- //
+//  * ClearWatchpoint( VAddr )
+// -------------------------------------------------------------------------- //
+Boolean
+TMemory::ClearWatchpoint( VAddr inAddr )
 {
 	// find the wp
-	int i;
-	for (i=0; i<mWPCount; i++) {
-		if (mWatchpoints[i].fAddress==inAddr) {
-			// move all following wp's one position back
-			memmove(mWatchpoints+i, mWatchpoints+i+1, (kMaxWatchpoints-i-1)*sizeof(SWatchpoint));
-			mWPCount--;
-			return false;
-		}
+	KUInt32 theIndex = LowerWatchpoint( inAddr );
+	if ((theIndex == mWPCount) || (mWatchpoints[theIndex].fAddress != inAddr))
+	{
+		return true;
 	}
-	return true;
+	// move all following wp's one position back
+	(void) ::memmove(
+		&mWatchpoints[theIndex],
+		&mWatchpoints[theIndex + 1],
+		(mWPCount - theIndex - 1) * sizeof(SWatchpoint) );
+	mWPCount--;
+	UpdateWatchedPage( inAddr );
+	return false;
 }
 
-Boolean TMemory::GetWatchpoint( int inIndex, VAddr &outAddress, KUInt8 &outMode )
+// -------------------------------------------------------------------------- //
+//  * GetWatchpoint( int, VAddr&, KUInt8& )
+// -------------------------------------------------------------------------- //
+Boolean
+TMemory::GetWatchpoint( int inIndex, VAddr &outAddress, KUInt8 &outMode )
 {
-	if (inIndex>=mWPCount) return true;
+	if ((KUInt32) inIndex >= mWPCount) return true;
 	outAddress = mWatchpoints[inIndex].fAddress;
 	outMode = mWatchpoints[inIndex].fMode;
 	return false;
 }
 
+// -------------------------------------------------------------------------- //
+//  * WatchpointHit( VAddr, KUInt8 )
+// -------------------------------------------------------------------------- //
+void
+TMemory::WatchpointHit( VAddr inAddress, KUInt8 inMode )
+{
+	KUInt32 theIndex = LowerWatchpoint( inAddress );
+	if ((theIndex < mWPCount)
+		&& (mWatchpoints[theIndex].fAddress == inAddress)
+		&& (mWatchpoints[theIndex].fMode & inMode))
+	{
+		(void) ::fprintf( stderr, "Watchpoint 0x%08X %s around 0x%08X\n",
+			(unsigned int) inAddress,
+			(inMode & 2) ? "written" : "read",
+			(unsigned int) mProcessor->mCurrentRegisters[15] );
+		mEmulator->BreakInMonitor();
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * LowerWatchpoint( VAddr ) const
+// -------------------------------------------------------------------------- //
+KUInt32
+TMemory::LowerWatchpoint( VAddr inAddress ) const
+{
+	KUInt32 theLow = 0;
+	KUInt32 theHigh = mWPCount;
+	while (theLow < theHigh)
+	{
+		KUInt32 theMiddle = (theLow + theHigh) / 2;
+		if (mWatchpoints[theMiddle].fAddress < inAddress)
+		{
+			theLow = theMiddle + 1;
+		} else {
+			theHigh = theMiddle;
+		}
+	}
+	return theLow;
+}
+
+// -------------------------------------------------------------------------- //
+//  * UpdateWatchedPage( VAddr )
+// -------------------------------------------------------------------------- //
+void
+TMemory::UpdateWatchedPage( VAddr inAddress )
+{
+	// The watchpoints of the page are next to each other.
+	VAddr thePageBase = inAddress & ~((1 << kWatchPageShift) - 1);
+	KUInt32 theIndex = LowerWatchpoint( thePageBase );
+	if ((theIndex == mWPCount)
+		|| ((mWatchpoints[theIndex].fAddress >> kWatchPageShift)
+			!= (inAddress >> kWatchPageShift)))
+	{
+		KUInt32 thePage = inAddress >> kWatchPageShift;
+		mWatchedPages[thePage >> 5] &= ~(1U << (thePage & 0x1F));
+	}
+}
 
 // ========================================================================== //
 // If I have seen farther than others, it is because I was standing on the    //
@@ -40,6 +40,12 @@
 #include "TMemoryConsts.h"
 #include "TMMU.h"
 
+// Look up the pages of RAM and ROM in a direct-mapped table before the MMU in
+// the memory accesses of the JIT.
+#ifndef JIT_SOFT_TLB
+	#define JIT_SOFT_TLB 1
+#endif
+
 class TROMImage;
 class TLog;
 class TARMProcessor;
@@ -76,13 +82,18 @@ public:
 	/// \param inLog				interface for logging.
 	/// \param inROMImageBuffer		pointer to the ROM Image (not copied).
 	/// \param inRAMSize			size of the RAM installed (in bytes)
-	/// \param inEmulator			interface to hardware.
+	/// \param inJITCacheSize		number of pages of the JIT cache (0 for
+	///								the default).
+	/// \param inTLBSize			number of entries of the TLB of the MMU
+	///								(0 for the default).
 	///
 	TMemory(
 			TLog* inLog,
 			KUInt8* inROMImageBuffer,
 			const char* inFlashPath,
-			KUInt32 inRAMSize = 0x00400000 );
+			KUInt32 inRAMSize = 0x00400000,
+			KUInt32 inJITCacheSize = 0,
+			KUInt32 inTLBSize = 0 );
 
 	///
 	/// Constructor from the ROM Image and the amount of RAM to use
@@ -91,13 +102,18 @@ public:
 	/// \param inLog				interface for logging.
 	/// \param inROMImage			ROM Image.
 	/// \param inRAMSize			size of the RAM installed (in bytes)
-	/// \param inEmulator			interface to hardware.
+	/// \param inJITCacheSize		number of pages of the JIT cache (0 for
+	///								the default).
+	/// \param inTLBSize			number of entries of the TLB of the MMU
+	///								(0 for the default).
 	///
 	TMemory(
 			TLog* inLog,
 			TROMImage* inROMImage,
 			const char* inFlashPath,
-			KUInt32 inRAMSize = 0x00400000 );
+			KUInt32 inRAMSize = 0x00400000,
+			KUInt32 inJITCacheSize = 0,
+			KUInt32 inTLBSize = 0 );
 
 	///
 	/// Destructor.
@@ -143,10 +159,83 @@ public:
 		{
 			return &mJIT;
 		}
+
+	///
+	/// Accessor on the MMU (for its counters).
+	///
+	TMMU*		GetMMU( void )
+		{
+			return &mMMU;
+		}
 	
 	typedef KUInt32 PAddr;	///< Physical address
 	typedef KUInt32 VAddr;	///< Virtual address
 
+	///
+	/// Read a hardware register.
+	///
+	/// \param inObject		object the register was mapped with.
+	/// \param inRegister	register the register was mapped with.
+	/// \param inAddress	physical address of the access.
+	/// \return the value of the register.
+	///
+	typedef KUInt32 (*ReadRegisterProc)(
+						void* inObject,
+						KUInt32 inRegister,
+						KUInt32 inAddress );
+
+	///
+	/// Write a hardware register.
+	///
+	/// \param inObject		object the register was mapped with.
+	/// \param inRegister	register the register was mapped with.
+	/// \param inAddress	physical address of the access.
+	/// \param inValue		value to write.
+	///
+	typedef void (*WriteRegisterProc)(
+						void* inObject,
+						KUInt32 inRegister,
+						KUInt32 inAddress,
+						KUInt32 inValue );
+
+	///
+	/// Map word hardware registers (banks #3 and #4).
+	/// Registers are 1 KB apart: a range covers whole pages of 1 KB and a
+	/// single register is only accessed at its exact address.
+	///
+	/// \param inAddress	physical address of the register or of the range.
+	/// \param inSize		size of the range, or 0 for a single register.
+	/// \param inObject		object passed to the procs.
+	/// \param inRegister	register passed to the procs.
+	/// \param inReadProc	proc to read a word (NULL if write only).
+	/// \param inWriteProc	proc to write a word (NULL if read only).
+	///
+	void		MapRegisters(
+					PAddr inAddress,
+					KUInt32 inSize,
+					void* inObject,
+					KUInt32 inRegister,
+					ReadRegisterProc inReadProc,
+					WriteRegisterProc inWriteProc );
+
+	///
+	/// Map byte hardware registers (serial ports).
+	///
+	/// \param inAddress	physical address of the range.
+	/// \param inSize		size of the range.
+	/// \param inObject		object passed to the procs.
+	/// \param inRegister	register passed to the procs.
+	/// \param inReadProc	proc to read a byte.
+	/// \param inWriteProc	proc to write a byte.
+	///
+	void		MapByteRegisters(
+					PAddr inAddress,
+					KUInt32 inSize,
+					void* inObject,
+					KUInt32 inRegister,
+					ReadRegisterProc inReadProc,
+					WriteRegisterProc inWriteProc );
+
 	///
 	/// Power flash off.
 	///
@@ -378,6 +467,185 @@ public:
 	///
 	Boolean		WriteBP( PAddr inAddress, KUInt8 inByte );
 
+	///
+	/// Read 32 bits from memory, for the JIT.
+	/// Look up the software TLB first, then perform the access as Read.
+	///
+	/// \param inAddress	virtual address to read 32 bits from.
+	/// \param outWord		32 bits word that was read.
+	/// \return true if the address couldn't be accessed for reading.
+	///
+	Boolean		FastRead( VAddr inAddress, KUInt32& outWord )
+		{
+#if JIT_SOFT_TLB
+			const STLBEntry& theEntry =
+				mReadTLB[(inAddress >> kTLBPageShift) & kTLBIndexMask];
+			if (theEntry.fTag == ((inAddress & kTLBWordTagMask) | mTLBStamp))
+			{
+				outWord = *((KUInt32*) (theEntry.fHost + inAddress));
+				return false;
+			}
+#endif
+			return Read( inAddress, outWord );
+		}
+
+	///
+	/// Read 8 bits from memory, for the JIT.
+	/// Look up the software TLB first, then perform the access as ReadB.
+	///
+	/// \param inAddress	virtual address to read 8 bits from.
+	/// \param outByte		byte that was read.
+	/// \return true if the address couldn't be accessed for reading.
+	///
+	Boolean		FastReadB( VAddr inAddress, KUInt8& outByte )
+		{
+#if JIT_SOFT_TLB
+			const STLBEntry& theEntry =
+				mReadTLB[(inAddress >> kTLBPageShift) & kTLBIndexMask];
+			if (theEntry.fTag == ((inAddress & kTLBByteTagMask) | mTLBStamp))
+			{
+#if TARGET_RT_LITTLE_ENDIAN
+				outByte = *((KUInt8*) (theEntry.fHost + (inAddress ^ 0x3)));
+#else
+				outByte = *((KUInt8*) (theEntry.fHost + inAddress));
+#endif
+				return false;
+			}
+#endif
+			return ReadB( inAddress, outByte );
+		}
+
+	///
+	/// Write 32 bits to memory, for the JIT.
+	/// Look up the software TLB first, then perform the access as Write.
+	///
+	/// \param inAddress	virtual address to write 32 bits to.
+	/// \param inWord		32 bits word to write.
+	/// \return true if the address couldn't be accessed for writing.
+	///
+	Boolean		FastWrite( VAddr inAddress, KUInt32 inWord )
+		{
+#if JIT_SOFT_TLB
+			const STLBEntry& theEntry =
+				mWriteTLB[(inAddress >> kTLBPageShift) & kTLBIndexMask];
+			if (theEntry.fTag == ((inAddress & kTLBWordTagMask) | mTLBStamp))
+			{
+				*((KUInt32*) (theEntry.fHost + inAddress)) = inWord;
+				mJIT.Invalidate( inAddress + theEntry.fPOffset );
+				return false;
+			}
+#endif
+			return Write( inAddress, inWord );
+		}
+
+	///
+	/// Write 8 bits to memory, for the JIT.
+	/// Look up the software TLB first, then perform the access as WriteB.
+	///
+	/// \param inAddress	virtual address to write 8 bits to.
+	/// \param inByte		byte to write.
+	/// \return true if the address couldn't be accessed for writing.
+	///
+	Boolean		FastWriteB( VAddr inAddress, KUInt8 inByte )
+		{
+#if JIT_SOFT_TLB
+			const STLBEntry& theEntry =
+				mWriteTLB[(inAddress >> kTLBPageShift) & kTLBIndexMask];
+			if (theEntry.fTag == ((inAddress & kTLBByteTagMask) | mTLBStamp))
+			{
+#if TARGET_RT_LITTLE_ENDIAN
+				*((KUInt8*) (theEntry.fHost + (inAddress ^ 0x3))) = inByte;
+#else
+				*((KUInt8*) (theEntry.fHost + inAddress)) = inByte;
+#endif
+				mJIT.Invalidate( inAddress + theEntry.fPOffset );
+				return false;
+			}
+#endif
+			return WriteB( inAddress, inByte );
+		}
+
+	///
+	/// Get the host pointer to a block of words to read, for LDM.
+	/// The block must be within a page of RAM or ROM.
+	///
+	/// \param inAddress	virtual address of the first word.
+	/// \param inSize		size of the block in bytes.
+	/// \return a pointer to the first word or NULL if the block crosses a
+	///			page, isn't in RAM or ROM or cannot be read. The words must
+	///			then be read one by one.
+	///
+	const KUInt32*	GetReadBlock( VAddr inAddress, KUInt32 inSize )
+		{
+#if JIT_SOFT_TLB
+			VAddr theAddress = inAddress & ~0x3;
+			if ((theAddress & ~TMemoryConsts::kMMUSmallestPageMask) + inSize
+					> TMemoryConsts::kMMUSmallestPageSize)
+			{
+				return NULL;
+			}
+			const STLBEntry& theEntry =
+				mReadTLB[(theAddress >> kTLBPageShift) & kTLBIndexMask];
+			if ((theEntry.fTag == ((theAddress & kTLBByteTagMask) | mTLBStamp))
+				|| FillSoftTLB( false, theAddress ))
+			{
+				return (const KUInt32*) (theEntry.fHost + theAddress);
+			}
+#else
+			(void) inAddress;
+			(void) inSize;
+#endif
+			return NULL;
+		}
+
+	///
+	/// Get the host pointer to a block of words to write, for STM.
+	/// The block must be within a page of RAM. The JIT page is invalidated.
+	///
+	/// \param inAddress	virtual address of the first word.
+	/// \param inSize		size of the block in bytes.
+	/// \return a pointer to the first word or NULL if the block crosses a
+	///			page, isn't in RAM or cannot be written. The words must
+	///			then be written one by one.
+	///
+	KUInt32*	GetWriteBlock( VAddr inAddress, KUInt32 inSize )
+		{
+#if JIT_SOFT_TLB
+			VAddr theAddress = inAddress & ~0x3;
+			if ((theAddress & ~TMemoryConsts::kMMUSmallestPageMask) + inSize
+					> TMemoryConsts::kMMUSmallestPageSize)
+			{
+				return NULL;
+			}
+			const STLBEntry& theEntry =
+				mWriteTLB[(theAddress >> kTLBPageShift) & kTLBIndexMask];
+			if ((theEntry.fTag == ((theAddress & kTLBByteTagMask) | mTLBStamp))
+				|| FillSoftTLB( true, theAddress ))
+			{
+				mJIT.Invalidate( theAddress + theEntry.fPOffset );
+				return (KUInt32*) (theEntry.fHost + theAddress);
+			}
+#else
+			(void) inAddress;
+			(void) inSize;
+#endif
+			return NULL;
+		}
+
+	///
+	/// Invalidate the software TLB, with the TLB of the MMU or when the
+	/// permissions change.
+	///
+	void		InvalidateSoftTLB( void );
+
+	///
+	/// Replace the ROM image, which may be shared with other emulators, by a
+	/// copy owned by this emulator, before the first write into the ROM.
+	///
+	/// \return true if the copy couldn't be allocated. The ROM is unchanged.
+	///
+	Boolean		MakeROMPrivate( void );
+
 	///
 	/// Translate a flash address and check its validity.
 	///
@@ -473,6 +741,7 @@ public:
 	void		SetMMUEnabled( Boolean inEnableMMU )
 		{
 			mMMU.SetMMUEnabled( inEnableMMU );
+			InvalidateSoftTLB();
 		}
 
 	///
@@ -697,11 +966,46 @@ public:
 	///		
 	Boolean		EnableBreakpoint( VAddr inAddress );
 
+	///
+	/// Set Breakpoints at several addresses. The JIT pages of the addresses
+	/// are invalidated once for the whole batch.
+	///
+	/// \param inAddresses	virtual addresses to set the Breakpoints to.
+	/// \param inCount		number of addresses.
+	/// \param inID			ID of the Breakpoints.
+	/// \return true if one of the addresses couldn't be accessed for writing.
+	///
+	Boolean		SetBreakpoints(
+						const VAddr* inAddresses,
+						KUInt32 inCount,
+						KUInt16 inID = 0 );
+
+	///
+	/// Clear the Breakpoints at several addresses. The JIT pages of the
+	/// addresses are invalidated once for the whole batch.
+	///
+	/// \param inAddresses	virtual addresses to clear the Breakpoints of.
+	/// \param inCount		number of addresses.
+	/// \return true if one of the addresses couldn't be accessed for writing.
+	///
+	Boolean		ClearBreakpoints( const VAddr* inAddresses, KUInt32 inCount );
+
+	///
+	/// Accessor on the number of Breakpoints.
+	///
+	KUInt32		GetBreakpointCount( void ) const
+		{
+			return mBPCount;
+		}
+
 	static const int kMaxWatchpoints = 32;
 	
 	///
 	/// Create a memory watchpoint for a specific address
 	///
+	/// \return true if there is no room for the watchpoint or the map of
+	///		the watched pages couldn't be allocated.
+	///
 	Boolean		AddWatchpoint( VAddr inAddress, KUInt8 inMode);
 	
 	///
@@ -754,11 +1058,21 @@ private:
 		KUInt32 fOriginalValue; ///< Original value of the Breakpoint.
 		KUInt32	fBPValue;		///< Value for the BP instruction.
 	};
+
+	enum {
+		kMinBPIndexSize		= 64,	///< Initial size of the index.
+	};
 	
 	struct SWatchpoint {
-		VAddr   fAddress;		///< (physical) address of the Breakpoint.
+		VAddr   fAddress;		///< (virtual) address of the Watchpoint.
 		KUInt8	fMode;			///< mode bit: 1 for reading, 2 for writing
 	};
+
+	enum {
+		kWatchPageShift		= 10,	///< Watched pages are 1 KB.
+		kWatchPageCount		= 1 << (32 - kWatchPageShift),
+		kWatchMapSize		= kWatchPageCount / 32,
+	};
 	
 	struct SDMAChannel {
 		PAddr	fBaseRegister;
@@ -840,11 +1154,300 @@ private:
 	///
 	void				Init( void );
 
+	/// Handler of a hardware register or range.
+	struct SRegisterHandler {
+		void*				fObject;		///< Object of the procs.
+		KUInt32				fRegister;		///< Register of the procs.
+		KUInt32				fOffsetMask;	///< Bits of the offset in the page
+											///< that are checked.
+		KUInt32				fOffset;		///< Value of these bits.
+		ReadRegisterProc	fRead;			///< Read a word (or NULL).
+		WriteRegisterProc	fWrite;			///< Write a word (or NULL).
+		ReadRegisterProc	fReadByte;		///< Read a byte (or NULL).
+		WriteRegisterProc	fWriteByte;		///< Write a byte (or NULL).
+	};
+
+	/// Registers of the memory controller and of the platform.
+	enum ERegister {
+		kRegRAMSize04,
+		kRegRAMSize08,
+		kRegPlatformVersion,
+		kRegHighSpeedClock,
+		kRegPCMCIADoorLock,
+		kRegExtDataAbort1,
+		kRegExtDataAbort2,
+		kRegExtDataAbort3,
+		kRegBankCtrl,
+		kRegROMSerialChip
+	};
+
+	///
+	/// Add a handler and map pages of the hardware banks to it.
+	///
+	void				MapHandler(
+								PAddr inAddress,
+								KUInt32 inSize,
+								const SRegisterHandler& inHandler );
+
+	///
+	/// Unmap every register.
+	///
+	void				UnmapRegisters( void );
+
+	///
+	/// Map the registers handled by the memory.
+	///
+	void				MapMemoryRegisters( void );
+
+	///
+	/// Procs for the registers handled by the memory.
+	///
+	static KUInt32		ReadMemoryRegister(
+								void* inObject,
+								KUInt32 inRegister,
+								KUInt32 inAddress );
+	static void			WriteMemoryRegister(
+								void* inObject,
+								KUInt32 inRegister,
+								KUInt32 inAddress,
+								KUInt32 inValue );
+
+	///
+	/// Find the handler of an access to the hardware banks.
+	///
+	/// \param inAddress	physical address, in banks #3 and #4.
+	/// \return the handler, the empty handler if there is none.
+	///
+	const SRegisterHandler&	GetRegisterHandler( PAddr inAddress ) const
+		{
+			if (inAddress < kRegistersEnd)
+			{
+				const SRegisterHandler& theHandler = mRegisterHandlers[
+					mRegisterPages[
+						(inAddress - TMemoryConsts::kHardwareBase)
+							>> kRegisterPageShift]];
+				if ((inAddress & theHandler.fOffsetMask) == theHandler.fOffset)
+				{
+					return theHandler;
+				}
+			}
+			return mRegisterHandlers[0];
+		}
+
+	///
+	/// Read or write a register of the hardware banks.
+	///
+	KUInt32				ReadRegister( PAddr inAddress );
+	void				WriteRegister( PAddr inAddress, KUInt32 inWord );
+	KUInt8				ReadByteRegister( PAddr inAddress );
+	void				WriteByteRegister( PAddr inAddress, KUInt8 inByte );
+
+	///
+	/// Controller of the PCMCIA socket of an address of bank #5.
+	///
+	/// \param inAddress	physical address, in a PCMCIA socket.
+	/// \return the controller or NULL.
+	///
+	TPCMCIAController*	GetSocketController( PAddr inAddress ) const
+		{
+			KUInt32 theSocket =
+				(inAddress - TMemoryConsts::kPCMCIA0Base) >> kSocketShift;
+			return (theSocket < kNbSockets) ? mPCMCIACtrls[theSocket] : NULL;
+		}
+
+	///
+	/// Enter a page of RAM or ROM into a table of the software TLB, after an
+	/// access that went through the MMU.
+	///
+	/// \param inWrite		whether the access was a write.
+	/// \param inVAddress	virtual address of the access.
+	/// \param inPAddress	physical address of the access.
+	/// \return \c true if the page was entered.
+	///
+	Boolean				FillSoftTLB(
+								Boolean inWrite,
+								VAddr inVAddress,
+								PAddr inPAddress );
+
+	///
+	/// Translate an address and enter its page into a table of the software
+	/// TLB, for a block transfer.
+	///
+	/// \param inWrite		whether the block is written.
+	/// \param inVAddress	virtual address.
+	/// \return \c true if the page was entered, \c false if it is not in
+	///			RAM or ROM or if the translation failed.
+	///
+	Boolean				FillSoftTLB(
+								Boolean inWrite,
+								VAddr inVAddress );
+
+	///
+	/// Translate the address of a Breakpoint (priviledged).
+	///
+	/// \param inAddress	virtual address.
+	/// \param outAddress	physical address.
+	/// \return true if the address couldn't be translated.
+	///
+	Boolean				TranslateBreakpoint( VAddr inAddress, PAddr& outAddress );
+
+	///
+	/// Find the slot of an address in the index of the Breakpoints.
+	///
+	/// \param inAddress	physical address of the Breakpoint.
+	/// \return the slot of the Breakpoint or the empty slot where it goes.
+	///
+	KUInt32				FindBreakpointSlot( PAddr inAddress ) const;
+
+	///
+	/// Find a Breakpoint.
+	///
+	/// \param inAddress	physical address of the Breakpoint.
+	/// \return the Breakpoint or NULL.
+	///
+	SBreakpoint*		FindBreakpoint( PAddr inAddress ) const
+		{
+			KUInt32 theIndex = mBPIndex[FindBreakpointSlot( inAddress )];
+			return theIndex ? &mBreakpoints[theIndex - 1] : NULL;
+		}
+
+	///
+	/// Make room for Breakpoints and rebuild the index if it grew.
+	///
+	/// \param inCount		number of Breakpoints.
+	///
+	void				ReserveBreakpoints( KUInt32 inCount );
+
+	///
+	/// Rebuild the index from the Breakpoints.
+	///
+	void				RebuildBreakpointIndex( void );
+
+	///
+	/// Add a Breakpoint.
+	///
+	/// \param inAddress	physical address of the Breakpoint.
+	/// \param inID			ID of the Breakpoint.
+	/// \param inInvalidate	whether the JIT page is invalidated.
+	/// \return true if the address couldn't be accessed for writing.
+	///
+	Boolean				AddBreakpoint(
+								PAddr inAddress,
+								KUInt16 inID,
+								Boolean inInvalidate );
+
+	///
+	/// Remove a Breakpoint and restore the original value.
+	///
+	/// \param inAddress	physical address of the Breakpoint.
+	/// \param inInvalidate	whether the JIT page is invalidated.
+	/// \return true if there is no Breakpoint at this address or if it
+	///			couldn't be accessed for writing.
+	///
+	Boolean				RemoveBreakpoint(
+								PAddr inAddress,
+								Boolean inInvalidate );
+
+	///
+	/// Write the word of a Breakpoint, in ROM or in RAM.
+	///
+	/// \param inAddress	physical address of the Breakpoint.
+	/// \param inValue		instruction or original value.
+	/// \param inInvalidate	whether the JIT page is invalidated.
+	/// \return true if the address couldn't be accessed for writing.
+	///
+	Boolean				WriteBreakpointWord(
+								PAddr inAddress,
+								KUInt32 inValue,
+								Boolean inInvalidate );
+
+	///
+	/// Determine if a page has a watchpoint.
+	///
+	/// \param inAddress	virtual address in the page.
+	/// \return \c true if a watchpoint is set in the 1 KB page.
+	///
+	Boolean				IsPageWatched( VAddr inAddress ) const
+		{
+			KUInt32 thePage = inAddress >> kWatchPageShift;
+			return (mWatchedPages != NULL)
+				&& (mWatchedPages[thePage >> 5] & (1U << (thePage & 0x1F)));
+		}
+
+	///
+	/// Break in the monitor if an address is watched. Only the pages with
+	/// a watchpoint look the watchpoints up.
+	///
+	/// \param inAddress	virtual address of the access.
+	/// \param inMode		1 for a read, 2 for a write.
+	///
+	void				CheckWatchpoint( VAddr inAddress, KUInt8 inMode )
+		{
+			if (IsPageWatched( inAddress ))
+			{
+				WatchpointHit( inAddress, inMode );
+			}
+		}
+
+	///
+	/// Look the watchpoints of a watched page up and break in the monitor if
+	/// the address is watched for this kind of access.
+	///
+	/// \param inAddress	virtual address of the access.
+	/// \param inMode		1 for a read, 2 for a write.
+	///
+	void				WatchpointHit( VAddr inAddress, KUInt8 inMode );
+
+	///
+	/// Find the first watchpoint at or after an address.
+	///
+	/// \param inAddress	virtual address.
+	/// \return the index of the watchpoint, mWPCount if there is none.
+	///
+	KUInt32				LowerWatchpoint( VAddr inAddress ) const;
+
+	///
+	/// Update the bit of a page after a watchpoint was removed.
+	///
+	/// \param inAddress	virtual address in the page.
+	///
+	void				UpdateWatchedPage( VAddr inAddress );
+
+	/// Entry of the software TLB.
+	struct STLBEntry {
+		KUInt32			fTag;		///< Virtual page | stamp (0 if empty).
+		KUInt32			fPOffset;	///< Physical - virtual address.
+		KUIntPtr		fHost;		///< Host - virtual address.
+	};
+
+	enum {
+		kTLBSize			= 1024,
+		kTLBIndexMask		= kTLBSize - 1,
+		kTLBPageShift		= 10,	///< TMemoryConsts::kMMUSmallestPageSize
+		kTLBByteTagMask		= TMemoryConsts::kMMUSmallestPageMask,
+		kTLBWordTagMask		= TMemoryConsts::kMMUSmallestPageMask | 0x3,
+									///< Unaligned words miss.
+		kTLBStampStep		= 0x4,	///< Stamps use the bits 2-9 of the tag.
+		kTLBStampMask		= 0x3FC,
+	};
+
+	enum {
+		kRegistersEnd		= 0x0F300000,	///< After the last register.
+		kRegisterPageShift	= 10,	///< Registers are 1 KB apart.
+		kRegisterPageCount	=
+			(kRegistersEnd - TMemoryConsts::kHardwareBase) >> kRegisterPageShift,
+		kMaxRegisterHandlers	= 64,
+		kSocketShift		= 28,	///< PCMCIA sockets are 256 MB apart.
+		kSocketOffsetMask	= 0x0FFFFFFF,
+	};
+
 	/// \name Variables
 	TARMProcessor*		mProcessor;			///< Reference to the CPU.
 	TLog*				mLog;				///< Interface for logging.
 	TFlash				mFlash;				///< Flash memory.
 	KUInt8*				mROMImagePtr;		///< 16 MB
+	KUInt8*				mROMCopy;			///< Private copy of the ROM
+											///< (or nil if it is shared).
 	KUInt8*				mRAM;				///< RAM
 	KUInt32				mRAMSize;			///< Size of the RAM.
 	KUInt32				mRAMEnd;			///< Address of the last RAM byte.
@@ -859,10 +1462,30 @@ private:
 	KUInt32				mSerialNumber[2];	///< Serial number.
 	TEmulator*			mEmulator;			///< Emulator (interface to hardware).
 	KUInt32				mBPCount;			///< Number of Breakpoints.
+	KUInt32				mBPCapacity;		///< Room in mBreakpoints.
 	SBreakpoint*		mBreakpoints;		///< Breakpoints.
+	KUInt32				mBPIndexMask;		///< Size of the index - 1.
+	KUInt32*			mBPIndex;			///< Open addressing index of the
+											///< Breakpoints by physical
+											///< address (index + 1, 0 if
+											///< empty).
 	KUInt32				mWPCount;			///< Number of Watchpoints.
-	SWatchpoint*		mWatchpoints;		///< Watchpoints.
+	SWatchpoint*		mWatchpoints;		///< Watchpoints, sorted by address.
+	KUInt32*			mWatchedPages;		///< One bit per page with a
+											///< watchpoint (NULL until the
+											///< first watchpoint).
 	JITClass			mJIT;				///< JIT.
+	KUInt32				mTLBStamp;			///< Stamp of the valid entries.
+	STLBEntry			mReadTLB[kTLBSize];	///< Pages that can be read.
+	STLBEntry			mWriteTLB[kTLBSize];	///< Pages of RAM that can be
+											///< written.
+	KUInt32				mRegisterHandlerCount;	///< Handlers, with the
+											///< empty one.
+	SRegisterHandler	mRegisterHandlers[kMaxRegisterHandlers];
+											///< Handlers of the registers.
+	KUInt8				mRegisterPages[kRegisterPageCount];
+											///< Handler of each page of the
+											///< hardware banks.
 };
 
 #endif
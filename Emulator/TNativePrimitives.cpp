@@ -27,6 +27,7 @@
 #include <sys/types.h>
 #include <signal.h>
 #include <stdlib.h>
+#include <string.h>
 
 #if !TARGET_OS_WIN32
 	#include <unistd.h>
@@ -94,8 +95,12 @@ TNativePrimitives::TNativePrimitives(
 #endif
 		mVirtualizedCalls( nil ),
 		mInputVolume( 0 ),
-		mQuit( false )
+		mQuit( false ),
+		mTraceProgress( true ),
+		mPrevProgress( 2 ),
+		mFirstPause( true )
 {
+	(void) ::memset( mBootCalls, 0, sizeof(mBootCalls) );
 }
 
 // -------------------------------------------------------------------------- //
@@ -149,8 +154,6 @@ TNativePrimitives::SetEmulator( TEmulator* inEmulator )
 void
 TNativePrimitives::ExecuteNative( KUInt32 inInstruction )
 {
-	static KUInt16 n[0x1000] = { 0 };
-	
 	if (inInstruction & 0x80000000)
 	{
 		// If the high bit is set, this instruction is actually a patch, not
@@ -163,10 +166,8 @@ TNativePrimitives::ExecuteNative( KUInt32 inInstruction )
 		// This block updates the progress bar overlay as the
 		// virtual Newton is going through its early boot phases.
 		
-		static Boolean traceProgress = true;
-		if (traceProgress) {
-			int nn = n[inInstruction&0xfff]++;
-			static int prevProgress = 2;
+		if (mTraceProgress) {
+			int nn = mBootCalls[inInstruction&0xfff]++;
 			int progress = 0;
 			const char *title = "";
 			if (nn==0) {
@@ -227,15 +228,15 @@ TNativePrimitives::ExecuteNative( KUInt32 inInstruction )
 					case 0x0000000d: progress=43; title = "Write Flash Memory"; break;
 					case 0x00000008: progress=44; title = "Write Flash Memory"; break;
 					case 0x0000000e: progress=45; title = "Setup Flash Memory"; //break;
-					case 0x00000112: progress=46; traceProgress = false;
+					case 0x00000112: progress=46; mTraceProgress = false;
 						mScreenManager->OverlayOff();
 						break;
 					default:
 						//printf("Unmanaged progress indicator: 0x%08x at %d\n", (unsigned int)inInstruction, progress);
 						break;
 				}
-				if (progress>prevProgress) {
-					prevProgress = progress;
+				if (progress>mPrevProgress) {
+					mPrevProgress = progress;
 					if (mScreenManager->OverlayIsOn()) {
 						mScreenManager->OverlayPrintProgress(1, progress*100/46);
 						if (*title) mScreenManager->OverlayPrintAt(0, 3, title, true);
@@ -847,20 +848,15 @@ TNativePrimitives::ExecutePlatformDriverNative( KUInt32 inInstruction )
 					"TMainPlatformDriver::PowerOnDeviceCheck( %.8X )",
 					(unsigned int) mProcessor->GetRegister(1) );
 			}
-			{
-				static int firstPause = 1;
-				if (firstPause) {
-					firstPause--;
-					// This will remove the boot-progress display
-					if (mScreenManager->OverlayIsOn()) {
-						mScreenManager->OverlayOff();
-					}
-					// this is a hack that will install packages that were added to a
-					// directory on the host. This is used by iOS/iPhone/Android.
-					if (firstPause==0) {
-						mPlatformManager->InstallNewPackages();
-					}
+			if (mFirstPause) {
+				mFirstPause = false;
+				// This will remove the boot-progress display
+				if (mScreenManager->OverlayIsOn()) {
+					mScreenManager->OverlayOff();
 				}
+				// this is a hack that will install packages that were added to a
+				// directory on the host. This is used by iOS/iPhone/Android.
+				mPlatformManager->InstallNewPackages();
 			}
 			mProcessor->SetRegister( 0, 0 );
 			break;
@@ -248,6 +248,12 @@ private:
 	Boolean				mQuit;				///< Whether to quit.
 	KUInt32				mSoundOutputBuffer1Addr;	///< Output buffer #1: the addr.
 	KUInt32				mSoundOutputBuffer2Addr;	///< Output buffer #2: the addr.
+	KUInt16				mBootCalls[0x1000];	///< Calls of each driver primitive,
+											///< for the boot progress.
+	Boolean				mTraceProgress;		///< Whether the boot progress is shown.
+	int					mPrevProgress;		///< Last boot progress shown.
+	Boolean				mFirstPause;		///< Whether the system was not
+											///< paused yet.
 };
 
 #endif
@@ -0,0 +1,231 @@
+// ==============================
+// Fichier:			UByteSex.cp
+// Projet:			K
+//
+// Tabulation:		4 espaces
+//
+// ***** BEGIN LICENSE BLOCK *****
+// Version: MPL 1.1
+//
+// The contents of this file are subject to the Mozilla Public License Version
+// 1.1 (the "License"); you may not use this file except in compliance with
+// the License. You may obtain a copy of the License at
+// http://www.mozilla.org/MPL/
+//
+// Software distributed under the License is distributed on an "AS IS" basis,
+// WITHOUT WARRANTY OF ANY KIND, either express or implied. See the License
+// for the specific language governing rights and limitations under the
+// License.
+//
+// The Original Code is UByteSex.h.
+//
+// The Initial Developer of the Original Code is Paul Guyot.
+// Portions created by the Initial Developer are Copyright (C) 2002-2004
+// the Initial Developer. All Rights Reserved.
+//
+// Contributor(s):
+//   Paul Guyot <pguyot@kallisys.net> (original author)
+//
+// ***** END LICENSE BLOCK *****
+// ===========
+// $Id$
+// ===========
+
+#include <K/Defines/KDefinitions.h>
+#include "UByteSex.h"
+
+// ANSI C
+#include <string.h>
+
+// Instructions vectorielles.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	#define UBYTESEX_X86 1
+	#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#define UBYTESEX_NEON 1
+	#include <arm_neon.h>
+#endif
+
+// -------------------------------------------------------------------------- //
+// Constantes
+// -------------------------------------------------------------------------- //
+
+typedef void (*SwapArrayProc)( KUInt8*, const KUInt8*, KUIntPtr );
+
+/// Version de l'change choisie pour le processeur hte.
+struct SSwapArrayKernel
+{
+	SwapArrayProc	fProc;		///< Fonction.
+	const char*		fName;		///< Nom (pour les tests de performance).
+};
+
+// -------------------------------------------------------------------------- //
+//  * SwapWords( KUInt8*, const KUInt8*, KUIntPtr )
+// -------------------------------------------------------------------------- //
+// Version scalaire, aussi utilise pour la fin des tableaux.
+// Les pointeurs n'ont pas besoin d'tre aligns.
+static void
+SwapWords( KUInt8* outDest, const KUInt8* inSource, KUIntPtr inCount )
+{
+	while (inCount-- > 0)
+	{
+		KUInt32 theWord;
+		(void) ::memcpy( &theWord, inSource, sizeof( theWord ) );
+		theWord = UByteSex::Swap( theWord );
+		(void) ::memcpy( outDest, &theWord, sizeof( theWord ) );
+		inSource += sizeof( theWord );
+		outDest += sizeof( theWord );
+	}
+}
+
+#if UBYTESEX_X86
+// -------------------------------------------------------------------------- //
+//  * SwapWordsSSE2( KUInt8*, const KUInt8*, KUIntPtr )
+// -------------------------------------------------------------------------- //
+// SSE2 n'a pas de permutation d'octets (pshufb est SSSE3): on change les
+// octets des demi-mots par dcalage, puis les demi-mots.
+__attribute__((target("sse2")))
+static void
+SwapWordsSSE2( KUInt8* outDest, const KUInt8* inSource, KUIntPtr inCount )
+{
+	while (inCount >= 8)
+	{
+		__m128i theLow = _mm_loadu_si128( (const __m128i*) inSource );
+		__m128i theHigh = _mm_loadu_si128( (const __m128i*) (inSource + 16) );
+		theLow = _mm_or_si128(
+					_mm_slli_epi16( theLow, 8 ), _mm_srli_epi16( theLow, 8 ) );
+		theHigh = _mm_or_si128(
+					_mm_slli_epi16( theHigh, 8 ), _mm_srli_epi16( theHigh, 8 ) );
+		theLow = _mm_shufflelo_epi16( theLow, _MM_SHUFFLE( 2, 3, 0, 1 ) );
+		theLow = _mm_shufflehi_epi16( theLow, _MM_SHUFFLE( 2, 3, 0, 1 ) );
+		theHigh = _mm_shufflelo_epi16( theHigh, _MM_SHUFFLE( 2, 3, 0, 1 ) );
+		theHigh = _mm_shufflehi_epi16( theHigh, _MM_SHUFFLE( 2, 3, 0, 1 ) );
+		_mm_storeu_si128( (__m128i*) outDest, theLow );
+		_mm_storeu_si128( (__m128i*) (outDest + 16), theHigh );
+		inSource += 32;
+		outDest += 32;
+		inCount -= 8;
+	}
+	SwapWords( outDest, inSource, inCount );
+}
+
+// -------------------------------------------------------------------------- //
+//  * SwapWordsAVX2( KUInt8*, const KUInt8*, KUIntPtr )
+// -------------------------------------------------------------------------- //
+__attribute__((target("avx2")))
+static void
+SwapWordsAVX2( KUInt8* outDest, const KUInt8* inSource, KUIntPtr inCount )
+{
+	const __m256i theMask = _mm256_setr_epi8(
+				3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+				3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 );
+	while (inCount >= 16)
+	{
+		__m256i theLow = _mm256_loadu_si256( (const __m256i*) inSource );
+		__m256i theHigh = _mm256_loadu_si256( (const __m256i*) (inSource + 32) );
+		_mm256_storeu_si256( (__m256i*) outDest,
+					_mm256_shuffle_epi8( theLow, theMask ) );
+		_mm256_storeu_si256( (__m256i*) (outDest + 32),
+					_mm256_shuffle_epi8( theHigh, theMask ) );
+		inSource += 64;
+		outDest += 64;
+		inCount -= 16;
+	}
+	SwapWords( outDest, inSource, inCount );
+}
+#endif
+
+#if UBYTESEX_NEON
+// -------------------------------------------------------------------------- //
+//  * SwapWordsNEON( KUInt8*, const KUInt8*, KUIntPtr )
+// -------------------------------------------------------------------------- //
+static void
+SwapWordsNEON( KUInt8* outDest, const KUInt8* inSource, KUIntPtr inCount )
+{
+	while (inCount >= 8)
+	{
+		uint8x16_t theLow = vld1q_u8( inSource );
+		uint8x16_t theHigh = vld1q_u8( inSource + 16 );
+		vst1q_u8( outDest, vrev32q_u8( theLow ) );
+		vst1q_u8( outDest + 16, vrev32q_u8( theHigh ) );
+		inSource += 32;
+		outDest += 32;
+		inCount -= 8;
+	}
+	SwapWords( outDest, inSource, inCount );
+}
+#endif
+
+// -------------------------------------------------------------------------- //
+//  * SelectKernel( void )
+// -------------------------------------------------------------------------- //
+// Choisit la version la plus rapide disponible sur le processeur hte.
+static SSwapArrayKernel
+SelectKernel( void )
+{
+	SSwapArrayKernel theResult = { SwapWords, "scalar" };
+#if UBYTESEX_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports( "avx2" ))
+	{
+		theResult.fProc = SwapWordsAVX2;
+		theResult.fName = "avx2";
+	} else if (__builtin_cpu_supports( "sse2" )) {
+		theResult.fProc = SwapWordsSSE2;
+		theResult.fName = "sse2";
+	}
+#elif UBYTESEX_NEON
+	theResult.fProc = SwapWordsNEON;
+	theResult.fName = "neon";
+#endif
+	return theResult;
+}
+
+// -------------------------------------------------------------------------- //
+//  * GetKernel( void )
+// -------------------------------------------------------------------------- //
+static const SSwapArrayKernel&
+GetKernel( void )
+{
+	static const SSwapArrayKernel kKernel = SelectKernel();
+	return kKernel;
+}
+
+// -------------------------------------------------------------------------- //
+//  * SwapArray( KUInt32*, const KUInt32*, KUIntPtr )
+// -------------------------------------------------------------------------- //
+void
+UByteSex::SwapArray(
+				KUInt32* outDest,
+				const KUInt32* inSource,
+				KUIntPtr inCount )
+{
+	GetKernel().fProc( (KUInt8*) outDest, (const KUInt8*) inSource, inCount );
+}
+
+// -------------------------------------------------------------------------- //
+//  * SwapArrayScalar( KUInt32*, const KUInt32*, KUIntPtr )
+// -------------------------------------------------------------------------- //
+void
+UByteSex::SwapArrayScalar(
+				KUInt32* outDest,
+				const KUInt32* inSource,
+				KUIntPtr inCount )
+{
+	SwapWords( (KUInt8*) outDest, (const KUInt8*) inSource, inCount );
+}
+
+// -------------------------------------------------------------------------- //
+//  * GetSwapArrayKernel( void )
+// -------------------------------------------------------------------------- //
+const char*
+UByteSex::GetSwapArrayKernel( void )
+{
+	return GetKernel().fName;
+}
+
+// ========================================================================= //
+// The nice thing about standards is that there are so many of them to       //
+// choose from.                                                              //
+//                 -- Andrew S. Tanenbaum                                    //
+// ========================================================================= //
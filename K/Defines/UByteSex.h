@@ -93,6 +93,42 @@ public:
 #endif
 		}
 
+	///
+	/// Echange les octets d'un tableau de mots de 32 bits.
+	/// Utilise SSE2, AVX2 ou NEON si le processeur hte les a, la version
+	/// est choisie au premier appel. Les tableaux n'ont pas besoin d'tre
+	/// aligns. La destination peut tre la source, mais les tableaux ne
+	/// doivent pas se chevaucher autrement.
+	///
+	/// \param outDest	tableau en sortie.
+	/// \param inSource	tableau en entre.
+	/// \param inCount	nombre de mots.
+	///
+	static void		SwapArray(
+						KUInt32* outDest,
+						const KUInt32* inSource,
+						KUIntPtr inCount );
+
+	///
+	/// Echange les octets d'un tableau de mots de 32 bits sans les
+	/// instructions vectorielles (pour les tests).
+	///
+	/// \param outDest	tableau en sortie.
+	/// \param inSource	tableau en entre.
+	/// \param inCount	nombre de mots.
+	///
+	static void		SwapArrayScalar(
+						KUInt32* outDest,
+						const KUInt32* inSource,
+						KUIntPtr inCount );
+
+	///
+	/// Nom de la version de SwapArray choisie pour le processeur hte.
+	///
+	/// \return "avx2", "sse2", "neon" ou "scalar".
+	///
+	static const char*	GetSwapArrayKernel( void );
+
 #if TARGET_RT_LITTLE_ENDIAN
 	// Macros pour une plateforme en petit indien
 	#define	UByteSex_FromBigEndian( inWord )	( UByteSex::Swap( inWord ) )
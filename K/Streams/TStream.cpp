@@ -53,6 +53,9 @@
 	#include <K/Exceptions/IO/TEOFException.h>
 #endif
 
+// Number of words of the arrays read or written at once.
+static const KUInt32 kWordsPerChunk = 4096;
+
 // ------------------------------------------------------------------------- //
 //  * GetCString( KUInt32 )
 // ------------------------------------------------------------------------- //
@@ -413,21 +416,82 @@ TStream::PutInt16( const KUInt16 inShort )
 }
 
 // ------------------------------------------------------------------------- //
-//  * GetInt32ArrayBE( const KUInt32*, const KUInt32 )
+//  * GetInt32Array( TStream*, KUInt32*, KUInt32, Boolean )
 // ------------------------------------------------------------------------- //
-void
-TStream::GetInt32ArrayBE(
+// Read the words by chunks and swap each chunk while it is in the cache.
+static void
+GetInt32Array(
+				TStream* inStream,
 				KUInt32* outArray,
-				const KUInt32 inCount )
+				KUInt32 inCount,
+				Boolean inSwap )
 {
 	KUInt32* cursor = outArray;
 	KUInt32 count = inCount;
-	while (count-- > 0)
+	while (count > 0)
 	{
-		*cursor++ = GetInt32BE();
+		KUInt32 nbWords = count < kWordsPerChunk ? count : kWordsPerChunk;
+		KUInt32 length = nbWords * sizeof( KUInt32 );
+		inStream->Read( cursor, &length );
+		if (length < nbWords * sizeof( KUInt32 ))
+		{
+#if HAS_EXCEPTION_HANDLING
+			throw EOFException;
+#else
+			(void) ::memset( cursor, 0, count * sizeof( KUInt32 ) );
+			return;
+#endif
+		}
+		if (inSwap)
+		{
+			UByteSex::SwapArray( cursor, cursor, nbWords );
+		}
+		cursor += nbWords;
+		count -= nbWords;
 	}
 }
 
+// ------------------------------------------------------------------------- //
+//  * PutInt32Array( TStream*, const KUInt32*, KUInt32, Boolean )
+// ------------------------------------------------------------------------- //
+// The words are swapped into a buffer, the array is left untouched.
+static void
+PutInt32Array(
+				TStream* inStream,
+				const KUInt32* inArray,
+				KUInt32 inCount,
+				Boolean inSwap )
+{
+	KUInt32 theBuffer[kWordsPerChunk];
+	const KUInt32* cursor = inArray;
+	KUInt32 count = inCount;
+	while (count > 0)
+	{
+		KUInt32 nbWords = count < kWordsPerChunk ? count : kWordsPerChunk;
+		KUInt32 length = nbWords * sizeof( KUInt32 );
+		if (inSwap)
+		{
+			UByteSex::SwapArray( theBuffer, cursor, nbWords );
+			inStream->Write( theBuffer, &length );
+		} else {
+			inStream->Write( cursor, &length );
+		}
+		cursor += nbWords;
+		count -= nbWords;
+	}
+}
+
+// ------------------------------------------------------------------------- //
+//  * GetInt32ArrayBE( const KUInt32*, const KUInt32 )
+// ------------------------------------------------------------------------- //
+void
+TStream::GetInt32ArrayBE(
+				KUInt32* outArray,
+				const KUInt32 inCount )
+{
+	GetInt32Array( this, outArray, inCount, TARGET_RT_LITTLE_ENDIAN );
+}
+
 // ------------------------------------------------------------------------- //
 //  * GetInt32ArrayLE( const KUInt32*, const KUInt32 )
 // ------------------------------------------------------------------------- //
@@ -436,12 +500,7 @@ TStream::GetInt32ArrayLE(
 				KUInt32* outArray,
 				const KUInt32 inCount )
 {
-	KUInt32* cursor = outArray;
-	KUInt32 count = inCount;
-	while (count-- > 0)
-	{
-		*cursor++ = GetInt32LE();
-	}
+	GetInt32Array( this, outArray, inCount, TARGET_RT_BIG_ENDIAN );
 }
 
 // ------------------------------------------------------------------------- //
@@ -452,12 +511,7 @@ TStream::PutInt32ArrayBE(
 				const KUInt32* inArray,
 				const KUInt32 inCount )
 {
-	const KUInt32* cursor = inArray;
-	KUInt32 count = inCount;
-	while (count-- > 0)
-	{
-		PutInt32BE( *cursor++ );
-	}
+	PutInt32Array( this, inArray, inCount, TARGET_RT_LITTLE_ENDIAN );
 }
 
 // ------------------------------------------------------------------------- //
@@ -468,12 +522,7 @@ TStream::PutInt32ArrayLE(
 				const KUInt32* inArray,
 				const KUInt32 inCount )
 {
-	const KUInt32* cursor = inArray;
-	KUInt32 count = inCount;
-	while (count-- > 0)
-	{
-		PutInt32LE( *cursor++ );
-	}
+	PutInt32Array( this, inArray, inCount, TARGET_RT_BIG_ENDIAN );
 }
 
 // ------------------------------------------------------------------------- //
@@ -767,6 +767,21 @@ TMonitor::ExecuteCommand( const char* inCommand )
 		} else {
 			PrintLine("Cannot play with MMU, the emulator is running", MONITOR_LOG_ERROR);
 		}
+	} else if (::strcmp(inCommand, "mmu stats") == 0) {
+		if (mHalted)
+		{
+			PrintMMUStats();
+		} else {
+			PrintLine("Cannot display the MMU, the emulator is running", MONITOR_LOG_ERROR);
+		}
+	} else if (::strcmp(inCommand, "mmu stats reset") == 0) {
+		if (mHalted)
+		{
+			mMemory->GetMMU()->ResetStats();
+			PrintLine("MMU counters reset", MONITOR_LOG_INFO);
+		} else {
+			PrintLine("Cannot reset the MMU, the emulator is running", MONITOR_LOG_ERROR);
+		}
 	} else if (::sscanf(inCommand, "mmu %X", &theArgInt) == 1) {
 		if (mHalted)
 		{
@@ -795,6 +810,21 @@ TMonitor::ExecuteCommand( const char* inCommand )
 		} else {
 			PrintLine("Cannot play with MMU, the emulator is running", MONITOR_LOG_ERROR);
 		}
+	} else if (::strcmp(inCommand, "jit") == 0) {
+		if (mHalted)
+		{
+			PrintJITStats();
+		} else {
+			PrintLine("Cannot display the JIT, the emulator is running", MONITOR_LOG_ERROR);
+		}
+	} else if (::strcmp(inCommand, "jit reset") == 0) {
+		if (mHalted)
+		{
+			mMemory->GetJITObject()->ResetCacheStats();
+			PrintLine("JIT counters reset", MONITOR_LOG_INFO);
+		} else {
+			PrintLine("Cannot reset the JIT, the emulator is running", MONITOR_LOG_ERROR);
+		}
 	// commands when the emulator is running
 	} else if (::strcmp(inCommand, "stop") == 0) {
 		if (!mHalted)
@@ -1276,6 +1306,8 @@ TMonitor::PrintHelp( void )
 	PrintLine(" g|run              run", MONITOR_LOG_INFO);
 	PrintLine(" mmu                display mmu registers", MONITOR_LOG_INFO);
 	PrintLine(" mmu <address>      mmu lookup address", MONITOR_LOG_INFO);
+	PrintLine(" mmu stats [reset]  display (reset) the mmu tlb counters", MONITOR_LOG_INFO);
+	PrintLine(" jit [reset]        display (reset) the jit counters", MONITOR_LOG_INFO);
 	PrintLine(" mr                 magic return (relies on lr)", MONITOR_LOG_INFO);
 	PrintLine(" r<i>=<val>         set ith register", MONITOR_LOG_INFO);
 	PrintLine(" pc=<val>           set pc", MONITOR_LOG_INFO);
@@ -1870,6 +1902,130 @@ TMonitor::PrintNSRef(KUInt32 inRef)
 	::free(objectDesc);
 }
 
+// -------------------------------------------------------------------------- //
+//  * PrintMMUStats( void )
+// -------------------------------------------------------------------------- //
+void
+TMonitor::PrintMMUStats( void )
+{
+	char theLine[256];
+	TMMU* theMMU = mMemory->GetMMU();
+	const TMMU::SStats& theStats = theMMU->GetStats();
+
+	(void) ::sprintf(
+		theLine, "TLB: %u pages, %u hits, %u section/large page hits",
+		(unsigned int) theMMU->GetCacheSize(),
+		(unsigned int) theStats.fHits,
+		(unsigned int) theStats.fBlockHits );
+	PrintLine(theLine, MONITOR_LOG_INFO);
+	(void) ::sprintf(
+		theLine, "Walks: %u, %u with a second level, %u permission faults",
+		(unsigned int) theStats.fWalks,
+		(unsigned int) theStats.fLevel2Walks,
+		(unsigned int) theStats.fPermissionFaults );
+	PrintLine(theLine, MONITOR_LOG_INFO);
+	(void) ::sprintf(
+		theLine, "Invalidations: %u",
+		(unsigned int) theStats.fInvalidateTLBs );
+	PrintLine(theLine, MONITOR_LOG_INFO);
+}
+
+// -------------------------------------------------------------------------- //
+//  * PrintJITStats( void )
+// -------------------------------------------------------------------------- //
+void
+TMonitor::PrintJITStats( void )
+{
+#ifdef JITTARGET_GENERIC
+	char theLine[256];
+	JITClass* theJIT = mMemory->GetJITObject();
+	const TJITCache<JITPageClass>::SStats& theStats = theJIT->GetCacheStats();
+	KUInt32 thePageCount = theJIT->GetCachePageCount();
+
+	(void) ::sprintf(
+		theLine, "Cache: %u pages, %u hits, %u misses, %u evictions",
+		(unsigned int) thePageCount,
+		(unsigned int) theStats.fHits,
+		(unsigned int) theStats.fMisses,
+		(unsigned int) theStats.fEvictions );
+	PrintLine(theLine, MONITOR_LOG_INFO);
+	(void) ::sprintf(
+		theLine, "Invalidations: %u pages, %u TLB, %u permissions",
+		(unsigned int) theStats.fInvalidatePages,
+		(unsigned int) theStats.fInvalidateTLBs,
+		(unsigned int) theStats.fInvalidatePerms );
+	PrintLine(theLine, MONITOR_LOG_INFO);
+
+	// Count the bound and hot pages and keep the most entered ones, sorted.
+	const KUInt32 kTopCount = 8;
+	JITPageClass* theTopPages[kTopCount];
+	KUInt32 theTopCount = 0;
+	KUInt32 theBoundCount = 0;
+	KUInt32 theHotCount = 0;
+	KUInt32 indexPage;
+	for (indexPage = 0; indexPage < thePageCount; indexPage++)
+	{
+		if (!theJIT->IsCachedPageBound( indexPage ))
+		{
+			continue;
+		}
+		theBoundCount++;
+		JITPageClass* thePage = theJIT->GetCachedPage( indexPage );
+		if (thePage->IsHot())
+		{
+			theHotCount++;
+		}
+		KUInt32 theCount = thePage->GetExecCount();
+		if (theCount == 0)
+		{
+			continue;
+		}
+		KUInt32 indexTop;
+		if (theTopCount < kTopCount)
+		{
+			indexTop = theTopCount++;
+		} else if (theTopPages[kTopCount - 1]->GetExecCount() < theCount) {
+			indexTop = kTopCount - 1;
+		} else {
+			continue;
+		}
+		while ((indexTop > 0)
+			&& (theTopPages[indexTop - 1]->GetExecCount() < theCount))
+		{
+			theTopPages[indexTop] = theTopPages[indexTop - 1];
+			indexTop--;
+		}
+		theTopPages[indexTop] = thePage;
+	}
+
+#if JIT_TIERED_TRANSLATION
+	(void) ::sprintf(
+		theLine, "Tiers: %u hot pages, %u cold pages, %u translated again",
+		(unsigned int) theHotCount,
+		(unsigned int) (theBoundCount - theHotCount),
+		(unsigned int) theJIT->GetTierUpCount() );
+	PrintLine(theLine, MONITOR_LOG_INFO);
+#else
+	(void) theBoundCount;
+	(void) theHotCount;
+#endif
+	KUInt32 indexTop;
+	for (indexTop = 0; indexTop < theTopCount; indexTop++)
+	{
+		JITPageClass* thePage = theTopPages[indexTop];
+		(void) ::sprintf(
+			theLine, "V0x%.8X P0x%.8X %10u entries%s",
+			(unsigned int) thePage->GetVAddr(),
+			(unsigned int) thePage->GetPAddr(),
+			(unsigned int) thePage->GetExecCount(),
+			thePage->IsHot() ? ", hot" : "" );
+		PrintLine(theLine, MONITOR_LOG_INFO);
+	}
+#else
+	PrintLine("No counters for this JIT", MONITOR_LOG_INFO);
+#endif
+}
+
 int
 TMonitor::FormatNSRef(char* buffer, size_t bufferSize, KUInt32 inRef, int indent, int maxDepth)
 {
@@ -216,6 +216,16 @@ protected:
 	///
 	void		PrintNSRef(KUInt32 inRef);
 
+	///
+	/// Display the counters of the JIT and its most executed pages.
+	///
+	void		PrintJITStats( void );
+
+	///
+	/// Display the counters of the TLB of the MMU.
+	///
+	void		PrintMMUStats( void );
+
 	///
 	/// Accessor on interrupt manager.
 	///
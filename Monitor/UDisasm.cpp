@@ -759,6 +759,9 @@ disasm_interface_t::di_printaddr( unsigned int inAddress )
 	if ( mSymbolList )
 	{
 		mSymbolList->GetNearestSymbolByAddress( inAddress, theSymbol, theComment, &theOffset );
+	} else {
+		// No symbols (e.g. einsteinaot), print the address.
+		(void) ::snprintf( theSymbol, sizeof(theSymbol), "%08X", inAddress );
 	}
 	
 	if (theOffset == 0)
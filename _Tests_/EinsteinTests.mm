@@ -58,6 +58,13 @@ typedef void (^LogBlock)(TLog* log);
 			UProcessorTests::ExecuteInstructionState1([instruction cStringUsingEncoding:NSUTF8StringEncoding], log);
 	} withOutputFile:outputFilePath];
 }
+- (void)doTestProcessorNativeCode:(NSString*) instruction {
+	NSString *outputFilePath = [[NSBundle bundleForClass:[self class]] pathForResource:[NSString stringWithFormat:@"master-test-native-code_%@", instruction] ofType:@""];
+
+	[self doTest: ^(TLog* log){
+			UProcessorTests::NativeCode([instruction cStringUsingEncoding:NSUTF8StringEncoding], log);
+	} withOutputFile:outputFilePath];
+}
 - (void)doTestProcessorExecuteInstructionState2:(NSString*) instruction {
 	NSString *outputFilePath = [[NSBundle bundleForClass:[self class]] pathForResource:[NSString stringWithFormat:@"master-test-execute-instruction-state2_%@", instruction] ofType:@""];
 	
@@ -265,6 +272,37 @@ typedef void (^LogBlock)(TLog* log);
     [self doTestProcessorExecuteInstructionState2:@"E1A0331C"];
 }
 
+- (void)testProcessorNativeCode_E0910002 {
+    [self doTestProcessorNativeCode:@"E0910002"];
+}
+- (void)testProcessorNativeCode_E0B10002 {
+    [self doTestProcessorNativeCode:@"E0B10002"];
+}
+- (void)testProcessorNativeCode_E0D10002 {
+    [self doTestProcessorNativeCode:@"E0D10002"];
+}
+- (void)testProcessorNativeCode_E0710002 {
+    [self doTestProcessorNativeCode:@"E0710002"];
+}
+- (void)testProcessorNativeCode_E1B00FE1 {
+    [self doTestProcessorNativeCode:@"E1B00FE1"];
+}
+- (void)testProcessorNativeCode_E1B00061 {
+    [self doTestProcessorNativeCode:@"E1B00061"];
+}
+- (void)testProcessorNativeCode_E1510002 {
+    [self doTestProcessorNativeCode:@"E1510002"];
+}
+- (void)testProcessorNativeCode_E0300004 {
+    [self doTestProcessorNativeCode:@"E0300004"];
+}
+- (void)testProcessorNativeCode_10810002 {
+    [self doTestProcessorNativeCode:@"10810002"];
+}
+- (void)testProcessorNativeCode_00810002 {
+    [self doTestProcessorNativeCode:@"00810002"];
+}
+
 - (void)testProcessorExecuteTwoInstructions_E282F014_E282F014 {
     [self doTestProcessorExecuteTwoInstructions:@"E282F014-E282F014"];
 }
@@ -582,6 +620,28 @@ bkpt 0
 	[self doTestProcessorRunCode:@"e3a01003 e3a00c02 e2800057 e1a02130 e1a031a0 e1a04150 e1a051c0 e1200070" master: @"20"];
 }
 
+// e3e03eff	mvn		r3, #0xFF0
+// e3a00000	mov		r0, #0x0
+// e2501000	subs	r1, r0, #0x0
+// e6902061	ldr		r2, [r0], r1, rrx
+// e2933001	adds	r3, r3, #0x1
+// 1afffffa	bne		0x00000004
+// e1200070	bkpt	#0x0
+// The loop makes the page hot. The carry set by subs is only read by the
+// rrx of ldr, adds clears it again.
+- (void)testProcessorRunCode_21 {
+	[self doTestProcessorRunCode:@"e3e03eff e3a00000 e2501000 e6902061 e2933001 1afffffa e1200070" master: @"21"];
+}
+
+// A loop that polls the timer. The JIT should wait for the next timer match
+// instead of spinning.
+- (void)testProcessorIdleLoop {
+	NSString *outputFilePath = [[NSBundle bundleForClass:[self class]] pathForResource:@"master-test-idle-loop" ofType:@""];
+	[self doTest: ^(TLog* log){
+		UProcessorTests::IdleLoop(log);
+	} withOutputFile:outputFilePath];
+}
+
 // Step tests require a ROM image
 
 - (void)testMemoryReadROM {
@@ -16,12 +16,18 @@
 #include "UMemoryTests.h"
 
 // ANSI C & POSIX
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
 #if !TARGET_OS_WIN32
 	#include <unistd.h>
+	#include <sys/time.h>
 #endif
 
 // K
 #include <K/Defines/UByteSex.h>
+#include <K/Streams/TFileStream.h>
 
 // Einstein
 #include "Emulator/Log/TLog.h"
@@ -32,8 +38,10 @@
 // -------------------------------------------------------------------------- //
 #if TARGET_OS_WIN32
 	#define kTempFlashPath "c:/EinsteinTests.flash"
+	#define kTempStatePath "c:/EinsteinTests.state"
 #else
 	#define kTempFlashPath "/tmp/EinsteinTests.flash"
+	#define kTempStatePath "/tmp/EinsteinTests.state"
 #endif
 
 // -------------------------------------------------------------------------- //
@@ -260,6 +268,155 @@ UMemoryTests::FlashTest( TLog* inLog )
 	::free( romBuffer );
 }
 
+// -------------------------------------------------------------------------- //
+//  * SetMMUMode( TMMU*, KUInt32 )
+// -------------------------------------------------------------------------- //
+static void
+SetMMUMode( TMMU* inMMU, KUInt32 inMode )
+{
+	inMMU->SetPrivilege( (inMode & 0x1) != 0 );
+	inMMU->SetROMProtection( (inMode & 0x2) != 0 );
+	inMMU->SetSystemProtection( (inMode & 0x4) != 0 );
+}
+
+// -------------------------------------------------------------------------- //
+//  * MMUTransferStateTest( TLog* )
+// -------------------------------------------------------------------------- //
+void
+UMemoryTests::MMUTransferStateTest( TLog* inLog )
+{
+	KUInt8* romBuffer = (KUInt8*) malloc(TMemoryConsts::kLowROMEnd);
+	TMemory theMem( inLog, romBuffer, kTempFlashPath );
+	TMMU* theMMU = theMem.GetMMU();
+
+	// Save the state in a mode and restore it over another mode. The JIT
+	// must record the restored mode.
+	static const KUInt32 kModes[][2] = {
+		{ 4, 1 },		// user, system protection over privileged.
+		{ 1, 6 },		// privileged over user, ROM and system protection.
+		{ 0, 7 },		// user over privileged, every protection.
+	};
+	KUInt32 index;
+	for (index = 0; index < sizeof(kModes) / sizeof(kModes[0]); index++)
+	{
+		SetMMUMode( theMMU, kModes[index][0] );
+		{
+			TFileStream theStream( kTempStatePath, "wb" );
+			theMMU->TransferState( &theStream );
+		}
+		SetMMUMode( theMMU, kModes[index][1] );
+		{
+			TFileStream theStream( kTempStatePath, "rb" );
+			theMMU->TransferState( &theStream );
+		}
+		inLog->FLogLine("MMU mode: %u, JIT mode: %u",
+			(unsigned int) theMMU->GetAPMode(),
+			(unsigned int) theMem.GetJITObject()->GetAPMode());
+	}
+
+	(void) ::unlink( kTempStatePath );
+	(void) ::unlink( kTempFlashPath );
+	::free( romBuffer );
+}
+
+#if !TARGET_OS_WIN32
+// -------------------------------------------------------------------------- //
+//  * SwapMegabytesPerSecond( ... )
+// -------------------------------------------------------------------------- //
+// Time a number of passes of a swap function over the buffer.
+static double
+SwapMegabytesPerSecond(
+		void (*inSwapArray)( KUInt32*, const KUInt32*, KUIntPtr ),
+		KUInt32* outDest,
+		const KUInt32* inSource,
+		KUInt32 inCount,
+		KUInt32 inPasses )
+{
+	struct timeval theStart;
+	struct timeval theEnd;
+	(void) ::gettimeofday( &theStart, NULL );
+	KUInt32 indexPass;
+	for (indexPass = 0; indexPass < inPasses; indexPass++)
+	{
+		(*inSwapArray)( outDest, inSource, inCount );
+	}
+	(void) ::gettimeofday( &theEnd, NULL );
+
+	double theSeconds = (double) (theEnd.tv_sec - theStart.tv_sec)
+		+ ((double) (theEnd.tv_usec - theStart.tv_usec) / 1000000.0);
+	double theMegabytes =
+		((double) inCount * sizeof( KUInt32 ) * inPasses) / (1024.0 * 1024.0);
+	return theSeconds > 0.0 ? theMegabytes / theSeconds : 0.0;
+}
+
+// -------------------------------------------------------------------------- //
+//  * ByteSwapBenchmark( const char*, TLog* )
+// -------------------------------------------------------------------------- //
+void
+UMemoryTests::ByteSwapBenchmark( const char* inMegabytes, TLog* inLog )
+{
+	KUInt32 theMegabytes = 16;
+	if (inMegabytes != nil)
+	{
+		theMegabytes = (KUInt32) ::strtoul( inMegabytes, NULL, 0 );
+	}
+	if (theMegabytes == 0)
+	{
+		inLog->LogLine("This test requires a size in megabytes.");
+		return;
+	}
+
+	// An odd number of words, to go through the end of the kernels.
+	KUInt32 theCount = ((theMegabytes * 1024 * 1024) / sizeof( KUInt32 )) - 3;
+	KUInt32* theSource = (KUInt32*) ::malloc( theCount * sizeof( KUInt32 ) );
+	KUInt32* theScalar = (KUInt32*) ::malloc( theCount * sizeof( KUInt32 ) );
+	KUInt32* theVector = (KUInt32*) ::malloc( theCount * sizeof( KUInt32 ) );
+	KUInt32 indexWord;
+	for (indexWord = 0; indexWord < theCount; indexWord++)
+	{
+		theSource[indexWord] = (indexWord * 0x9E3779B1) ^ (indexWord >> 3);
+	}
+
+	// Check the kernel against the scalar version, with unaligned
+	// pointers too.
+	UByteSex::SwapArrayScalar( theScalar, theSource, theCount );
+	UByteSex::SwapArray( theVector, theSource, theCount );
+	Boolean theResult =
+		::memcmp( theScalar, theVector, theCount * sizeof( KUInt32 ) ) == 0;
+	UByteSex::SwapArray(
+		(KUInt32*) (((KUInt8*) theVector) + 1),
+		(const KUInt32*) (((KUInt8*) theSource) + 2),
+		theCount - 1 );
+	UByteSex::SwapArrayScalar(
+		theScalar,
+		(const KUInt32*) (((KUInt8*) theSource) + 2),
+		theCount - 1 );
+	theResult = theResult && (::memcmp(
+		theScalar, ((KUInt8*) theVector) + 1,
+		(theCount - 1) * sizeof( KUInt32 ) ) == 0);
+	// And in place.
+	UByteSex::SwapArray( theVector, theScalar, theCount );
+	UByteSex::SwapArray( theVector, theVector, theCount );
+	theResult = theResult && (::memcmp(
+		theScalar, theVector, theCount * sizeof( KUInt32 ) ) == 0);
+	inLog->FLogLine("Kernel: %s, %s",
+		UByteSex::GetSwapArrayKernel(), theResult ? "ok" : "MISMATCH");
+
+	// Time both versions.
+	const KUInt32 kPasses = 16;
+	double theScalarRate = SwapMegabytesPerSecond(
+		UByteSex::SwapArrayScalar, theScalar, theSource, theCount, kPasses );
+	double theVectorRate = SwapMegabytesPerSecond(
+		UByteSex::SwapArray, theVector, theSource, theCount, kPasses );
+	inLog->FLogLine("scalar: %.0f MB/s", theScalarRate);
+	inLog->FLogLine("%s: %.0f MB/s", UByteSex::GetSwapArrayKernel(), theVectorRate);
+
+	::free( theVector );
+	::free( theScalar );
+	::free( theSource );
+}
+#endif
+
 // ========================================================= //
 // You are in a maze of little twisting passages, all alike. //
 // ========================================================= //
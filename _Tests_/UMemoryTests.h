@@ -46,6 +46,22 @@ public:
 	/// Perform flash accesses.
 	///
 	static void FlashTest( TLog* inLog );
+
+	///
+	/// Save the state of the MMU in a privilege mode and restore it over
+	/// another one.
+	///
+	static void MMUTransferStateTest( TLog* inLog );
+
+#if !TARGET_OS_WIN32
+	///
+	/// Check the byte swapping kernel of the host against the scalar
+	/// version and compare their speeds.
+	///
+	/// \param inMegabytes	size of the buffer in MB (default 16).
+	///
+	static void ByteSwapBenchmark( const char* inMegabytes, TLog* inLog );
+#endif
 };
 
 #endif
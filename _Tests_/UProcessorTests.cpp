@@ -17,6 +17,7 @@
 
 // ANSI C & POSIX
 #include <stdlib.h>
+#include <string.h>
 
 #if !TARGET_OS_WIN32
 	#include <unistd.h>
@@ -47,6 +48,29 @@
 	#define kTempFlashPath "/tmp/EinsteinTests.flash"
 #endif
 
+// -------------------------------------------------------------------------- //
+//  * SetState1( TARMProcessor* )
+// -------------------------------------------------------------------------- //
+static void
+SetState1( TARMProcessor* ioProcessor )
+{
+	ioProcessor->SetRegister( 0, 0x01020304 );
+	ioProcessor->SetRegister( 1, 0x05060708 );
+	ioProcessor->SetRegister( 2, 0x090A0B0C );
+	ioProcessor->SetRegister( 3, 0x0D0E0F10 );
+	ioProcessor->SetRegister( 4, 0x11121314 );
+	ioProcessor->SetRegister( 5, 0x15161718 );
+	ioProcessor->SetRegister( 6, 0x191A1B1C );
+	ioProcessor->SetRegister( 7, 0x1D1E1F20 );
+	ioProcessor->SetRegister( 8, 0x21222324 );
+	ioProcessor->SetRegister( 9, 0x25262728 );
+	ioProcessor->SetRegister( 10, 0x292A2B2C );
+	ioProcessor->SetRegister( 11, 0x2D2E2F30 );
+	ioProcessor->SetRegister( 12, 0x31323334 );
+	ioProcessor->SetRegister( 13, 0x35363738 );
+	ioProcessor->SetRegister( 14, 0x393A3B3C );
+}
+
 // -------------------------------------------------------------------------- //
 //  * ExecuteInstruction( const char* )
 // -------------------------------------------------------------------------- //
@@ -94,21 +118,7 @@ UProcessorTests::ExecuteInstructionState1( const char* inHexWord, TLog* inLog )
 		((KUInt32*) rom)[0] = theInstruction;
 		TMemory theMem( inLog, rom, kTempFlashPath );
 		TARMProcessor theProcessor( inLog, &theMem );
-		theProcessor.SetRegister( 0, 0x01020304 );
-		theProcessor.SetRegister( 1, 0x05060708 );
-		theProcessor.SetRegister( 2, 0x090A0B0C );
-		theProcessor.SetRegister( 3, 0x0D0E0F10 );
-		theProcessor.SetRegister( 4, 0x11121314 );
-		theProcessor.SetRegister( 5, 0x15161718 );
-		theProcessor.SetRegister( 6, 0x191A1B1C );
-		theProcessor.SetRegister( 7, 0x1D1E1F20 );
-		theProcessor.SetRegister( 8, 0x21222324 );
-		theProcessor.SetRegister( 9, 0x25262728 );
-		theProcessor.SetRegister( 10, 0x292A2B2C );
-		theProcessor.SetRegister( 11, 0x2D2E2F30 );
-		theProcessor.SetRegister( 12, 0x31323334 );
-		theProcessor.SetRegister( 13, 0x35363738 );
-		theProcessor.SetRegister( 14, 0x393A3B3C );
+		SetState1( &theProcessor );
 //		theProcessor.SetRegister( 15, 0x00000004 );
 		theMem.GetJITObject()->Step( &theProcessor, 1 );
 		theProcessor.PrintRegisters();
@@ -117,6 +127,74 @@ UProcessorTests::ExecuteInstructionState1( const char* inHexWord, TLog* inLog )
 	}
 }
 
+// -------------------------------------------------------------------------- //
+//  * NativeCode( const char* )
+// -------------------------------------------------------------------------- //
+void
+UProcessorTests::NativeCode( const char* inHexWord, TLog* inLog )
+{
+	KUInt32 theInstruction;
+	if (inHexWord == nil)
+	{
+		(void) ::printf( "This test requires an instruction in hexa.\n" );
+	} else if (::sscanf(
+					inHexWord,
+					"%X",
+					(unsigned int*) &theInstruction ) != 1) {
+		(void) ::printf( "Can't parse instruction (%s).\n", inHexWord );
+	} else {
+		KUInt8* rom = (KUInt8*) ::calloc( 8 * 1024 * 1024, 1 );
+		((KUInt32*) rom)[0] = theInstruction;
+		TMemory theMem( inLog, rom, kTempFlashPath );
+		TARMProcessor theProcessor( inLog, &theMem );
+		SetState1( &theProcessor );
+		theProcessor.SetCPSR( theProcessor.GetCPSR() | TARMProcessor::kPSR_CBit );
+		KUInt32 theCPSR = theProcessor.GetCPSR();
+		// Stepping executes the generic units.
+		theMem.GetJITObject()->Step( &theProcessor, 1 );
+		theProcessor.PrintRegisters();
+#if JIT_NATIVE_CODE
+		// Run the native code from the same state. Only differences are
+		// printed, so the output is the same without native code.
+		TARMProcessor theNativeProcessor( inLog, &theMem );
+		SetState1( &theNativeProcessor );
+		theNativeProcessor.SetCPSR( theCPSR );
+		TJITX86_64Emitter theEmitter;
+		JITNativeFuncPtr theCode =
+			(JITNativeFuncPtr) theEmitter.Translate( theInstruction, 0, 0 );
+		if (theCode == NULL)
+		{
+			(void) ::printf( "No native code for %.8X.\n",
+				(unsigned int) theInstruction );
+		} else {
+			theEmitter.CloseBlock();
+			theEmitter.MakeExecutable();
+			(void) theCode( &theNativeProcessor );
+			KUInt32 indexReg;
+			for (indexReg = 0; indexReg < 15; indexReg++)
+			{
+				if (theNativeProcessor.GetRegister( indexReg )
+					!= theProcessor.GetRegister( indexReg ))
+				{
+					(void) ::printf( "Native R%i = %.8X\n",
+						(int) indexReg,
+						(unsigned int) theNativeProcessor.GetRegister( indexReg ) );
+				}
+			}
+			if (theNativeProcessor.GetCPSR() != theProcessor.GetCPSR())
+			{
+				(void) ::printf( "Native CPSR = %.8X\n",
+					(unsigned int) theNativeProcessor.GetCPSR() );
+			}
+		}
+#else
+		(void) theCPSR;
+#endif
+		(void) ::unlink( kTempFlashPath );
+		::free( rom );
+	}
+}
+
 // -------------------------------------------------------------------------- //
 //  * ExecuteInstructionState2( const char* )
 // -------------------------------------------------------------------------- //
@@ -204,6 +282,54 @@ UProcessorTests::RunCode( const char* inHexWords, TLog* inLog ) {
 	}
 }
 
+// -------------------------------------------------------------------------- //
+//  * IdleLoop( TLog* )
+// -------------------------------------------------------------------------- //
+void
+UProcessorTests::IdleLoop( TLog* inLog ) {
+	// Wait for 0x10000 ticks (about 18 ms), like SafeShortTimerDelay.
+	// The copies of the time make the passes long enough for the ticks to
+	// change before the JIT counts enough passes with the same registers.
+	static const KUInt32 kCode[] = {
+		0xE3A0040F,		// mov		r0, #0x0F000000
+		0xE2800818,		// add		r0, r0, #0x00180000
+		0xE2800C18,		// add		r0, r0, #0x00001800 (ticks)
+		0xE5902000,		// ldr		r2, [r0]
+		0xE2822801,		// add		r2, r2, #0x00010000
+		0xE5901000,		// loop: ldr	r1, [r0]
+		0xE0513002,		// subs		r3, r1, r2
+		0xE1A04001,		// mov		r4, r1
+		0xE1A05001,		// mov		r5, r1
+		0xE1A06001,		// mov		r6, r1
+		0xE1A07001,		// mov		r7, r1
+		0xE1A08001,		// mov		r8, r1
+		0xE1A09001,		// mov		r9, r1
+		0x4AFFFFF6,		// bmi		loop
+		0xE3A01000,		// mov		r1, #0
+		0xE3A02000,		// mov		r2, #0
+		0xE3A03000,		// mov		r3, #0
+		0xE3A04000,		// mov		r4, #0
+		0xE3A05000,		// mov		r5, #0
+		0xE3A06000,		// mov		r6, #0
+		0xE3A07000,		// mov		r7, #0
+		0xE3A08000,		// mov		r8, #0
+		0xE3A09000,		// mov		r9, #0
+		0xE1500000,		// cmp		r0, r0
+		0xE1200070		// bkpt
+	};
+	KUInt8* rom = (KUInt8*) ::calloc( 8 * 1024 * 1024, 1 );
+	(void) ::memcpy( rom, kCode, sizeof(kCode) );
+
+	TEmulator theEmulator(inLog, rom, kTempFlashPath);
+	theEmulator.Run();
+	theEmulator.GetProcessor()->PrintRegisters();
+	if (inLog) {
+		inLog->FLogLine("Waited for a timer match: %s",
+			theEmulator.GetInterruptManager()->GetIdleCount() ? "yes" : "no");
+	}
+	(void) ::unlink( kTempFlashPath );
+	::free( rom );
+}
 
 // -------------------------------------------------------------------------- //
 //  * Step( const char* )
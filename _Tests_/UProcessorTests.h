@@ -46,6 +46,16 @@ public:
 	///
 	static void ExecuteInstructionState1( const char* inHexWord, TLog* inLog );
 
+	///
+	/// Execute an instruction from the state of ExecuteInstructionState1
+	/// with the carry set and print the registers afterwards. With the
+	/// x86-64 target, also run the native code of the instruction and print
+	/// the registers that differ.
+	///
+	/// \param inHexWord	instruction (as hexa) to execute.
+	///
+	static void NativeCode( const char* inHexWord, TLog* inLog );
+
 	///
 	/// Execute an instruction and print the registers afterwards.
 	/// The processor is set in some random (actually fixed) state.
@@ -68,6 +78,12 @@ public:
 	///
 	static void RunCode( const char* inHexWords, TLog* inLog );
 
+	///
+	/// Run a loop that polls the timer and tell whether the JIT waited for
+	/// the next timer match instead of spinning.
+	///
+	static void IdleLoop( TLog* inLog );
+
 	///
 	/// Step into the ROM (found at ../../_Data_/717006)
 	///
@@ -198,3 +198,37 @@ perl tests.pl "$TESTSPATH" execute-instruction EE010F11
 
 # 00000000 mla      r0, r4, r0, r5
 perl tests.pl "$TESTSPATH" execute-instruction-state1 E0205094
+
+# Poll the timer for 0x10000 ticks, the JIT should wait for the match.
+perl tests.pl "$TESTSPATH" idle-loop
+
+# Native code (x86-64 target) and generic units, with the carry set.
+# 00000000 adds     r0, r1, r2
+perl tests.pl "$TESTSPATH" native-code E0910002
+
+# 00000000 adcs     r0, r1, r2
+perl tests.pl "$TESTSPATH" native-code E0B10002
+
+# 00000000 sbcs     r0, r1, r2
+perl tests.pl "$TESTSPATH" native-code E0D10002
+
+# 00000000 rsbs     r0, r1, r2
+perl tests.pl "$TESTSPATH" native-code E0710002
+
+# 00000000 movs     r0, r1, ror #31
+perl tests.pl "$TESTSPATH" native-code E1B00FE1
+
+# 00000000 movs     r0, r1, rrx
+perl tests.pl "$TESTSPATH" native-code E1B00061
+
+# 00000000 cmp      r1, r2
+perl tests.pl "$TESTSPATH" native-code E1510002
+
+# 00000000 eors     r0, r0, r4
+perl tests.pl "$TESTSPATH" native-code E0300004
+
+# 00000000 addne    r0, r1, r2
+perl tests.pl "$TESTSPATH" native-code 10810002
+
+# 00000000 addeq    r0, r1, r2
+perl tests.pl "$TESTSPATH" native-code 00810002
@@ -2,3 +2,4 @@
 . common.sh $*
 perl tests.pl "$TESTSPATH" memory-read-rom
 perl tests.pl "$TESTSPATH" memory-read-write-ram
+perl tests.pl "$TESTSPATH" mmu-transfer-state
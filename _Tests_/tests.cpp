@@ -64,6 +64,9 @@ test( const char* inTestName, const char* inArgument )
 	} else if (::strcmp(inTestName, "execute-instruction-state1") == 0) {
 		// inArgument: instruction to execute.
 		UProcessorTests::ExecuteInstructionState1( inArgument, &theLog );
+	} else if (::strcmp(inTestName, "native-code") == 0) {
+		// inArgument: instruction to execute.
+		UProcessorTests::NativeCode( inArgument, &theLog );
 	} else if (::strcmp(inTestName, "execute-instruction-state2") == 0) {
 		// inArgument: instruction to execute.
 		UProcessorTests::ExecuteInstructionState2( inArgument, &theLog );
@@ -76,6 +79,8 @@ test( const char* inTestName, const char* inArgument )
 	} else if (::strcmp(inTestName, "run-code") == 0) {
 		// inArgument: code to execute.
 		UProcessorTests::RunCode( inArgument, &theLog );
+	} else if (::strcmp(inTestName, "idle-loop") == 0) {
+		UProcessorTests::IdleLoop( &theLog );
 #ifndef TARGET_OS_MAC
 	} else if (::strcmp(inTestName, "screen-x11") == 0) {
 		UScreenTests::TestX11();
@@ -86,6 +91,13 @@ test( const char* inTestName, const char* inArgument )
 		UMemoryTests::ReadWriteRAMTest(&theLog);
 	} else if (::strcmp(inTestName, "flash") == 0) {
 		UMemoryTests::FlashTest(&theLog);
+	} else if (::strcmp(inTestName, "mmu-transfer-state") == 0) {
+		UMemoryTests::MMUTransferStateTest(&theLog);
+#if !TARGET_OS_WIN32
+	} else if (::strcmp(inTestName, "byteswap-benchmark") == 0) {
+		// inArgument: size of the buffer in MB.
+		UMemoryTests::ByteSwapBenchmark( inArgument, &theLog );
+#endif
 	} else if (::strcmp(inTestName, "host-info") == 0) {
 		UHostInfoTests::HostInfoTest(&theLog);
 	} else {
@@ -0,0 +1,1017 @@
+// ==============================
+// File:			TAOTCompiler.cp
+// Project:			Einstein
+//
+// Copyright 2003-2007 by Paul Guyot (pguyot@kallisys.net).
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+#include <K/Defines/KDefinitions.h>
+#include "TAOTCompiler.h"
+
+// ANSI C & POSIX
+#include <stdio.h>
+
+// Einstein
+#include "Emulator/JIT/JIT.h"
+#include "Emulator/JIT/Generic/TJITGenericROMPatch.h"
+#include "Monitor/UDisasm.h"
+
+// -------------------------------------------------------------------------- //
+// Constantes
+// -------------------------------------------------------------------------- //
+
+static const char* const kConditions[16] = {
+	"EQ", "NE", "CS", "CC", "MI", "PL", "VS", "VC",
+	"HI", "LS", "GE", "LT", "GT", "LE", "AL", "NV"
+};
+
+// -------------------------------------------------------------------------- //
+//  * TAOTCompiler( const KUInt32*, const KUInt32*, KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+TAOTCompiler::TAOTCompiler(
+			const KUInt32* inROM,
+			const KUInt32* inPatchedROM,
+			KUInt32 inROMSize,
+			KUInt32 inWindow )
+	:
+		mROM( inROM ),
+		mPatchedROM( inPatchedROM ),
+		mROMSize( inROMSize ),
+		mWindow( inWindow ),
+		mEntry( 0 )
+{
+}
+
+// -------------------------------------------------------------------------- //
+//  * WriteHeader( FILE*, Boolean )
+// -------------------------------------------------------------------------- //
+void
+TAOTCompiler::WriteHeader( FILE* inFile, Boolean inVerify )
+{
+	(void) ::fprintf( inFile,
+		"// ==============================\n"
+		"// File:\t\t\tPrecompiledPatches.cp\n"
+		"// Project:\t\t\tEinstein\n"
+		"//\n"
+		"// Generated by einsteinaot, do not edit.\n"
+		"// ==============================\n"
+		"\n"
+		"#include <K/Defines/KDefinitions.h>\n"
+		"#include \"JIT.h\"\n"
+		"\n"
+		"#ifdef JITTARGET_GENERIC\n"
+		"\n"
+		"#define PRECOMPILED_VERIFY %d\n"
+		"#include \"Emulator/ROM/PrecompiledPatches.h\"\n"
+		"\n",
+		inVerify ? 1 : 0 );
+}
+
+// -------------------------------------------------------------------------- //
+//  * WriteFooter( FILE*, KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TAOTCompiler::WriteFooter( FILE* inFile, KUInt32 inCount )
+{
+	(void) ::fprintf( inFile,
+		"KUInt32 gPrecompiledFunctionCount = %u;\n"
+		"\n"
+		"#endif\n",
+		(unsigned int) inCount );
+}
+
+// -------------------------------------------------------------------------- //
+//  * GetInstruction( KUInt32, KUInt32* ) const
+// -------------------------------------------------------------------------- //
+Boolean
+TAOTCompiler::GetInstruction( KUInt32 inAddress, KUInt32* outInstruction ) const
+{
+	if ((inAddress & 0x3) || (inAddress >= mROMSize))
+	{
+		return false;
+	}
+
+	KUInt32 theInstruction = mROM[inAddress >> 2];
+	KUInt32 thePatched = mPatchedROM[inAddress >> 2];
+	if (thePatched != theInstruction)
+	{
+		// The translations of a previous run are replaced, the other
+		// patches are left to the JIT.
+		TJITGenericPatchObject* thePatch = NULL;
+		if (TJITGenericPatchObject::IsNativeCall(thePatched)
+			|| TJITGenericPatchObject::IsNativeInjection(thePatched))
+		{
+			thePatch = TJITGenericPatchManager::GetPatchAt(
+							TJITGenericPatchObject::GetIndex(thePatched));
+		}
+		if (dynamic_cast<TJITGenericPatchPrecompiled*>(thePatch) == NULL)
+		{
+			return false;
+		}
+	}
+
+	*outInstruction = theInstruction;
+	return true;
+}
+
+// -------------------------------------------------------------------------- //
+//  * CanTranslate( KUInt32 )
+// -------------------------------------------------------------------------- //
+Boolean
+TAOTCompiler::CanTranslate( KUInt32 inInstruction )
+{
+	if ((inInstruction >> 28) == 0xF)
+	{
+		// Never, it's a nop.
+		return true;
+	}
+
+	switch ((inInstruction >> 25) & 0x7)
+	{
+		case 0x0:
+			if ((inInstruction & 0x0FC000F0) == 0x00000090)
+			{
+				// MUL, MLA without S and without the PC.
+				KUInt32 Rd = (inInstruction >> 16) & 0xF;
+				KUInt32 Rn = (inInstruction >> 12) & 0xF;
+				KUInt32 Rs = (inInstruction >> 8) & 0xF;
+				KUInt32 Rm = inInstruction & 0xF;
+				return ((inInstruction & 0x00100000) == 0)
+					&& (Rd != 15) && (Rn != 15) && (Rs != 15) && (Rm != 15);
+			}
+			if ((inInstruction & 0x00000090) == 0x00000090)
+			{
+				// Long multiplications, swaps, half words.
+				return false;
+			}
+			if (inInstruction & 0x00000010)
+			{
+				// Shift by a register.
+				return false;
+			}
+			// Fall through.
+		case 0x1:
+		{
+			KUInt32 theOpCode = (inInstruction >> 21) & 0xF;
+			Boolean theS = (inInstruction & 0x00100000) != 0;
+			KUInt32 Rd = (inInstruction >> 12) & 0xF;
+			if ((theOpCode >= 0x8) && (theOpCode <= 0xB))
+			{
+				// MRS, MSR and the tests that write the PSR.
+				return theS && (Rd != 15);
+			}
+			// movs pc, lr and the like restore the CPSR.
+			return !(theS && (Rd == 15));
+		}
+
+		case 0x3:
+			if (inInstruction & 0x00000010)
+			{
+				// Undefined.
+				return false;
+			}
+			// Fall through.
+		case 0x2:
+		{
+			Boolean theP = (inInstruction & 0x01000000) != 0;
+			Boolean theB = (inInstruction & 0x00400000) != 0;
+			Boolean theW = (inInstruction & 0x00200000) != 0;
+			KUInt32 Rn = (inInstruction >> 16) & 0xF;
+			KUInt32 Rd = (inInstruction >> 12) & 0xF;
+			Boolean theWriteBack = theW || !theP;
+			if (!theP && theW)
+			{
+				// User mode access (LDRT, STRT).
+				return false;
+			}
+			if ((inInstruction & 0x02000000) && ((inInstruction & 0xF) == 15))
+			{
+				return false;
+			}
+			if (theWriteBack && ((Rn == 15) || (Rn == Rd)))
+			{
+				return false;
+			}
+			if (theB && (Rd == 15))
+			{
+				return false;
+			}
+			return true;
+		}
+
+		case 0x4:
+		{
+			KUInt32 Rn = (inInstruction >> 16) & 0xF;
+			KUInt32 theList = inInstruction & 0xFFFF;
+			if (inInstruction & 0x00400000)
+			{
+				// User bank or CPSR restore.
+				return false;
+			}
+			if ((Rn == 15) || (theList == 0))
+			{
+				return false;
+			}
+			if ((inInstruction & 0x00200000) && (theList & (1 << Rn)))
+			{
+				return false;
+			}
+			return true;
+		}
+
+		case 0x5:
+			return true;
+
+		default:
+			// Coprocessors and SWIs.
+			return false;
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * WritesPC( KUInt32 )
+// -------------------------------------------------------------------------- //
+Boolean
+TAOTCompiler::WritesPC( KUInt32 inInstruction )
+{
+	switch ((inInstruction >> 25) & 0x7)
+	{
+		case 0x0:
+		case 0x1:
+		{
+			if ((inInstruction & 0x0E0000F0) == 0x00000090)
+			{
+				return false;
+			}
+			KUInt32 theOpCode = (inInstruction >> 21) & 0xF;
+			if ((theOpCode >= 0x8) && (theOpCode <= 0xB))
+			{
+				return false;
+			}
+			return ((inInstruction >> 12) & 0xF) == 15;
+		}
+
+		case 0x2:
+		case 0x3:
+			return (inInstruction & 0x00100000)
+				&& (((inInstruction >> 12) & 0xF) == 15);
+
+		case 0x4:
+			return (inInstruction & 0x00100000)
+				&& (inInstruction & 0x00008000);
+
+		case 0x5:
+			// Calls leave the function.
+			return (inInstruction & 0x01000000) != 0;
+
+		default:
+			return false;
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * FallsThrough( KUInt32 )
+// -------------------------------------------------------------------------- //
+Boolean
+TAOTCompiler::FallsThrough( KUInt32 inInstruction )
+{
+	if ((inInstruction >> 28) != 0xE)
+	{
+		return true;
+	}
+	if (((inInstruction >> 25) & 0x7) == 0x5)
+	{
+		return false;
+	}
+	return !WritesPC( inInstruction );
+}
+
+// -------------------------------------------------------------------------- //
+//  * BranchTarget( KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+KUInt32
+TAOTCompiler::BranchTarget( KUInt32 inInstruction, KUInt32 inAddress )
+{
+	KUInt32 theOffset = (inInstruction & 0x00FFFFFF) << 2;
+	if (theOffset & 0x02000000)
+	{
+		theOffset |= 0xFC000000;
+	}
+	return inAddress + 8 + theOffset;
+}
+
+// -------------------------------------------------------------------------- //
+//  * Discover( KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TAOTCompiler::Discover( KUInt32 inEntry )
+{
+	mTranslated.clear();
+	mExits.clear();
+	mLabels.clear();
+
+	KUInt32 theEnd = inEntry + (mWindow * 4);
+	std::set<KUInt32> theWorkList;
+	theWorkList.insert( inEntry );
+	while (!theWorkList.empty())
+	{
+		KUInt32 theAddress = *theWorkList.begin();
+		theWorkList.erase( theWorkList.begin() );
+		if ((theAddress < inEntry) || (theAddress >= theEnd)
+			|| mTranslated.count( theAddress ) || mExits.count( theAddress ))
+		{
+			continue;
+		}
+
+		KUInt32 theInstruction;
+		if (!GetInstruction( theAddress, &theInstruction )
+			|| !CanTranslate( theInstruction ))
+		{
+			mExits.insert( theAddress );
+			continue;
+		}
+		mTranslated.insert( theAddress );
+
+		if (((theInstruction >> 28) != 0xF)
+			&& (((theInstruction >> 25) & 0x7) == 0x5)
+			&& !(theInstruction & 0x01000000))
+		{
+			theWorkList.insert( BranchTarget( theInstruction, theAddress ) );
+		}
+		if (FallsThrough( theInstruction ))
+		{
+			theWorkList.insert( theAddress + 4 );
+		}
+	}
+
+	// Branches to translated instructions need a label.
+	std::set<KUInt32>::const_iterator it;
+	for (it = mTranslated.begin(); it != mTranslated.end(); ++it)
+	{
+		KUInt32 theInstruction;
+		(void) GetInstruction( *it, &theInstruction );
+		if (((theInstruction >> 28) != 0xF)
+			&& (((theInstruction >> 25) & 0x7) == 0x5)
+			&& !(theInstruction & 0x01000000))
+		{
+			KUInt32 theTarget = BranchTarget( theInstruction, *it );
+			if (mTranslated.count( theTarget ))
+			{
+				mLabels.insert( theTarget );
+			}
+		}
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * Compile( FILE*, KUInt32, KUInt64 )
+// -------------------------------------------------------------------------- //
+Boolean
+TAOTCompiler::Compile( FILE* inFile, KUInt32 inEntry, KUInt64 inHits )
+{
+	mEntry = inEntry;
+	Discover( inEntry );
+	if (mTranslated.count( inEntry ) == 0)
+	{
+		return false;
+	}
+
+	// Loops need a counter.
+	Boolean hasLoops = false;
+	std::set<KUInt32>::const_iterator it;
+	for (it = mTranslated.begin(); it != mTranslated.end(); ++it)
+	{
+		KUInt32 theInstruction;
+		(void) GetInstruction( *it, &theInstruction );
+		if ((((theInstruction >> 25) & 0x7) == 0x5)
+			&& !(theInstruction & 0x01000000)
+			&& mLabels.count( BranchTarget( theInstruction, *it ) )
+			&& (BranchTarget( theInstruction, *it ) <= *it))
+		{
+			hasLoops = true;
+		}
+	}
+
+	(void) ::fprintf( inFile,
+		"// -------------------------------------------------------------------------- //\n"
+		"//  * 0x%08X (%llu hits, %u instructions)\n"
+		"// -------------------------------------------------------------------------- //\n"
+		"PRECOMPILED_FUNCTION(0x%08X)\n"
+		"{\n",
+		(unsigned int) inEntry,
+		(unsigned long long) inHits,
+		(unsigned int) mTranslated.size(),
+		(unsigned int) inEntry );
+	if (hasLoops)
+	{
+		(void) ::fprintf( inFile, "\tKUInt32 theLoops = 0;\n" );
+	}
+
+	// Instructions in address order, with the exits where the function
+	// continues with an instruction that is not translated.
+	std::set<KUInt32> theAll( mTranslated );
+	theAll.insert( mExits.begin(), mExits.end() );
+	for (it = theAll.begin(); it != theAll.end(); ++it)
+	{
+		KUInt32 theAddress = *it;
+		if (mExits.count( theAddress ))
+		{
+			(void) ::fprintf( inFile,
+				"\tAOT_EXIT(0x%08X);\n",
+				(unsigned int) theAddress );
+			continue;
+		}
+
+		KUInt32 theInstruction;
+		(void) GetInstruction( theAddress, &theInstruction );
+		if (mLabels.count( theAddress ))
+		{
+			(void) ::fprintf( inFile, "L%08X:\n", (unsigned int) theAddress );
+		}
+		EmitInstruction( inFile, theInstruction, theAddress );
+
+		// Continue with the next instruction.
+		if (FallsThrough( theInstruction ))
+		{
+			std::set<KUInt32>::const_iterator theNext = it;
+			++theNext;
+			if ((theNext == theAll.end()) || (*theNext != theAddress + 4))
+			{
+				(void) ::fprintf( inFile,
+					"\tAOT_EXIT(0x%08X);\n",
+					(unsigned int) (theAddress + 4) );
+			}
+		}
+	}
+
+	(void) ::fprintf( inFile, "}\n\n" );
+	return true;
+}
+
+// -------------------------------------------------------------------------- //
+//  * EmitInstruction( FILE*, KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TAOTCompiler::EmitInstruction(
+			FILE* inFile,
+			KUInt32 inInstruction,
+			KUInt32 inAddress )
+{
+	char theLine[512];
+	UDisasm::Disasm( theLine, sizeof(theLine), inAddress, inInstruction );
+	(void) ::fprintf( inFile,
+		"\t// %08X  %s\n"
+		"\tAOT_INSN();\n",
+		(unsigned int) inAddress,
+		theLine );
+
+	KUInt32 theCondition = inInstruction >> 28;
+	if (theCondition == 0xF)
+	{
+		return;
+	}
+	if (theCondition != 0xE)
+	{
+		(void) ::fprintf( inFile,
+			"\tif (ioCPU->Test%s())\n",
+			kConditions[theCondition] );
+	}
+	(void) ::fprintf( inFile, "\t{\n" );
+
+	switch ((inInstruction >> 25) & 0x7)
+	{
+		case 0x0:
+			if ((inInstruction & 0x0FC000F0) == 0x00000090)
+			{
+				EmitMultiply( inFile, inInstruction );
+				break;
+			}
+			// Fall through.
+		case 0x1:
+			EmitDataProcessing( inFile, inInstruction, inAddress );
+			break;
+
+		case 0x2:
+		case 0x3:
+			EmitSingleDataTransfer( inFile, inInstruction, inAddress );
+			break;
+
+		case 0x4:
+			EmitBlockDataTransfer( inFile, inInstruction, inAddress );
+			break;
+
+		case 0x5:
+			EmitBranch( inFile, inInstruction, inAddress );
+			break;
+	}
+
+	(void) ::fprintf( inFile, "\t}\n" );
+}
+
+// -------------------------------------------------------------------------- //
+//  * Register( KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+std::string
+TAOTCompiler::Register( KUInt32 inReg, KUInt32 inAddress )
+{
+	char theString[32];
+	if (inReg == 15)
+	{
+		(void) ::sprintf( theString, "0x%08XU", (unsigned int) (inAddress + 8) );
+	} else {
+		(void) ::sprintf( theString, "AOT_R(%u)", (unsigned int) inReg );
+	}
+	return theString;
+}
+
+// -------------------------------------------------------------------------- //
+//  * ImmShift( KUInt32, KUInt32, std::string*, std::string* )
+// -------------------------------------------------------------------------- //
+void
+TAOTCompiler::ImmShift(
+			KUInt32 inInstruction,
+			KUInt32 inAddress,
+			std::string* outValue,
+			std::string* outCarry )
+{
+	std::string Rm = Register( inInstruction & 0xF, inAddress );
+	KUInt32 theAmount = (inInstruction >> 7) & 0x1F;
+	char theValue[128];
+	char theCarry[128];
+	switch ((inInstruction >> 5) & 0x3)
+	{
+		case 0x0:	// LSL
+			if (theAmount == 0)
+			{
+				(void) ::sprintf( theValue, "%s", Rm.c_str() );
+				(void) ::sprintf( theCarry, "ioCPU->mCPSR_C" );
+			} else {
+				(void) ::sprintf( theValue, "(%s << %u)",
+							Rm.c_str(), (unsigned int) theAmount );
+				(void) ::sprintf( theCarry, "((%s >> %u) & 1)",
+							Rm.c_str(), (unsigned int) (32 - theAmount) );
+			}
+			break;
+
+		case 0x1:	// LSR
+			if (theAmount == 0)
+			{
+				(void) ::sprintf( theValue, "0" );
+				(void) ::sprintf( theCarry, "(%s >> 31)", Rm.c_str() );
+			} else {
+				(void) ::sprintf( theValue, "(%s >> %u)",
+							Rm.c_str(), (unsigned int) theAmount );
+				(void) ::sprintf( theCarry, "((%s >> %u) & 1)",
+							Rm.c_str(), (unsigned int) (theAmount - 1) );
+			}
+			break;
+
+		case 0x2:	// ASR
+			if (theAmount == 0)
+			{
+				theAmount = 32;
+			}
+			(void) ::sprintf( theValue, "(KUInt32) ((KSInt32) %s >> %u)",
+						Rm.c_str(), (unsigned int) (theAmount == 32 ? 31 : theAmount) );
+			(void) ::sprintf( theCarry, "((%s >> %u) & 1)",
+						Rm.c_str(), (unsigned int) (theAmount - 1) );
+			break;
+
+		case 0x3:	// ROR
+			if (theAmount == 0)
+			{
+				// RRX
+				(void) ::sprintf( theValue, "(((KUInt32) ioCPU->mCPSR_C << 31) | (%s >> 1))",
+							Rm.c_str() );
+				(void) ::sprintf( theCarry, "(%s & 1)", Rm.c_str() );
+			} else {
+				(void) ::sprintf( theValue, "((%s >> %u) | (%s << %u))",
+							Rm.c_str(), (unsigned int) theAmount,
+							Rm.c_str(), (unsigned int) (32 - theAmount) );
+				(void) ::sprintf( theCarry, "((%s >> %u) & 1)",
+							Rm.c_str(), (unsigned int) (theAmount - 1) );
+			}
+			break;
+	}
+	*outValue = theValue;
+	*outCarry = theCarry;
+}
+
+// -------------------------------------------------------------------------- //
+//  * EmitDataProcessing( FILE*, KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TAOTCompiler::EmitDataProcessing(
+			FILE* inFile,
+			KUInt32 inInstruction,
+			KUInt32 inAddress )
+{
+	KUInt32 theOpCode = (inInstruction >> 21) & 0xF;
+	Boolean theS = (inInstruction & 0x00100000) != 0;
+	KUInt32 Rn = (inInstruction >> 16) & 0xF;
+	KUInt32 Rd = (inInstruction >> 12) & 0xF;
+	std::string theRn = Register( Rn, inAddress );
+
+	// Second operand and carry of the shifter.
+	std::string theOp2;
+	std::string theShifterCarry;
+	if (inInstruction & 0x02000000)
+	{
+		KUInt32 theImmediate = inInstruction & 0xFF;
+		KUInt32 theRotate = ((inInstruction >> 8) & 0xF) * 2;
+		if (theRotate)
+		{
+			theImmediate =
+				(theImmediate >> theRotate) | (theImmediate << (32 - theRotate));
+		}
+		char theString[32];
+		(void) ::sprintf( theString, "0x%08XU", (unsigned int) theImmediate );
+		theOp2 = theString;
+		theShifterCarry = (theRotate == 0) ? "ioCPU->mCPSR_C"
+			: ((theImmediate & 0x80000000) ? "1" : "0");
+	} else {
+		ImmShift( inInstruction, inAddress, &theOp2, &theShifterCarry );
+	}
+
+	Boolean isLogical = false;
+	Boolean isTest = false;
+	std::string theResult;
+	switch (theOpCode)
+	{
+		case 0x0:	// AND
+			theResult = theRn + " & theOp2";
+			isLogical = true;
+			break;
+		case 0x1:	// EOR
+			theResult = theRn + " ^ theOp2";
+			isLogical = true;
+			break;
+		case 0x2:	// SUB
+			theResult = theS ? "AOT_SUBS(ioCPU, " + theRn + ", theOp2, 1)"
+				: theRn + " - theOp2";
+			break;
+		case 0x3:	// RSB
+			theResult = theS ? "AOT_SUBS(ioCPU, theOp2, " + theRn + ", 1)"
+				: "theOp2 - " + theRn;
+			break;
+		case 0x4:	// ADD
+			theResult = theS ? "AOT_ADDS(ioCPU, " + theRn + ", theOp2, 0)"
+				: theRn + " + theOp2";
+			break;
+		case 0x5:	// ADC
+			theResult = theS ? "AOT_ADDS(ioCPU, " + theRn + ", theOp2, ioCPU->mCPSR_C)"
+				: theRn + " + theOp2 + ioCPU->mCPSR_C";
+			break;
+		case 0x6:	// SBC
+			theResult = theS ? "AOT_SUBS(ioCPU, " + theRn + ", theOp2, ioCPU->mCPSR_C)"
+				: theRn + " - theOp2 - !ioCPU->mCPSR_C";
+			break;
+		case 0x7:	// RSC
+			theResult = theS ? "AOT_SUBS(ioCPU, theOp2, " + theRn + ", ioCPU->mCPSR_C)"
+				: "theOp2 - " + theRn + " - !ioCPU->mCPSR_C";
+			break;
+		case 0x8:	// TST
+			theResult = theRn + " & theOp2";
+			isLogical = true;
+			isTest = true;
+			break;
+		case 0x9:	// TEQ
+			theResult = theRn + " ^ theOp2";
+			isLogical = true;
+			isTest = true;
+			break;
+		case 0xA:	// CMP
+			theResult = "AOT_SUBS(ioCPU, " + theRn + ", theOp2, 1)";
+			isTest = true;
+			break;
+		case 0xB:	// CMN
+			theResult = "AOT_ADDS(ioCPU, " + theRn + ", theOp2, 0)";
+			isTest = true;
+			break;
+		case 0xC:	// ORR
+			theResult = theRn + " | theOp2";
+			isLogical = true;
+			break;
+		case 0xD:	// MOV
+			theResult = "theOp2";
+			isLogical = true;
+			break;
+		case 0xE:	// BIC
+			theResult = theRn + " & ~theOp2";
+			isLogical = true;
+			break;
+		case 0xF:	// MVN
+			theResult = "~theOp2";
+			isLogical = true;
+			break;
+	}
+
+	(void) ::fprintf( inFile, "\t\tKUInt32 theOp2 = %s;\n", theOp2.c_str() );
+	if (theS && isLogical)
+	{
+		// The carry is computed before the registers change.
+		(void) ::fprintf( inFile,
+			"\t\tBoolean theCarry = %s;\n", theShifterCarry.c_str() );
+		theResult = "AOT_NZC(ioCPU, " + theResult + ", theCarry)";
+	}
+
+	if (isTest)
+	{
+		(void) ::fprintf( inFile, "\t\t(void) (%s);\n", theResult.c_str() );
+	} else if (Rd == 15) {
+		(void) ::fprintf( inFile,
+			"\t\tKUInt32 theTarget = %s;\n"
+			"\t\tAOT_EXIT(theTarget);\n",
+			theResult.c_str() );
+	} else {
+		(void) ::fprintf( inFile,
+			"\t\tAOT_R(%u) = %s;\n",
+			(unsigned int) Rd, theResult.c_str() );
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * EmitMultiply( FILE*, KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TAOTCompiler::EmitMultiply( FILE* inFile, KUInt32 inInstruction )
+{
+	KUInt32 Rd = (inInstruction >> 16) & 0xF;
+	KUInt32 Rn = (inInstruction >> 12) & 0xF;
+	KUInt32 Rs = (inInstruction >> 8) & 0xF;
+	KUInt32 Rm = inInstruction & 0xF;
+	if (inInstruction & 0x00200000)
+	{
+		(void) ::fprintf( inFile,
+			"\t\tAOT_R(%u) = (AOT_R(%u) * AOT_R(%u)) + AOT_R(%u);\n",
+			(unsigned int) Rd, (unsigned int) Rm,
+			(unsigned int) Rs, (unsigned int) Rn );
+	} else {
+		(void) ::fprintf( inFile,
+			"\t\tAOT_R(%u) = AOT_R(%u) * AOT_R(%u);\n",
+			(unsigned int) Rd, (unsigned int) Rm, (unsigned int) Rs );
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * EmitSingleDataTransfer( FILE*, KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TAOTCompiler::EmitSingleDataTransfer(
+			FILE* inFile,
+			KUInt32 inInstruction,
+			KUInt32 inAddress )
+{
+	Boolean theP = (inInstruction & 0x01000000) != 0;
+	Boolean theU = (inInstruction & 0x00800000) != 0;
+	Boolean theB = (inInstruction & 0x00400000) != 0;
+	Boolean theW = (inInstruction & 0x00200000) != 0;
+	Boolean theL = (inInstruction & 0x00100000) != 0;
+	KUInt32 Rn = (inInstruction >> 16) & 0xF;
+	KUInt32 Rd = (inInstruction >> 12) & 0xF;
+	const char* theSign = theU ? "+" : "-";
+
+	std::string theOffset;
+	if (inInstruction & 0x02000000)
+	{
+		std::string theCarry;
+		ImmShift( inInstruction, inAddress, &theOffset, &theCarry );
+	} else {
+		char theString[32];
+		(void) ::sprintf( theString, "0x%03X",
+					(unsigned int) (inInstruction & 0xFFF) );
+		theOffset = theString;
+	}
+
+	(void) ::fprintf( inFile,
+		"\t\tKUInt32 theOffset = %s;\n"
+		"\t\tKUInt32 theAddress = %s",
+		theOffset.c_str(),
+		Register( Rn, inAddress ).c_str() );
+	if (theP)
+	{
+		(void) ::fprintf( inFile, " %s theOffset", theSign );
+	}
+	(void) ::fprintf( inFile, ";\n" );
+
+	if (theL)
+	{
+		(void) ::fprintf( inFile,
+			"\t\t%s theData;\n"
+			"\t\t%s(0x%08X, theAddress, theData);\n",
+			theB ? "KUInt8" : "KUInt32",
+			theB ? "AOT_READB" : "AOT_READ",
+			(unsigned int) inAddress );
+	} else {
+		std::string theValue;
+		if (Rd == 15)
+		{
+			char theString[32];
+			(void) ::sprintf( theString, "0x%08XU", (unsigned int) (inAddress + 12) );
+			theValue = theString;
+		} else {
+			theValue = Register( Rd, inAddress );
+		}
+		(void) ::fprintf( inFile,
+			"\t\t%s(0x%08X, theAddress, %s);\n",
+			theB ? "AOT_WRITEB" : "AOT_WRITE",
+			(unsigned int) inAddress,
+			theValue.c_str() );
+	}
+
+	if (theW || !theP)
+	{
+		if (theP)
+		{
+			(void) ::fprintf( inFile,
+				"\t\tAOT_R(%u) = theAddress;\n", (unsigned int) Rn );
+		} else {
+			(void) ::fprintf( inFile,
+				"\t\tAOT_R(%u) = theAddress %s theOffset;\n",
+				(unsigned int) Rn, theSign );
+		}
+	}
+
+	if (theL)
+	{
+		if (Rd == 15)
+		{
+			(void) ::fprintf( inFile, "\t\tAOT_EXIT(theData);\n" );
+		} else {
+			(void) ::fprintf( inFile,
+				"\t\tAOT_R(%u) = theData;\n", (unsigned int) Rd );
+		}
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * EmitBlockDataTransfer( FILE*, KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TAOTCompiler::EmitBlockDataTransfer(
+			FILE* inFile,
+			KUInt32 inInstruction,
+			KUInt32 inAddress )
+{
+	Boolean theP = (inInstruction & 0x01000000) != 0;
+	Boolean theU = (inInstruction & 0x00800000) != 0;
+	Boolean theW = (inInstruction & 0x00200000) != 0;
+	Boolean theL = (inInstruction & 0x00100000) != 0;
+	KUInt32 Rn = (inInstruction >> 16) & 0xF;
+	KUInt32 theList = inInstruction & 0xFFFF;
+
+	KUInt32 theCount = 0;
+	KUInt32 indexReg;
+	for (indexReg = 0; indexReg < 16; indexReg++)
+	{
+		if (theList & (1 << indexReg))
+		{
+			theCount++;
+		}
+	}
+
+	// Lowest address, registers are transferred in ascending order.
+	KUInt32 theStart;
+	if (theU)
+	{
+		theStart = theP ? 4 : 0;
+	} else {
+		theStart = (theP ? 0 : 4) - (theCount * 4);
+	}
+	(void) ::fprintf( inFile,
+		"\t\tKUInt32 theAddress = AOT_R(%u) + 0x%08XU;\n",
+		(unsigned int) Rn, (unsigned int) theStart );
+
+	KUInt32 theOffset = 0;
+	if (theL)
+	{
+		// Load everything first, an abort leaves the registers unchanged.
+		(void) ::fprintf( inFile,
+			"\t\tKUInt32 theData[%u];\n", (unsigned int) theCount );
+		for (indexReg = 0; indexReg < theCount; indexReg++)
+		{
+			(void) ::fprintf( inFile,
+				"\t\tAOT_READ(0x%08X, theAddress + %u, theData[%u]);\n",
+				(unsigned int) inAddress,
+				(unsigned int) (indexReg * 4),
+				(unsigned int) indexReg );
+		}
+	} else {
+		for (indexReg = 0; indexReg < 16; indexReg++)
+		{
+			if (theList & (1 << indexReg))
+			{
+				std::string theValue;
+				if (indexReg == 15)
+				{
+					char theString[32];
+					(void) ::sprintf( theString, "0x%08XU",
+								(unsigned int) (inAddress + 12) );
+					theValue = theString;
+				} else {
+					theValue = Register( indexReg, inAddress );
+				}
+				(void) ::fprintf( inFile,
+					"\t\tAOT_WRITE(0x%08X, theAddress + %u, %s);\n",
+					(unsigned int) inAddress,
+					(unsigned int) theOffset,
+					theValue.c_str() );
+				theOffset += 4;
+			}
+		}
+	}
+
+	if (theW)
+	{
+		(void) ::fprintf( inFile,
+			"\t\tAOT_R(%u) %s= %u;\n",
+			(unsigned int) Rn,
+			theU ? "+" : "-",
+			(unsigned int) (theCount * 4) );
+	}
+
+	if (theL)
+	{
+		KUInt32 indexData = 0;
+		for (indexReg = 0; indexReg < 16; indexReg++)
+		{
+			if (theList & (1 << indexReg))
+			{
+				if (indexReg == 15)
+				{
+					(void) ::fprintf( inFile,
+						"\t\tAOT_EXIT(theData[%u]);\n",
+						(unsigned int) indexData );
+				} else {
+					(void) ::fprintf( inFile,
+						"\t\tAOT_R(%u) = theData[%u];\n",
+						(unsigned int) indexReg,
+						(unsigned int) indexData );
+				}
+				indexData++;
+			}
+		}
+	}
+}
+
+// -------------------------------------------------------------------------- //
+//  * EmitBranch( FILE*, KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TAOTCompiler::EmitBranch(
+			FILE* inFile,
+			KUInt32 inInstruction,
+			KUInt32 inAddress )
+{
+	KUInt32 theTarget = BranchTarget( inInstruction, inAddress );
+	if (inInstruction & 0x01000000)
+	{
+		// Call, the JIT continues in the callee.
+		(void) ::fprintf( inFile,
+			"\t\tAOT_R(14) = 0x%08XU;\n"
+			"\t\tAOT_EXIT(0x%08X);\n",
+			(unsigned int) (inAddress + 4),
+			(unsigned int) theTarget );
+	} else if (mLabels.count( theTarget )) {
+		if (theTarget <= inAddress)
+		{
+			// Leave long loops to the JIT, for the interrupts.
+			(void) ::fprintf( inFile,
+				"\t\tif (++theLoops < AOT_MAX_LOOPS) goto L%08X;\n"
+				"\t\tAOT_EXIT(0x%08X);\n",
+				(unsigned int) theTarget,
+				(unsigned int) theTarget );
+		} else {
+			(void) ::fprintf( inFile,
+				"\t\tgoto L%08X;\n",
+				(unsigned int) theTarget );
+		}
+	} else {
+		(void) ::fprintf( inFile,
+			"\t\tAOT_EXIT(0x%08X);\n",
+			(unsigned int) theTarget );
+	}
+}
+
+// ==================================================================== //
+// The first 90% of the code accounts for the first 90% of the          //
+// development time.  The remaining 10% of the code accounts for the    //
+// other 90% of the development time.                                   //
+//                 -- Tom Cargill                                       //
+// ==================================================================== //
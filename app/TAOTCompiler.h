@@ -0,0 +1,181 @@
+// ==============================
+// File:			TAOTCompiler.h
+// Project:			Einstein
+//
+// Copyright 2003-2007 by Paul Guyot (pguyot@kallisys.net).
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+#ifndef _TAOTCOMPILER_H
+#define _TAOTCOMPILER_H
+
+#include <K/Defines/KDefinitions.h>
+
+#include <stdio.h>
+#include <set>
+#include <string>
+
+///
+/// Ahead of time compiler of ROM functions into C++.
+///
+/// A function is translated from its entry point, following branches within
+/// a window after the entry. Data processing with immediate shifts,
+/// multiplications, single and block data transfers and branches are
+/// translated. The translation leaves to the JIT at the first instruction
+/// that is not, at calls and at loads into the PC.
+///
+/// The output uses the macros of PrecompiledPatches.h.
+///
+class TAOTCompiler
+{
+public:
+	///
+	/// Constructor from the ROM.
+	///
+	/// \param inROM			ROM words, in host order, before patches.
+	/// \param inPatchedROM		ROM words after the patches of the JIT were
+	///							applied.
+	/// \param inROMSize		size of the ROM in bytes.
+	/// \param inWindow			number of instructions after the entry point
+	///							that may be translated.
+	///
+	TAOTCompiler(
+			const KUInt32* inROM,
+			const KUInt32* inPatchedROM,
+			KUInt32 inROMSize,
+			KUInt32 inWindow );
+
+	///
+	/// Write the start of the output file.
+	///
+	/// \param inFile		output file.
+	/// \param inVerify		whether the translations are verified.
+	///
+	static void	WriteHeader( FILE* inFile, Boolean inVerify );
+
+	///
+	/// Write the end of the output file.
+	///
+	/// \param inFile		output file.
+	/// \param inCount		number of translated functions.
+	///
+	static void	WriteFooter( FILE* inFile, KUInt32 inCount );
+
+	///
+	/// Translate a function.
+	///
+	/// \param inFile		output file.
+	/// \param inEntry		address of the function.
+	/// \param inHits		number of hits from the profile.
+	/// \return \c true if the function was translated, \c false if its first
+	///			instruction cannot be.
+	///
+	Boolean		Compile( FILE* inFile, KUInt32 inEntry, KUInt64 inHits );
+
+private:
+	///
+	/// Constructeur par copie volontairement indisponible.
+	///
+	/// \param inCopy		objet  copier
+	///
+	TAOTCompiler( const TAOTCompiler& inCopy );
+
+	///
+	/// Oprateur d'assignation volontairement indisponible.
+	///
+	/// \param inCopy		objet  copier
+	///
+	TAOTCompiler& operator = ( const TAOTCompiler& inCopy );
+
+	///
+	/// Get an instruction of the ROM.
+	///
+	/// \param inAddress	address of the instruction.
+	/// \param outInstruction	the instruction, without the translations
+	///							of a previous run.
+	/// \return \c false if the address is out of the ROM or is patched.
+	///
+	Boolean		GetInstruction( KUInt32 inAddress, KUInt32* outInstruction ) const;
+
+	///
+	/// Determine if an instruction can be translated.
+	///
+	static Boolean	CanTranslate( KUInt32 inInstruction );
+
+	///
+	/// Determine if an instruction continues with the next one.
+	///
+	static Boolean	FallsThrough( KUInt32 inInstruction );
+
+	///
+	/// Determine if an instruction writes the PC (and leaves the function).
+	///
+	static Boolean	WritesPC( KUInt32 inInstruction );
+
+	///
+	/// Target of a branch.
+	///
+	static KUInt32	BranchTarget( KUInt32 inInstruction, KUInt32 inAddress );
+
+	///
+	/// Find the instructions of the function and the targets of branches.
+	///
+	void		Discover( KUInt32 inEntry );
+
+	/// \name Emission
+	void		EmitInstruction( FILE* inFile, KUInt32 inInstruction, KUInt32 inAddress );
+	void		EmitDataProcessing( FILE* inFile, KUInt32 inInstruction, KUInt32 inAddress );
+	void		EmitMultiply( FILE* inFile, KUInt32 inInstruction );
+	void		EmitSingleDataTransfer( FILE* inFile, KUInt32 inInstruction, KUInt32 inAddress );
+	void		EmitBlockDataTransfer( FILE* inFile, KUInt32 inInstruction, KUInt32 inAddress );
+	void		EmitBranch( FILE* inFile, KUInt32 inInstruction, KUInt32 inAddress );
+
+	///
+	/// Expression of a register read by the instruction at inAddress.
+	///
+	static std::string	Register( KUInt32 inReg, KUInt32 inAddress );
+
+	///
+	/// Expressions of an operand shifted by an immediate and of the carry
+	/// out of the shifter.
+	///
+	static void			ImmShift(
+							KUInt32 inInstruction,
+							KUInt32 inAddress,
+							std::string* outValue,
+							std::string* outCarry );
+
+	/// \name Variables
+	const KUInt32*		mROM;			///< ROM before patches.
+	const KUInt32*		mPatchedROM;	///< ROM after patches.
+	KUInt32				mROMSize;		///< Size of the ROM in bytes.
+	KUInt32				mWindow;		///< Instructions after the entry.
+	KUInt32				mEntry;			///< Entry of the current function.
+	std::set<KUInt32>	mTranslated;	///< Instructions that are translated.
+	std::set<KUInt32>	mExits;			///< Instructions left to the JIT.
+	std::set<KUInt32>	mLabels;		///< Targets of branches.
+};
+
+#endif
+		// _TAOTCOMPILER_H
+
+// ======================================================================= //
+// A language that doesn't affect the way you think about programming is   //
+// not worth knowing.                                                      //
+//                 -- Alan Perlis                                          //
+// ======================================================================= //
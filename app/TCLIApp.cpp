@@ -49,6 +49,7 @@
 #include "Emulator/Sound/TPulseAudioSoundManager.h"
 #endif
 #include "Emulator/Sound/TNullSoundManager.h"
+#include "Emulator/Screen/TNullScreenManager.h"
 #ifndef NOX11
 #include "Emulator/Screen/TX11ScreenManager.h"
 #else
@@ -68,6 +69,7 @@
 // -------------------------------------------------------------------------- //
 // Constantes
 // -------------------------------------------------------------------------- //
+static const int kMaxInstances = 64;
 
 // -------------------------------------------------------------------------- //
 //  * TCLIApp( void )
@@ -95,6 +97,14 @@ TCLIApp::~TCLIApp( void )
 {
     ::close(mCmdPipe[0]);
     ::close(mCmdPipe[1]);
+	std::vector<SInstance>::iterator it;
+	for (it = mInstances.begin(); it != mInstances.end(); ++it)
+	{
+		delete it->fEmulator;
+		delete it->fScreenManager;
+		delete it->fNetworkManager;
+		delete it->fSoundManager;
+	}
 	if (mEmulator)
 	{
 		delete mEmulator;
@@ -147,6 +157,9 @@ TCLIApp::Run( int argc, char* argv[] )
 	int portraitWidth = TScreenManager::kDefaultPortraitWidth;
 	int portraitHeight = TScreenManager::kDefaultPortraitHeight;
 	int ramSize = 0x40;
+	int jitCacheSize = 0;			// Default size of the JIT cache.
+	int tlbSize = 0;				// Default size of the TLB of the MMU.
+	int instances = 1;				// Default is one emulator.
 	Boolean fullscreen = false;		// Default is not full screen.
 	Boolean useAIFROMFile = false;	// Default is to use flat rom format.
 	Boolean faceless = false;		// Default is to have an interface.
@@ -276,6 +289,34 @@ TCLIApp::Run( int argc, char* argv[] )
 					"first bank is handled)\nI'll boot with 4 MB (64).\n");
 				ramSize = 0x40;
 			}
+		} else if (::sscanf(argv[indexArgs], "--jitcache=%i", &jitCacheSize) == 1) {
+			if ((jitCacheSize < 2) || (jitCacheSize > 16384))
+			{
+				(void) ::fprintf(
+					stderr,
+					"JIT cache size must be between 2 and 16384 pages\n"
+					"I'll use the default size (128).\n");
+				jitCacheSize = 0;
+			}
+		} else if (::sscanf(argv[indexArgs], "--tlbsize=%i", &tlbSize) == 1) {
+			if ((tlbSize < 2) || (tlbSize > 16384))
+			{
+				(void) ::fprintf(
+					stderr,
+					"TLB size must be between 2 and 16384 entries\n"
+					"I'll use the default size (256).\n");
+				tlbSize = 0;
+			}
+		} else if (::sscanf(argv[indexArgs], "--instances=%i", &instances) == 1) {
+			if ((instances < 1) || (instances > kMaxInstances))
+			{
+				(void) ::fprintf(
+					stderr,
+					"Number of instances must be between 1 and %i\n"
+					"I'll run one emulator.\n",
+					kMaxInstances );
+				instances = 1;
+			}
         } else if (::strncmp(argv[indexArgs], "--serial=tcp:", 13) == 0) {
             theSerialPortDriver = argv[indexArgs]+9;
         } else if (::strcmp(argv[indexArgs], "--serial=tcp") == 0) {
@@ -305,6 +346,12 @@ TCLIApp::Run( int argc, char* argv[] )
 		::exit(0);
 	}
 
+	if ((instances > 1) && (useMonitor || (theRestoreFile != nil)))
+	{
+		(void) ::printf( "--instances is exclusive with --monitor and --restore.\n" );
+		::exit(0);
+	}
+
 	if (portraitHeight < portraitWidth)
 	{
 		(void) ::fprintf(
@@ -357,10 +404,14 @@ TCLIApp::Run( int argc, char* argv[] )
 	mNetworkManager = new TNullNetwork(mLog);
 	mEmulator = new TEmulator(
 				mLog, mROMImage, theFlashPath,
-				mSoundManager, mScreenManager, mNetworkManager, ramSize << 16 );
+				mSoundManager, mScreenManager, mNetworkManager, ramSize << 16,
+				jitCacheSize, tlbSize );
 
 	mPlatformManager = mEmulator->GetPlatformManager();
 
+	CreateInstances(
+		instances - 1, theDataPath, ramSize << 16, jitCacheSize, tlbSize );
+
 	mEmulator->CallOnQuit(
 	        [this]() {
                 ::write(mCmdPipe[1], "Q", 1);
@@ -449,6 +500,7 @@ TCLIApp::Run( int argc, char* argv[] )
 		(void) ::fprintf( stderr, "Error with pthread_create (%i)\n", theErr );
 		::exit(2);
 	}
+	StartInstances();
 
 	if (!faceless)
 	{
@@ -457,6 +509,101 @@ TCLIApp::Run( int argc, char* argv[] )
 
 	// Wait for the thread to finish.
 	(void) ::pthread_join( theThread, NULL );
+
+	// The other emulators quit with the first one.
+	StopInstances();
+}
+
+// -------------------------------------------------------------------------- //
+// CreateInstances( int, const char*, KUInt32, KUInt32, KUInt32 )
+// -------------------------------------------------------------------------- //
+void
+TCLIApp::CreateInstances(
+				int inCount,
+				const char* inDataPath,
+				KUInt32 inRAMSize,
+				KUInt32 inJITCacheSize,
+				KUInt32 inTLBSize )
+{
+	// The ROM image is mapped once: the emulators only read it and an
+	// emulator that writes into its ROM (breakpoints) gets a copy.
+	// Everything else, from the RAM to the JIT cache, is per emulator.
+	int indexInstance;
+	for (indexInstance = 0; indexInstance < inCount; indexInstance++)
+	{
+		char theFlashPath[512];
+		(void) ::snprintf( theFlashPath, 512, "%s/flash-%i",
+							inDataPath, indexInstance + 2 );
+
+		SInstance theInstance;
+		theInstance.fSoundManager = new TNullSoundManager( mLog );
+		theInstance.fScreenManager = new TNullScreenManager( mLog );
+		theInstance.fNetworkManager = new TNullNetwork( mLog );
+		theInstance.fEmulator = new TEmulator(
+					mLog, mROMImage, theFlashPath,
+					theInstance.fSoundManager,
+					theInstance.fScreenManager,
+					theInstance.fNetworkManager,
+					inRAMSize,
+					inJITCacheSize,
+					inTLBSize );
+		theInstance.fEmulator->SerialPorts.Initialize(
+					TSerialPorts::kNullDriver,
+					TSerialPorts::kNullDriver,
+					TSerialPorts::kNullDriver,
+					TSerialPorts::kNullDriver );
+		mInstances.push_back( theInstance );
+	}
+}
+
+// -------------------------------------------------------------------------- //
+// StartInstances( void )
+// -------------------------------------------------------------------------- //
+void
+TCLIApp::StartInstances( void )
+{
+	std::vector<SInstance>::iterator it;
+	for (it = mInstances.begin(); it != mInstances.end(); ++it)
+	{
+		int theErr = ::pthread_create(
+					&it->fThread, NULL, SInstanceEntry, it->fEmulator );
+		if (theErr)
+		{
+			(void) ::fprintf( stderr, "Error with pthread_create (%i)\n", theErr );
+			::exit(2);
+		}
+	}
+	if (!mInstances.empty())
+	{
+		(void) ::printf( "Running %i emulators.\n", (int) mInstances.size() + 1 );
+	}
+}
+
+// -------------------------------------------------------------------------- //
+// StopInstances( void )
+// -------------------------------------------------------------------------- //
+void
+TCLIApp::StopInstances( void )
+{
+	std::vector<SInstance>::iterator it;
+	for (it = mInstances.begin(); it != mInstances.end(); ++it)
+	{
+		it->fEmulator->Stop();
+	}
+	for (it = mInstances.begin(); it != mInstances.end(); ++it)
+	{
+		(void) ::pthread_join( it->fThread, NULL );
+	}
+}
+
+// -------------------------------------------------------------------------- //
+// SInstanceEntry( void* )
+// -------------------------------------------------------------------------- //
+void*
+TCLIApp::SInstanceEntry( void* inEmulator )
+{
+	((TEmulator*) inEmulator)->Run();
+	return NULL;
 }
 
 // -------------------------------------------------------------------------- //
@@ -807,6 +954,13 @@ TCLIApp::Help( void )
 				"  --monitor                       monitor mode\n" );
 	(void) ::printf(
 				"  --ram=size                      ram size in 64 KB (1-255) (default: 64, i.e. 4 MB)\n" );
+	(void) ::printf(
+				"  --jitcache=pages                JIT cache size in 1 KB pages (2-16384) (default: 128)\n" );
+	(void) ::printf(
+				"  --tlbsize=entries               MMU TLB size for small pages (2-16384) (default: 256)\n" );
+	(void) ::printf(
+				"  --instances=count               emulators sharing the ROM (1-64), the others\n"
+				"                                  are headless and use data_path/flash-2, ...\n" );
 	(void) ::printf(
 				"  --aif                           read aif files\n" );
 	::exit(1);
@@ -28,6 +28,9 @@
 
 #include "Version.h"
 
+#include <pthread.h>
+#include <vector>
+
 class TROMImage;
 class TEmulator;
 class TNetworkManager;
@@ -135,6 +138,39 @@ private:
 	///
 	void ThreadEntry( void );
 
+	///
+	/// Point d'entrée du processus léger d'un émulateur supplémentaire.
+	///
+	static void* SInstanceEntry( void* inEmulator );
+
+	///
+	/// Crée les émulateurs supplémentaires, sans interface. Ils partagent
+	/// l'image ROM et le log du premier émulateur, chacun a sa mémoire
+	/// flash.
+	///
+	/// \param inCount		nombre d'émulateurs supplémentaires.
+	/// \param inDataPath	chemin des données.
+	/// \param inRAMSize	taille de la RAM.
+	/// \param inJITCacheSize	taille du cache du JIT.
+	/// \param inTLBSize	taille du TLB de la MMU.
+	///
+	void CreateInstances(
+				int inCount,
+				const char* inDataPath,
+				KUInt32 inRAMSize,
+				KUInt32 inJITCacheSize,
+				KUInt32 inTLBSize );
+
+	///
+	/// Lance les émulateurs supplémentaires.
+	///
+	void StartInstances( void );
+
+	///
+	/// Arrête les émulateurs supplémentaires et attend leurs processus légers.
+	///
+	void StopInstances( void );
+
 	///
 	/// Boucle du menu.
 	///
@@ -180,6 +216,16 @@ private:
 	TSymbolList*		mSymbolList;		///< List of symbols.
 	Boolean				mQuit;				///< If we should quit.
 	int                 mCmdPipe[2] {-1, -1}; ///< Make the command line wait for keyboard an a possible Quit event
+
+	/// Emulateur supplémentaire.
+	struct SInstance {
+		TEmulator*			fEmulator;			///< Emulateur.
+		TNetworkManager*	fNetworkManager;	///< Network Manager.
+		TSoundManager*		fSoundManager;		///< Gestionnaire de son.
+		TScreenManager*		fScreenManager;		///< Gestionnaire d'écran.
+		pthread_t			fThread;			///< Processus léger.
+	};
+	std::vector<SInstance>	mInstances;		///< Emulateurs supplémentaires.
 };
 
 #endif
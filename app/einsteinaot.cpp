@@ -0,0 +1,247 @@
+// ==============================
+// File:			einsteinaot.cp
+// Project:			Einstein
+//
+// Copyright 2003-2007 by Paul Guyot (pguyot@kallisys.net).
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+// ==============================
+// $Id$
+// ==============================
+
+//
+// einsteinaot translates the most called ROM functions into C++ for
+// PrecompiledPatches.cpp.
+//
+// The profile is the output of TJITPerfHitCounter::print with kStyleHex,
+// typically branchLinkDestCount, one "address: hits" line per function.
+//
+
+#include <K/Defines/KDefinitions.h>
+#include <K/Defines/UByteSex.h>
+
+// ANSI C & POSIX
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Einstein
+#include "TAOTCompiler.h"
+#include "Emulator/JIT/JIT.h"
+#include "Emulator/JIT/Generic/TJITGenericROMPatch.h"
+
+// -------------------------------------------------------------------------- //
+// Constantes
+// -------------------------------------------------------------------------- //
+static const KUInt32 kMaxROMSize = 0x01000000;
+static const KUInt32 kDefaultCount = 32;
+static const KUInt32 kDefaultWindow = 256;
+
+typedef std::pair<KUInt64, KUInt32> SHit;
+
+// -------------------------------------------------------------------------- //
+//  * Usage( const char* )
+// -------------------------------------------------------------------------- //
+static void
+Usage( const char* inProgramName )
+{
+	(void) ::fprintf( stderr,
+		"Usage: %s [options] rom-image profile\n"
+		"Translate the most called ROM functions into C++.\n"
+		"\n"
+		"  -n count           number of functions (default %u)\n"
+		"  -o file            output file (default PrecompiledPatches.cpp)\n"
+		"  -m, --machine id   machine of the ROM (default 717006)\n"
+		"  -w, --window count instructions after the entry that are translated\n"
+		"                     (default %u)\n"
+		"  --verify           check the translations against the JIT when\n"
+		"                     they run\n",
+		inProgramName,
+		(unsigned int) kDefaultCount,
+		(unsigned int) kDefaultWindow );
+	::exit(1);
+}
+
+// -------------------------------------------------------------------------- //
+//  * ReadROM( const char*, KUInt32* )
+// -------------------------------------------------------------------------- //
+static KUInt32*
+ReadROM( const char* inPath, KUInt32* outSize )
+{
+	FILE* theFile = ::fopen( inPath, "rb" );
+	if (theFile == NULL)
+	{
+		(void) ::fprintf( stderr, "Cannot open ROM image %s\n", inPath );
+		return NULL;
+	}
+
+	KUInt32* theROM = (KUInt32*) ::calloc( 1, kMaxROMSize );
+	size_t theSize = ::fread( theROM, 1, kMaxROMSize, theFile );
+	(void) ::fclose( theFile );
+	if ((theSize < 0x00800000) || (theSize & 0x3))
+	{
+		(void) ::fprintf( stderr, "%s is not a flat ROM image\n", inPath );
+		::free( theROM );
+		return NULL;
+	}
+
+#if TARGET_RT_LITTLE_ENDIAN
+	KUInt32 indexWord;
+	for (indexWord = 0; indexWord < kMaxROMSize / 4; indexWord++)
+	{
+		theROM[indexWord] = UByteSex::Swap( theROM[indexWord] );
+	}
+#endif
+
+	*outSize = (KUInt32) theSize;
+	return theROM;
+}
+
+// -------------------------------------------------------------------------- //
+//  * ReadProfile( const char*, KUInt32, std::vector<SHit>* )
+// -------------------------------------------------------------------------- //
+static Boolean
+ReadProfile( const char* inPath, KUInt32 inROMSize, std::vector<SHit>* outHits )
+{
+	FILE* theFile = ::fopen( inPath, "r" );
+	if (theFile == NULL)
+	{
+		(void) ::fprintf( stderr, "Cannot open profile %s\n", inPath );
+		return false;
+	}
+
+	// Keep the "address: hits" lines, skip the statistics and the lines
+	// with symbols.
+	char theLine[256];
+	while (::fgets( theLine, sizeof(theLine), theFile ))
+	{
+		unsigned int theAddress;
+		unsigned long long theHits;
+		if ((::sscanf( theLine, "%8X: %llu", &theAddress, &theHits ) == 2)
+			&& (theLine[8] == ':')
+			&& (theAddress < inROMSize))
+		{
+			outHits->push_back( SHit( (KUInt64) theHits, (KUInt32) theAddress ) );
+		}
+	}
+	(void) ::fclose( theFile );
+
+	// Most hit first.
+	std::sort( outHits->begin(), outHits->end() );
+	std::reverse( outHits->begin(), outHits->end() );
+	return true;
+}
+
+// -------------------------------------------------------------------------- //
+// main
+// -------------------------------------------------------------------------- //
+int
+main( int argc, char** argv )
+{
+	const char* theOutputPath = "PrecompiledPatches.cpp";
+	const char* theMachine = "717006";
+	KUInt32 theCount = kDefaultCount;
+	KUInt32 theWindow = kDefaultWindow;
+	Boolean verify = false;
+
+	int indexArgs;
+	for (indexArgs = 1; indexArgs < argc - 2; indexArgs++)
+	{
+		if (::strcmp( argv[indexArgs], "-n" ) == 0) {
+			if (++indexArgs == argc - 2) Usage( argv[0] );
+			theCount = (KUInt32) ::strtoul( argv[indexArgs], NULL, 0 );
+		} else if (::strcmp( argv[indexArgs], "-o" ) == 0) {
+			if (++indexArgs == argc - 2) Usage( argv[0] );
+			theOutputPath = argv[indexArgs];
+		} else if ((::strcmp( argv[indexArgs], "-m" ) == 0)
+					|| (::strcmp( argv[indexArgs], "--machine" ) == 0)) {
+			if (++indexArgs == argc - 2) Usage( argv[0] );
+			theMachine = argv[indexArgs];
+		} else if ((::strcmp( argv[indexArgs], "-w" ) == 0)
+					|| (::strcmp( argv[indexArgs], "--window" ) == 0)) {
+			if (++indexArgs == argc - 2) Usage( argv[0] );
+			theWindow = (KUInt32) ::strtoul( argv[indexArgs], NULL, 0 );
+		} else if (::strcmp( argv[indexArgs], "--verify" ) == 0) {
+			verify = true;
+		} else {
+			Usage( argv[0] );
+		}
+	}
+	if ((indexArgs != argc - 2) || (theWindow == 0))
+	{
+		Usage( argv[0] );
+	}
+
+	// The ROM, and the ROM as the JIT sees it.
+	KUInt32 theROMSize = 0;
+	KUInt32* theROM = ReadROM( argv[argc - 2], &theROMSize );
+	if (theROM == NULL)
+	{
+		return 1;
+	}
+	KUInt32* thePatchedROM = (KUInt32*) ::malloc( kMaxROMSize );
+	(void) ::memcpy( thePatchedROM, theROM, kMaxROMSize );
+	TJITGenericPatchManager::DoPatchROM( thePatchedROM, theMachine );
+
+	std::vector<SHit> theHits;
+	if (!ReadProfile( argv[argc - 1], theROMSize, &theHits ))
+	{
+		return 1;
+	}
+
+	FILE* theOutput = ::fopen( theOutputPath, "w" );
+	if (theOutput == NULL)
+	{
+		(void) ::fprintf( stderr, "Cannot create %s\n", theOutputPath );
+		return 1;
+	}
+
+	TAOTCompiler theCompiler( theROM, thePatchedROM, theROMSize, theWindow );
+	TAOTCompiler::WriteHeader( theOutput, verify );
+	KUInt32 theTranslated = 0;
+	std::vector<SHit>::const_iterator it;
+	for (it = theHits.begin();
+		(it != theHits.end()) && (theTranslated < theCount);
+		++it)
+	{
+		if (theCompiler.Compile( theOutput, it->second, it->first ))
+		{
+			theTranslated++;
+		} else {
+			(void) ::fprintf( stderr,
+				"Skipped 0x%08X: first instruction is not translated\n",
+				(unsigned int) it->second );
+		}
+	}
+	TAOTCompiler::WriteFooter( theOutput, theTranslated );
+	(void) ::fclose( theOutput );
+
+	(void) ::fprintf( stderr, "%u functions translated into %s\n",
+				(unsigned int) theTranslated, theOutputPath );
+
+	::free( thePatchedROM );
+	::free( theROM );
+	return 0;
+}
+
+// ========================================================================== //
+// Real programmers don't comment their code.  It was hard to write, it       //
+// should be hard to understand.                                              //
+// ========================================================================== //